@@ -5,6 +5,9 @@
 // includes
 #include "include/ubo_camera.glsl"
 
+// drawn from the render callback, only the main camera renders it
+#define camera CAMERA_MAIN
+
 // input fragment attributes
 layout(location = 1) in vec3 inNearPoint;
 layout(location = 2) in vec3 inFarPoint;
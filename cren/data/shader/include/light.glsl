@@ -0,0 +1,39 @@
+// clustered point lights, the view frustum of the main camera is split in a froxel grid and every cluster lists the lights touching it
+// light_cluster.comp builds the clusters each frame, fragment shaders find their cluster with LightClusterIndex and only shade it's lights
+
+#define LIGHT_CLUSTERS_X 16             // must match cren_defines.h
+#define LIGHT_CLUSTERS_Y 9              // must match cren_defines.h
+#define LIGHT_CLUSTERS_Z 24             // must match cren_defines.h
+#define LIGHTS_PER_CLUSTER_MAX 64       // must match cren_defines.h
+#define LIGHT_CLUSTER_COUNT (LIGHT_CLUSTERS_X * LIGHT_CLUSTERS_Y * LIGHT_CLUSTERS_Z)
+
+// matches vkPointLight (std430)
+struct point_light
+{
+    vec3 position;      // world space
+    float radius;       // the light doesn't reach past it
+    vec3 color;
+    float intensity;
+};
+
+// the cluster buffer starts with the frustum it was built for, then the light count of every cluster and finally
+// LIGHTS_PER_CLUSTER_MAX light indices per cluster. frustum is near, far, tan(fov / 2) * aspect and tan(fov / 2)
+
+// depth slices are exponential so near clusters aren't stretched along the view direction
+float LightClusterSliceDepth(uint slice, vec4 frustum)
+{
+    return frustum.x * pow(frustum.y / frustum.x, float(slice) / float(LIGHT_CLUSTERS_Z));
+}
+
+// returns the cluster a view space position falls on, positions outside the frustum use the closest cluster
+uint LightClusterIndex(vec3 viewPos, vec4 frustum)
+{
+    float depth = max(-viewPos.z, frustum.x);
+    vec2 ndc = viewPos.xy / (depth * frustum.zw);
+
+    uvec3 cluster;
+    cluster.xy = uvec2(clamp((ndc * 0.5 + 0.5) * vec2(LIGHT_CLUSTERS_X, LIGHT_CLUSTERS_Y), vec2(0.0), vec2(LIGHT_CLUSTERS_X - 1, LIGHT_CLUSTERS_Y - 1)));
+    cluster.z = uint(clamp(log(depth / frustum.x) / log(frustum.y / frustum.x) * float(LIGHT_CLUSTERS_Z), 0.0, float(LIGHT_CLUSTERS_Z - 1)));
+
+    return cluster.x + cluster.y * LIGHT_CLUSTERS_X + cluster.z * LIGHT_CLUSTERS_X * LIGHT_CLUSTERS_Y;
+}
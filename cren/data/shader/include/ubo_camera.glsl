@@ -1,8 +1,19 @@
-// this is defined globally and contains information about the camera
+// this is defined globally and contains information about every camera rendering the frame
 
-layout(set = 0, binding = 0) uniform ubo_camera
+#define CREN_VIEWS_MAX 8 // must match cren_defines.h
+
+struct camera_view
 {
     mat4 view;
     mat4 viewInverse;
     mat4 proj;
-} camera;
\ No newline at end of file
+    float time;
+};
+
+layout(set = 0, binding = 0) uniform ubo_camera
+{
+    camera_view views[CREN_VIEWS_MAX];
+} cameras;
+
+// the main camera, shaders including push_constant.glsl see the camera of the view being rendered instead
+#define CAMERA_MAIN cameras.views[0]
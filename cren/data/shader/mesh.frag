@@ -7,12 +7,28 @@
 #include "include/ubo_mesh.glsl"
 #include "include/push_constant.glsl"
 #include "include/fun.glsl"
+#include "include/light.glsl"
 
 // mesh samplers
 layout(set = 0, binding = 2) uniform sampler2D colorMapSampler;
 
+// clustered point lights, see include/light.glsl
+layout(std430, set = 0, binding = 3) readonly buffer Lights { point_light lights[]; };
+layout(std430, set = 0, binding = 4) readonly buffer Clusters
+{
+    vec4 frustum;
+    uint lightCount;
+    uint padding0;
+    uint padding1;
+    uint padding2;
+    uint counts[LIGHT_CLUSTER_COUNT];
+    uint indices[];
+};
+
 // input fragment attributes
 layout(location = 0) in vec2 inFragTexCoord;
+layout(location = 1) in vec3 inWorldPosition;
+layout(location = 2) in vec3 inWorldNormal;
 
 // output fragment color
 layout(location = 0) out vec4 outColor;
@@ -26,4 +42,26 @@ void main()
     if(outColor.a == 0.0) {
         discard;
     }
+
+    // scenes without lights stay unlit
+    if(lightCount == 0u) {
+        return;
+    }
+
+    // clusters are built for the main camera, only the lights of the fragment's cluster are shaded
+    uint cluster = LightClusterIndex((CAMERA_MAIN.view * vec4(inWorldPosition, 1.0)).xyz, frustum);
+    uint clusterLights = counts[cluster];
+    vec3 normal = normalize(inWorldNormal);
+    vec3 lighting = vec3(0.0);
+    const vec3 ambient = vec3(0.15); // keeps what no light reaches from going black
+
+    for(uint i = 0u; i < clusterLights; i++) {
+        point_light light = lights[indices[cluster * LIGHTS_PER_CLUSTER_MAX + i]];
+        vec3 toLight = light.position - inWorldPosition;
+        float distance = length(toLight);
+        float falloff = clamp(1.0 - (distance * distance) / (light.radius * light.radius), 0.0, 1.0);
+        lighting += light.color * light.intensity * falloff * falloff * max(dot(normal, toLight / max(distance, 0.0001)), 0.0);
+    }
+
+    outColor.rgb *= ambient + lighting;
 }
\ No newline at end of file
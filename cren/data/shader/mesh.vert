@@ -14,13 +14,18 @@ layout(location = 2) in vec2 inTexCoord;
 
 // output vertex attributes
 layout(location = 0) out vec2 outFragTexCoord;
+layout(location = 1) out vec3 outWorldPosition;
+layout(location = 2) out vec3 outWorldNormal;
 
 // entrypoint
 void main()
 {
     // set vertex position on world
-    gl_Position = camera.proj * camera.view * pushConstant.model * vec4(inPosition, 1.0);
+    vec4 worldPosition = pushConstant.model * vec4(inPosition, 1.0);
+    gl_Position = camera.proj * camera.view * worldPosition;
 
-    // output variables for the fragment shader
+    // output variables for the fragment shader, the lights are in world space
     outFragTexCoord = inTexCoord;
+    outWorldPosition = worldPosition.xyz;
+    outWorldNormal = mat3(pushConstant.model) * inNormal;
 }
\ No newline at end of file
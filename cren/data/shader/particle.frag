@@ -0,0 +1,23 @@
+#version 460
+#extension GL_GOOGLE_include_directive : enable
+
+// particle sampler
+layout(set = 0, binding = 2) uniform sampler2D colorMapSampler;
+
+// input fragment attributes
+layout(location = 0) in vec2 inFragTexCoord;
+layout(location = 1) in vec4 inFragColor;
+
+// output fragment color
+layout(location = 0) out vec4 outColor;
+
+// entrypoint
+void main()
+{
+    outColor = texture(colorMapSampler, inFragTexCoord) * inFragColor;
+
+    // discard full transparent pixels
+    if(outColor.a == 0.0) {
+        discard;
+    }
+}
\ No newline at end of file
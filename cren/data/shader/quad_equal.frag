@@ -0,0 +1,30 @@
+#version 460
+#extension GL_GOOGLE_include_directive : enable
+#extension GL_ARB_gpu_shader_int64 : enable
+
+// shades the quads after the depth prepass, the equal depth test already rejected the transparent and hidden pixels so nothing is discarded (keeping early depth tests on)
+
+// includes
+#include "include/fun.glsl"
+#include "include/ubo_camera.glsl"
+#include "include/ubo_sprite.glsl"
+#include "include/push_constant.glsl"
+
+// mesh samplers
+layout(set = 0, binding = 2) uniform sampler2D colorMapSampler;
+
+// input fragment attributes
+layout(location = 0) in vec2 inFragTexCoord;
+layout(location = 1) flat in vec2 inFlipbookCell;
+layout(location = 2) flat in uint inSprite;
+
+// output fragment color
+layout(location = 0) out vec4 outColor;
+
+// entrypoint
+void main()
+{
+    SpriteParams spriteParams = sprites[inSprite];
+    vec2 grid = spriteParams.flipbookFrames > 0u ? spriteParams.flipbookGrid : vec2(1.0);
+    outColor = texture(colorMapSampler, TransformFlipbookUV(inFragTexCoord, inFlipbookCell, grid, spriteParams.uv_offset, spriteParams.uv_scale, radians(spriteParams.uv_rotation)));
+}
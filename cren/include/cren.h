@@ -25,6 +25,10 @@
 #include <cren_platform.h>
 #endif
 
+#ifndef CREN_TRACE_INCLUDED
+#include <cren_trace.h>
+#endif
+
 #ifndef CREN_UTILS_INCLUDED
 #include <cren_utils.h>
 #endif
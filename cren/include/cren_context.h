@@ -7,7 +7,8 @@
 /// @brief a list of render stages the frame may be
 typedef enum {
     Default = 0,
-    Picking
+    Picking,
+    Prepass                         // depth-only pass recorded before the default stage, see crenvk_renderphase_default_set_prepass. The render callback is never called with it
 } CRenRenderStage;
 
 /// @brief used for creating the cren context, specifies various details about the cren graphics context. They may however, latter be modified by functions
@@ -22,14 +23,80 @@ typedef struct {
     int width;
     int height;
     int smallerViewport;
-    void* nativeWindow;
+    int picking;                    // creates the picking phase at initialization instead of on first use, see crenvk_renderphase_picking_enable
+    int depthPrepass;               // renders the draw list depth before shading it, see crenvk_renderphase_default_set_prepass
+    int dynamicRendering;           // renders without render pass and framebuffer objects, needs vulkan 1.3 or VK_KHR_dynamic_rendering and is ignored otherwise
+    int mergedUI;                   // resolves the anti-aliasing and draws the ui in a single render pass, see vkDefaultRenderphase's mergedUI. Ignored with dynamic rendering
+    void* nativeWindow;             // NULL renders headless, nothing is presented
+    const char* tracePath;          // when set every api call is recorded into this file since initialization, see cren_trace_begin
 } CRenCreateInfo;
 
+/// @brief gpu memory usage of a memory heap
+typedef struct {
+    unsigned long long size;        // heap size in bytes
+    unsigned long long budget;      // how much of the heap the application may use
+    unsigned long long usage;       // how much of the heap is in use
+    int deviceLocal;
+} CRenMemoryHeap;
+
+/// @brief gpu memory usage, see cren_memory_stats
+typedef struct {
+    int budgetExtension;            // budget and usage come from the driver, otherwise budget is estimated and usage only accounts textures
+    unsigned int heapCount;
+    CRenMemoryHeap heaps[CREN_MEMORY_HEAPS_MAX];
+    unsigned int textureCount;
+    unsigned long long textureBytes;
+    unsigned int evictedLevels;     // texture mip levels dropped to fit the budget so far
+    unsigned int streamedIn;        // texture re-builds that increased/decreased the resident mip levels
+    unsigned int streamedOut;
+} CRenMemoryStats;
+
+/// @brief file formats a captured frame may be encoded to
+typedef enum {
+    Capture_PNG = 0,
+    Capture_JPEG
+} CRenCaptureFormat;
+
+/// @brief a captured frame, handed to the capture callback
+typedef struct {
+    int success;                    // 0 if the frame couldn't be encoded
+    CRenCaptureFormat format;
+    unsigned int width;
+    unsigned int height;
+    unsigned long long frame;       // frame number the capture was taken on
+    const unsigned char* data;      // the encoded file, only valid during the callback
+    unsigned long long size;        // encoded file's size in bytes
+} CRenCapture;
+
+/// @brief receives a captured frame, called from the capture worker thread and not from the render loop
+/// @param capture the captured frame
+/// @param userData user-defined pointer given to cren_capture_frame
+typedef void (*CRenCallback_Capture)(const CRenCapture* capture, void* userData);
+
+/// @brief containers a frame sequence may be written to
+typedef enum {
+    Sequence_Y4M = 0,               // YUV4MPEG2 4:4:4, readable by most video tools
+    Sequence_Raw                    // rgba8 frames back to back, without any header
+} CRenSequenceFormat;
+
+/// @brief state of the frame sequence being written, see cren_capture_sequence_begin
+typedef struct {
+    int recording;                  // frames are still being captured
+    int writing;                    // the file is still open, captured frames are being written
+    unsigned int width;
+    unsigned int height;
+    unsigned long long frameCapacity;   // how many frames the file was allocated for
+    unsigned long long framesWritten;
+    unsigned long long framesDropped;   // frames that should have been captured but the ring was busy (or the image changed size)
+} CRenSequenceStats;
+
 /// @brief holds all current state about the cren context, like camera, renderer's backend, userpointer
 typedef struct {
     CRenCreateInfo createInfo;
     CRenCamera camera;
     void* backend;
+    void* trace;                    // the trace being recorded, see cren_trace.h
+    double time;                    // seconds updated so far, the sum of every cren_update timestep
     
     void* userPointer;
     void* renderCallback;
@@ -57,6 +124,10 @@ CREN_API void cren_terminate(CRenContext* context);
 /// @param timestep interpolation step, time betweent last and current frame
 CREN_API void cren_update(CRenContext* context, double timestep);
 
+/// @brief returns the sum of every cren_update timestep, shaders see it as the camera's time (flipbooks are animated with it)
+/// @param context cren context memory address
+CREN_API double cren_get_time(CRenContext* context);
+
 /// @brief performs the frame rendering, setting-up all resources required for drawing the current frame and presenting the previously rendered
 /// @param context cren context memory address
 /// @param timestep interpolation step, time betweent last and current frame
@@ -68,6 +139,69 @@ CREN_API void cren_render(CRenContext* context, double timestep);
 /// @param height new height
 CREN_API void cren_resize(CRenContext* context, int width, int height);
 
+/// @brief changes the anti-aliasing sample count, render phases and pipelines depending on it are re-created at the end of the current frame
+/// @note pipelines created by the user against the default/picking renderpass must be re-built after this
+/// @param context cren context memory address
+/// @param msaa desired sample count (1, 2, 4, 8...), lowered to the highest one the device supports
+CREN_API void cren_set_msaa(CRenContext* context, int msaa);
+
+/// @brief turns vsync on/off, the swapchain is re-created at the end of the current frame
+/// @param context cren context memory address
+/// @param vsync 1 to enable vsync (fifo), 0 to disable it (mailbox/immediate if available)
+CREN_API void cren_set_vsync(CRenContext* context, int vsync);
+
+/// @brief returns the current gpu memory usage and budget per heap
+/// @param context cren context memory address
+/// @param stats output statistics
+CREN_API void cren_memory_stats(CRenContext* context, CRenMemoryStats* stats);
+
+/// @brief selects every object inside a rectangle without stalling the render loop, like a drag selection
+/// the ids on the picking image are de-duplicated by a compute dispatch and only the distinct ids are read back, a few frames later. See cren_pick_rect_result
+/// @param context cren context memory address
+/// @param x rectangle's left, in pixels of the picking image (same size as the window)
+/// @param y rectangle's top, in pixels of the picking image
+/// @param width rectangle width
+/// @param height rectangle height
+/// @return 1 if the pick was queued, 0 if another one is still in flight
+CREN_API int cren_pick_rect(CRenContext* context, int x, int y, int width, int height);
+
+/// @brief reads the ids selected by the last cren_pick_rect, call it every frame until it returns 1
+/// @param context cren context memory address
+/// @param ids output ids, in no particular order
+/// @param capacity how many ids may be written
+/// @param count output distinct ids found, may be more than capacity (CREN_PICK_RECT_IDS_MAX at most are ever written)
+/// @return 1 if the pick finished, 0 if it's still in flight or nothing was requested
+CREN_API int cren_pick_rect_result(CRenContext* context, unsigned long long* ids, unsigned int capacity, unsigned int* count);
+
+/// @brief captures the next rendered frame without stalling the render loop. The viewport image is captured when the viewport is in use, otherwise the presented image
+/// the frame is copied into a readback buffer on the gpu and encoded by a worker thread once the copy is done, a few frames later
+/// @param context cren context memory address
+/// @param format file format to encode to
+/// @param callback receives the encoded frame on the worker thread
+/// @param userData user-defined pointer given to the callback
+/// @return 1 if the capture was queued, 0 if too many captures are already in flight
+CREN_API int cren_capture_frame(CRenContext* context, CRenCaptureFormat format, CRenCallback_Capture callback, void* userData);
+
+/// @brief starts writing every Nth rendered frame into a file, the same image cren_capture_frame would capture is used
+/// the file is allocated up-front and memory-mapped, frames are written by the capture worker and flushed to disk asynchronously. Frames are dropped (and counted) instead of stalling the renderer when the writes can't keep up
+/// @param context cren context memory address
+/// @param path output file's disk path
+/// @param format file container
+/// @param interval a frame is captured every interval frames, 1 captures every frame
+/// @param fps playback frame rate written on the y4m header
+/// @param maxFrames how many frames the file holds, the sequence stops once it's full
+/// @return 1 if the sequence started, 0 if one is already being written or the file couldn't be created
+CREN_API int cren_capture_sequence_begin(CRenContext* context, const char* path, CRenSequenceFormat format, unsigned int interval, unsigned int fps, unsigned int maxFrames);
+
+/// @brief stops capturing frames, the file is closed a few frames later once the frames in flight are written
+/// @param context cren context memory address
+CREN_API void cren_capture_sequence_end(CRenContext* context);
+
+/// @brief returns the state of the frame sequence being written, or of the last one
+/// @param context cren context memory address
+/// @param stats output statistics
+CREN_API void cren_capture_sequence_stats(CRenContext* context, CRenSequenceStats* stats);
+
 /// @brief minimizes the renderer, stopping rendering without staling it
 /// @param context cren context memory address
 CREN_API void cren_minimize(CRenContext* context);
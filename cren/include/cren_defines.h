@@ -64,10 +64,119 @@
 /// @brief How many shader stages a pipeline may have, since we only support Vertex and Fragment for now, 2
 #define CREN_PIPELINE_SHADER_STAGES_COUNT 2
 
+/// @brief How many pipeline libraries a fast-linked pipeline is made of (vertex input, pre-rasterization, fragment shader and fragment output)
+#define CREN_PIPELINE_LIBRARY_PARTS 4
+
 /// @brief The quad's default pipeline name, used for hashtable look-ups
 #define CREN_PIPELINE_QUAD_DEFAULT_NAME "Quad:Default"
 
 /// @brief The quad's picking pipeline name, used for hashtable look-ups
 #define CREN_PIPELINE_QUAD_PICKING_NAME "Quad:Picking"
 
+/// @brief The quad's depth prepass pipeline name, used for hashtable look-ups
+#define CREN_PIPELINE_QUAD_DEPTH_NAME "Quad:Depth"
+
+/// @brief The quad's pipeline used after the depth prepass, used for hashtable look-ups
+#define CREN_PIPELINE_QUAD_EQUAL_NAME "Quad:Equal"
+
+/// @brief The particle's default pipeline name, used for hashtable look-ups
+#define CREN_PIPELINE_PARTICLE_DEFAULT_NAME "Particle:Default"
+
+/// @brief The particle's simulation (compute) pipeline name, used for hashtable look-ups
+#define CREN_PIPELINE_PARTICLE_SIMULATE_NAME "Particle:Simulate"
+
+/// @brief How many particles a simulation workgroup processes, must match particle.comp
+#define CREN_PARTICLE_WORKGROUP_SIZE 256
+
+/// @brief How many point lights may be submitted on a single frame, lights past it are dropped
+#define CREN_LIGHTS_MAX 1024
+
+/// @brief How many clusters the view frustum is split into horizontally, must match include/light.glsl
+#define CREN_LIGHT_CLUSTERS_X 16
+
+/// @brief How many clusters the view frustum is split into vertically, must match include/light.glsl
+#define CREN_LIGHT_CLUSTERS_Y 9
+
+/// @brief How many (exponential) depth slices the view frustum is split into, must match include/light.glsl
+#define CREN_LIGHT_CLUSTERS_Z 24
+
+/// @brief How many lights a single cluster references at most, must match include/light.glsl
+#define CREN_LIGHTS_PER_CLUSTER_MAX 64
+
+/// @brief How many clusters a light clustering workgroup processes, must match light_cluster.comp
+#define CREN_LIGHT_CLUSTER_WORKGROUP_SIZE 64
+
+/// @brief The smallest render scale the viewport may be rendered with
+#define CREN_VIEWPORT_RENDER_SCALE_MIN 0.25f
+
+/// @brief The biggest render scale the viewport may be rendered with (super-sampling)
+#define CREN_VIEWPORT_RENDER_SCALE_MAX 2.0f
+
+/// @brief How many pixels the viewport size must change before it's images are re-allocated
+#define CREN_VIEWPORT_RESIZE_THRESHOLD 8
+
+/// @brief How many different pipelines a draw list may sort per frame, the pipeline slot of the sort key is 12 bits wide
+#define CREN_DRAWLIST_PIPELINES_MAX 4096
+
+/// @brief How many draw packets a draw list reserves the first time it's used
+#define CREN_DRAWLIST_INITIAL_CAPACITY 256
+
+/// @brief How many cameras may render the draw list on the same frame, the main camera included. Visibility is a bitmask per packet, must match include/ubo_camera.glsl
+#define CREN_VIEWS_MAX 8
+
+/// @brief How many retired objects the retirement queue reserves the first time it's used
+#define CREN_RETIREMENT_INITIAL_CAPACITY 64
+
+/// @brief How many memory heaps are reported by cren_memory_stats, same as VK_MAX_MEMORY_HEAPS
+#define CREN_MEMORY_HEAPS_MAX 16
+
+/// @brief How many frames between memory budget checks
+#define CREN_MEMORY_BUDGET_INTERVAL 60
+
+/// @brief How many frames a texture must go without being drawn before it may be evicted
+#define CREN_TEXTURE_EVICTION_FRAMES 300
+
+/// @brief Evicted textures are never shrunk below this size (in texels, on the largest side)
+#define CREN_TEXTURE_EVICTION_MIN_SIZE 64
+
+/// @brief How many textures may be streaming at the same time
+#define CREN_TEXTURE_STREAMING_JOBS_MAX 4
+
+/// @brief Streamed textures keep the mip levels up to this size (in texels, on the largest side) always resident
+#define CREN_TEXTURE_STREAMING_TAIL_SIZE 64
+
+/// @brief How many frames a streamed texture must go off-screen before it's streamed back to it's tail
+#define CREN_TEXTURE_STREAMING_IDLE_FRAMES 120
+
+/// @brief Default atlas page size (in texels, on both sides)
+#define CREN_ATLAS_PAGE_SIZE 2048
+
+/// @brief Default padding around every texture packed into an atlas (in texels), filled with the texture's edge so filtering and the first mips don't bleed into neighbours
+#define CREN_ATLAS_PADDING 4
+
+/// @brief How many quads may sample the same atlas page, their params live on a single buffer per page and frame
+#define CREN_ATLAS_PAGE_QUADS_MAX 4096
+
+/// @brief How many frame captures may be in flight at the same time, each one holds a readback buffer with the size of the captured image
+/// @note a capture is in flight for CREN_CONCURRENTLY_RENDERED_FRAMES frames plus the time it takes to encode/write, frame sequences capturing every frame need more slots than that
+#define CREN_CAPTURE_RING_SIZE 4
+
+/// @brief Quality of jpeg frame captures (1 to 100)
+#define CREN_CAPTURE_JPEG_QUALITY 90
+
+/// @brief How many distinct ids a rectangle pick reads back at most
+#define CREN_PICK_RECT_IDS_MAX 1024
+
+/// @brief How many ids a rectangle pick collects from it's tiles before removing the ones found by more than one tile, ids found past it are lost
+#define CREN_PICK_RECT_CANDIDATES_MAX 8192
+
+/// @brief How many texels a rectangle pick workgroup reduces on each side, must match include/pick_rect.glsl
+#define CREN_PICK_RECT_TILE_SIZE 16
+
+/// @brief How many textures a mipmap batch holds before it's flushed
+#define CREN_MIPMAP_BATCH_MAX 64
+
+/// @brief How many mip levels (besides the base one) the compute mipmap generator produces on a single dispatch, textures with more levels (above 4096x4096) use blits
+#define CREN_MIPMAP_COMPUTE_LEVELS_MAX 12
+
 #endif // CREN_DEFINES_INCLUDED
\ No newline at end of file
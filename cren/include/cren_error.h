@@ -26,6 +26,7 @@ extern "C" {
 typedef enum {
 	ContextIntializationFailed = -65536,
 	RendererInitializationFailed,
+	MemoryAllocationFailed,
 	
 	Vulkan_InstanceCreationFailed,
 	Vulkan_DebuggerCreationFailed,
@@ -39,6 +40,7 @@ typedef enum {
 	Vulkan_CommandBufferCreationFailed,
 	Vulkan_CommandBufferAllocationFailed,
 	Vulkan_FramebufferCreationFailed,
+	Vulkan_ImageCreationFailed,
 
 	Success = 1
 } CRenError;
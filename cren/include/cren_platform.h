@@ -52,6 +52,73 @@ CREN_API void cren_thread_lock();
 /// @brief unlocks the in-context thread
 CREN_API void cren_thread_unlock();
 
+/// @brief a thread's entry point
+typedef int (*CRenThreadFunction)(void* argument);
+
+/// @brief starts a new thread
+/// @param function thread's entry point
+/// @param argument passed to the entry point
+/// @return the thread or NULL on failure
+CREN_API void* cren_thread_create(CRenThreadFunction function, void* argument);
+
+/// @brief waits for a thread to return and releases it
+/// @param thread the thread
+CREN_API void cren_thread_join(void* thread);
+
+/// @brief creates a mutex
+/// @return the mutex or NULL on failure
+CREN_API void* cren_mutex_create();
+
+/// @brief releases a mutex, it must be unlocked
+/// @param mutex the mutex
+CREN_API void cren_mutex_destroy(void* mutex);
+
+/// @brief locks a mutex
+/// @param mutex the mutex
+CREN_API void cren_mutex_lock(void* mutex);
+
+/// @brief unlocks a mutex
+/// @param mutex the mutex
+CREN_API void cren_mutex_unlock(void* mutex);
+
+/// @brief creates a condition variable
+/// @return the condition variable or NULL on failure
+CREN_API void* cren_condition_create();
+
+/// @brief releases a condition variable, no thread may be waiting on it
+/// @param condition the condition variable
+CREN_API void cren_condition_destroy(void* condition);
+
+/// @brief unlocks the mutex and waits until the condition is signaled, the mutex is locked again before returning
+/// @param condition the condition variable
+/// @param mutex a locked mutex
+CREN_API void cren_condition_wait(void* condition, void* mutex);
+
+/// @brief wakes up every thread waiting on the condition
+/// @param condition the condition variable
+CREN_API void cren_condition_signal(void* condition);
+
+/// @brief creates (or truncates) a file with a given size and maps it into memory for writing
+/// @param path file's disk path
+/// @param size file's size in bytes
+/// @param outData the mapped file contents
+/// @return the mapped file or NULL on failure
+CREN_API void* cren_file_map_create(const char* path, unsigned long long size, unsigned char** outData);
+
+/// @brief starts writing a range of the mapped file back to disk without waiting for it
+/// @param file the mapped file
+/// @param offset range start in bytes
+/// @param size range size in bytes
+CREN_API void cren_file_map_flush(void* file, unsigned long long offset, unsigned long long size);
+
+/// @brief unmaps and closes the file, truncating it to it's final size
+/// @param file the mapped file
+/// @param finalSize file's size in bytes after closing, must not be bigger than the mapped size
+CREN_API void cren_file_map_destroy(void* file, unsigned long long finalSize);
+
+/// @brief returns a monotonic time in seconds, only meaningful when compared against another call
+CREN_API double cren_time_seconds();
+
 /// @brief loads an image given a disk path using stb's library
 /// @param path image's disk path
 /// @param desiredChannels how many channels are desired to be loaded (3: RGB, 4: RGBA)
@@ -69,6 +136,21 @@ CREN_API void cren_stbimage_destroy(unsigned char* ptr);
 // @return the brief error message
 CREN_API const char* cren_stbimage_get_error();
 
+/// @brief encodes an image into a png or jpeg file in memory using stb's library
+/// @param pixels image's texels
+/// @param width image's width
+/// @param height image's height
+/// @param channels how many channels each texel has (3: RGB, 4: RGBA)
+/// @param jpeg 1 encodes a jpeg, 0 a png
+/// @param quality jpeg quality (1 to 100), ignored by png
+/// @param outSize encoded file's size in bytes
+/// @return the encoded file or NULL if an error has occured, release it with cren_stbimage_encoded_destroy
+CREN_API unsigned char* cren_stbimage_encode(const unsigned char* pixels, int width, int height, int channels, int jpeg, int quality, unsigned long long* outSize);
+
+/// @brief release an encoded file previously created
+/// @param ptr encoded file's address
+CREN_API void cren_stbimage_encoded_destroy(unsigned char* ptr);
+
 #ifdef __cplusplus 
 }
 #endif
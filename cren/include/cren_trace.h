@@ -0,0 +1,198 @@
+#ifndef CREN_TRACE_INCLUDED
+#define CREN_TRACE_INCLUDED
+
+#include "cren_camera.h"
+#include "cren_context.h"
+#include "cren_defines.h"
+#include "cren_vulkan.h"
+
+/// @brief first bytes of every trace file
+#define CREN_TRACE_MAGIC "CRTR"
+
+/// @brief trace file version, bumped every time a record (or a struct recorded as-is, like CRenCamera) changes
+#define CREN_TRACE_VERSION 4
+
+/// @brief size of the buffer records are written through, so every api call doesn't hit the disk
+#define CREN_TRACE_BUFFER_SIZE (1 << 20)
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Records
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+/// @brief every api call a trace records, a record is a 16-bit type and a 32-bit payload size followed by the payload (native endianness)
+typedef enum {
+    TraceRecord_Begin = 1,          // CRenTraceBegin, always the first record
+    TraceRecord_End,                // no payload, the trace was closed (the application terminated or stopped tracing)
+    TraceRecord_Update,             // CRenTraceUpdate
+    TraceRecord_Render,             // CRenTraceRender, records until TraceRecord_RenderEnd were issued from the render callbacks
+    TraceRecord_RenderEnd,          // no payload
+    TraceRecord_Resize,             // CRenTraceResize
+    TraceRecord_SetMsaa,            // CRenTraceValue
+    TraceRecord_SetVsync,           // CRenTraceValue
+    TraceRecord_Minimize,           // no payload
+    TraceRecord_Restore,            // no payload
+    TraceRecord_TextureCreate,      // CRenTraceTexture
+    TraceRecord_TextureDestroy,     // CRenTraceHandle
+    TraceRecord_QuadCreate,         // CRenTraceQuadCreate
+    TraceRecord_QuadDestroy,        // CRenTraceHandle
+    TraceRecord_QuadParams,         // CRenTraceQuadParams
+    TraceRecord_QuadRender,         // CRenTraceQuadDraw
+    TraceRecord_QuadSubmit,         // CRenTraceQuadDraw
+    TraceRecord_PickingEnable,      // no payload, the picking phase was created after initialization
+    TraceRecord_SetDepthPrepass     // CRenTraceValue
+} CRenTraceRecordType;
+
+/// @brief the renderer configuration when the trace started
+typedef struct {
+    int width;
+    int height;
+    int msaa;
+    int vsync;
+    int smallerViewport;
+    int picking;                    // the picking phase already exists
+    int depthPrepass;
+    char assetsRoot[CREN_PATH_MAX_SIZE];
+} CRenTraceBegin;
+
+/// @brief cren_update, the camera is recorded before it's updated so the replay computes the same matrices
+typedef struct {
+    double timestep;
+    CRenCamera camera;
+} CRenTraceUpdate;
+
+/// @brief cren_render
+typedef struct {
+    double timestep;
+} CRenTraceRender;
+
+/// @brief cren_resize
+typedef struct {
+    int width;
+    int height;
+} CRenTraceResize;
+
+/// @brief settings that take a single value, like cren_set_msaa
+typedef struct {
+    int value;
+} CRenTraceValue;
+
+/// @brief objects are identified by their address on the traced application, addresses are re-used once the object is destroyed
+typedef struct {
+    unsigned long long handle;
+} CRenTraceHandle;
+
+/// @brief a texture created by the application, textures created from buffers have no path and are replayed as blank textures of the same size
+typedef struct {
+    unsigned long long handle;
+    int gui;
+    int width;
+    int height;
+    char path[CREN_PATH_MAX_SIZE];
+} CRenTraceTexture;
+
+/// @brief crenvk_quad_create
+typedef struct {
+    unsigned long long handle;
+    char albedoPath[CREN_PATH_MAX_SIZE];
+} CRenTraceQuadCreate;
+
+/// @brief crenvk_quad_apply_buffer_changes
+typedef struct {
+    unsigned long long handle;
+    unsigned long long id;
+    QuadParams params;
+} CRenTraceQuadParams;
+
+/// @brief crenvk_quad_render/crenvk_quad_submit
+typedef struct {
+    unsigned long long handle;
+    unsigned long long id;
+    int stage;                      // unused by submits
+    mat4 transform;
+} CRenTraceQuadDraw;
+
+/// @brief a trace being recorded
+typedef struct {
+    void* file;
+    char* buffer;
+    int suspended;                  // records are ignored while cren calls it's own public api
+    unsigned long long records;
+    unsigned long long bytes;
+} CRenTrace;
+
+/// @brief a trace being read
+typedef struct {
+    void* file;
+    unsigned int version;
+    unsigned char* payload;
+    unsigned int capacity;
+} CRenTraceReader;
+
+/// @brief a record read from a trace, the payload is valid until the next record is read
+typedef struct {
+    CRenTraceRecordType type;
+    unsigned int size;
+    const void* payload;
+} CRenTraceRecord;
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Recording
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+/// @brief starts recording every api call into a trace file, objects created before the trace started are unknown to it. See CRenCreateInfo's tracePath to trace since initialization
+/// @param context cren context memory address
+/// @param path the trace's disk path
+/// @return 1 on success, 0 if a trace is already being recorded or the file couldn't be created
+CREN_API int cren_trace_begin(CRenContext* context, const char* path);
+
+/// @brief stops recording and closes the trace file
+/// @param context cren context memory address
+CREN_API void cren_trace_end(CRenContext* context);
+
+/// @brief returns if api calls are currently being recorded
+/// @param context cren context memory address
+CREN_API int cren_trace_recording(CRenContext* context);
+
+/// @brief stops recording until resumed, used by cren when it's public api calls it's own (like the quad loading it's colormap). Calls may be nested
+/// @param context cren context memory address
+CREN_API void cren_trace_suspend(CRenContext* context);
+
+/// @brief resumes recording after cren_trace_suspend
+/// @param context cren context memory address
+CREN_API void cren_trace_resume(CRenContext* context);
+
+/// @brief writes a record, ignored if not recording
+/// @param context cren context memory address
+/// @param type the record type
+/// @param payload the record payload, may be NULL if size is 0
+/// @param size payload size in bytes
+CREN_API void cren_trace_write(CRenContext* context, CRenTraceRecordType type, const void* payload, unsigned int size);
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Reading
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+/// @brief opens a trace file for reading
+/// @param path the trace's disk path
+/// @return the reader or NULL if the file isn't a trace or has another version
+CREN_API CRenTraceReader* cren_trace_open(const char* path);
+
+/// @brief reads the next record
+/// @param reader the trace reader
+/// @param record output record
+/// @return 1 on success, 0 at the end of the trace or if it's truncated
+CREN_API int cren_trace_read(CRenTraceReader* reader, CRenTraceRecord* record);
+
+/// @brief closes the trace file and releases the reader
+/// @param reader the trace reader
+CREN_API void cren_trace_close(CRenTraceReader* reader);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // CREN_TRACE_INCLUDED
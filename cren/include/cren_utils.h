@@ -40,6 +40,13 @@ void crenmemory_zero(void* ptr, unsigned long long size);
 /// @return dest's address
 void* crenmemory_copy(void* dest, const void* src, unsigned long long size);
 
+/// @brief compares two blocks of memory
+/// @param ptr0 first block's address
+/// @param ptr1 second block's address
+/// @param size how many bytes to compare
+/// @return 0 if both blocks are equal
+int crenmemory_compare(const void* ptr0, const void* ptr1, unsigned long long size);
+
 /////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 // Dynamic array
 /////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
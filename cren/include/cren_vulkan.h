@@ -49,6 +49,12 @@ typedef struct {
     VkQueue presentQueue;
     VkQueue computeQueue;
 
+    // dynamic rendering, phases begin rendering straight into image views instead of render pass and framebuffer objects
+    int dynamicRendering;
+    PFN_vkCmdBeginRenderingKHR cmdBeginRendering;
+    PFN_vkCmdEndRenderingKHR cmdEndRendering;
+    unsigned int apiVersion;        // vulkan version the device is used with, the lowest between the requested one and what the device supports
+
     unsigned int imageIndex;
     unsigned int currentFrame;
     VkSemaphore* imageAvailableSemaphores;
@@ -68,6 +74,43 @@ typedef struct {
 /// @return 1 on success, 0 on failure
 CREN_API int crenvk_device_create_buffer(VkDevice device, VkPhysicalDevice physicalDevice, VkBufferUsageFlags usage, VkMemoryPropertyFlags properties, VkDeviceSize size, VkBuffer* buffer, VkDeviceMemory* memory, void* data);
 
+/// @brief returns the highest anti-aliasing sample count usable by both color and depth attachments
+/// @param physicalDevice vulkan physical device
+/// @return the highest supported sample count
+CREN_API VkSampleCountFlagBits crenvk_device_get_max_msaa(VkPhysicalDevice physicalDevice);
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Retirement-related
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+/// @brief releases a retired object, called once the gpu is done with it
+typedef void (*vkRetireFunction)(VkDevice device, void* object);
+
+/// @brief an object waiting for the frames that may use it to finish
+typedef struct {
+    unsigned long long frame; // frame number it was retired on
+    vkRetireFunction function;
+    void* object;
+} vkRetiredObject;
+
+/// @brief objects destroyed by the application, they are only released once every frame in flight when they were destroyed has finished
+typedef struct {
+    vkRetiredObject* objects;
+    unsigned int count;
+    unsigned int capacity;
+    unsigned long long frameNumber; // how many frames were submitted so far
+} vkRetirementQueue;
+
+/// @brief enqueues an object to be released once the gpu can't be using it anymore, this never waits on the gpu
+/// @param context cren context
+/// @param function function that releases the object
+/// @param object the object
+CREN_API void crenvk_retire(CRenContext* context, vkRetireFunction function, void* object);
+
+/// @brief releases every retired object right away, the device must be idle
+/// @param context cren context
+CREN_API void crenvk_retire_flush(CRenContext* context);
+
 /////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 // Swapchain-related
 /////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -102,6 +145,8 @@ typedef struct {
     const char* name;
     VkSampleCountFlagBits msaa;
     VkFormat surfaceFormat;
+    VkFormat depthFormat;           // VK_FORMAT_UNDEFINED when the phase has no depth attachment
+    int dynamic;                    // renders with dynamic rendering, renderPass and framebuffers are left empty
     VkRenderPass renderPass;
     VkCommandPool commandPool;
     VkDescriptorPool descriptorPool;
@@ -109,8 +154,26 @@ typedef struct {
     VkFramebuffer* framebuffers;
     unsigned int commandBufferCount;
     unsigned int framebufferCount;
+
+    // retained mode, what each command buffer was last recorded with
+    unsigned long long recordedVersion[CREN_CONCURRENTLY_RENDERED_FRAMES];
+    VkImageView recordedTarget[CREN_CONCURRENTLY_RENDERED_FRAMES];
 } vkRenderpass;
 
+/// @brief what a renderpass renders into for one frame, the framebuffer is used with render pass objects and the image views with dynamic rendering
+typedef struct {
+    VkFramebuffer framebuffer;
+    VkExtent2D extent;
+    VkImage colorImage;
+    VkImageView colorView;
+    VkImage resolveImage;           // VK_NULL_HANDLE when the color isn't multisampled
+    VkImageView resolveView;
+    VkImage depthImage;             // VK_NULL_HANDLE when the phase has no depth attachment
+    VkImageView depthView;
+    VkImageLayout finalLayout;      // layout the resolved (or color) image is left in once rendering ends
+    int loadColor;                  // keeps what was previously rendered into the color image instead of clearing it
+} vkRenderTarget;
+
 /// @brief all kinds of shaders
 typedef enum {
     SHADER_TYPE_VERTEX = 0,
@@ -128,6 +191,7 @@ typedef struct {
     vkShaderType type;
     VkShaderModule shaderModule;
     VkPipelineShaderStageCreateInfo shaderStageCI;
+    unsigned long long hash;        // hash of the SPIR-V code, 0 if it couldn't be loaded
 } vkShader;
 
 /// @brief cren vertex components, custom attributes not supported, also only covering 1 of each type at the momment
@@ -153,6 +217,14 @@ typedef struct {
     float4 weights_0;
 } vkVertex;
 
+/// @brief the parts of VK_EXT_graphics_pipeline_library a pipeline is split on
+typedef enum {
+    PipelineLibrary_VertexInput = 0,
+    PipelineLibrary_PreRasterization,
+    PipelineLibrary_FragmentShader,
+    PipelineLibrary_FragmentOutput
+} vkPipelineLibraryPart;
+
 /// @brief cren pipeline create info, needed data to create a pipeline
 typedef struct vkPipelineCreateInfo
 {
@@ -196,29 +268,132 @@ typedef struct {
 	VkPipelineDepthStencilStateCreateInfo depthStencilState;
 	VkPipelineColorBlendAttachmentState colorBlendAttachmentState;
 	VkPipelineColorBlendStateCreateInfo colorBlendState;
+
+	// pipeline registry, see crenvk_pipeline_intern
+	unsigned long long shaderHashes[CREN_PIPELINE_SHADER_STAGES_COUNT];
+	unsigned long long layoutHash;  // hash of the descriptor bindings and push constants
+	int interned;
+	VkPipeline libraries[CREN_PIPELINE_LIBRARY_PARTS]; // the pipeline was fast-linked from these, indexed by vkPipelineLibraryPart
 } vkPipeline;
 
+/// @brief cren compute pipeline create info
+typedef struct {
+	VkPipelineCache pipelineCache;
+	vkShader computeShader;
+	VkDescriptorSetLayoutBinding bindings[CREN_PIPELINE_DESCRIPTOR_SET_LAYOUT_BINDING_MAX];
+	unsigned int bindingsCount;
+	VkPushConstantRange pushConstants[CREN_PIPELINE_PUSH_CONSTANTS_MAX];
+	unsigned int pushConstantsCount;
+} vkComputePipelineCreateInfo;
+
+/// @brief cren vulkan compute pipeline, it has no state to configure so it's built when created
+typedef struct {
+	VkPipelineCache cache;
+	VkDescriptorSetLayout descriptorSetLayout;
+	VkPipelineLayout layout;
+	VkPipeline pipeline;
+	VkShaderModule shaderModule;
+} vkComputePipeline;
+
+/// @brief a pipeline shared through the registry
+typedef struct {
+	unsigned long long hash;
+	vkPipeline* pipeline;
+	unsigned int references;
+} vkPipelineRegistryEntry;
+
+/// @brief a descriptor set layout and pipeline layout shared by every interned pipeline with the same bindings and push constants
+typedef struct {
+	unsigned long long hash;
+	VkDescriptorSetLayout descriptorSetLayout;
+	VkPipelineLayout layout;
+	unsigned int references;
+} vkPipelineLayoutEntry;
+
+/// @brief a pipeline library shared by every pipeline linked with the same state on it's part
+typedef struct {
+	unsigned long long hash;
+	VkPipeline library;
+	unsigned int references;
+} vkPipelineLibraryEntry;
+
+/// @brief pipelines interned by the hash of their whole build state, identical pipelines are built once and shared
+/// @note when VK_EXT_graphics_pipeline_library supports fast linking, pipelines are linked from a library per part instead of compiled whole, so a new permutation only compiles the parts that changed
+typedef struct {
+	vkPipelineRegistryEntry* pipelines;
+	unsigned int pipelineCount;
+	unsigned int pipelineCapacity;
+	vkPipelineLayoutEntry* layouts;
+	unsigned int layoutCount;
+	unsigned int layoutCapacity;
+	vkPipelineLibraryEntry* libraries;
+	unsigned int libraryCount;
+	unsigned int libraryCapacity;
+	int linking;                    // the device fast-links pipeline libraries, otherwise pipelines are built monolithic
+	unsigned int hits;              // interns that found an identical pipeline
+	unsigned int misses;            // interns that had to build the pipeline
+	unsigned int linked;            // misses that were fast-linked
+} vkPipelineRegistry;
+
 /// @brief creates a cren vulkan pipeline
 /// @param device cren vulkan pipeline
 /// @param ci pipeline create info
 /// @return the pipeline or NULL if an error has happend
 CREN_API vkPipeline* crenvk_pipeline_create(VkDevice device, vkPipelineCreateInfo* ci);
 
-/// @brief destroys a cren vulkan pipeline
+/// @brief destroys a cren vulkan pipeline right away, the gpu must not be using it (see crenvk_pipeline_retire)
 /// @param device cren vulkan device
 /// @param pipeline cren vulkan pipeline
 CREN_API void crenvk_pipeline_destroy(VkDevice device, vkPipeline* pipeline);
 
+/// @brief destroys a cren vulkan pipeline once the frames in flight are done with it
+/// @param context cren context
+/// @param pipeline cren vulkan pipeline
+CREN_API void crenvk_pipeline_retire(CRenContext* context, vkPipeline* pipeline);
+
 /// @brief builds a pipeline with it's setup configuration
 /// @param device vulkan device
 /// @param pipeline cren vulkan pipeline
 CREN_API void crenvk_pipeline_build(VkDevice device, vkPipeline* pipeline);
 
-/// @brief destroy all resources related to the renderpass and itself
+/// @brief builds a pipeline through the registry: if an identical one was already interned the given pipeline is destroyed and the existing one is returned instead, otherwise it's built and registered
+/// @note the hash covers the shaders code, descriptor bindings, push constants, vertex input, every fixed-function state and the renderpass. Change the state between crenvk_pipeline_create and this call, like with crenvk_pipeline_build
+/// @param context cren context
+/// @param pipeline a created but not built pipeline, it must not be used after this call
+/// @return the shared pipeline, released with crenvk_pipeline_release (never with crenvk_pipeline_destroy)
+CREN_API vkPipeline* crenvk_pipeline_intern(CRenContext* context, vkPipeline* pipeline);
+
+/// @brief releases a pipeline returned by crenvk_pipeline_intern, it's retired once nobody references it. Pipelines that weren't interned are retired right away
+/// @param context cren context
+/// @param pipeline cren vulkan pipeline
+CREN_API void crenvk_pipeline_release(CRenContext* context, vkPipeline* pipeline);
+
+/// @brief creates and builds a compute pipeline, the pipeline takes ownership of the shader module
+/// @param device vulkan device
+/// @param ci compute pipeline create info
+/// @return the pipeline or NULL if an error has happend
+CREN_API vkComputePipeline* crenvk_compute_pipeline_create(VkDevice device, vkComputePipelineCreateInfo* ci);
+
+/// @brief destroys a compute pipeline right away, the gpu must not be using it (see crenvk_compute_pipeline_retire)
+/// @param device vulkan device
+/// @param pipeline cren vulkan compute pipeline
+CREN_API void crenvk_compute_pipeline_destroy(VkDevice device, vkComputePipeline* pipeline);
+
+/// @brief destroys a compute pipeline once the frames in flight are done with it
+/// @param context cren context
+/// @param pipeline cren vulkan compute pipeline
+CREN_API void crenvk_compute_pipeline_retire(CRenContext* context, vkComputePipeline* pipeline);
+
+/// @brief destroy all resources related to the renderpass and itself right away, the gpu must not be using it (see crenvk_renderpass_retire)
 /// @param device vulkan device
 /// @param renderpass cren vulkan renderpass
 CREN_API void crenvk_renderpass_destroy(VkDevice device, vkRenderpass* renderpass);
 
+/// @brief destroys the renderpass once the frames in flight are done with it
+/// @param context cren context
+/// @param renderpass cren vulkan renderpass
+CREN_API void crenvk_renderpass_retire(CRenContext* context, vkRenderpass* renderpass);
+
 /// @brief creates a cren vulkan shader
 /// @param device vulkan device
 /// @param name shader's name
@@ -257,8 +432,23 @@ typedef struct {
     VkFormat surfaceFormat;
     VkFormat depthFormat;
 
+    // the ui is drawn on a second subpass over the resolved swapchain image, so tile-based gpus never write the multisampled
+    // images to memory nor read the swapchain image back. The ui phase isn't recorded, the sample count can't change and views need the smaller viewport
+    int mergedUI;
 } vkDefaultRenderphase;
 
+/// @brief enables/disables the depth prepass. The draw list depth is rendered first with cheap alpha-tested shaders and then shaded with an equal depth test, so every pixel is shaded once no matter how many quads overlap it
+/// @note meant for cut-out sprites (fully opaque or fully transparent pixels). Semi-transparent pixels still blend over what was drawn before them, but hide the quads behind them. Packets without prepass pipelines are drawn as usual
+/// @note the prepass pipelines are created on first enable. Don't call it from the render callbacks
+/// @param context cren context
+/// @param enabled 1 to enable, 0 to disable
+/// @return 1 on success, 0 if the prepass pipelines couldn't be created
+CREN_API int crenvk_renderphase_default_set_prepass(CRenContext* context, int enabled);
+
+/// @brief returns if the depth prepass is enabled
+/// @param context cren context
+CREN_API int crenvk_renderphase_default_prepass_enabled(CRenContext* context);
+
 /// @brief cren picking renderphase
 typedef struct {
     vkRenderpass* renderpass;
@@ -275,6 +465,16 @@ typedef struct {
     VkFormat depthFormat;
 } vkPickingRenderphase;
 
+/// @brief creates the picking render phase if it doesn't exist yet, it's otherwise only created at initialization when CRenCreateInfo's picking is set. Rectangle picks call it on their own
+/// @note the picking stage isn't rendered (nor the render callback called with it) while the phase doesn't exist. Don't call it from the render callbacks
+/// @param context cren context
+/// @return 1 if the phase exists, 0 if it couldn't be created
+CREN_API int crenvk_renderphase_picking_enable(CRenContext* context);
+
+/// @brief returns if the picking render phase was created
+/// @param context cren context
+CREN_API int crenvk_renderphase_picking_enabled(CRenContext* context);
+
 /// @brief cren ui renderphase
 typedef struct {
     vkRenderpass* renderpass;
@@ -282,6 +482,7 @@ typedef struct {
     // some things may be missing
     VkDescriptorPool descPool;
     VkDescriptorSetLayout descSetLayout;
+    int merged;                     // drawn on the default renderpass subpass 1 instead of it's own renderpass, see vkDefaultRenderphase's mergedUI
 } vkUIRenderphase;
 
 /// @brief cren viewport render phase
@@ -306,8 +507,651 @@ typedef struct {
 	float2 vpSize;
 	float2 vpMin;
 	float2 vpMax;
+
+	// dynamic resolution
+	VkExtent2D renderExtent;    // the extent the viewport images are currently allocated with
+	float renderScale;          // multiplier applied over vpSize when allocating the viewport images
+	unsigned int resizeThreshold;   // how many pixels the scaled size must differ from renderExtent before re-allocating
+	int hint_resize;            // the viewport images must be re-allocated at the end of the frame
+	int autoScale;              // render scale is controlled by the frame time instead of manually
+	double targetFrameTime;     // frame time in seconds the automatic controller tries to hold
+	double averageFrameTime;    // smoothed frame time in seconds, used by the automatic controller
+	unsigned int autoScaleCooldown; // frames left before the automatic controller is allowed to change the scale again
 } vkViewportRenderphase;
 
+/// @brief viewport images replaced by a resize, released once the frames that sample them have finished
+typedef struct {
+    VkImage colorImage;
+    VkDeviceMemory colorMemory;
+    VkImageView colorView;
+    VkImage depthImage;
+    VkDeviceMemory depthMemory;
+    VkImageView depthView;
+    VkFramebuffer* framebuffers;
+    unsigned int framebufferCount;
+    VkDescriptorPool descriptorPool;    // the set is freed back into the phase's pool
+    VkDescriptorSet descriptorSet;
+} vkRetiredViewportTargets;
+
+/// @brief informs the viewport render phase about the panel it's displayed on, the viewport images are re-allocated to the panel size times the render scale only when it differs more than the resize threshold
+/// @param context cren context
+/// @param position panel's position on the window
+/// @param size panel's size on the window
+CREN_API void crenvk_renderphase_viewport_set_boundaries(CRenContext* context, float2 position, float2 size);
+
+/// @brief sets the viewport render scale, a value of 0.5 renders the viewport with half the panel's resolution
+/// @param context cren context
+/// @param scale the new render scale, clamped between CREN_VIEWPORT_RENDER_SCALE_MIN and CREN_VIEWPORT_RENDER_SCALE_MAX
+CREN_API void crenvk_renderphase_viewport_set_render_scale(CRenContext* context, float scale);
+
+/// @brief enables/disables the automatic render scale controller, wich lowers/raises the render scale to hold a target frame time
+/// @param context cren context
+/// @param enabled 1 to enable, 0 to disable (the render scale is kept as it currently is)
+/// @param targetFrameTime the frame time in seconds to hold, like 1.0 / 60.0
+CREN_API void crenvk_renderphase_viewport_set_auto_scale(CRenContext* context, int enabled, double targetFrameTime);
+
+/// @brief feeds the automatic render scale controller with the last frame time, does nothing if the controller is disabled
+/// @param context cren context
+/// @param frameTime the elapsed time in seconds of the last frame
+CREN_API void crenvk_renderphase_viewport_auto_scale_update(CRenContext* context, double frameTime);
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Drawlist-related
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+/// @brief a draw request, submitted once per frame and replayed on every render stage it has a pipeline for
+typedef struct {
+    vkPipeline* pipeline;           // pipeline used on the default stage, NULL skips the stage
+    vkPipeline* pickingPipeline;    // pipeline used on the picking stage, NULL skips the stage
+    vkPipeline* depthPipeline;      // pipeline used on the prepass stage, NULL keeps the packet out of the prepass
+    vkPipeline* equalPipeline;      // pipeline used on the default stage while the prepass is enabled, testing depth for equality. Required with depthPipeline
+    VkDescriptorSet descriptorSets[CREN_CONCURRENTLY_RENDERED_FRAMES]; // descriptor set bound at set 0 of every pipeline, the one of the frame in flight being recorded
+    unsigned long long id;          // object id, sent with the push constants
+    mat4 model;                     // object transformation, sent with the push constants
+    unsigned int vertexCount;
+    unsigned int instanceCount;
+    unsigned int firstInstance;     // first instance drawn, selects the params of packets sharing a buffer (atlas quads)
+    struct Texture2DBackend* texture; // texture sampled by the packet, marked as used every frame it's drawn (may be NULL)
+    float radius;                   // bounding sphere radius around the model origin before scaling, packets with 0 are never culled
+} vkDrawPacket;
+
+/// @brief sort key of a packet on a given stage, the stage lives on the top bits so every stage is a contiguous range after sorting
+typedef struct {
+    unsigned long long key;
+    unsigned int packet;
+} vkDrawKey;
+
+/// @brief the frame's draw list, filled by the application and consumed (sorted, recorded and cleared) by cren_render. On retained mode it's kept across frames
+typedef struct {
+    vkDrawPacket* packets;
+    vkDrawKey* keys;
+    vkDrawKey* scratch;
+    unsigned int* visibility;       // per packet, bit N is set when view N sees it. See crenvk_view_create
+    unsigned int packetCount;
+    unsigned int packetCapacity;
+    unsigned int keyCount;
+    int sorted;
+    int retained;
+    int hasBlended;                 // blended packets are sorted by depth, a camera change re-sorts the list
+    int prepass;                    // packets with prepass pipelines are drawn on the prepass stage and then on the default one with their equal pipeline
+    mat4 sortedView;                // camera view the keys were built with
+    unsigned long long version;     // bumped whenever recorded command buffers may no longer match, starts at 1
+
+    vkPipeline* pipelines[CREN_DRAWLIST_PIPELINES_MAX]; // pipelines seen this frame, their index is the pipeline slot of the key
+    unsigned int pipelineCount;
+} vkDrawlist;
+
+/// @brief submits a packet to the frame's draw list, packets are sorted by stage, pipeline, descriptor and depth (back-to-front for alpha blended pipelines) before being recorded
+/// @note pipelines must declare a vkPushConstant range visible to the vertex and fragment stages, like the quad pipelines do
+/// @param context cren context
+/// @param packet the packet to submit, it's copied
+/// @return 1 on success, 0 if the list could not grow
+CREN_API int crenvk_drawlist_submit(CRenContext* context, const vkDrawPacket* packet);
+
+/// @brief returns how many packets were submitted for the current frame
+/// @param context cren context
+CREN_API unsigned int crenvk_drawlist_get_count(CRenContext* context);
+
+/// @brief enables/disables retained mode. When retained the draw list is kept across frames and the default, picking and viewport command buffers are re-submitted as they are until something invalidates them
+/// @note on retained mode the application calls crenvk_drawlist_reset and re-submits it's packets only when objects are added, removed or moved
+/// @param context cren context
+/// @param enabled 1 to enable, 0 to go back to recording every frame
+CREN_API void crenvk_drawlist_set_retained(CRenContext* context, int enabled);
+
+/// @brief discards every submitted packet, on retained mode this also invalidates the recorded command buffers
+/// @param context cren context
+CREN_API void crenvk_drawlist_reset(CRenContext* context);
+
+/// @brief forces the phases to be recorded again on the next frame, use it when something drawn on the render callback has changed on retained mode
+/// @param context cren context
+CREN_API void crenvk_drawlist_invalidate(CRenContext* context);
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// View-related
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+/// @brief a camera rendering the draw list into it's own image, like a minimap, a split-screen player or an editor preview. Slot 0 is the context's main camera
+typedef struct {
+    int used;
+    int enabled;
+    unsigned int index;             // camera buffer slot and visibility bit, sent with the push constants
+    CRenCamera camera;
+    VkExtent2D extent;
+
+    VkImage colorImage;             // multisampled when the main renderpass is
+    VkDeviceMemory colorMemory;
+    VkImageView colorView;
+    VkImage resolveImage;           // single-sampled copy of the color image, only when multisampled
+    VkDeviceMemory resolveMemory;
+    VkImageView resolveView;
+    VkImage depthImage;
+    VkDeviceMemory depthMemory;
+    VkImageView depthView;
+    VkFramebuffer framebuffer;
+    VkDescriptorSet descriptorSet;  // samples the view image, for drawing it on the ui
+    VkCommandBuffer commandBuffers[CREN_CONCURRENTLY_RENDERED_FRAMES];
+
+    // visibility, computed for every view on a single pass over the draw list
+    mat4 culledViewProj;            // camera matrices the visibility was last computed with
+    float4 planes[6];               // normalized frustum planes, pointing inwards
+    unsigned int visibleCount;
+    unsigned long long visibleHash; // views with the same hash and count see the same packets
+    unsigned int listOwner;         // view whose sorted list is recorded, itself unless it's shared with another view
+
+    // sorted list of the visible packets, only built when the view owns it
+    vkDrawKey* keys;
+    vkDrawKey* scratch;
+    unsigned int keyCount;
+    unsigned int keyCapacity;
+    unsigned long long sortedVersion; // draw list version the keys were built on
+    unsigned long long sortedHash;    // visibility the keys were built with
+    mat4 sortedView;
+
+    // retained mode, bumped whenever the recorded list changes
+    unsigned long long listVersion;
+    unsigned long long recordedVersion[CREN_CONCURRENTLY_RENDERED_FRAMES];
+    unsigned long long recordedListVersion[CREN_CONCURRENTLY_RENDERED_FRAMES];
+} vkView;
+
+/// @brief every view, they share a renderpass compatible with the main one so the same pipelines draw into all of them
+typedef struct {
+    vkView views[CREN_VIEWS_MAX];   // views[0] only holds the main camera visibility
+    vkRenderpass* renderpass;       // created with the first view
+    VkFormat depthFormat;
+    VkSampler sampler;
+    VkDescriptorPool descriptorPool;
+    VkDescriptorSetLayout descriptorSetLayout;
+    unsigned long long culledVersion; // draw list version the visibility was last computed on
+    unsigned int sharedLists;       // how many views recorded another view's list on the last frame
+} vkViewSet;
+
+/// @brief a view images, framebuffer and descriptor set waiting on the retirement queue, and it's command buffers when the view was destroyed
+typedef struct {
+    VkImage images[3];              // color, resolve and depth
+    VkDeviceMemory memories[3];
+    VkImageView views[3];
+    VkFramebuffer framebuffer;
+    VkDescriptorPool descriptorPool; // the set is freed back into the views pool
+    VkDescriptorSet descriptorSet;
+    VkCommandPool commandPool;
+    VkCommandBuffer commandBuffers[CREN_CONCURRENTLY_RENDERED_FRAMES];
+} vkRetiredViewTargets;
+
+/// @brief creates a view, it renders the draw list packets (but not what's drawn from the render callback) with it's own camera every frame it's enabled
+/// the visibility of every view is computed on a single pass over the draw list, views that see the same packets record the same sorted list
+/// @param context cren context
+/// @param width view image width
+/// @param height view image height
+/// @return the view or NULL if CREN_VIEWS_MAX - 1 views already exist or it's images couldn't be created
+CREN_API vkView* crenvk_view_create(CRenContext* context, unsigned int width, unsigned int height);
+
+/// @brief destroys a view, it's images and command buffers are released once the frames in flight are done with them
+/// @param context cren context
+/// @param view the view
+CREN_API void crenvk_view_destroy(CRenContext* context, vkView* view);
+
+/// @brief re-allocates the view images with another size, the previous ones are released once the frames in flight are done with them. The view descriptor set changes
+/// @param context cren context
+/// @param view the view
+/// @param width new width
+/// @param height new height
+CREN_API void crenvk_view_resize(CRenContext* context, vkView* view, unsigned int width, unsigned int height);
+
+/// @brief enables/disables rendering the view, disabled views keep their last image
+/// @param view the view
+/// @param enabled 1 to render it every frame, 0 to stop
+CREN_API void crenvk_view_set_enabled(vkView* view, int enabled);
+
+/// @brief returns the view camera, it's updated by cren_update like the main camera
+/// @param view the view
+CREN_API CRenCamera* crenvk_view_get_camera(vkView* view);
+
+/// @brief returns the descriptor set sampling the view image (a combined image sampler), like the viewport one
+/// @param view the view
+CREN_API VkDescriptorSet crenvk_view_get_descriptor(vkView* view);
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Mipmap-related
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+/// @brief push constants of the mipmap compute shader
+typedef struct {
+    int size[2];
+    unsigned int mipCount;
+    unsigned int workGroupCount;
+    unsigned int counterIndex;
+    unsigned int srgb;
+} vkMipmapPushConstant;
+
+/// @brief a texture waiting for it's mip levels
+typedef struct {
+    VkImage image;
+    unsigned int width;
+    unsigned int height;
+    unsigned int mipLevels;
+    int srgb;
+    VkImageView views[CREN_MIPMAP_COMPUTE_LEVELS_MAX + 1];
+    VkDescriptorSet descriptorSet;
+} vkMipmapRequest;
+
+/// @brief generates every mip level of a texture with a single compute dispatch (single pass downsampler), blits are used when the device can't
+typedef struct {
+    int supported;                      // compute path is available, textures are created with storage usage
+    int asyncCompute;                   // dispatches run on the compute queue
+    int batching;                       // requests are held until the batch ends
+    unsigned int graphicsFamily;
+    unsigned int queueFamily;           // family the dispatches run on, graphics unless async compute
+    VkQueue queue;
+    VkCommandPool graphicsCommandPool;  // ownership transfers and blit fallback
+    VkCommandPool commandPool;          // dispatches
+    VkDescriptorSetLayout descriptorSetLayout;
+    VkPipelineLayout layout;
+    VkPipeline pipeline;
+    VkDescriptorPool descriptorPool;
+    VkBuffer counterBuffer;             // one atomic counter per batched texture
+    VkDeviceMemory counterMemory;
+    vkMipmapRequest requests[CREN_MIPMAP_BATCH_MAX];
+    unsigned int requestCount;
+} vkMipmapGenerator;
+
+/// @brief returns if textures mips are generated with compute, textures must then be created with storage usage and mutable format (see crenvk_texture2d_create_from_path)
+/// @param context cren context
+CREN_API int crenvk_mipmaps_compute_supported(CRenContext* context);
+
+/// @brief generates all mip levels of an image from it's base level, using a single compute dispatch when supported and blits otherwise
+/// @note every level must be on VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, they're left on VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL. Inside a batch the image must not be used until the batch ends
+/// @param context cren context
+/// @param image the image, it's base level already filled
+/// @param width base level width
+/// @param height base level height
+/// @param mipLevels how many levels the image has
+/// @param srgb 1 if the texels are sRGB encoded (image created as UNORM with a sRGB view), filtering then happens in linear space
+CREN_API void crenvk_mipmaps_generate(CRenContext* context, VkImage image, unsigned int width, unsigned int height, unsigned int mipLevels, int srgb);
+
+/// @brief starts holding mipmap requests, so a level load generates every texture's mips on a single submission
+/// @param context cren context
+CREN_API void crenvk_mipmaps_begin_batch(CRenContext* context);
+
+/// @brief generates the mips of every texture requested since the batch began and waits for them
+/// @param context cren context
+CREN_API void crenvk_mipmaps_end_batch(CRenContext* context);
+
+/// @brief chooses the queue mipmaps are generated on, the compute queue only takes effect when it's a different queue family than graphics
+/// @param context cren context
+/// @param enabled 1 to use the compute queue, 0 to use the graphics queue
+CREN_API void crenvk_mipmaps_set_async_compute(CRenContext* context, int enabled);
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Memory-related
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+/// @brief gpu memory usage and budget of every memory heap
+typedef struct {
+    int budgetExtension;                                // VK_EXT_memory_budget is enabled, otherwise budgets are estimated from the heap sizes and usage only accounts textures
+    PFN_vkGetPhysicalDeviceMemoryProperties2KHR getMemoryProperties2;
+    unsigned int heapCount;
+    unsigned int textureHeap;                           // device-local heap textures are allocated from
+    VkDeviceSize heapSize[VK_MAX_MEMORY_HEAPS];
+    VkDeviceSize heapBudget[VK_MAX_MEMORY_HEAPS];
+    VkDeviceSize heapUsage[VK_MAX_MEMORY_HEAPS];
+    VkMemoryHeapFlags heapFlags[VK_MAX_MEMORY_HEAPS];
+    unsigned long long updatedFrame;                    // frame the budget was last queried on
+    unsigned long long evictionCheckFrame;              // frame the renderer last checked the budget on it's own, stats queries don't delay it
+} vkMemoryBudget;
+
+/// @brief every live texture, used to evict the least recently used ones when over the memory budget
+typedef struct {
+    struct Texture2DBackend** textures;
+    unsigned int count;
+    unsigned int capacity;
+    VkDeviceSize residentBytes;                         // memory used by all textures
+    unsigned int evictedLevels;                         // mip levels dropped so far
+} vkTextureResidency;
+
+/// @brief a texture being re-built with a different resident base level, the old image is sampled until the new one is uploaded
+typedef struct {
+    struct Texture2DBackend* texture;
+    int uploaded;                       // the upload finished, descriptor sets are being switched to the new image
+    unsigned int pendingSlots;          // frame slots whose descriptor sets still sample the old image
+    unsigned int baseLevel;
+    unsigned int width;
+    unsigned int height;
+    unsigned int mipLevels;
+    VkImage image;
+    VkDeviceMemory memory;
+    VkImageView view;
+    VkBuffer staging;
+    VkDeviceMemory stagingMemory;
+    VkCommandBuffer cmdBuffer;
+    VkFence fence;
+} vkStreamingJob;
+
+/// @brief a descriptor set waiting to be freed back into it's pool
+typedef struct {
+    VkDescriptorPool pool;
+    VkDescriptorSet set;
+} vkRetiredDescriptorSet;
+
+/// @brief streams texture mip levels in and out based on how big they're drawn on screen
+typedef struct {
+    int enabled;                        // textures created while enabled start with only their mip tail resident
+    vkStreamingJob jobs[CREN_TEXTURE_STREAMING_JOBS_MAX];
+    unsigned int jobCount;
+    unsigned int streamedIn;            // statistics, jobs that increased/decreased the resident levels
+    unsigned int streamedOut;
+} vkTextureStreamer;
+
+/// @brief re-queries the per-heap usage and budget
+/// @param context cren context
+CREN_API void crenvk_memory_budget_update(CRenContext* context);
+
+/// @brief drops the top mip level of the least recently used textures until the texture heap fits it's budget. Textures are re-built on the gpu and switched over like streaming jobs, only forcing waits for the device
+/// @param context cren context
+/// @param incomingBytes memory about to be allocated for textures, that must fit as well
+/// @param force also evicts textures used on the last frames, used when an allocation already failed
+/// @return how many mip levels were dropped
+CREN_API unsigned int crenvk_memory_evict_textures(CRenContext* context, VkDeviceSize incomingBytes, int force);
+
+/// @brief enables/disables mip streaming, textures created from a path while enabled start with only their mip tail resident and have the levels they need on screen streamed in (within the memory budget)
+/// @param context cren context
+/// @param enabled 1 to enable, 0 to disable. Disabling only affects textures created afterwards
+CREN_API void crenvk_texture_streaming_set_enabled(CRenContext* context, int enabled);
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Capture-related
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+/// @brief where a capture slot is on it's way from the gpu to the capture callback
+typedef enum {
+    CaptureSlot_Free = 0,
+    CaptureSlot_Requested,          // the copy is recorded on the next frame
+    CaptureSlot_Copying,            // the copy was submitted, waiting for the frame to leave the gpu
+    CaptureSlot_Encoding            // owned by the capture worker
+} vkCaptureSlotState;
+
+/// @brief a readback buffer of the capture ring
+typedef struct {
+    vkCaptureSlotState state;
+    CRenCaptureFormat format;
+    CRenCallback_Capture callback;
+    void* userData;
+    unsigned long long frame;       // frame number the copy was submitted on
+    unsigned int width;
+    unsigned int height;
+    int bgra;                       // texels are stored as bgra, swizzled by the worker
+    int sequence;                   // part of the frame sequence, written to it's file instead of encoded
+    unsigned long long sequenceIndex;
+    VkBuffer buffer;
+    VkDeviceMemory memory;
+    VkDeviceSize size;
+    void* mapped;                   // persistently mapped, host coherent
+    VkCommandBuffer cmdBuffer;
+} vkCaptureSlot;
+
+/// @brief a frame sequence being written into a memory-mapped file
+typedef struct {
+    int recording;                  // frames are still being captured
+    CRenSequenceFormat format;
+    unsigned int interval;
+    unsigned long long frameCounter;    // frames rendered since the sequence started
+    unsigned int width;
+    unsigned int height;
+    void* file;                     // the mapped file, open until every captured frame is written
+    unsigned char* data;
+    unsigned long long headerSize;
+    unsigned long long frameSize;   // bytes per frame on the file, frame header included
+    unsigned long long frameCapacity;
+    unsigned long long assigned;    // frames given a place on the file
+    unsigned long long written;     // frames written by the worker
+    unsigned long long dropped;
+} vkCaptureSequence;
+
+/// @brief captures frames into host-visible buffers and encodes them on a worker thread, the render loop never waits on either
+typedef struct {
+    vkCaptureSlot slots[CREN_CAPTURE_RING_SIZE];
+    vkCaptureSequence sequence;
+    void* worker;                   // started on the first capture
+    void* mutex;                    // guards the slot states
+    void* condition;                // signaled when a slot is ready to encode or the ring shuts down
+    int running;
+} vkCaptureRing;
+
+/// @brief queues a capture of the next rendered frame, see cren_capture_frame
+/// @param context cren context
+/// @param format file format to encode to
+/// @param callback receives the encoded frame on the worker thread
+/// @param userData user-defined pointer given to the callback
+/// @return 1 if the capture was queued, 0 if every slot is in use
+CREN_API int crenvk_capture_request(CRenContext* context, CRenCaptureFormat format, CRenCallback_Capture callback, void* userData);
+
+/// @brief starts a frame sequence, see cren_capture_sequence_begin
+/// @param context cren context
+/// @param path output file's disk path
+/// @param format file container
+/// @param interval a frame is captured every interval frames
+/// @param fps playback frame rate written on the y4m header
+/// @param maxFrames how many frames the file holds
+/// @return 1 if the sequence started, 0 otherwise
+CREN_API int crenvk_capture_sequence_begin(CRenContext* context, const char* path, CRenSequenceFormat format, unsigned int interval, unsigned int fps, unsigned int maxFrames);
+
+/// @brief stops capturing the frame sequence, the file is closed once the frames in flight are written
+/// @param context cren context
+CREN_API void crenvk_capture_sequence_end(CRenContext* context);
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Timestamp-related
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+/// @brief measures how long the gpu takes on every frame, a timestamp is written before the first and after the last command buffer of the frame
+typedef struct {
+    int supported;                  // the graphics queue supports timestamps
+    int enabled;
+    double period;                  // nanoseconds per timestamp tick
+    unsigned long long validMask;   // timestamp bits the queue writes
+    VkQueryPool queryPool;          // two queries per slot
+    VkCommandBuffer beginCmds[CREN_CONCURRENTLY_RENDERED_FRAMES];
+    VkCommandBuffer endCmds[CREN_CONCURRENTLY_RENDERED_FRAMES];
+    unsigned long long frames[CREN_CONCURRENTLY_RENDERED_FRAMES]; // frame number written on every slot, plus one (0 if never written)
+} vkFrameTimer;
+
+/// @brief enables/disables measuring the gpu frame time, disabled by default
+/// @param context cren context
+/// @param enabled 1 to enable, 0 to disable
+/// @return 1 if the timer is enabled, 0 if disabled or the device doesn't support timestamps
+CREN_API int crenvk_frame_timer_set_enabled(CRenContext* context, int enabled);
+
+/// @brief returns how long the gpu took to render a frame, results are only kept for the last CREN_CONCURRENTLY_RENDERED_FRAMES frames
+/// @param context cren context
+/// @param frame the frame number, see vkRetirementQueue's frameNumber
+/// @param milliseconds output gpu time in milliseconds
+/// @return 1 if the time is available, 0 if the frame wasn't measured, was overwritten or is still on the gpu
+CREN_API int crenvk_frame_timer_get(CRenContext* context, unsigned long long frame, double* milliseconds);
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Compute-related
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+/// @brief per-frame compute work, dispatches recorded during a frame are submitted right before it's graphics work, which waits on them with a semaphore
+typedef struct {
+    int async;                      // dispatches run on the compute queue family
+    int recording;                  // the slot's command buffer is being recorded
+    unsigned int family;            // family the dispatches run on, graphics unless async
+    unsigned int graphicsFamily;
+    unsigned int slot;              // slot being recorded
+    VkQueue queue;
+    VkCommandPool commandPools[CREN_CONCURRENTLY_RENDERED_FRAMES];
+    VkCommandBuffer cmdBuffers[CREN_CONCURRENTLY_RENDERED_FRAMES];
+    VkSemaphore semaphores[CREN_CONCURRENTLY_RENDERED_FRAMES];  // signaled by the compute submit, waited by the graphics submit
+    VkFence fences[CREN_CONCURRENTLY_RENDERED_FRAMES];          // the slot's compute work is done
+} vkComputeQueue;
+
+/// @brief returns the command buffer of the current frame's compute work, recording starts on the first call of every frame
+/// @note the frame's graphics work waits on it, but compute work of the next frame may overlap with this frame's graphics. Work recorded on a skipped frame (minimized, out of date swapchain) is submitted and waited on that frame
+/// @param context cren context
+/// @return the command buffer, or VK_NULL_HANDLE on failure
+CREN_API VkCommandBuffer crenvk_compute_get_command_buffer(CRenContext* context);
+
+/// @brief records a dispatch into the current frame's compute work
+/// @param context cren context
+/// @param pipeline the compute pipeline
+/// @param descriptorSet descriptor set bound on set 0, may be VK_NULL_HANDLE
+/// @param pushConstants push constants data, may be NULL
+/// @param pushConstantsSize push constants size in bytes
+/// @param groupsX workgroups on x
+/// @param groupsY workgroups on y
+/// @param groupsZ workgroups on z
+/// @return 1 on success, 0 on failure
+CREN_API int crenvk_compute_dispatch(CRenContext* context, vkComputePipeline* pipeline, VkDescriptorSet descriptorSet, const void* pushConstants, unsigned int pushConstantsSize, unsigned int groupsX, unsigned int groupsY, unsigned int groupsZ);
+
+/// @brief makes the writes of previous dispatches visible to the next ones, needed when a dispatch reads what an earlier one wrote
+/// @param context cren context
+CREN_API void crenvk_compute_barrier(CRenContext* context);
+
+/// @brief chooses the queue dispatches run on, the compute queue only takes effect when it's a different queue family than graphics
+/// @note resources used by both queues must then be created with VK_SHARING_MODE_CONCURRENT, see crenvk_compute_get_queue_families
+/// @param context cren context
+/// @param enabled 1 to use the compute queue, 0 to use the graphics queue
+/// @return 1 if dispatches run on the compute queue, 0 otherwise
+CREN_API int crenvk_compute_set_async(CRenContext* context, int enabled);
+
+/// @brief returns the distinct queue families that use compute resources, for resources created with VK_SHARING_MODE_CONCURRENT
+/// @param context cren context
+/// @param families output families, graphics first
+/// @return how many families were written, 2 when async compute is in use and 1 otherwise (exclusive sharing is enough)
+CREN_API unsigned int crenvk_compute_get_queue_families(CRenContext* context, unsigned int families[2]);
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Pick-related
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+/// @brief push constants of the rectangle pick compute shader
+typedef struct {
+    int offset[2];
+    int size[2];
+    unsigned int workGroupCount;
+    unsigned int maxCandidates;
+    unsigned int maxIds;
+} vkPickRectPushConstant;
+
+/// @brief where a rectangle pick is on it's way from the gpu to the application
+typedef enum {
+    PickRect_Free = 0,
+    PickRect_Requested,             // the dispatch is recorded on the next frame
+    PickRect_Picking,               // the dispatch was submitted, waiting for the frame to leave the gpu
+    PickRect_Ready                  // the ids may be read
+} vkPickRectState;
+
+/// @brief selects every object inside a rectangle of the picking image, a compute dispatch removes the repeated ids on the gpu and only the resulting list is read back
+typedef struct {
+    vkPickRectState state;
+    int x;
+    int y;
+    int width;
+    int height;
+    unsigned long long frame;               // frame number the dispatch was submitted on
+    vkComputePipeline* pipeline;            // reads single-sampled picking images
+    vkComputePipeline* multisampledPipeline;
+    VkDescriptorPool descriptorPool;
+    VkDescriptorSet descriptorSet;
+    VkBuffer workBuffer;                    // counters and the ids of every tile, device local
+    VkDeviceMemory workMemory;
+    VkBuffer resultBuffer;                  // distinct ids, host visible
+    VkDeviceMemory resultMemory;
+    void* mapped;                           // persistently mapped, host coherent
+    VkCommandBuffer cmdBuffer;
+} vkPickRect;
+
+/// @brief queues a pick of every object inside a rectangle of the picking image, the dispatch is recorded on the next frame. See crenvk_pick_rect_result
+/// @param context cren context
+/// @param x rectangle's left, in picking image texels (the swapchain extent)
+/// @param y rectangle's top, in picking image texels
+/// @param width rectangle width, the rectangle is clamped to the image
+/// @param height rectangle height
+/// @return 1 if the pick was queued, 0 if another pick is in flight or the pick pipelines couldn't be created
+CREN_API int crenvk_pick_rect_request(CRenContext* context, int x, int y, int width, int height);
+
+/// @brief reads the ids of the last rectangle pick once it left the gpu, a few frames after it was requested
+/// @param context cren context
+/// @param ids output ids, in no particular order
+/// @param capacity how many ids may be written
+/// @param count output distinct ids found, ids past capacity or CREN_PICK_RECT_IDS_MAX aren't written
+/// @return 1 if the pick finished and it's ids were read, 0 if it's still in flight or nothing was requested
+CREN_API int crenvk_pick_rect_result(CRenContext* context, unsigned long long* ids, unsigned int capacity, unsigned int* count);
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Light-related
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+/// @brief a point light as the shaders see it, matches include/light.glsl (std430)
+typedef struct {
+    float3 position;                        // world space
+    float radius;                           // the light doesn't reach past it
+    float3 color;
+    float intensity;
+} vkPointLight;
+
+/// @brief push constants of the light clustering compute shader
+typedef struct {
+    mat4 view;
+    float4 frustum;                         // near, far, tan(fov / 2) * aspect, tan(fov / 2)
+    unsigned int lightCount;
+    unsigned int padding[3];
+} vkLightClusterPushConstant;
+
+/// @brief bins the point lights of a frame into a froxel grid of the main camera's frustum, fragments only shade the lights of their cluster
+/// @note cluster buffer layout: frustum (float4), lightCount, 3 padding uints, CREN_LIGHT_CLUSTERS_X * Y * Z light counts and CREN_LIGHTS_PER_CLUSTER_MAX light indices per cluster
+typedef struct {
+    vkPointLight* lights;                   // submitted this frame, cleared after rendering
+    unsigned int lightCount;
+    vkComputePipeline* pipeline;
+    VkDescriptorPool descriptorPool;
+    VkDescriptorSet descriptorSets[CREN_CONCURRENTLY_RENDERED_FRAMES];
+    VkBuffer lightBuffers[CREN_CONCURRENTLY_RENDERED_FRAMES];          // host visible
+    VkDeviceMemory lightMemories[CREN_CONCURRENTLY_RENDERED_FRAMES];
+    void* mapped[CREN_CONCURRENTLY_RENDERED_FRAMES];                   // persistently mapped, host coherent
+    VkBuffer clusterBuffers[CREN_CONCURRENTLY_RENDERED_FRAMES];        // device local, written by the clustering dispatch
+    VkDeviceMemory clusterMemories[CREN_CONCURRENTLY_RENDERED_FRAMES];
+} vkLightClusters;
+
+/// @brief submits a point light for the current frame, lights must be submitted every frame as they're cleared after rendering
+/// @param context cren context
+/// @param light the light, it's copied
+/// @return 1 if the light was submitted, 0 if CREN_LIGHTS_MAX was reached or the clustering resources couldn't be created
+CREN_API int crenvk_light_submit(CRenContext* context, const vkPointLight* light);
+
+/// @brief returns how many lights were submitted so far on the current frame
+/// @param context cren context
+/// @return the light count
+CREN_API unsigned int crenvk_light_count(CRenContext* context);
+
+/// @brief returns the buffers a fragment shader reads the clustered lights from (bindings 3 and 4 of the mesh pipeline), creating them if needed
+/// @param context cren context
+/// @param frame the frame in flight the descriptors are written for
+/// @param lights output light buffer info, a storage buffer of vkPointLight
+/// @param clusters output cluster buffer info, a storage buffer laid as described on vkLightClusters
+/// @return 1 on success, 0 if the clustering resources couldn't be created
+CREN_API int crenvk_lights_get_descriptor_infos(CRenContext* context, unsigned int frame, VkDescriptorBufferInfo* lights, VkDescriptorBufferInfo* clusters);
+
 /////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 // Core-related
 /////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -320,6 +1164,7 @@ typedef struct {
     int hint_resize;
     int hint_minimized;
     int hint_viewport;
+    int hint_msaa;
 
     vkDefaultRenderphase defaultRenderphase;
     vkPickingRenderphase pickingRenderphase;
@@ -328,6 +1173,19 @@ typedef struct {
 
     Hashtable* buffersLib;
     Hashtable* pipelinesLib;
+    vkPipelineRegistry pipelineRegistry;
+    vkDrawlist drawlist;
+    vkViewSet viewSet;
+    vkMipmapGenerator mipmapGenerator;
+    vkRetirementQueue retirement;
+    vkMemoryBudget memoryBudget;
+    vkTextureResidency textureResidency;
+    vkTextureStreamer textureStreamer;
+    vkCaptureRing captureRing;
+    vkFrameTimer frameTimer;
+    vkComputeQueue compute;
+    vkPickRect pickRect;
+    vkLightClusters lights;
 } CRenVulkanBackend;
 
 /// @brief initializes the vulkan renderer, this is called by cren
@@ -460,13 +1318,15 @@ CREN_API VkFormat crenvk_find_depth_format(VkPhysicalDevice physicalDevice);
 typedef struct {
     align_as(8) unsigned long long id;
     align_as(16) mat4 model;
+    align_as(4) unsigned int view;      // camera buffer slot the object is seen from, 0 is the main camera
 } vkPushConstant;
 
-/// @brief cren camera buffer
+/// @brief a camera on the camera buffer, the buffer holds CREN_VIEWS_MAX of them
 typedef struct {
     align_as(16) mat4 view;
     align_as(16) mat4 viewInverse;
     align_as(16) mat4 proj;
+    align_as(4) float time;             // seconds updated so far, see cren_get_time
 } vkBufferCamera;
 
 /// @brief cren vulkan buffer
@@ -548,6 +1408,32 @@ typedef struct Texture2DBackend {
     VkSampler sampler;
     VkImageView view;
     VkDescriptorSet uiDescriptor;
+
+    // residency
+    VkFormat format;                    // image format, the view is always sRGB
+    VkImageUsageFlags usage;
+    VkImageCreateFlags flags;
+    unsigned int width;                 // resident size, smaller than the texture's after evictions
+    unsigned int height;
+    unsigned int mipLevels;
+    unsigned int evictedLevels;         // top mip levels dropped to fit the memory budget
+    VkDeviceSize size;                  // resident memory in bytes
+    unsigned long long lastUsedFrame;
+    unsigned int residencyIndex;
+    VkDescriptorSet boundSets[CREN_CONCURRENTLY_RENDERED_FRAMES]; // descriptor sets sampling the texture, re-written when it's evicted
+    unsigned int boundBinding;
+
+    // streaming
+    int streamable;                     // levels are streamed from path as needed
+    int streaming;                      // a streaming job is re-building the texture
+    char path[CREN_PATH_MAX_SIZE];
+    unsigned int fullWidth;
+    unsigned int fullHeight;
+    unsigned int fullMipLevels;
+    unsigned int requestedLevel;        // finest level needed on screen on the requested frame
+    unsigned long long requestedFrame;
+
+    int shared;                         // sampled by descriptor sets the texture doesn't know about (atlas pages), never evicted
 } CRenTexture2DBackend;
 
 /// @brief 2d texture relevant data
@@ -581,7 +1467,7 @@ CREN_API CRenTexture2D crenvk_texture2d_create_from_path(CRenContext* context, c
 /// @return the created 2d texture
 CREN_API CRenTexture2D crenvk_texture2d_create_from_buffer(CRenContext* context, CrenTexture2DBuffer* bufferInfo, int gui);
 
-/// @brief release the resources used by the texture
+/// @brief release the resources used by the texture, they're released once the frames in flight are done with them
 /// @param context cren context
 /// @param texture the texture to have it's resources released
 CREN_API void crenvk_texture2d_destroy(CRenContext* context, CRenTexture2D* texture);
@@ -601,6 +1487,94 @@ CREN_API VkImageView crenvk_texture2d_get_image_view(CRenTexture2D* texture);
 /// @return texture's VkDescriptorSet object
 CREN_API VkDescriptorSet crenvk_texture2d_get_descriptor(CRenTexture2D* texture);
 
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Atlas-related
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+/// @brief where a texture was packed inside an atlas, the uv offset and scale are ready to be used on QuadParams
+typedef struct {
+    int packed;                 // 0 if the texture didn't fit a page
+    unsigned int page;
+    int x;                      // texels inside the page, padding not included
+    int y;
+    int width;
+    int height;
+    float2 uv_offset;
+    float2 uv_scale;
+} CRenAtlasRegion;
+
+/// @brief a texture waiting to be packed
+typedef struct {
+    unsigned char* pixels;      // rgba8, released once the atlas is built
+    int width;
+    int height;
+} vkAtlasEntry;
+
+/// @brief what the quads of an atlas page share, one descriptor set per frame and a params buffer indexed by the quad slot (the draw instance)
+typedef struct {
+    vkBuffer* params;           // CREN_ATLAS_PAGE_QUADS_MAX QuadParams per frame
+    VkDescriptorPool descriptorPool;
+    VkDescriptorSet descriptorSets[CREN_CONCURRENTLY_RENDERED_FRAMES];
+    unsigned int* freeSlots;    // slots released once the frames in flight were done with them
+    unsigned int freeCount;
+    unsigned int slotCount;     // slots handed out so far, free or not
+} vkAtlasPage;
+
+/// @brief an atlas page slot waiting on the retirement queue to be handed out again
+typedef struct {
+    vkAtlasPage* page;
+    unsigned int slot;
+} vkRetiredAtlasSlot;
+
+/// @brief packs many small textures into a few large pages, quads addressing a page region share the page texture
+typedef struct {
+    int pageSize;
+    int padding;
+    int built;
+    vkAtlasEntry* entries;
+    CRenAtlasRegion* regions;
+    unsigned int count;
+    unsigned int capacity;
+    CRenTexture2D* pages;
+    vkAtlasPage** pageBatches;  // one per page, NULL if it couldn't be created
+    unsigned int pageCount;
+} CRenAtlas;
+
+/// @brief creates an empty atlas
+/// @param pageSize page width and height in texels, CREN_ATLAS_PAGE_SIZE is used when 0
+/// @param padding texels around every texture, CREN_ATLAS_PADDING is used when negative
+/// @return the atlas or NULL on failure
+CREN_API CRenAtlas* crenvk_atlas_create(int pageSize, int padding);
+
+/// @brief releases the atlas and it's pages, quads using it must be destroyed or moved to another texture first
+/// @param context cren context
+/// @param atlas the atlas
+CREN_API void crenvk_atlas_destroy(CRenContext* context, CRenAtlas* atlas);
+
+/// @brief loads a texture from disk to be packed on the next build
+/// @param atlas the atlas
+/// @param path texture's disk path
+/// @return the texture region index, -1 on failure
+CREN_API int crenvk_atlas_add_from_path(CRenAtlas* atlas, const char* path);
+
+/// @brief copies a rgba8 texture to be packed on the next build
+/// @param atlas the atlas
+/// @param bufferInfo the texture data
+/// @return the texture region index, -1 on failure
+CREN_API int crenvk_atlas_add_from_buffer(CRenAtlas* atlas, CrenTexture2DBuffer* bufferInfo);
+
+/// @brief packs the added textures into pages and uploads them with their mip chain, an atlas is built only once
+/// @param context cren context
+/// @param atlas the atlas
+/// @return 1 on success, 0 on failure. Textures that don't fit a page aren't packed
+CREN_API int crenvk_atlas_build(CRenContext* context, CRenAtlas* atlas);
+
+/// @brief returns where a texture was packed
+/// @param atlas the atlas, must be built
+/// @param index the texture region index
+/// @return the region, or NULL if index is out of bounds
+CREN_API const CRenAtlasRegion* crenvk_atlas_get_region(CRenAtlas* atlas, int index);
+
 /////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 // Quad-related
 /////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -612,11 +1586,19 @@ typedef struct {
     align_as(8) float2 lockAxis;	    // controls wich axis to lock
     align_as(8) float2 uv_offset;	    // offsets the uv/texture
     align_as(8) float2 uv_scale;	    // scales the uv/texture
+    align_as(8) float2 flipbookGrid;          // columns/rows of the sprite sheet, uv offset/scale then select the sheet
+    align_as(4) unsigned int flipbookFrames;  // frames on the sheet (row-major from the top-left), 0 disables the flipbook
+    align_as(4) float flipbookFps;            // frames per second
+    align_as(4) float flipbookStartTime;      // time the animation starts at, see cren_get_time
+    align_as(4) unsigned int flipbookLoop;    // 1 loops, 0 holds the last frame
 } QuadParams;
 
 /// @brief holds vulkan information about the quad
 typedef struct {
 	CRenTexture2D colormap;
+	CRenTexture2D* atlasPage;	// when set the quad samples a region of this page instead of it's colormap
+	vkAtlasPage* atlasBatch;	// the page descriptor sets and params buffer, used instead of the quad's own when atlasPage is set
+	unsigned int atlasSlot;		// where the quad params live on the page buffer
 	vkBuffer* buffer;
 	VkDescriptorPool descriptorPool;
 	VkDescriptorSet descriptorSets[CREN_CONCURRENTLY_RENDERED_FRAMES];
@@ -635,7 +1617,7 @@ typedef struct {
 /// @return the created quad
 CREN_API CRenQuad* crenvk_quad_create(CRenContext* context, const char* albedoPath);
 
-/// @brief release all resources used by a quad
+/// @brief release all resources used by a quad, gpu resources are released once the frames in flight are done with them
 /// @param context cren context
 /// @param quad the quad to destroy
 CREN_API void crenvk_quad_destroy(CRenContext* context, CRenQuad* quad);
@@ -652,6 +1634,111 @@ CREN_API void crenvk_quad_apply_buffer_changes(CRenContext* context, CRenQuad* q
 /// @param transform quad's transformation matrix
 CREN_API void crenvk_quad_render(CRenContext* context, CRenRenderStage stage, CRenQuad* quad, const mat4 transform);
 
+/// @brief makes the quad sample an atlas region instead of it's own colormap, rewriting the uv offset/scale. The colormap is released
+/// @note the quad takes a slot on the page params buffer and is drawn with the page descriptor sets, so quads of the same page are bound once
+/// @param context cren context
+/// @param quad the quad
+/// @param atlas the atlas, must be built and outlive the quad
+/// @param index the texture region index
+/// @return 1 on success, 0 if the region wasn't packed or the page has no free slots
+CREN_API int crenvk_quad_set_atlas_region(CRenContext* context, CRenQuad* quad, CRenAtlas* atlas, int index);
+
+/// @brief submits the quad to the frame's draw list, it's drawn on both default and picking stages without walking the scene twice
+/// @param context cren context
+/// @param quad the quad to submit
+/// @param transform quad's transformation matrix
+CREN_API void crenvk_quad_submit(CRenContext* context, CRenQuad* quad, const mat4 transform);
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Particle-related
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+/// @brief how an emitter spawns, moves and draws it's particles, read every time it's simulated/rendered
+typedef struct {
+    float4 origin;              // xyz world position, w radius of the sphere particles spawn in
+    float4 velocity;            // xyz initial velocity, w random spread added on every axis
+    float4 acceleration;        // xyz constant acceleration (gravity, wind), w linear drag
+    float4 startColor;          // multiplies the colormap at birth
+    float4 endColor;            // multiplies the colormap at death
+    float2 size;                // half extent at birth/death
+    float2 lifetime;            // min/max seconds a particle lives
+    float2 lockAxis;            // controls wich axis to lock, same as quads
+    unsigned int billboard;     // always faces the camera
+    float spawnRate;            // particles spawned per second
+} ParticleParams;
+
+/// @brief push constants of the particle simulation, must match particle.comp
+typedef struct {
+    float4 origin;
+    float4 velocity;
+    float4 acceleration;
+    float2 lifetime;
+    float timestep;
+    unsigned int spawnCount;
+    unsigned int seed;
+    unsigned int maxParticles;
+    unsigned int target;
+} vkParticleSimulatePushConstant;
+
+/// @brief push constants of the particle rendering, must match particle.vert
+typedef struct {
+    float4 startColor;
+    float4 endColor;
+    float2 size;
+    float2 lockAxis;
+    unsigned int billboard;
+    unsigned int source;
+} vkParticleDrawPushConstant;
+
+/// @brief holds vulkan information about the emitter, particles live on two buffers the simulation ping-pongs between
+typedef struct {
+	CRenTexture2D colormap;
+	unsigned int maxParticles;
+	unsigned int target;                // buffer the last simulation wrote
+	unsigned int seed;
+	int simulated;                      // the draw commands were initialized
+	double spawnAccumulator;            // fraction of a particle carried to the next simulation
+	VkBuffer particleBuffers[2];
+	VkDeviceMemory particleMemories[2];
+	VkBuffer drawBuffer;                // one VkDrawIndirectCommand per particle buffer, the instance count is it's alive count
+	VkDeviceMemory drawMemory;
+	VkDescriptorPool descriptorPool;
+	VkDescriptorSet simulateSets[2];    // indexed by the buffer being written
+	VkDescriptorSet drawSets[CREN_CONCURRENTLY_RENDERED_FRAMES];
+} vkParticleBackend;
+
+/// @brief cren particle emitter, it's particles only exist on the gpu
+typedef struct {
+	unsigned long long id;
+	ParticleParams params;
+	vkParticleBackend* backend;
+} CRenParticleEmitter;
+
+/// @brief creates a particle emitter, the particle pipelines are created with the first emitter
+/// @param context cren context
+/// @param albedoPath the particles colormap
+/// @param maxParticles how many particles may be alive at once
+/// @return the emitter or NULL on failure (like the particle shaders not being compiled)
+CREN_API CRenParticleEmitter* crenvk_particles_create(CRenContext* context, const char* albedoPath, unsigned int maxParticles);
+
+/// @brief release all resources used by an emitter, gpu resources are released once the frames in flight are done with them
+/// @param context cren context
+/// @param emitter the emitter to destroy
+CREN_API void crenvk_particles_destroy(CRenContext* context, CRenParticleEmitter* emitter);
+
+/// @brief spawns, ages, moves and compacts the emitter's particles with a single dispatch on the frame's compute work
+/// @note call it once per frame, before or while rendering. Resources are shared with the compute queue, so choose it (crenvk_compute_set_async) before creating emitters
+/// @param context cren context
+/// @param emitter the emitter
+/// @param timestep seconds since the last simulation
+CREN_API void crenvk_particles_simulate(CRenContext* context, CRenParticleEmitter* emitter, double timestep);
+
+/// @brief renders every alive particle with a single indirect instanced draw, particles aren't drawn on the picking stage
+/// @param context cren context
+/// @param stage wich render stage is, only default draws
+/// @param emitter the emitter to render
+CREN_API void crenvk_particles_render(CRenContext* context, CRenRenderStage stage, CRenParticleEmitter* emitter);
+
 #ifdef __cplusplus 
 }
 #endif
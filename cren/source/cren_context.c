@@ -1,6 +1,7 @@
 #include "cren_context.h"
 
 #include "cren_error.h"
+#include "cren_trace.h"
 #include "cren_vulkan.h"
 
 CRenContext* cren_initialize(CRenCreateInfo createInfo) {
@@ -22,6 +23,7 @@ CRenContext* cren_initialize(CRenCreateInfo createInfo) {
     context->camera = cren_camera_create(CAMERA_TYPE_FREE_LOOK, (float)createInfo.width / (float)createInfo.height);
 
     cren_vulkan_init((CRenVulkanBackend*)context->backend, &context->createInfo);
+    if (createInfo.tracePath) cren_trace_begin(context, createInfo.tracePath);
 
     return context;
 }
@@ -32,6 +34,7 @@ void cren_terminate(CRenContext* context) {
 
     CRenVulkanBackend* renderer = (CRenVulkanBackend*)context->backend;
 
+    cren_trace_end(context);
     cren_vulkan_shutdown(renderer);
 
     if(context->backend) crenmemory_deallocate(context->backend);
@@ -39,17 +42,34 @@ void cren_terminate(CRenContext* context) {
 }
 
 void cren_update(CRenContext* context, double timestep) {
+    if (cren_trace_recording(context)) {
+        CRenTraceUpdate update = { timestep, context->camera };
+        cren_trace_write(context, TraceRecord_Update, &update, sizeof(update));
+    }
+
+    context->time += timestep;
     cren_camera_update(&context->camera, timestep);
     cren_vulkan_update(context, timestep);
 }
 
+double cren_get_time(CRenContext* context) {
+    return context->time;
+}
+
 void cren_render(CRenContext* context, double timestep)
 {
+    // everything recorded until the end of the frame was issued from the render callbacks
+    CRenTraceRender render = { timestep };
+    cren_trace_write(context, TraceRecord_Render, &render, sizeof(render));
     cren_vulkan_render(context, timestep);
+    cren_trace_write(context, TraceRecord_RenderEnd, NULL, 0);
 }
 
 void cren_resize(CRenContext *context, int width, int height)
 {
+    CRenTraceResize resize = { width, height };
+    cren_trace_write(context, TraceRecord_Resize, &resize, sizeof(resize));
+
     context->createInfo.width = width;
     context->createInfo.height = height;
 
@@ -57,12 +77,109 @@ void cren_resize(CRenContext *context, int width, int height)
     renderer->hint_resize = 1;
 }
 
+void cren_set_msaa(CRenContext* context, int msaa) {
+    if (context->createInfo.msaa == msaa) return;
+
+    CRenTraceValue value = { msaa };
+    cren_trace_write(context, TraceRecord_SetMsaa, &value, sizeof(value));
+
+    context->createInfo.msaa = msaa;
+
+    CRenVulkanBackend* renderer = (CRenVulkanBackend*)context->backend;
+    renderer->hint_msaa = 1;
+}
+
+void cren_set_vsync(CRenContext* context, int vsync) {
+    if (context->createInfo.vsync == vsync) return;
+
+    CRenTraceValue value = { vsync };
+    cren_trace_write(context, TraceRecord_SetVsync, &value, sizeof(value));
+
+    context->createInfo.vsync = vsync;
+
+    CRenVulkanBackend* renderer = (CRenVulkanBackend*)context->backend;
+    renderer->hint_resize = 1;
+}
+
+void cren_memory_stats(CRenContext* context, CRenMemoryStats* stats) {
+    if (!context || !stats) return;
+
+    CRenVulkanBackend* renderer = (CRenVulkanBackend*)context->backend;
+    crenvk_memory_budget_update(context);
+    crenmemory_zero(stats, sizeof(CRenMemoryStats));
+
+    vkMemoryBudget* budget = &renderer->memoryBudget;
+    stats->budgetExtension = budget->budgetExtension;
+    stats->heapCount = uint_min(budget->heapCount, CREN_MEMORY_HEAPS_MAX);
+
+    for (unsigned int i = 0; i < stats->heapCount; i++) {
+        stats->heaps[i].size = budget->heapSize[i];
+        stats->heaps[i].budget = budget->heapBudget[i];
+        stats->heaps[i].usage = budget->heapUsage[i];
+        stats->heaps[i].deviceLocal = (budget->heapFlags[i] & VK_MEMORY_HEAP_DEVICE_LOCAL_BIT) != 0;
+    }
+
+    stats->textureCount = renderer->textureResidency.count;
+    stats->textureBytes = renderer->textureResidency.residentBytes;
+    stats->evictedLevels = renderer->textureResidency.evictedLevels;
+    stats->streamedIn = renderer->textureStreamer.streamedIn;
+    stats->streamedOut = renderer->textureStreamer.streamedOut;
+}
+
+int cren_pick_rect(CRenContext* context, int x, int y, int width, int height) {
+    if (!context) return 0;
+    return crenvk_pick_rect_request(context, x, y, width, height);
+}
+
+int cren_pick_rect_result(CRenContext* context, unsigned long long* ids, unsigned int capacity, unsigned int* count) {
+    if (!context) return 0;
+    return crenvk_pick_rect_result(context, ids, capacity, count);
+}
+
+int cren_capture_frame(CRenContext* context, CRenCaptureFormat format, CRenCallback_Capture callback, void* userData) {
+    if (!context || !callback) return 0;
+    return crenvk_capture_request(context, format, callback, userData);
+}
+
+int cren_capture_sequence_begin(CRenContext* context, const char* path, CRenSequenceFormat format, unsigned int interval, unsigned int fps, unsigned int maxFrames) {
+    if (!context || !path || maxFrames == 0) return 0;
+    return crenvk_capture_sequence_begin(context, path, format, interval > 0 ? interval : 1, fps > 0 ? fps : 60, maxFrames);
+}
+
+void cren_capture_sequence_end(CRenContext* context) {
+    if (!context) return;
+    crenvk_capture_sequence_end(context);
+}
+
+void cren_capture_sequence_stats(CRenContext* context, CRenSequenceStats* stats) {
+    if (!context || !stats) return;
+
+    CRenVulkanBackend* renderer = (CRenVulkanBackend*)context->backend;
+    vkCaptureRing* ring = &renderer->captureRing;
+    crenmemory_zero(stats, sizeof(CRenSequenceStats));
+    if (ring->mutex == NULL) return;
+
+    cren_mutex_lock(ring->mutex);
+    stats->recording = ring->sequence.recording;
+    stats->writing = ring->sequence.file != NULL;
+    stats->width = ring->sequence.width;
+    stats->height = ring->sequence.height;
+    stats->frameCapacity = ring->sequence.frameCapacity;
+    stats->framesWritten = ring->sequence.written;
+    stats->framesDropped = ring->sequence.dropped;
+    cren_mutex_unlock(ring->mutex);
+}
+
 void cren_minimize(CRenContext* context) {
+    cren_trace_write(context, TraceRecord_Minimize, NULL, 0);
+
     CRenVulkanBackend* renderer = (CRenVulkanBackend*)context->backend;
     renderer->hint_minimized = 1;
 }
 
 void cren_restore(CRenContext* context) {
+    cren_trace_write(context, TraceRecord_Restore, NULL, 0);
+
     CRenVulkanBackend* renderer = (CRenVulkanBackend*)context->backend;
     renderer->hint_minimized = 0;
 }
@@ -11,6 +11,7 @@ const char* cren_error_cstr(CRenError error) {
 	// context
 	case ContextIntializationFailed: return "CRen context could not be initialized";
 	case RendererInitializationFailed: return "Cren renderer could not be initialized";
+	case MemoryAllocationFailed: return "CRen could not allocate memory";
 	// renderer
 	case Vulkan_InstanceCreationFailed: return "Vulkan instance creation has failed";
 	case Vulkan_DebuggerCreationFailed: return "Vulkan debugger creation has failed";
@@ -24,6 +25,7 @@ const char* cren_error_cstr(CRenError error) {
 	case Vulkan_CommandBufferCreationFailed: return "Vulkan command buffer creation has failed";
 	case Vulkan_CommandBufferAllocationFailed: return "Vulkan command buffer allocation has failed";
 	case Vulkan_FramebufferCreationFailed: return "Vulkan framebuffer creation has failed";
+	case Vulkan_ImageCreationFailed: return "Vulkan image creation has failed";
 
 
 	case Success: return "No errors";
@@ -1,3 +1,8 @@
+// mmap, ftruncate and madvise aren't part of strict c11
+#if !defined _WIN32 && !defined _DEFAULT_SOURCE
+    #define _DEFAULT_SOURCE
+#endif
+
 #include "cren_platform.h"
 #include "cren_error.h"
 
@@ -35,7 +40,15 @@
     #include <X11/Xlib.h>
 #endif
 
+#if !defined PLATFORM_WINDOWS
+    #include <fcntl.h>
+    #include <sys/mman.h>
+    #include <time.h>
+    #include <unistd.h>
+#endif
+
 #include <stb_image.h>
+#include <stb_image_write.h>
 
 #if defined PLATFORM_WINDOWS || defined PLATFORM_WAYLAND || defined PLATFORM_X11
 
@@ -231,6 +244,193 @@ void cren_thread_unlock() {
     internal_unlock();
 }
 
+void* cren_thread_create(CRenThreadFunction function, void* argument) {
+    thrd_t* thread = (thrd_t*)crenmemory_allocate(sizeof(thrd_t), 1);
+    if (!thread) return NULL;
+
+    if (thrd_create(thread, function, argument) != thrd_success) {
+        crenmemory_deallocate(thread);
+        return NULL;
+    }
+
+    return thread;
+}
+
+void cren_thread_join(void* thread) {
+    if (!thread) return;
+
+    thrd_join(*(thrd_t*)thread, NULL);
+    crenmemory_deallocate(thread);
+}
+
+void* cren_mutex_create() {
+    mtx_t* mutex = (mtx_t*)crenmemory_allocate(sizeof(mtx_t), 1);
+    if (!mutex) return NULL;
+
+    if (mtx_init(mutex, mtx_plain) != thrd_success) {
+        crenmemory_deallocate(mutex);
+        return NULL;
+    }
+
+    return mutex;
+}
+
+void cren_mutex_destroy(void* mutex) {
+    if (!mutex) return;
+
+    mtx_destroy((mtx_t*)mutex);
+    crenmemory_deallocate(mutex);
+}
+
+void cren_mutex_lock(void* mutex) {
+    mtx_lock((mtx_t*)mutex);
+}
+
+void cren_mutex_unlock(void* mutex) {
+    mtx_unlock((mtx_t*)mutex);
+}
+
+void* cren_condition_create() {
+    cnd_t* condition = (cnd_t*)crenmemory_allocate(sizeof(cnd_t), 1);
+    if (!condition) return NULL;
+
+    if (cnd_init(condition) != thrd_success) {
+        crenmemory_deallocate(condition);
+        return NULL;
+    }
+
+    return condition;
+}
+
+void cren_condition_destroy(void* condition) {
+    if (!condition) return;
+
+    cnd_destroy((cnd_t*)condition);
+    crenmemory_deallocate(condition);
+}
+
+void cren_condition_wait(void* condition, void* mutex) {
+    cnd_wait((cnd_t*)condition, (mtx_t*)mutex);
+}
+
+void cren_condition_signal(void* condition) {
+    cnd_broadcast((cnd_t*)condition);
+}
+
+/// @brief a file mapped into memory
+typedef struct {
+    unsigned char* data;
+    unsigned long long size;
+#if defined PLATFORM_WINDOWS
+    HANDLE file;
+    HANDLE mapping;
+#else
+    int descriptor;
+#endif
+} CRenMappedFile;
+
+void* cren_file_map_create(const char* path, unsigned long long size, unsigned char** outData) {
+    CRenMappedFile* mapped = (CRenMappedFile*)crenmemory_allocate(sizeof(CRenMappedFile), 1);
+    if (!mapped || size == 0) {
+        if (mapped) crenmemory_deallocate(mapped);
+        return NULL;
+    }
+
+    mapped->size = size;
+
+#if defined PLATFORM_WINDOWS
+    mapped->file = CreateFileA(path, GENERIC_READ | GENERIC_WRITE, FILE_SHARE_READ, NULL, CREATE_ALWAYS, FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, NULL);
+    if (mapped->file == INVALID_HANDLE_VALUE) {
+        crenmemory_deallocate(mapped);
+        return NULL;
+    }
+
+    mapped->mapping = CreateFileMappingA(mapped->file, NULL, PAGE_READWRITE, (DWORD)(size >> 32), (DWORD)(size & 0xFFFFFFFF), NULL);
+    mapped->data = mapped->mapping != NULL ? (unsigned char*)MapViewOfFile(mapped->mapping, FILE_MAP_WRITE, 0, 0, (SIZE_T)size) : NULL;
+    if (mapped->data == NULL) {
+        if (mapped->mapping != NULL) CloseHandle(mapped->mapping);
+        CloseHandle(mapped->file);
+        crenmemory_deallocate(mapped);
+        return NULL;
+    }
+#else
+    mapped->descriptor = open(path, O_RDWR | O_CREAT | O_TRUNC, 0644);
+    if (mapped->descriptor < 0) {
+        crenmemory_deallocate(mapped);
+        return NULL;
+    }
+
+    // the whole file is allocated up-front, running out of disk space is found now and not half-way through
+    void* data = ftruncate(mapped->descriptor, (off_t)size) == 0 ? mmap(NULL, (size_t)size, PROT_READ | PROT_WRITE, MAP_SHARED, mapped->descriptor, 0) : MAP_FAILED;
+    if (data == MAP_FAILED) {
+        close(mapped->descriptor);
+        crenmemory_deallocate(mapped);
+        return NULL;
+    }
+
+    mapped->data = (unsigned char*)data;
+    madvise(data, (size_t)size, MADV_SEQUENTIAL);
+#endif
+
+    *outData = mapped->data;
+    return mapped;
+}
+
+void cren_file_map_flush(void* file, unsigned long long offset, unsigned long long size) {
+    CRenMappedFile* mapped = (CRenMappedFile*)file;
+    if (!mapped || offset >= mapped->size) return;
+    if (offset + size > mapped->size) size = mapped->size - offset;
+
+#if defined PLATFORM_WINDOWS
+    FlushViewOfFile(mapped->data + offset, (SIZE_T)size);
+#else
+    // msync wants a page-aligned address
+    unsigned long long page = (unsigned long long)sysconf(_SC_PAGESIZE);
+    unsigned long long start = offset / page * page;
+    msync(mapped->data + start, (size_t)(offset + size - start), MS_ASYNC);
+#endif
+}
+
+void cren_file_map_destroy(void* file, unsigned long long finalSize) {
+    CRenMappedFile* mapped = (CRenMappedFile*)file;
+    if (!mapped) return;
+    if (finalSize > mapped->size) finalSize = mapped->size;
+
+#if defined PLATFORM_WINDOWS
+    UnmapViewOfFile(mapped->data);
+    CloseHandle(mapped->mapping);
+
+    LARGE_INTEGER end;
+    end.QuadPart = (LONGLONG)finalSize;
+    SetFilePointerEx(mapped->file, end, NULL, FILE_BEGIN);
+    SetEndOfFile(mapped->file);
+    CloseHandle(mapped->file);
+#else
+    munmap(mapped->data, (size_t)mapped->size);
+    if (ftruncate(mapped->descriptor, (off_t)finalSize) != 0) {
+        CREN_LOG("CRen: Failed to truncate mapped file");
+    }
+    close(mapped->descriptor);
+#endif
+
+    crenmemory_deallocate(mapped);
+}
+
+double cren_time_seconds() {
+#if defined PLATFORM_WINDOWS
+    static LARGE_INTEGER frequency = { 0 };
+    if (frequency.QuadPart == 0) QueryPerformanceFrequency(&frequency);
+
+    LARGE_INTEGER counter;
+    QueryPerformanceCounter(&counter);
+    return (double)counter.QuadPart / (double)frequency.QuadPart;
+#else
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (double)now.tv_sec + (double)now.tv_nsec / 1000000000.0;
+#endif
+}
+
 unsigned char* cren_stbimage_load_from_file(const char* path, int desiredChannels, int* outWidth, int* outHeight, int* outChannels) {
 
     int x, y, channels = 0;
@@ -250,3 +450,57 @@ const char* cren_stbimage_get_error()
 {
     return stbi_failure_reason();
 }
+
+/// @brief growable memory the encoders write into
+typedef struct {
+    unsigned char* data;
+    unsigned long long size;
+    unsigned long long capacity;
+    int failed;
+} CRenEncodeTarget;
+
+/// @brief stb's write callback, appends the encoded bytes to the target
+/// @param context the encode target
+/// @param data encoded bytes
+/// @param size how many bytes
+static void internal_cren_encode_write(void* context, void* data, int size) {
+    CRenEncodeTarget* target = (CRenEncodeTarget*)context;
+    if (target->failed || size <= 0) return;
+
+    if (target->size + (unsigned long long)size > target->capacity) {
+        unsigned long long capacity = target->capacity > 0 ? target->capacity : 64 * 1024;
+        while (capacity < target->size + (unsigned long long)size) capacity *= 2;
+
+        unsigned char* grown = (unsigned char*)crenmemory_reallocate(target->data, (size_t)capacity);
+        if (!grown) {
+            target->failed = 1;
+            return;
+        }
+
+        target->data = grown;
+        target->capacity = capacity;
+    }
+
+    crenmemory_copy(target->data + target->size, data, (size_t)size);
+    target->size += (unsigned long long)size;
+}
+
+unsigned char* cren_stbimage_encode(const unsigned char* pixels, int width, int height, int channels, int jpeg, int quality, unsigned long long* outSize) {
+    CRenEncodeTarget target = { 0 };
+    int success = jpeg
+        ? stbi_write_jpg_to_func(internal_cren_encode_write, &target, width, height, channels, pixels, quality)
+        : stbi_write_png_to_func(internal_cren_encode_write, &target, width, height, channels, pixels, width * channels);
+
+    if (!success || target.failed) {
+        if (target.data) crenmemory_deallocate(target.data);
+        *outSize = 0;
+        return NULL;
+    }
+
+    *outSize = target.size;
+    return target.data;
+}
+
+void cren_stbimage_encoded_destroy(unsigned char* ptr) {
+    if (ptr) crenmemory_deallocate(ptr);
+}
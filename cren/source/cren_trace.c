@@ -0,0 +1,164 @@
+#include "cren_trace.h"
+
+#include "cren_error.h"
+#include "cren_utils.h"
+
+#include <stdio.h>
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Recording
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+int cren_trace_begin(CRenContext* context, const char* path) {
+    if (!context || !path || context->trace) return 0;
+
+    CRenTrace* trace = (CRenTrace*)crenmemory_allocate(sizeof(CRenTrace), 1);
+    if (!trace) return 0;
+
+    FILE* file = fopen(path, "wb");
+    if (!file) {
+        CREN_LOG("CRen: Failed to create the trace file %s", path);
+        crenmemory_deallocate(trace);
+        return 0;
+    }
+
+    // records are small and many, they're only written to disk once the buffer is full
+    trace->buffer = (char*)crenmemory_allocate(CREN_TRACE_BUFFER_SIZE, 0);
+    if (trace->buffer) setvbuf(file, trace->buffer, _IOFBF, CREN_TRACE_BUFFER_SIZE);
+
+    unsigned int version = CREN_TRACE_VERSION;
+    fwrite(CREN_TRACE_MAGIC, 1, 4, file);
+    fwrite(&version, sizeof(version), 1, file);
+
+    trace->file = file;
+    context->trace = trace;
+
+    CRenTraceBegin begin = { 0 };
+    begin.width = context->createInfo.width;
+    begin.height = context->createInfo.height;
+    begin.msaa = context->createInfo.msaa;
+    begin.vsync = context->createInfo.vsync;
+    begin.smallerViewport = context->createInfo.smallerViewport;
+    begin.picking = context->createInfo.picking;
+    begin.depthPrepass = context->createInfo.depthPrepass;
+    if (context->createInfo.assetsRoot) cren_strncpy(begin.assetsRoot, context->createInfo.assetsRoot, sizeof(begin.assetsRoot) - 1);
+    cren_trace_write(context, TraceRecord_Begin, &begin, sizeof(begin));
+
+    CREN_LOG("CRen: Tracing api calls into %s", path);
+    return 1;
+}
+
+void cren_trace_end(CRenContext* context) {
+    if (!context || !context->trace) return;
+
+    CRenTrace* trace = (CRenTrace*)context->trace;
+    trace->suspended = 0;
+    cren_trace_write(context, TraceRecord_End, NULL, 0);
+
+    // the file must be closed before the buffer it writes through is released
+    fclose((FILE*)trace->file);
+    CREN_LOG("CRen: Trace closed, %llu records (%llu bytes)", trace->records, trace->bytes);
+
+    if (trace->buffer) crenmemory_deallocate(trace->buffer);
+    crenmemory_deallocate(trace);
+    context->trace = NULL;
+}
+
+int cren_trace_recording(CRenContext* context) {
+    if (!context || !context->trace) return 0;
+    return ((CRenTrace*)context->trace)->suspended == 0;
+}
+
+void cren_trace_suspend(CRenContext* context) {
+    if (!context || !context->trace) return;
+    ((CRenTrace*)context->trace)->suspended++;
+}
+
+void cren_trace_resume(CRenContext* context) {
+    if (!context || !context->trace) return;
+
+    CRenTrace* trace = (CRenTrace*)context->trace;
+    if (trace->suspended > 0) trace->suspended--;
+}
+
+void cren_trace_write(CRenContext* context, CRenTraceRecordType type, const void* payload, unsigned int size) {
+    if (!cren_trace_recording(context)) return;
+
+    CRenTrace* trace = (CRenTrace*)context->trace;
+    FILE* file = (FILE*)trace->file;
+    unsigned short recordType = (unsigned short)type;
+
+    fwrite(&recordType, sizeof(recordType), 1, file);
+    fwrite(&size, sizeof(size), 1, file);
+    if (size > 0) fwrite(payload, 1, size, file);
+
+    trace->records++;
+    trace->bytes += sizeof(recordType) + sizeof(size) + size;
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Reading
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+CRenTraceReader* cren_trace_open(const char* path) {
+    if (!path) return NULL;
+
+    FILE* file = fopen(path, "rb");
+    if (!file) return NULL;
+
+    char magic[4] = { 0 };
+    unsigned int version = 0;
+    if (fread(magic, 1, 4, file) != 4 || fread(&version, sizeof(version), 1, file) != 1 || crenmemory_compare(magic, CREN_TRACE_MAGIC, 4) != 0) {
+        CREN_LOG("CRen: %s is not a trace file", path);
+        fclose(file);
+        return NULL;
+    }
+
+    if (version != CREN_TRACE_VERSION) {
+        CREN_LOG("CRen: %s is a version %u trace, only version %u is supported", path, version, CREN_TRACE_VERSION);
+        fclose(file);
+        return NULL;
+    }
+
+    CRenTraceReader* reader = (CRenTraceReader*)crenmemory_allocate(sizeof(CRenTraceReader), 1);
+    if (!reader) {
+        fclose(file);
+        return NULL;
+    }
+
+    reader->file = file;
+    reader->version = version;
+    return reader;
+}
+
+int cren_trace_read(CRenTraceReader* reader, CRenTraceRecord* record) {
+    if (!reader || !record) return 0;
+
+    FILE* file = (FILE*)reader->file;
+    unsigned short recordType = 0;
+    unsigned int size = 0;
+    if (fread(&recordType, sizeof(recordType), 1, file) != 1 || fread(&size, sizeof(size), 1, file) != 1) return 0;
+
+    if (size > reader->capacity) {
+        unsigned char* payload = (unsigned char*)crenmemory_reallocate(reader->payload, size);
+        if (!payload) return 0;
+
+        reader->payload = payload;
+        reader->capacity = size;
+    }
+
+    if (size > 0 && fread(reader->payload, 1, size, file) != size) return 0;
+
+    record->type = (CRenTraceRecordType)recordType;
+    record->size = size;
+    record->payload = reader->payload;
+    return 1;
+}
+
+void cren_trace_close(CRenTraceReader* reader) {
+    if (!reader) return;
+
+    fclose((FILE*)reader->file);
+    if (reader->payload) crenmemory_deallocate(reader->payload);
+    crenmemory_deallocate(reader);
+}
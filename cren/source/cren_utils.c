@@ -33,6 +33,10 @@ void* crenmemory_copy(void* dest, const void* src, unsigned long long size) {
     return memcpy(dest, src, size);
 }
 
+int crenmemory_compare(const void* ptr0, const void* ptr1, unsigned long long size) {
+    return memcmp(ptr0, ptr1, size);
+}
+
 /////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 // Dynamic array
 /////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
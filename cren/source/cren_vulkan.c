@@ -4,8 +4,13 @@
 #include "cren_context.h"
 #include "cren_error.h"
 #include "cren_math.h"
+#include "cren_trace.h"
 #include "cren_utils.h"
 
+#include <stb_rect_pack.h>
+#include <stddef.h>
+#include <stdio.h>
+
 /////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 // Instance-related
 /////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -42,25 +47,35 @@ static VKAPI_ATTR VkBool32 VKAPI_CALL internal_crenvk_debug_callback(VkDebugUtil
 
 /// @brief returns a dynamic array containing all instance extensions required by the renderer
 /// @param validations includes validation extensions support, used if validations are requested by the application
+/// @param headless there's no window to present to, the headless surface is used instead of the platform's one
 /// @return the array with all extensions required
-static CRenArray* cren_get_required_instance_extensions(int validations) {
+static CRenArray* cren_get_required_instance_extensions(int validations, int headless) {
     CRenArray* extensions = crenarray_create(6);
     if (!extensions) {
         return NULL;
     }
 
     crenarray_push_back(extensions, VK_KHR_SURFACE_EXTENSION_NAME);
+    if (headless) {
+        crenarray_push_back(extensions, VK_EXT_HEADLESS_SURFACE_EXTENSION_NAME);
+    }
+
+    else {
 #if defined(PLATFORM_WINDOWS)
-    crenarray_push_back(extensions, "VK_KHR_win32_surface");
+        crenarray_push_back(extensions, "VK_KHR_win32_surface");
 #elif defined(PLATFORM_APPLE)
-    crenarray_push_back(extensions, "VK_EXT_metal_surface");
-    crenarray_push_back(extensions, VK_KHR_PORTABILITY_ENUMERATION_EXTENSION_NAME);
+        crenarray_push_back(extensions, "VK_EXT_metal_surface");
 #elif defined(PLATFORM_ANDROID)
-    crenarray_push_back(extensions, "VK_KHR_android_surface");
+        crenarray_push_back(extensions, "VK_KHR_android_surface");
 #elif defined(PLATFORM_WAYLAND)
-    crenarray_push_back(extensions, "VK_KHR_wayland_surface");
+        crenarray_push_back(extensions, "VK_KHR_wayland_surface");
 #elif defined(PLATFORM_X11)
-    crenarray_push_back(extensions, "VK_KHR_xlib_surface");
+        crenarray_push_back(extensions, "VK_KHR_xlib_surface");
+#endif
+    }
+
+#if defined(PLATFORM_APPLE)
+    crenarray_push_back(extensions, VK_KHR_PORTABILITY_ENUMERATION_EXTENSION_NAME);
 #endif
 
     crenarray_push_back(extensions, VK_KHR_GET_PHYSICAL_DEVICE_PROPERTIES_2_EXTENSION_NAME);
@@ -124,11 +139,12 @@ void print_cren_array_strings(const CRenArray* array) {
 /// @param appVersion application's version
 /// @param apiVersion wich vulkan version desired
 /// @param validations request the api validaions or not
+/// @param headless there's no window to present to
 /// @return 1 on success, 0 on failure
-static int internal_crenvk_instance_create(vkInstance* instance, const char* appName, unsigned int appVersion, unsigned int apiVersion, int validations) {
+static int internal_crenvk_instance_create(vkInstance* instance, const char* appName, unsigned int appVersion, unsigned int apiVersion, int validations, int headless) {
 
     
-    CRenArray* extensions = cren_get_required_instance_extensions(validations);
+    CRenArray* extensions = cren_get_required_instance_extensions(validations, headless);
     print_cren_array_strings(extensions);
 
     print_available_instance_extensions();
@@ -374,8 +390,12 @@ static VkPhysicalDevice internal_crenvk_choose_physical_device(VkInstance instan
 /// @param presentQueue vulkan presentation queue
 /// @param computeQueue vulkan compute queue
 /// @param validations signals vulkan validations on/off
+/// @param memoryBudget enables VK_EXT_memory_budget, it must be supported
+/// @param pipelineLibrary enables VK_EXT_graphics_pipeline_library, it must be supported
+/// @param dynamicRendering enables the dynamic rendering feature, it must be supported
+/// @param dynamicRenderingExtension how many of VK_KHR_dynamic_rendering and it's dependencies must be enabled, 0 where it's core. See internal_crenvk_dynamic_rendering_supported
 /// @return 1 on success, 0 on failure
-static int internal_crenvk_create_logical_device(VkPhysicalDevice physicalDevice, VkSurfaceKHR surface, VkDevice* device, VkQueue* graphicsQueue, VkQueue* presentQueue, VkQueue* computeQueue, int validations)
+static int internal_crenvk_create_logical_device(VkPhysicalDevice physicalDevice, VkSurfaceKHR surface, VkDevice* device, VkQueue* graphicsQueue, VkQueue* presentQueue, VkQueue* computeQueue, int validations, int memoryBudget, int pipelineLibrary, int dynamicRendering, int dynamicRenderingExtension)
 {
     const char* validationLayers[] = { "VK_LAYER_KHRONOS_validation" }; // must be the same as instance, wich it is
     unsigned int validationLayerCount = 1;
@@ -403,13 +423,31 @@ static int internal_crenvk_create_logical_device(VkPhysicalDevice physicalDevice
     }
 
     // extensions
-    #if defined(PLATFORM_APPLE) && (VK_HEADER_VERSION >= 216)
-    const char* extensions[] = { VK_KHR_SWAPCHAIN_EXTENSION_NAME, VK_KHR_PORTABILITY_ENUMERATION_EXTENSION_NAME };
-    unsigned int extensionCount = 2;
-    #else
-    const char* extensions[] = { VK_KHR_SWAPCHAIN_EXTENSION_NAME };
+    const char* extensions[10] = { VK_KHR_SWAPCHAIN_EXTENSION_NAME };
     unsigned int extensionCount = 1;
+    #if defined(PLATFORM_APPLE) && (VK_HEADER_VERSION >= 216)
+    extensions[extensionCount++] = VK_KHR_PORTABILITY_ENUMERATION_EXTENSION_NAME;
     #endif
+    if (memoryBudget) extensions[extensionCount++] = VK_EXT_MEMORY_BUDGET_EXTENSION_NAME;
+    if (pipelineLibrary) {
+        extensions[extensionCount++] = VK_KHR_PIPELINE_LIBRARY_EXTENSION_NAME;
+        extensions[extensionCount++] = VK_EXT_GRAPHICS_PIPELINE_LIBRARY_EXTENSION_NAME;
+    }
+    if (dynamicRendering) {
+        const char* dynamicRenderingExtensions[] = { VK_KHR_DYNAMIC_RENDERING_EXTENSION_NAME, VK_KHR_DEPTH_STENCIL_RESOLVE_EXTENSION_NAME, VK_KHR_CREATE_RENDERPASS_2_EXTENSION_NAME, VK_KHR_MULTIVIEW_EXTENSION_NAME, VK_KHR_MAINTENANCE_2_EXTENSION_NAME };
+        for (int i = 0; i < dynamicRenderingExtension && i < (int)CREN_ARRAYSIZE(dynamicRenderingExtensions); i++) {
+            extensions[extensionCount++] = dynamicRenderingExtensions[i];
+        }
+    }
+
+    VkPhysicalDeviceGraphicsPipelineLibraryFeaturesEXT pipelineLibraryFeatures = { 0 };
+    pipelineLibraryFeatures.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_GRAPHICS_PIPELINE_LIBRARY_FEATURES_EXT;
+    pipelineLibraryFeatures.graphicsPipelineLibrary = VK_TRUE;
+
+    VkPhysicalDeviceDynamicRenderingFeaturesKHR dynamicRenderingFeatures = { 0 };
+    dynamicRenderingFeatures.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_DYNAMIC_RENDERING_FEATURES_KHR;
+    dynamicRenderingFeatures.pNext = pipelineLibrary ? &pipelineLibraryFeatures : NULL;
+    dynamicRenderingFeatures.dynamicRendering = VK_TRUE;
 
     // required features
     VkPhysicalDeviceFeatures deviceFeatures = { 0 };
@@ -421,7 +459,7 @@ static int internal_crenvk_create_logical_device(VkPhysicalDevice physicalDevice
     // device create info
     VkDeviceCreateInfo deviceCI = { 0 };
     deviceCI.sType = VK_STRUCTURE_TYPE_DEVICE_CREATE_INFO;
-    deviceCI.pNext = NULL;
+    deviceCI.pNext = dynamicRendering ? (void*)&dynamicRenderingFeatures : (pipelineLibrary ? (void*)&pipelineLibraryFeatures : NULL);
     deviceCI.flags = 0;
     deviceCI.queueCreateInfoCount = queueCount;
     deviceCI.pQueueCreateInfos = queueCreateInfos;
@@ -453,13 +491,98 @@ static int internal_crenvk_create_logical_device(VkPhysicalDevice physicalDevice
     return 1;
 }
 
+/// @brief checks if pipelines can be fast-linked from VK_EXT_graphics_pipeline_library libraries, linking is only worth it when the driver says it's fast
+/// @param instance vulkan instance, created with the properties2 extension
+/// @param physicalDevice vulkan physical device
+/// @return 1 if supported, 0 otherwise
+static int internal_crenvk_pipeline_library_supported(VkInstance instance, VkPhysicalDevice physicalDevice) {
+    const char* libraryExtensions[] = { VK_KHR_PIPELINE_LIBRARY_EXTENSION_NAME, VK_EXT_GRAPHICS_PIPELINE_LIBRARY_EXTENSION_NAME };
+    if (!internal_crenvk_check_device_extension_support(physicalDevice, libraryExtensions, 2)) return 0;
+
+    PFN_vkGetPhysicalDeviceFeatures2KHR getFeatures2 = (PFN_vkGetPhysicalDeviceFeatures2KHR)vkGetInstanceProcAddr(instance, "vkGetPhysicalDeviceFeatures2KHR");
+    PFN_vkGetPhysicalDeviceProperties2KHR getProperties2 = (PFN_vkGetPhysicalDeviceProperties2KHR)vkGetInstanceProcAddr(instance, "vkGetPhysicalDeviceProperties2KHR");
+    if (getFeatures2 == NULL || getProperties2 == NULL) return 0;
+
+    VkPhysicalDeviceGraphicsPipelineLibraryFeaturesEXT libraryFeatures = { 0 };
+    libraryFeatures.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_GRAPHICS_PIPELINE_LIBRARY_FEATURES_EXT;
+    VkPhysicalDeviceFeatures2 features = { 0 };
+    features.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_FEATURES_2;
+    features.pNext = &libraryFeatures;
+    getFeatures2(physicalDevice, &features);
+
+    VkPhysicalDeviceGraphicsPipelineLibraryPropertiesEXT libraryProperties = { 0 };
+    libraryProperties.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_GRAPHICS_PIPELINE_LIBRARY_PROPERTIES_EXT;
+    VkPhysicalDeviceProperties2 properties = { 0 };
+    properties.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_PROPERTIES_2;
+    properties.pNext = &libraryProperties;
+    getProperties2(physicalDevice, &properties);
+
+    return libraryFeatures.graphicsPipelineLibrary == VK_TRUE && libraryProperties.graphicsPipelineLibraryFastLinking == VK_TRUE;
+}
+
+/// @brief checks if phases can render with dynamic rendering, either from vulkan 1.3 or VK_KHR_dynamic_rendering
+/// VK_KHR_dynamic_rendering needs VK_KHR_depth_stencil_resolve and VK_KHR_create_renderpass2 (core on 1.2), wich need VK_KHR_multiview and VK_KHR_maintenance2 (core on 1.1)
+/// @param instance vulkan instance, created with the properties2 extension
+/// @param physicalDevice vulkan physical device
+/// @param apiVersion the vulkan version the application asked for
+/// @param extension outputs how many extensions must be enabled, in order: VK_KHR_dynamic_rendering and the dependencies that aren't core on the version the device is used with. 0 when the feature is core
+/// @return 1 if supported, 0 otherwise
+static int internal_crenvk_dynamic_rendering_supported(VkInstance instance, VkPhysicalDevice physicalDevice, unsigned int apiVersion, int* extension) {
+    VkPhysicalDeviceProperties properties = { 0 };
+    vkGetPhysicalDeviceProperties(physicalDevice, &properties);
+
+    // same order as the logical device enables them
+    const char* dynamicRenderingExtensions[] = { VK_KHR_DYNAMIC_RENDERING_EXTENSION_NAME, VK_KHR_DEPTH_STENCIL_RESOLVE_EXTENSION_NAME, VK_KHR_CREATE_RENDERPASS_2_EXTENSION_NAME, VK_KHR_MULTIVIEW_EXTENSION_NAME, VK_KHR_MAINTENANCE_2_EXTENSION_NAME };
+    unsigned int usedVersion = apiVersion < properties.apiVersion ? apiVersion : properties.apiVersion;
+    int required = 0;
+    if (usedVersion < VK_API_VERSION_1_3) required = 1;
+    if (usedVersion < VK_API_VERSION_1_2) required = 3;
+    if (usedVersion < VK_API_VERSION_1_1) required = 5;
+    if (required > 0 && !internal_crenvk_check_device_extension_support(physicalDevice, dynamicRenderingExtensions, required)) return 0;
+
+    PFN_vkGetPhysicalDeviceFeatures2KHR getFeatures2 = (PFN_vkGetPhysicalDeviceFeatures2KHR)vkGetInstanceProcAddr(instance, "vkGetPhysicalDeviceFeatures2KHR");
+    if (getFeatures2 == NULL) return 0;
+
+    VkPhysicalDeviceDynamicRenderingFeaturesKHR dynamicRenderingFeatures = { 0 };
+    dynamicRenderingFeatures.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_DYNAMIC_RENDERING_FEATURES_KHR;
+    VkPhysicalDeviceFeatures2 features = { 0 };
+    features.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_FEATURES_2;
+    features.pNext = &dynamicRenderingFeatures;
+    getFeatures2(physicalDevice, &features);
+
+    *extension = required;
+    return dynamicRenderingFeatures.dynamicRendering == VK_TRUE;
+}
+
+/// @brief creates a surface that isn't tied to any window, presenting to it is a no-op. Used by headless renderers (trace replays, offline captures)
+/// @param instance vulkan instance, created with the headless surface extension
+/// @param surface output surface
+/// @return 1 on success, 0 on failure
+static int internal_crenvk_headless_surface_create(VkInstance instance, VkSurfaceKHR* surface) {
+    PFN_vkCreateHeadlessSurfaceEXT fn = (PFN_vkCreateHeadlessSurfaceEXT)vkGetInstanceProcAddr(instance, "vkCreateHeadlessSurfaceEXT");
+    if (fn == NULL) return 0;
+
+    VkHeadlessSurfaceCreateInfoEXT createInfo = { 0 };
+    createInfo.sType = VK_STRUCTURE_TYPE_HEADLESS_SURFACE_CREATE_INFO_EXT;
+    return fn(instance, &createInfo, NULL, surface) == VK_SUCCESS;
+}
+
 /// @brief creates the physical and logical device as well of other related-stuff
 /// @param backend cren vulkan backend memory address
-/// @param nativeWindow raw ptr to the window object
+/// @param nativeWindow raw ptr to the window object, NULL renders headless
 /// @param validations flags the validations are on/off
+/// @param apiVersion the vulkan version the application asked for
+/// @param dynamicRendering phases render with dynamic rendering when the device supports it
 /// @return 1 on success, 0 on failure
-static int internal_crenvk_device_create(CRenVulkanBackend* backend, void* nativeWindow, int validations) {
-    if (cren_surface_create(backend->instance.instance, &backend->device.surface, nativeWindow) != 1) {
+static int internal_crenvk_device_create(CRenVulkanBackend* backend, void* nativeWindow, int validations, unsigned int apiVersion, int dynamicRendering) {
+    if (nativeWindow == NULL) {
+        if (internal_crenvk_headless_surface_create(backend->instance.instance, &backend->device.surface) != 1) {
+            CREN_LOG("Failed to create headless surface");
+            return 0;
+        }
+    }
+
+    else if (cren_surface_create(backend->instance.instance, &backend->device.surface, nativeWindow) != 1) {
         CREN_LOG("Failed to create window surface");
         return 0;
     }
@@ -475,13 +598,38 @@ static int internal_crenvk_device_create(CRenVulkanBackend* backend, void* nativ
     vkGetPhysicalDeviceMemoryProperties(backend->device.physicalDevice, &backend->device.physicalDeviceMemoryProperties);
     vkGetPhysicalDeviceProperties(backend->device.physicalDevice, &backend->device.physicalDeviceProperties);
     vkGetPhysicalDeviceFeatures(backend->device.physicalDevice, &backend->device.physicalDeviceFeatures);
+    backend->device.apiVersion = apiVersion < backend->device.physicalDeviceProperties.apiVersion ? apiVersion : backend->device.physicalDeviceProperties.apiVersion;
+
+    // memory budget is optional, it also needs the properties2 instance extension
+    const char* budgetExtension[] = { VK_EXT_MEMORY_BUDGET_EXTENSION_NAME };
+    backend->memoryBudget.getMemoryProperties2 = (PFN_vkGetPhysicalDeviceMemoryProperties2KHR)vkGetInstanceProcAddr(backend->instance.instance, "vkGetPhysicalDeviceMemoryProperties2KHR");
+    backend->memoryBudget.budgetExtension = backend->memoryBudget.getMemoryProperties2 != NULL && internal_crenvk_check_device_extension_support(backend->device.physicalDevice, budgetExtension, 1);
+
+    // fast-linked pipelines are optional as well, the pipeline registry builds them whole without it
+    backend->pipelineRegistry.linking = internal_crenvk_pipeline_library_supported(backend->instance.instance, backend->device.physicalDevice);
+    if (backend->pipelineRegistry.linking) CREN_LOG("CRen: Pipelines are fast-linked from pipeline libraries");
+
+    // dynamic rendering is opt-in, phases fall back to render pass and framebuffer objects without it
+    int dynamicRenderingExtension = 0;
+    backend->device.dynamicRendering = dynamicRendering && internal_crenvk_dynamic_rendering_supported(backend->instance.instance, backend->device.physicalDevice, apiVersion, &dynamicRenderingExtension);
+    if (dynamicRendering && !backend->device.dynamicRendering) CREN_LOG("CRen: Dynamic rendering is not supported, using render pass objects");
 
     // create logical device
-    if(internal_crenvk_create_logical_device(backend->device.physicalDevice, backend->device.surface, &backend->device.device, &backend->device.graphicsQueue, &backend->device.presentQueue, &backend->device.computeQueue, validations) != 1) {
+    if(internal_crenvk_create_logical_device(backend->device.physicalDevice, backend->device.surface, &backend->device.device, &backend->device.graphicsQueue, &backend->device.presentQueue, &backend->device.computeQueue, validations, backend->memoryBudget.budgetExtension, backend->pipelineRegistry.linking, backend->device.dynamicRendering, dynamicRenderingExtension) != 1) {
         vkDestroySurfaceKHR(backend->instance.instance, backend->device.surface, NULL);
         return 0;
     }
 
+    if (backend->device.dynamicRendering) {
+        const char* beginName = dynamicRenderingExtension ? "vkCmdBeginRenderingKHR" : "vkCmdBeginRendering";
+        const char* endName = dynamicRenderingExtension ? "vkCmdEndRenderingKHR" : "vkCmdEndRendering";
+        backend->device.cmdBeginRendering = (PFN_vkCmdBeginRenderingKHR)vkGetDeviceProcAddr(backend->device.device, beginName);
+        backend->device.cmdEndRendering = (PFN_vkCmdEndRenderingKHR)vkGetDeviceProcAddr(backend->device.device, endName);
+        backend->device.dynamicRendering = backend->device.cmdBeginRendering != NULL && backend->device.cmdEndRendering != NULL;
+        if (!backend->device.dynamicRendering) CREN_LOG("CRen: Dynamic rendering entry points are missing, using render pass objects");
+    }
+    if (backend->device.dynamicRendering) CREN_LOG("CRen: Phases render with dynamic rendering");
+
     // syncronization objects
     VkSemaphoreCreateInfo semaphoreCI = { 0 };
     semaphoreCI.sType = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO;
@@ -540,6 +688,33 @@ static void internal_crenvk_device_destroy(vkInstance* instance, vkDevice* devic
     if (device->surface) vkDestroySurfaceKHR(instance->instance, device->surface, NULL);
 }
 
+VkSampleCountFlagBits crenvk_device_get_max_msaa(VkPhysicalDevice physicalDevice) {
+    VkPhysicalDeviceProperties properties = { 0 };
+    vkGetPhysicalDeviceProperties(physicalDevice, &properties);
+
+    VkSampleCountFlags counts = properties.limits.framebufferColorSampleCounts & properties.limits.framebufferDepthSampleCounts;
+    if (counts & VK_SAMPLE_COUNT_64_BIT) return VK_SAMPLE_COUNT_64_BIT;
+    if (counts & VK_SAMPLE_COUNT_32_BIT) return VK_SAMPLE_COUNT_32_BIT;
+    if (counts & VK_SAMPLE_COUNT_16_BIT) return VK_SAMPLE_COUNT_16_BIT;
+    if (counts & VK_SAMPLE_COUNT_8_BIT) return VK_SAMPLE_COUNT_8_BIT;
+    if (counts & VK_SAMPLE_COUNT_4_BIT) return VK_SAMPLE_COUNT_4_BIT;
+    if (counts & VK_SAMPLE_COUNT_2_BIT) return VK_SAMPLE_COUNT_2_BIT;
+    return VK_SAMPLE_COUNT_1_BIT;
+}
+
+/// @brief returns the highest supported sample count that is not above the requested one
+/// @param physicalDevice vulkan physical device
+/// @param requested the requested sample count, like 4
+/// @return the choosen sample count
+static VkSampleCountFlagBits internal_crenvk_choose_msaa(VkPhysicalDevice physicalDevice, int requested) {
+    VkSampleCountFlagBits max = crenvk_device_get_max_msaa(physicalDevice);
+    unsigned int samples = VK_SAMPLE_COUNT_1_BIT;
+
+    // sample counts are powers of two
+    while (samples * 2 <= (unsigned int)requested && samples * 2 <= (unsigned int)max) samples *= 2;
+    return (VkSampleCountFlagBits)samples;
+}
+
 int crenvk_device_create_buffer(VkDevice device, VkPhysicalDevice physicalDevice, VkBufferUsageFlags usage, VkMemoryPropertyFlags properties, VkDeviceSize size, VkBuffer* buffer, VkDeviceMemory *memory, void *data) {
     VkBufferCreateInfo bufferCI = { 0 };
     bufferCI.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
@@ -598,6 +773,81 @@ int crenvk_device_create_buffer(VkDevice device, VkPhysicalDevice physicalDevice
     return 1;
 }
 
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Retirement-related
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+/// @brief grows the retirement queue storage to hold one more object
+/// @param queue the retirement queue
+/// @return 1 on success, 0 on failure
+static int internal_crenvk_retirement_reserve(vkRetirementQueue* queue) {
+    if (queue->count < queue->capacity) return 1;
+
+    unsigned int newCapacity = queue->capacity > 0 ? queue->capacity * 2 : CREN_RETIREMENT_INITIAL_CAPACITY;
+    vkRetiredObject* objects = (vkRetiredObject*)crenmemory_reallocate(queue->objects, sizeof(vkRetiredObject) * newCapacity);
+    if (!objects) return 0;
+
+    queue->objects = objects;
+    queue->capacity = newCapacity;
+    return 1;
+}
+
+/// @brief releases the retired objects no frame in flight may be using anymore
+/// @param queue the retirement queue
+/// @param device vulkan device
+/// @param all releases every object regardless of the frame they were retired on, the device must be idle
+static void internal_crenvk_retirement_collect(vkRetirementQueue* queue, VkDevice device, int all) {
+    unsigned int kept = 0;
+
+    // an object retired on frame N may be used by it, that frame is finished once frame N + CREN_CONCURRENTLY_RENDERED_FRAMES waited on it's fence
+    for (unsigned int i = 0; i < queue->count; i++) {
+        vkRetiredObject* retired = &queue->objects[i];
+
+        if (all || retired->frame + CREN_CONCURRENTLY_RENDERED_FRAMES <= queue->frameNumber) {
+            retired->function(device, retired->object);
+            continue;
+        }
+
+        queue->objects[kept++] = *retired;
+    }
+
+    queue->count = kept;
+}
+
+/// @brief releases every retired object and the queue storage, the device must be idle
+/// @param queue the retirement queue
+/// @param device vulkan device
+static void internal_crenvk_retirement_destroy(vkRetirementQueue* queue, VkDevice device) {
+    internal_crenvk_retirement_collect(queue, device, 1);
+    if (queue->objects) crenmemory_deallocate(queue->objects);
+    crenmemory_zero(queue, sizeof(vkRetirementQueue));
+}
+
+void crenvk_retire(CRenContext* context, vkRetireFunction function, void* object) {
+    if (!context || !function || !object) return;
+
+    CRenVulkanBackend* renderer = (CRenVulkanBackend*)context->backend;
+    vkRetirementQueue* queue = &renderer->retirement;
+
+    // out of memory, fallback to the old behaviour and stall
+    if (!internal_crenvk_retirement_reserve(queue)) {
+        cren_set_error(MemoryAllocationFailed);
+        vkDeviceWaitIdle(renderer->device.device);
+        function(renderer->device.device, object);
+        return;
+    }
+
+    vkRetiredObject* retired = &queue->objects[queue->count++];
+    retired->frame = queue->frameNumber;
+    retired->function = function;
+    retired->object = object;
+}
+
+void crenvk_retire_flush(CRenContext* context) {
+    CRenVulkanBackend* renderer = (CRenVulkanBackend*)context->backend;
+    internal_crenvk_retirement_collect(&renderer->retirement, renderer->device.device, 1);
+}
+
 /////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 // Swapchain-related
 /////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -777,6 +1027,433 @@ static void internal_crenvk_swapchain_destroy(vkSwapchain* swapchain, VkDevice d
 // Pipeline-related
 /////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 
+/// @brief first value of every hash chained through internal_crenvk_hash
+#define CREN_HASH_SEED 14695981039346656037ULL
+
+/// @brief chains bytes into a 64-bit FNV-1a hash
+/// @param hash the hash so far, CREN_HASH_SEED for the first bytes
+/// @param data the bytes
+/// @param size how many bytes
+/// @return the new hash
+static unsigned long long internal_crenvk_hash(unsigned long long hash, const void* data, size_t size) {
+	const unsigned char* bytes = (const unsigned char*)data;
+	for (size_t i = 0; i < size; i++) {
+		hash ^= bytes[i];
+		hash *= 1099511628211ULL;
+	}
+	return hash;
+}
+
+/// @brief hashes the shader of a stage by content, two modules loaded from the same file are the same shader
+/// @param hash the hash so far
+/// @param pipeline cren vulkan pipeline
+/// @param index the stage index, 0 is the vertex and 1 the fragment shader
+/// @return the new hash
+static unsigned long long internal_crenvk_pipeline_hash_stage(unsigned long long hash, const vkPipeline* pipeline, unsigned int index) {
+	const VkPipelineShaderStageCreateInfo* stage = &pipeline->shaderStages[index];
+	hash = internal_crenvk_hash(hash, &pipeline->shaderHashes[index], sizeof(pipeline->shaderHashes[index]));
+	hash = internal_crenvk_hash(hash, &stage->stage, sizeof(stage->stage));
+	for (const char* name = stage->pName; name != NULL && *name != '\0'; name++) hash = internal_crenvk_hash(hash, name, 1);
+	return hash;
+}
+
+/// @brief hashes the renderpass a pipeline is built against
+/// @param hash the hash so far
+/// @param renderpass cren vulkan renderpass
+/// @return the new hash
+static unsigned long long internal_crenvk_pipeline_hash_renderpass(unsigned long long hash, const vkRenderpass* renderpass) {
+	// pipelines are only compatible with the renderpass handle they're built with, the sample count and format tell apart a handle re-used after a msaa change
+	// with dynamic rendering the handle is empty, so pipelines of phases sharing the attachment formats and sample count are shared as well
+	hash = internal_crenvk_hash(hash, &renderpass->renderPass, sizeof(VkRenderPass));
+	hash = internal_crenvk_hash(hash, &renderpass->dynamic, sizeof(int));
+	hash = internal_crenvk_hash(hash, &renderpass->msaa, sizeof(VkSampleCountFlagBits));
+	hash = internal_crenvk_hash(hash, &renderpass->depthFormat, sizeof(VkFormat));
+	return internal_crenvk_hash(hash, &renderpass->surfaceFormat, sizeof(VkFormat));
+}
+
+/// @brief fills the attachment formats a pipeline is built against when the renderpass uses dynamic rendering
+/// @param renderpass cren vulkan renderpass
+/// @param info output rendering info
+/// @return the info to chain into the pipeline create info, NULL when the renderpass has a render pass object
+static const void* internal_crenvk_pipeline_rendering_info(const vkRenderpass* renderpass, VkPipelineRenderingCreateInfoKHR* info) {
+	if (!renderpass->dynamic) return NULL;
+
+	crenmemory_zero(info, sizeof(VkPipelineRenderingCreateInfoKHR));
+	info->sType = VK_STRUCTURE_TYPE_PIPELINE_RENDERING_CREATE_INFO_KHR;
+	info->colorAttachmentCount = 1;
+	info->pColorAttachmentFormats = &renderpass->surfaceFormat;
+	info->depthAttachmentFormat = renderpass->depthFormat;
+	info->stencilAttachmentFormat = VK_FORMAT_UNDEFINED;
+	return info;
+}
+
+/// @brief hashes the multisample state
+/// @param hash the hash so far
+/// @param multisample the multisample state
+/// @return the new hash
+static unsigned long long internal_crenvk_pipeline_hash_multisample(unsigned long long hash, const VkPipelineMultisampleStateCreateInfo* multisample) {
+	hash = internal_crenvk_hash(hash, &multisample->rasterizationSamples, sizeof(VkSampleCountFlagBits));
+	hash = internal_crenvk_hash(hash, &multisample->sampleShadingEnable, sizeof(VkBool32));
+	hash = internal_crenvk_hash(hash, &multisample->minSampleShading, sizeof(float));
+	hash = internal_crenvk_hash(hash, &multisample->alphaToCoverageEnable, sizeof(VkBool32));
+	return internal_crenvk_hash(hash, &multisample->alphaToOneEnable, sizeof(VkBool32));
+}
+
+/// @brief hashes everything a pipeline is built with, split on the parts a pipeline library holds. Fields are hashed one by one since the state structs have padding and pNext pointers
+/// @param pipeline cren vulkan pipeline, created but not built
+/// @param parts output hashes, indexed by vkPipelineLibraryPart
+static void internal_crenvk_pipeline_hash_parts(const vkPipeline* pipeline, unsigned long long parts[CREN_PIPELINE_LIBRARY_PARTS]) {
+
+	// vertex input, the descriptions are plain 32-bit fields
+	unsigned long long hash = CREN_HASH_SEED;
+	hash = internal_crenvk_hash(hash, pipeline->pBindingsDescription, sizeof(VkVertexInputBindingDescription) * pipeline->bindingsDescriptionCount);
+	hash = internal_crenvk_hash(hash, &pipeline->bindingsDescriptionCount, sizeof(pipeline->bindingsDescriptionCount));
+	hash = internal_crenvk_hash(hash, pipeline->pAttributesDescription, sizeof(VkVertexInputAttributeDescription) * pipeline->attributesDescriptionCount);
+	hash = internal_crenvk_hash(hash, &pipeline->attributesDescriptionCount, sizeof(pipeline->attributesDescriptionCount));
+	hash = internal_crenvk_hash(hash, &pipeline->inputVertexAssemblyState.topology, sizeof(VkPrimitiveTopology));
+	parts[PipelineLibrary_VertexInput] = internal_crenvk_hash(hash, &pipeline->inputVertexAssemblyState.primitiveRestartEnable, sizeof(VkBool32));
+
+	// vertex shader and rasterization
+	const VkPipelineRasterizationStateCreateInfo* raster = &pipeline->rasterizationState;
+	hash = internal_crenvk_pipeline_hash_stage(CREN_HASH_SEED, pipeline, 0);
+	hash = internal_crenvk_hash(hash, &pipeline->layoutHash, sizeof(pipeline->layoutHash));
+	hash = internal_crenvk_hash(hash, &raster->depthClampEnable, sizeof(VkBool32));
+	hash = internal_crenvk_hash(hash, &raster->rasterizerDiscardEnable, sizeof(VkBool32));
+	hash = internal_crenvk_hash(hash, &raster->polygonMode, sizeof(VkPolygonMode));
+	hash = internal_crenvk_hash(hash, &raster->cullMode, sizeof(VkCullModeFlags));
+	hash = internal_crenvk_hash(hash, &raster->frontFace, sizeof(VkFrontFace));
+	hash = internal_crenvk_hash(hash, &raster->depthBiasEnable, sizeof(VkBool32));
+	hash = internal_crenvk_hash(hash, &raster->depthBiasConstantFactor, sizeof(float));
+	hash = internal_crenvk_hash(hash, &raster->depthBiasClamp, sizeof(float));
+	hash = internal_crenvk_hash(hash, &raster->depthBiasSlopeFactor, sizeof(float));
+	hash = internal_crenvk_hash(hash, &raster->lineWidth, sizeof(float));
+	parts[PipelineLibrary_PreRasterization] = internal_crenvk_pipeline_hash_renderpass(hash, pipeline->renderpass);
+
+	// fragment shader and depth/stencil tests
+	const VkPipelineDepthStencilStateCreateInfo* depthStencil = &pipeline->depthStencilState;
+	hash = internal_crenvk_pipeline_hash_stage(CREN_HASH_SEED, pipeline, 1);
+	hash = internal_crenvk_hash(hash, &pipeline->layoutHash, sizeof(pipeline->layoutHash));
+	hash = internal_crenvk_hash(hash, &depthStencil->depthTestEnable, sizeof(VkBool32));
+	hash = internal_crenvk_hash(hash, &depthStencil->depthWriteEnable, sizeof(VkBool32));
+	hash = internal_crenvk_hash(hash, &depthStencil->depthCompareOp, sizeof(VkCompareOp));
+	hash = internal_crenvk_hash(hash, &depthStencil->depthBoundsTestEnable, sizeof(VkBool32));
+	hash = internal_crenvk_hash(hash, &depthStencil->stencilTestEnable, sizeof(VkBool32));
+	hash = internal_crenvk_hash(hash, &depthStencil->front, sizeof(VkStencilOpState));
+	hash = internal_crenvk_hash(hash, &depthStencil->back, sizeof(VkStencilOpState));
+	hash = internal_crenvk_hash(hash, &depthStencil->minDepthBounds, sizeof(float));
+	hash = internal_crenvk_hash(hash, &depthStencil->maxDepthBounds, sizeof(float));
+	hash = internal_crenvk_pipeline_hash_multisample(hash, &pipeline->multisampleState);
+	parts[PipelineLibrary_FragmentShader] = internal_crenvk_pipeline_hash_renderpass(hash, pipeline->renderpass);
+
+	// blending, the attachment state is plain 32-bit fields as well
+	const VkPipelineColorBlendStateCreateInfo* blend = &pipeline->colorBlendState;
+	hash = internal_crenvk_hash(CREN_HASH_SEED, &pipeline->colorBlendAttachmentState, sizeof(VkPipelineColorBlendAttachmentState));
+	hash = internal_crenvk_hash(hash, &blend->logicOpEnable, sizeof(VkBool32));
+	hash = internal_crenvk_hash(hash, &blend->logicOp, sizeof(VkLogicOp));
+	hash = internal_crenvk_hash(hash, &blend->attachmentCount, sizeof(unsigned int));
+	hash = internal_crenvk_hash(hash, blend->blendConstants, sizeof(blend->blendConstants));
+	hash = internal_crenvk_pipeline_hash_multisample(hash, &pipeline->multisampleState);
+	parts[PipelineLibrary_FragmentOutput] = internal_crenvk_pipeline_hash_renderpass(hash, pipeline->renderpass);
+}
+
+/// @brief drops a reference to a pipeline library, destroying it once unused. Pipelines linked from a library don't need it anymore
+/// @param registry the pipeline registry
+/// @param device vulkan device
+/// @param library the pipeline library
+static void internal_crenvk_pipeline_library_release(vkPipelineRegistry* registry, VkDevice device, VkPipeline library) {
+	if (library == VK_NULL_HANDLE) return;
+
+	for (unsigned int i = 0; i < registry->libraryCount; i++) {
+		vkPipelineLibraryEntry* entry = &registry->libraries[i];
+		if (entry->library != library) continue;
+
+		if (--entry->references > 0) return;
+		registry->libraries[i] = registry->libraries[--registry->libraryCount];
+		break;
+	}
+
+	vkDestroyPipeline(device, library, NULL);
+}
+
+/// @brief returns the library of a pipeline part, compiling it if no pipeline was linked with the same state on that part
+/// @param registry the pipeline registry
+/// @param device vulkan device
+/// @param pipeline cren vulkan pipeline, created but not built
+/// @param part the part to compile
+/// @param hash the part hash
+/// @return the pipeline library, VK_NULL_HANDLE on failure
+static VkPipeline internal_crenvk_pipeline_library_acquire(vkPipelineRegistry* registry, VkDevice device, const vkPipeline* pipeline, vkPipelineLibraryPart part, unsigned long long hash) {
+	for (unsigned int i = 0; i < registry->libraryCount; i++) {
+		vkPipelineLibraryEntry* entry = &registry->libraries[i];
+		if (entry->hash != hash) continue;
+
+		entry->references++;
+		return entry->library;
+	}
+
+	if (registry->libraryCount == registry->libraryCapacity) {
+		unsigned int capacity = registry->libraryCapacity ? registry->libraryCapacity * 2 : 32;
+		vkPipelineLibraryEntry* entries = (vkPipelineLibraryEntry*)crenmemory_reallocate(registry->libraries, sizeof(vkPipelineLibraryEntry) * capacity);
+		if (entries == NULL) return VK_NULL_HANDLE;
+		registry->libraries = entries;
+		registry->libraryCapacity = capacity;
+	}
+
+	// viewport and scissor are part of the pre-rasterization state
+	const VkDynamicState dynamicStates[2] = { VK_DYNAMIC_STATE_VIEWPORT, VK_DYNAMIC_STATE_SCISSOR };
+	VkPipelineDynamicStateCreateInfo dynamicState = { 0 };
+	dynamicState.sType = VK_STRUCTURE_TYPE_PIPELINE_DYNAMIC_STATE_CREATE_INFO;
+	dynamicState.dynamicStateCount = 2;
+	dynamicState.pDynamicStates = dynamicStates;
+
+	VkPipelineRenderingCreateInfoKHR renderingCI;
+	VkGraphicsPipelineLibraryCreateInfoEXT libraryCI = { 0 };
+	libraryCI.sType = VK_STRUCTURE_TYPE_GRAPHICS_PIPELINE_LIBRARY_CREATE_INFO_EXT;
+	libraryCI.pNext = internal_crenvk_pipeline_rendering_info(pipeline->renderpass, &renderingCI);
+
+	VkGraphicsPipelineCreateInfo ci = { 0 };
+	ci.sType = VK_STRUCTURE_TYPE_GRAPHICS_PIPELINE_CREATE_INFO;
+	ci.pNext = &libraryCI;
+	ci.flags = VK_PIPELINE_CREATE_LIBRARY_BIT_KHR;
+
+	switch (part) {
+		case PipelineLibrary_VertexInput:
+		{
+			libraryCI.flags = VK_GRAPHICS_PIPELINE_LIBRARY_VERTEX_INPUT_INTERFACE_BIT_EXT;
+			ci.pVertexInputState = &pipeline->vertexInputState;
+			ci.pInputAssemblyState = &pipeline->inputVertexAssemblyState;
+			break;
+		}
+
+		case PipelineLibrary_PreRasterization:
+		{
+			libraryCI.flags = VK_GRAPHICS_PIPELINE_LIBRARY_PRE_RASTERIZATION_SHADERS_BIT_EXT;
+			ci.stageCount = 1;
+			ci.pStages = &pipeline->shaderStages[0];
+			ci.pViewportState = &pipeline->viewportState;
+			ci.pRasterizationState = &pipeline->rasterizationState;
+			ci.pDynamicState = &dynamicState;
+			ci.layout = pipeline->layout;
+			ci.renderPass = pipeline->renderpass->renderPass;
+			break;
+		}
+
+		case PipelineLibrary_FragmentShader:
+		{
+			libraryCI.flags = VK_GRAPHICS_PIPELINE_LIBRARY_FRAGMENT_SHADER_BIT_EXT;
+			ci.stageCount = 1;
+			ci.pStages = &pipeline->shaderStages[1];
+			ci.pDepthStencilState = &pipeline->depthStencilState;
+			ci.pMultisampleState = &pipeline->multisampleState;
+			ci.layout = pipeline->layout;
+			ci.renderPass = pipeline->renderpass->renderPass;
+			break;
+		}
+
+		case PipelineLibrary_FragmentOutput:
+		{
+			libraryCI.flags = VK_GRAPHICS_PIPELINE_LIBRARY_FRAGMENT_OUTPUT_INTERFACE_BIT_EXT;
+			ci.pColorBlendState = &pipeline->colorBlendState;
+			ci.pMultisampleState = &pipeline->multisampleState;
+			ci.renderPass = pipeline->renderpass->renderPass;
+			break;
+		}
+	}
+
+	VkPipeline library = VK_NULL_HANDLE;
+	if (vkCreateGraphicsPipelines(device, pipeline->cache, 1, &ci, NULL, &library) != VK_SUCCESS) return VK_NULL_HANDLE;
+
+	vkPipelineLibraryEntry* entry = &registry->libraries[registry->libraryCount++];
+	entry->hash = hash;
+	entry->library = library;
+	entry->references = 1;
+	return library;
+}
+
+/// @brief builds a pipeline by fast-linking a library per part, without link time optimization
+/// @param registry the pipeline registry
+/// @param device vulkan device
+/// @param pipeline cren vulkan pipeline, created but not built
+/// @param parts the pipeline part hashes
+/// @return 1 on success, 0 if it must be built monolithic instead
+static int internal_crenvk_pipeline_link(vkPipelineRegistry* registry, VkDevice device, vkPipeline* pipeline, const unsigned long long parts[CREN_PIPELINE_LIBRARY_PARTS]) {
+	VkPipeline libraries[CREN_PIPELINE_LIBRARY_PARTS] = { 0 };
+	int success = 1;
+
+	for (unsigned int i = 0; i < CREN_PIPELINE_LIBRARY_PARTS && success; i++) {
+		libraries[i] = internal_crenvk_pipeline_library_acquire(registry, device, pipeline, (vkPipelineLibraryPart)i, parts[i]);
+		success = libraries[i] != VK_NULL_HANDLE;
+	}
+
+	if (success) {
+		VkPipelineLibraryCreateInfoKHR linkCI = { 0 };
+		linkCI.sType = VK_STRUCTURE_TYPE_PIPELINE_LIBRARY_CREATE_INFO_KHR;
+		linkCI.libraryCount = CREN_PIPELINE_LIBRARY_PARTS;
+		linkCI.pLibraries = libraries;
+
+		VkGraphicsPipelineCreateInfo ci = { 0 };
+		ci.sType = VK_STRUCTURE_TYPE_GRAPHICS_PIPELINE_CREATE_INFO;
+		ci.pNext = &linkCI;
+		ci.layout = pipeline->layout;
+		success = vkCreateGraphicsPipelines(device, pipeline->cache, 1, &ci, NULL, &pipeline->pipeline) == VK_SUCCESS;
+	}
+
+	if (!success) {
+		CREN_LOG("CRen: Failed to link a pipeline from libraries, building it whole");
+		for (unsigned int i = 0; i < CREN_PIPELINE_LIBRARY_PARTS; i++) internal_crenvk_pipeline_library_release(registry, device, libraries[i]);
+		pipeline->pipeline = VK_NULL_HANDLE;
+		return 0;
+	}
+
+	for (unsigned int i = 0; i < CREN_PIPELINE_LIBRARY_PARTS; i++) pipeline->libraries[i] = libraries[i];
+	registry->linked++;
+	return 1;
+}
+
+/// @brief interns a pipeline, see crenvk_pipeline_intern
+/// @param registry the pipeline registry
+/// @param device vulkan device
+/// @param pipeline a created but not built pipeline
+/// @return the shared pipeline, NULL if the registry couldn't grow
+static vkPipeline* internal_crenvk_pipeline_registry_intern(vkPipelineRegistry* registry, VkDevice device, vkPipeline* pipeline) {
+	if (pipeline == NULL) return NULL;
+
+	unsigned long long parts[CREN_PIPELINE_LIBRARY_PARTS];
+	internal_crenvk_pipeline_hash_parts(pipeline, parts);
+	unsigned long long hash = internal_crenvk_hash(CREN_HASH_SEED, parts, sizeof(parts));
+
+	for (unsigned int i = 0; i < registry->pipelineCount; i++) {
+		vkPipelineRegistryEntry* entry = &registry->pipelines[i];
+		if (entry->hash != hash) continue;
+
+		entry->references++;
+		registry->hits++;
+		crenvk_pipeline_destroy(device, pipeline);
+		return entry->pipeline;
+	}
+
+	if (registry->pipelineCount == registry->pipelineCapacity) {
+		unsigned int capacity = registry->pipelineCapacity ? registry->pipelineCapacity * 2 : 16;
+		vkPipelineRegistryEntry* entries = (vkPipelineRegistryEntry*)crenmemory_reallocate(registry->pipelines, sizeof(vkPipelineRegistryEntry) * capacity);
+		if (entries == NULL) {
+			cren_set_error(MemoryAllocationFailed);
+			crenvk_pipeline_destroy(device, pipeline);
+			return NULL;
+		}
+		registry->pipelines = entries;
+		registry->pipelineCapacity = capacity;
+	}
+
+	if (registry->layoutCount == registry->layoutCapacity) {
+		unsigned int capacity = registry->layoutCapacity ? registry->layoutCapacity * 2 : 16;
+		vkPipelineLayoutEntry* entries = (vkPipelineLayoutEntry*)crenmemory_reallocate(registry->layouts, sizeof(vkPipelineLayoutEntry) * capacity);
+		if (entries == NULL) {
+			cren_set_error(MemoryAllocationFailed);
+			crenvk_pipeline_destroy(device, pipeline);
+			return NULL;
+		}
+		registry->layouts = entries;
+		registry->layoutCapacity = capacity;
+	}
+
+	// pipelines with the same bindings and push constants share the layouts, the ones the pipeline was created with are dropped
+	vkPipelineLayoutEntry* layout = NULL;
+	for (unsigned int i = 0; i < registry->layoutCount; i++) {
+		if (registry->layouts[i].hash == pipeline->layoutHash) {
+			layout = &registry->layouts[i];
+			break;
+		}
+	}
+
+	if (layout != NULL) {
+		vkDestroyPipelineLayout(device, pipeline->layout, NULL);
+		vkDestroyDescriptorSetLayout(device, pipeline->descriptorSetLayout, NULL);
+		pipeline->layout = layout->layout;
+		pipeline->descriptorSetLayout = layout->descriptorSetLayout;
+		layout->references++;
+	}
+
+	else {
+		layout = &registry->layouts[registry->layoutCount++];
+		layout->hash = pipeline->layoutHash;
+		layout->layout = pipeline->layout;
+		layout->descriptorSetLayout = pipeline->descriptorSetLayout;
+		layout->references = 1;
+	}
+
+	if (!registry->linking || !internal_crenvk_pipeline_link(registry, device, pipeline, parts)) crenvk_pipeline_build(device, pipeline);
+	pipeline->interned = 1;
+	registry->misses++;
+
+	vkPipelineRegistryEntry* entry = &registry->pipelines[registry->pipelineCount++];
+	entry->hash = hash;
+	entry->pipeline = pipeline;
+	entry->references = 1;
+	return pipeline;
+}
+
+/// @brief drops a reference to an interned pipeline
+/// @param registry the pipeline registry
+/// @param device vulkan device
+/// @param pipeline cren vulkan pipeline, pipelines that weren't interned are always released
+/// @return 1 if nobody references the pipeline anymore and it must be destroyed, 0 otherwise. Layouts still shared are detached from the pipeline so destroying it keeps them
+static int internal_crenvk_pipeline_registry_remove(vkPipelineRegistry* registry, VkDevice device, vkPipeline* pipeline) {
+	if (pipeline == NULL) return 0;
+	if (!pipeline->interned) return 1;
+
+	for (unsigned int i = 0; i < registry->pipelineCount; i++) {
+		vkPipelineRegistryEntry* entry = &registry->pipelines[i];
+		if (entry->pipeline != pipeline) continue;
+
+		if (--entry->references > 0) return 0;
+		registry->pipelines[i] = registry->pipelines[--registry->pipelineCount];
+		break;
+	}
+
+	for (unsigned int i = 0; i < registry->layoutCount; i++) {
+		vkPipelineLayoutEntry* layout = &registry->layouts[i];
+		if (layout->layout != pipeline->layout) continue;
+
+		if (--layout->references > 0) {
+			pipeline->layout = VK_NULL_HANDLE;
+			pipeline->descriptorSetLayout = VK_NULL_HANDLE;
+		}
+
+		else {
+			registry->layouts[i] = registry->layouts[--registry->layoutCount];
+		}
+		break;
+	}
+
+	for (unsigned int i = 0; i < CREN_PIPELINE_LIBRARY_PARTS; i++) {
+		internal_crenvk_pipeline_library_release(registry, device, pipeline->libraries[i]);
+		pipeline->libraries[i] = VK_NULL_HANDLE;
+	}
+
+	pipeline->interned = 0;
+	return 1;
+}
+
+/// @brief destroys every pipeline still interned and the registry itself
+/// @param registry the pipeline registry
+/// @param device vulkan device
+static void internal_crenvk_pipeline_registry_destroy(vkPipelineRegistry* registry, VkDevice device) {
+	if (registry->pipelineCount > 0) {
+		CREN_LOG("CRen: %u interned pipelines were never released", registry->pipelineCount);
+	}
+
+	while (registry->pipelineCount > 0) {
+		vkPipeline* pipeline = registry->pipelines[0].pipeline;
+		registry->pipelines[0].references = 1;
+		if (internal_crenvk_pipeline_registry_remove(registry, device, pipeline)) crenvk_pipeline_destroy(device, pipeline);
+	}
+
+	if (registry->pipelines) crenmemory_deallocate(registry->pipelines);
+	if (registry->layouts) crenmemory_deallocate(registry->layouts);
+	if (registry->libraries) crenmemory_deallocate(registry->libraries);
+	crenmemory_zero(registry, sizeof(vkPipelineRegistry));
+}
+
 /// @brief creates an array of VkVertexInputBindingDescription based on parameters
 /// @param passingVertexData flags if vertex data is passed to the shader stages
 /// @param bindingCount output binding count
@@ -883,27 +1560,26 @@ static VkPipelineVertexInputStateCreateInfo internal_crenvk_pipeline_populate_vi
 	return visci;
 }
 
-/// @brief setup the quad pipeline, used by all quads across the renderer
+/// @brief setup the quad picking pipeline, only created once the picking phase exists
 /// @param pipelines pipeline's hashtable
-/// @param device vulkan device
-/// @param usedRenderpass cren vulkan renderpass in context, may be default or viewport
+/// @param registry the pipeline registry
 /// @param pickingRenderpass cren vulkan picking renderpass
-static void internal_crenvk_pipeline_quad_create(Hashtable* pipelines, vkRenderpass* usedRenderpass, vkRenderpass* pickingRenderpass, VkDevice device,  const char* rootPath) {
-	
-    // default pipeline
-	vkPipeline* defaultPipeline = (vkPipeline*)crenhashtable_lookup(pipelines, CREN_PIPELINE_QUAD_DEFAULT_NAME);
-	if (defaultPipeline != NULL) crenvk_pipeline_destroy(device, defaultPipeline);
+/// @param device vulkan device
+/// @param rootPath assets root path
+static void internal_crenvk_pipeline_quad_picking_create(Hashtable* pipelines, vkPipelineRegistry* registry, vkRenderpass* pickingRenderpass, VkDevice device, const char* rootPath) {
+	// the previous pipeline is released after interning the new one, so an identical pipeline isn't built again
+	vkPipeline* previousPipeline = (vkPipeline*)crenhashtable_lookup(pipelines, CREN_PIPELINE_QUAD_PICKING_NAME);
 
-	char defaultVert[CREN_PATH_MAX_SIZE], defaultFrag[CREN_PATH_MAX_SIZE];
-	cren_get_path("shader/compiled/quad.vert.spv", rootPath, 0, defaultVert, sizeof(defaultVert));
-	cren_get_path("shader/compiled/quad.frag.spv", rootPath, 0, defaultFrag, sizeof(defaultFrag));
+	char pickingVert[CREN_PATH_MAX_SIZE], pickingFrag[CREN_PATH_MAX_SIZE];
+	cren_get_path("shader/compiled/quad_picking.vert.spv", rootPath, 0, pickingVert, sizeof(pickingVert));
+	cren_get_path("shader/compiled/quad_picking.frag.spv", rootPath, 0, pickingFrag, sizeof(pickingFrag));
 
 	vkPipelineCreateInfo ci = { 0 };
-	ci.renderpass = usedRenderpass; // this will either be default or viewport renderpass
-	ci.vertexShader = crenvk_shader_create(device, "quad.vert", defaultVert, SHADER_TYPE_VERTEX);
-	ci.fragmentShader = crenvk_shader_create(device, "quad.frag", defaultFrag, SHADER_TYPE_FRAGMENT);
+	ci.renderpass = pickingRenderpass;
+	ci.vertexShader = crenvk_shader_create(device, "quad.vert", pickingVert, SHADER_TYPE_VERTEX);
+	ci.fragmentShader = crenvk_shader_create(device, "quad.frag", pickingFrag, SHADER_TYPE_FRAGMENT);
 	ci.passingVertexData = 0;
-	ci.alphaBlending = 1;
+	ci.alphaBlending = 0;
 
 	// push constant
 	ci.pushConstantsCount = 1;
@@ -919,9 +1595,9 @@ static void internal_crenvk_pipeline_quad_create(Hashtable* pipelines, vkRenderp
 	ci.bindings[0].descriptorCount = 1;
 	ci.bindings[0].stageFlags = VK_SHADER_STAGE_VERTEX_BIT | VK_SHADER_STAGE_FRAGMENT_BIT;
 	ci.bindings[0].pImmutableSamplers = NULL;
-	// quad data
+	// quad params, indexed by the draw instance
 	ci.bindings[1].binding = 1;
-	ci.bindings[1].descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
+	ci.bindings[1].descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
 	ci.bindings[1].descriptorCount = 1;
 	ci.bindings[1].stageFlags = VK_SHADER_STAGE_VERTEX_BIT | VK_SHADER_STAGE_FRAGMENT_BIT;
 	ci.bindings[1].pImmutableSamplers = NULL;
@@ -932,25 +1608,135 @@ static void internal_crenvk_pipeline_quad_create(Hashtable* pipelines, vkRenderp
 	ci.bindings[2].stageFlags = VK_SHADER_STAGE_FRAGMENT_BIT;
 	ci.bindings[2].pImmutableSamplers = NULL;
 
-	defaultPipeline = crenvk_pipeline_create(device, &ci);
-	defaultPipeline->rasterizationState.cullMode = VK_CULL_MODE_NONE;
-	crenvk_pipeline_build(device, defaultPipeline);
-	crenhashtable_insert(pipelines, CREN_PIPELINE_QUAD_DEFAULT_NAME, defaultPipeline);
+	vkPipeline* pickingPipeline = crenvk_pipeline_create(device, &ci);
+	pickingPipeline->rasterizationState.cullMode = VK_CULL_MODE_NONE;
+	pickingPipeline = internal_crenvk_pipeline_registry_intern(registry, device, pickingPipeline);
+	if (internal_crenvk_pipeline_registry_remove(registry, device, previousPipeline)) crenvk_pipeline_destroy(device, previousPipeline);
+	crenhashtable_insert(pipelines, CREN_PIPELINE_QUAD_PICKING_NAME, pickingPipeline);
+}
 
-	// picking pipeline
-	vkPipeline* pickingPipeline = (vkPipeline*)crenhashtable_lookup(pipelines, CREN_PIPELINE_QUAD_PICKING_NAME);
-	if (pickingPipeline != NULL) crenvk_pipeline_destroy(device, pickingPipeline);
+/// @brief releases the quad depth prepass pipelines and removes them from the hashtable
+/// @param pipelines pipeline's hashtable
+/// @param registry the pipeline registry
+/// @param device vulkan device
+static void internal_crenvk_pipeline_quad_prepass_remove(Hashtable* pipelines, vkPipelineRegistry* registry, VkDevice device) {
+	const char* names[2] = { CREN_PIPELINE_QUAD_DEPTH_NAME, CREN_PIPELINE_QUAD_EQUAL_NAME };
 
-	char pickingVert[CREN_PATH_MAX_SIZE], pickingFrag[CREN_PATH_MAX_SIZE];
-	cren_get_path("shader/compiled/quad_picking.vert.spv", rootPath, 0, pickingVert, sizeof(pickingVert));
-	cren_get_path("shader/compiled/quad_picking.frag.spv", rootPath, 0, pickingFrag, sizeof(pickingFrag));
+	for (unsigned int i = 0; i < 2; i++) {
+		vkPipeline* pipeline = (vkPipeline*)crenhashtable_lookup(pipelines, names[i]);
+		if (pipeline == NULL) continue;
 
-	ci = (vkPipelineCreateInfo) { 0 };
-	ci.renderpass = pickingRenderpass;
-	ci.vertexShader = crenvk_shader_create(device, "quad.vert", pickingVert, SHADER_TYPE_VERTEX);
-	ci.fragmentShader = crenvk_shader_create(device, "quad.frag", pickingFrag, SHADER_TYPE_FRAGMENT);
+		if (internal_crenvk_pipeline_registry_remove(registry, device, pipeline)) crenvk_pipeline_destroy(device, pipeline);
+		crenhashtable_delete(pipelines, names[i]);
+	}
+}
+
+/// @brief setup the quad depth prepass pipelines, only created once the prepass is enabled
+/// the depth pipeline alpha-tests the colormap and writes depth only, the equal pipeline shades what's left without discarding and blends like the default pipeline
+/// @param pipelines pipeline's hashtable
+/// @param registry the pipeline registry
+/// @param usedRenderpass cren vulkan renderpass in context, may be default or viewport
+/// @param device vulkan device
+/// @param rootPath assets root path
+/// @return 1 on success, 0 if a shader couldn't be loaded. Both pipelines are removed on failure
+static int internal_crenvk_pipeline_quad_prepass_create(Hashtable* pipelines, vkPipelineRegistry* registry, vkRenderpass* usedRenderpass, VkDevice device, const char* rootPath) {
+	const char* names[2] = { CREN_PIPELINE_QUAD_DEPTH_NAME, CREN_PIPELINE_QUAD_EQUAL_NAME };
+	const char* fragPaths[2] = { "shader/compiled/quad_depth.frag.spv", "shader/compiled/quad_equal.frag.spv" };
+
+	char vert[CREN_PATH_MAX_SIZE];
+	cren_get_path("shader/compiled/quad.vert.spv", rootPath, 0, vert, sizeof(vert));
+
+	for (unsigned int i = 0; i < 2; i++) {
+		// the previous pipeline is released after interning the new one, so an identical pipeline isn't built again
+		vkPipeline* previousPipeline = (vkPipeline*)crenhashtable_lookup(pipelines, names[i]);
+
+		char frag[CREN_PATH_MAX_SIZE];
+		cren_get_path(fragPaths[i], rootPath, 0, frag, sizeof(frag));
+
+		// both pipelines run the same vertex shader, so the equal depth test sees the exact depth the prepass wrote
+		vkPipelineCreateInfo ci = { 0 };
+		ci.renderpass = usedRenderpass;
+		ci.vertexShader = crenvk_shader_create(device, "quad.vert", vert, SHADER_TYPE_VERTEX);
+		ci.fragmentShader = crenvk_shader_create(device, i == 0 ? "quad_depth.frag" : "quad_equal.frag", frag, SHADER_TYPE_FRAGMENT);
+		ci.passingVertexData = 0;
+		ci.alphaBlending = i == 1; // semi-transparent pixels that passed the equal test still blend over what's behind them
+
+		if (ci.vertexShader.shaderStageCI.module == VK_NULL_HANDLE || ci.fragmentShader.shaderStageCI.module == VK_NULL_HANDLE) {
+			CREN_LOG("CRen: Failed to load the %s shaders", names[i]);
+			if (ci.vertexShader.shaderStageCI.module != VK_NULL_HANDLE) vkDestroyShaderModule(device, ci.vertexShader.shaderStageCI.module, NULL);
+			if (ci.fragmentShader.shaderStageCI.module != VK_NULL_HANDLE) vkDestroyShaderModule(device, ci.fragmentShader.shaderStageCI.module, NULL);
+			internal_crenvk_pipeline_quad_prepass_remove(pipelines, registry, device);
+			return 0;
+		}
+
+		// push constant
+		ci.pushConstantsCount = 1;
+		ci.pushConstants[0].offset = 0;
+		ci.pushConstants[0].size = sizeof(vkPushConstant);
+		ci.pushConstants[0].stageFlags = VK_SHADER_STAGE_VERTEX_BIT | VK_SHADER_STAGE_FRAGMENT_BIT;
+
+		// bindings, same as the default pipeline so the quads descriptor sets are shared
+		ci.bindingsCount = 3;
+		// camera data
+		ci.bindings[0].binding = 0;
+		ci.bindings[0].descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
+		ci.bindings[0].descriptorCount = 1;
+		ci.bindings[0].stageFlags = VK_SHADER_STAGE_VERTEX_BIT | VK_SHADER_STAGE_FRAGMENT_BIT;
+		ci.bindings[0].pImmutableSamplers = NULL;
+		// quad params, indexed by the draw instance
+		ci.bindings[1].binding = 1;
+		ci.bindings[1].descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+		ci.bindings[1].descriptorCount = 1;
+		ci.bindings[1].stageFlags = VK_SHADER_STAGE_VERTEX_BIT | VK_SHADER_STAGE_FRAGMENT_BIT;
+		ci.bindings[1].pImmutableSamplers = NULL;
+		// colormap
+		ci.bindings[2].binding = 2;
+		ci.bindings[2].descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+		ci.bindings[2].descriptorCount = 1;
+		ci.bindings[2].stageFlags = VK_SHADER_STAGE_FRAGMENT_BIT;
+		ci.bindings[2].pImmutableSamplers = NULL;
+
+		vkPipeline* pipeline = crenvk_pipeline_create(device, &ci);
+		pipeline->rasterizationState.cullMode = VK_CULL_MODE_NONE;
+
+		if (i == 0) {
+			pipeline->colorBlendAttachmentState.colorWriteMask = 0;
+		}
+
+		else {
+			pipeline->depthStencilState.depthWriteEnable = VK_FALSE;
+			pipeline->depthStencilState.depthCompareOp = VK_COMPARE_OP_EQUAL;
+		}
+
+		pipeline = internal_crenvk_pipeline_registry_intern(registry, device, pipeline);
+		if (internal_crenvk_pipeline_registry_remove(registry, device, previousPipeline)) crenvk_pipeline_destroy(device, previousPipeline);
+		crenhashtable_insert(pipelines, names[i], pipeline);
+	}
+
+	return 1;
+}
+
+/// @brief setup the quad pipeline, used by all quads across the renderer
+/// @param pipelines pipeline's hashtable
+/// @param registry the pipeline registry
+/// @param device vulkan device
+/// @param usedRenderpass cren vulkan renderpass in context, may be default or viewport
+/// @param pickingRenderpass cren vulkan picking renderpass, NULL while the picking phase wasn't created (the picking pipeline is skipped)
+static void internal_crenvk_pipeline_quad_create(Hashtable* pipelines, vkPipelineRegistry* registry, vkRenderpass* usedRenderpass, vkRenderpass* pickingRenderpass, VkDevice device,  const char* rootPath) {
+	
+    // default pipeline
+	vkPipeline* previousPipeline = (vkPipeline*)crenhashtable_lookup(pipelines, CREN_PIPELINE_QUAD_DEFAULT_NAME);
+
+	char defaultVert[CREN_PATH_MAX_SIZE], defaultFrag[CREN_PATH_MAX_SIZE];
+	cren_get_path("shader/compiled/quad.vert.spv", rootPath, 0, defaultVert, sizeof(defaultVert));
+	cren_get_path("shader/compiled/quad.frag.spv", rootPath, 0, defaultFrag, sizeof(defaultFrag));
+
+	vkPipelineCreateInfo ci = { 0 };
+	ci.renderpass = usedRenderpass; // this will either be default or viewport renderpass
+	ci.vertexShader = crenvk_shader_create(device, "quad.vert", defaultVert, SHADER_TYPE_VERTEX);
+	ci.fragmentShader = crenvk_shader_create(device, "quad.frag", defaultFrag, SHADER_TYPE_FRAGMENT);
 	ci.passingVertexData = 0;
-	ci.alphaBlending = 0;
+	ci.alphaBlending = 1;
 
 	// push constant
 	ci.pushConstantsCount = 1;
@@ -966,9 +1752,9 @@ static void internal_crenvk_pipeline_quad_create(Hashtable* pipelines, vkRenderp
 	ci.bindings[0].descriptorCount = 1;
 	ci.bindings[0].stageFlags = VK_SHADER_STAGE_VERTEX_BIT | VK_SHADER_STAGE_FRAGMENT_BIT;
 	ci.bindings[0].pImmutableSamplers = NULL;
-	// quad data
+	// quad params, indexed by the draw instance
 	ci.bindings[1].binding = 1;
-	ci.bindings[1].descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
+	ci.bindings[1].descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
 	ci.bindings[1].descriptorCount = 1;
 	ci.bindings[1].stageFlags = VK_SHADER_STAGE_VERTEX_BIT | VK_SHADER_STAGE_FRAGMENT_BIT;
 	ci.bindings[1].pImmutableSamplers = NULL;
@@ -979,22 +1765,144 @@ static void internal_crenvk_pipeline_quad_create(Hashtable* pipelines, vkRenderp
 	ci.bindings[2].stageFlags = VK_SHADER_STAGE_FRAGMENT_BIT;
 	ci.bindings[2].pImmutableSamplers = NULL;
 
-	pickingPipeline = crenvk_pipeline_create(device, &ci);
-	pickingPipeline->rasterizationState.cullMode = VK_CULL_MODE_NONE;
-	crenvk_pipeline_build(device, pickingPipeline);
-	crenhashtable_insert(pipelines, CREN_PIPELINE_QUAD_PICKING_NAME, pickingPipeline);
-}
+	vkPipeline* defaultPipeline = crenvk_pipeline_create(device, &ci);
+	defaultPipeline->rasterizationState.cullMode = VK_CULL_MODE_NONE;
+	defaultPipeline = internal_crenvk_pipeline_registry_intern(registry, device, defaultPipeline);
+	if (internal_crenvk_pipeline_registry_remove(registry, device, previousPipeline)) crenvk_pipeline_destroy(device, previousPipeline);
+	crenhashtable_insert(pipelines, CREN_PIPELINE_QUAD_DEFAULT_NAME, defaultPipeline);
 
-vkPipeline* crenvk_pipeline_create(VkDevice device, vkPipelineCreateInfo *ci) {
-    vkPipeline* pipeline = (vkPipeline*)crenmemory_allocate(sizeof(vkPipeline), 1);
-    if(!pipeline) return NULL;
+	if (pickingRenderpass != NULL) internal_crenvk_pipeline_quad_picking_create(pipelines, registry, pickingRenderpass, device, rootPath);
+}
 
-	pipeline->passingVertexData = ci->passingVertexData;
+/// @brief setup the particle pipelines, the simulation is only created once and the default pipeline is re-created with the renderpass it draws on
+/// @param pipelines pipeline's hashtable
+/// @param registry the pipeline registry
+/// @param usedRenderpass cren vulkan renderpass in context, may be default or viewport
+/// @param device vulkan device
+/// @param rootPath assets root path
+/// @return 1 on success, 0 if the particle shaders couldn't be loaded
+static int internal_crenvk_pipeline_particle_create(Hashtable* pipelines, vkPipelineRegistry* registry, vkRenderpass* usedRenderpass, VkDevice device, const char* rootPath) {
+
+	// simulation pipeline
+	if (crenhashtable_lookup(pipelines, CREN_PIPELINE_PARTICLE_SIMULATE_NAME) == NULL) {
+		char simulateComp[CREN_PATH_MAX_SIZE];
+		cren_get_path("shader/compiled/particle.comp.spv", rootPath, 0, simulateComp, sizeof(simulateComp));
+
+		vkComputePipelineCreateInfo computeCI = { 0 };
+		computeCI.computeShader = crenvk_shader_create(device, "particle.comp", simulateComp, SHADER_TYPE_COMPUTE);
+		if (computeCI.computeShader.shaderStageCI.module == VK_NULL_HANDLE) return 0;
+
+		computeCI.pushConstantsCount = 1;
+		computeCI.pushConstants[0].offset = 0;
+		computeCI.pushConstants[0].size = sizeof(vkParticleSimulatePushConstant);
+		computeCI.pushConstants[0].stageFlags = VK_SHADER_STAGE_COMPUTE_BIT;
+
+		// 0: particles read, 1: particles written, 2: draw commands
+		computeCI.bindingsCount = 3;
+		for (unsigned int i = 0; i < computeCI.bindingsCount; i++) {
+			computeCI.bindings[i].binding = i;
+			computeCI.bindings[i].descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+			computeCI.bindings[i].descriptorCount = 1;
+			computeCI.bindings[i].stageFlags = VK_SHADER_STAGE_COMPUTE_BIT;
+			computeCI.bindings[i].pImmutableSamplers = NULL;
+		}
+
+		vkComputePipeline* simulatePipeline = crenvk_compute_pipeline_create(device, &computeCI);
+		if (simulatePipeline == NULL) return 0;
+		crenhashtable_insert(pipelines, CREN_PIPELINE_PARTICLE_SIMULATE_NAME, simulatePipeline);
+	}
+
+	// default pipeline
+	vkPipeline* previousPipeline = (vkPipeline*)crenhashtable_lookup(pipelines, CREN_PIPELINE_PARTICLE_DEFAULT_NAME);
+
+	char defaultVert[CREN_PATH_MAX_SIZE], defaultFrag[CREN_PATH_MAX_SIZE];
+	cren_get_path("shader/compiled/particle.vert.spv", rootPath, 0, defaultVert, sizeof(defaultVert));
+	cren_get_path("shader/compiled/particle.frag.spv", rootPath, 0, defaultFrag, sizeof(defaultFrag));
+
+	vkPipelineCreateInfo ci = { 0 };
+	ci.renderpass = usedRenderpass; // this will either be default or viewport renderpass
+	ci.vertexShader = crenvk_shader_create(device, "particle.vert", defaultVert, SHADER_TYPE_VERTEX);
+	ci.fragmentShader = crenvk_shader_create(device, "particle.frag", defaultFrag, SHADER_TYPE_FRAGMENT);
+	ci.passingVertexData = 0;
+	ci.alphaBlending = 1;
+
+	if (ci.vertexShader.shaderStageCI.module == VK_NULL_HANDLE || ci.fragmentShader.shaderStageCI.module == VK_NULL_HANDLE) {
+		if (ci.vertexShader.shaderStageCI.module != VK_NULL_HANDLE) vkDestroyShaderModule(device, ci.vertexShader.shaderStageCI.module, NULL);
+		if (ci.fragmentShader.shaderStageCI.module != VK_NULL_HANDLE) vkDestroyShaderModule(device, ci.fragmentShader.shaderStageCI.module, NULL);
+		if (internal_crenvk_pipeline_registry_remove(registry, device, previousPipeline)) crenvk_pipeline_destroy(device, previousPipeline);
+		crenhashtable_delete(pipelines, CREN_PIPELINE_PARTICLE_DEFAULT_NAME);
+		return 0;
+	}
+
+	// push constant
+	ci.pushConstantsCount = 1;
+	ci.pushConstants[0].offset = 0;
+	ci.pushConstants[0].size = sizeof(vkParticleDrawPushConstant);
+	ci.pushConstants[0].stageFlags = VK_SHADER_STAGE_VERTEX_BIT;
+
+	// bindings
+	ci.bindingsCount = 4;
+	// camera data
+	ci.bindings[0].binding = 0;
+	ci.bindings[0].descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
+	ci.bindings[0].descriptorCount = 1;
+	ci.bindings[0].stageFlags = VK_SHADER_STAGE_VERTEX_BIT;
+	ci.bindings[0].pImmutableSamplers = NULL;
+	// first particle buffer
+	ci.bindings[1].binding = 1;
+	ci.bindings[1].descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+	ci.bindings[1].descriptorCount = 1;
+	ci.bindings[1].stageFlags = VK_SHADER_STAGE_VERTEX_BIT;
+	ci.bindings[1].pImmutableSamplers = NULL;
+	// colormap
+	ci.bindings[2].binding = 2;
+	ci.bindings[2].descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+	ci.bindings[2].descriptorCount = 1;
+	ci.bindings[2].stageFlags = VK_SHADER_STAGE_FRAGMENT_BIT;
+	ci.bindings[2].pImmutableSamplers = NULL;
+	// second particle buffer
+	ci.bindings[3].binding = 3;
+	ci.bindings[3].descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+	ci.bindings[3].descriptorCount = 1;
+	ci.bindings[3].stageFlags = VK_SHADER_STAGE_VERTEX_BIT;
+	ci.bindings[3].pImmutableSamplers = NULL;
+
+	vkPipeline* defaultPipeline = crenvk_pipeline_create(device, &ci);
+	defaultPipeline->rasterizationState.cullMode = VK_CULL_MODE_NONE;
+	defaultPipeline->depthStencilState.depthWriteEnable = VK_FALSE; // particles are blended over each other in no particular order
+	defaultPipeline = internal_crenvk_pipeline_registry_intern(registry, device, defaultPipeline);
+	if (internal_crenvk_pipeline_registry_remove(registry, device, previousPipeline)) crenvk_pipeline_destroy(device, previousPipeline);
+	crenhashtable_insert(pipelines, CREN_PIPELINE_PARTICLE_DEFAULT_NAME, defaultPipeline);
+	return 1;
+}
+
+vkPipeline* crenvk_pipeline_create(VkDevice device, vkPipelineCreateInfo *ci) {
+    vkPipeline* pipeline = (vkPipeline*)crenmemory_allocate(sizeof(vkPipeline), 1);
+    if(!pipeline) return NULL;
+
+	pipeline->passingVertexData = ci->passingVertexData;
+	pipeline->alphaBlending = ci->alphaBlending;
 	pipeline->cache = ci->pipelineCache;
 	pipeline->shaderStages[0] = ci->vertexShader.shaderStageCI;
 	pipeline->shaderStages[1] = ci->fragmentShader.shaderStageCI;
+	pipeline->shaderHashes[0] = ci->vertexShader.hash;
+	pipeline->shaderHashes[1] = ci->fragmentShader.hash;
 	pipeline->renderpass = ci->renderpass;
 
+	// immutable samplers are hashed by handle, the same layout would reference them
+	unsigned long long layoutHash = CREN_HASH_SEED;
+	for (unsigned int i = 0; i < ci->bindingsCount; i++) {
+		const VkDescriptorSetLayoutBinding* binding = &ci->bindings[i];
+		layoutHash = internal_crenvk_hash(layoutHash, &binding->binding, sizeof(binding->binding));
+		layoutHash = internal_crenvk_hash(layoutHash, &binding->descriptorType, sizeof(binding->descriptorType));
+		layoutHash = internal_crenvk_hash(layoutHash, &binding->descriptorCount, sizeof(binding->descriptorCount));
+		layoutHash = internal_crenvk_hash(layoutHash, &binding->stageFlags, sizeof(binding->stageFlags));
+		layoutHash = internal_crenvk_hash(layoutHash, &binding->pImmutableSamplers, sizeof(binding->pImmutableSamplers));
+	}
+	layoutHash = internal_crenvk_hash(layoutHash, &ci->bindingsCount, sizeof(ci->bindingsCount));
+	layoutHash = internal_crenvk_hash(layoutHash, ci->pushConstants, sizeof(VkPushConstantRange) * ci->pushConstantsCount);
+	pipeline->layoutHash = internal_crenvk_hash(layoutHash, &ci->pushConstantsCount, sizeof(ci->pushConstantsCount));
+
 	// descriptor set
 	VkDescriptorSetLayoutCreateInfo descSetLayoutCI = { 0 };
 	descSetLayoutCI.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO;
@@ -1095,8 +2003,6 @@ vkPipeline* crenvk_pipeline_create(VkDevice device, vkPipelineCreateInfo *ci) {
 }
 
 void crenvk_pipeline_destroy(VkDevice device, vkPipeline* pipeline) {
-	vkDeviceWaitIdle(device);
-
 	vkDestroyPipeline(device, pipeline->pipeline, NULL);
 	vkDestroyPipelineLayout(device, pipeline->layout, NULL);
 	vkDestroyDescriptorSetLayout(device, pipeline->descriptorSetLayout, NULL);
@@ -1111,6 +2017,17 @@ void crenvk_pipeline_destroy(VkDevice device, vkPipeline* pipeline) {
 	crenmemory_deallocate(pipeline);
 }
 
+/// @brief retirement queue adapter for pipelines
+/// @param device vulkan device
+/// @param object the cren vulkan pipeline
+static void internal_crenvk_pipeline_release(VkDevice device, void* object) {
+	crenvk_pipeline_destroy(device, (vkPipeline*)object);
+}
+
+void crenvk_pipeline_retire(CRenContext* context, vkPipeline* pipeline) {
+	crenvk_retire(context, internal_crenvk_pipeline_release, pipeline);
+}
+
 void crenvk_pipeline_build(VkDevice device, vkPipeline *pipeline) {
 	// dynamic state is here because dynamic states must be constant
 	VkPipelineDynamicStateCreateInfo dynamicState = { 0 };
@@ -1121,9 +2038,10 @@ void crenvk_pipeline_build(VkDevice device, vkPipeline *pipeline) {
 	dynamicState.dynamicStateCount = 2;
 	dynamicState.pDynamicStates = dynamicStates;
 
+	VkPipelineRenderingCreateInfoKHR renderingCI;
 	VkGraphicsPipelineCreateInfo ci = { 0 };
 	ci.sType = VK_STRUCTURE_TYPE_GRAPHICS_PIPELINE_CREATE_INFO;
-	ci.pNext = NULL;
+	ci.pNext = internal_crenvk_pipeline_rendering_info(pipeline->renderpass, &renderingCI);
 	ci.flags = 0;
 	ci.stageCount = CREN_PIPELINE_SHADER_STAGES_COUNT;
 	ci.pStages = pipeline->shaderStages;
@@ -1141,11 +2059,77 @@ void crenvk_pipeline_build(VkDevice device, vkPipeline *pipeline) {
 	CREN_ASSERT(vkCreateGraphicsPipelines(device, pipeline->cache, 1, &ci, NULL, &pipeline->pipeline) == VK_SUCCESS, "Failed to create vulkan graphics pipeline");
 }
 
+vkPipeline* crenvk_pipeline_intern(CRenContext* context, vkPipeline* pipeline) {
+	CRenVulkanBackend* renderer = (CRenVulkanBackend*)context->backend;
+	return internal_crenvk_pipeline_registry_intern(&renderer->pipelineRegistry, renderer->device.device, pipeline);
+}
+
+void crenvk_pipeline_release(CRenContext* context, vkPipeline* pipeline) {
+	CRenVulkanBackend* renderer = (CRenVulkanBackend*)context->backend;
+	if (internal_crenvk_pipeline_registry_remove(&renderer->pipelineRegistry, renderer->device.device, pipeline)) crenvk_pipeline_retire(context, pipeline);
+}
+
+vkComputePipeline* crenvk_compute_pipeline_create(VkDevice device, vkComputePipelineCreateInfo* ci) {
+	vkComputePipeline* pipeline = (vkComputePipeline*)crenmemory_allocate(sizeof(vkComputePipeline), 1);
+	if (!pipeline) return NULL;
+
+	pipeline->cache = ci->pipelineCache;
+	pipeline->shaderModule = ci->computeShader.shaderStageCI.module;
+
+	VkDescriptorSetLayoutCreateInfo descSetLayoutCI = { 0 };
+	descSetLayoutCI.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO;
+	descSetLayoutCI.bindingCount = ci->bindingsCount;
+	descSetLayoutCI.pBindings = ci->bindings;
+	VkResult res = vkCreateDescriptorSetLayout(device, &descSetLayoutCI, NULL, &pipeline->descriptorSetLayout);
+
+	VkPipelineLayoutCreateInfo pipelineLayoutCI = { 0 };
+	pipelineLayoutCI.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
+	pipelineLayoutCI.setLayoutCount = 1;
+	pipelineLayoutCI.pSetLayouts = &pipeline->descriptorSetLayout;
+	pipelineLayoutCI.pushConstantRangeCount = ci->pushConstantsCount;
+	pipelineLayoutCI.pPushConstantRanges = ci->pushConstants;
+	if (res == VK_SUCCESS) res = vkCreatePipelineLayout(device, &pipelineLayoutCI, NULL, &pipeline->layout);
+
+	VkComputePipelineCreateInfo pipelineCI = { 0 };
+	pipelineCI.sType = VK_STRUCTURE_TYPE_COMPUTE_PIPELINE_CREATE_INFO;
+	pipelineCI.stage = ci->computeShader.shaderStageCI;
+	pipelineCI.layout = pipeline->layout;
+	if (res == VK_SUCCESS) res = vkCreateComputePipelines(device, pipeline->cache, 1, &pipelineCI, NULL, &pipeline->pipeline);
+
+	if (res != VK_SUCCESS) {
+		CREN_LOG("CRen: Failed to create the compute pipeline %s", ci->computeShader.name ? ci->computeShader.name : "");
+		crenvk_compute_pipeline_destroy(device, pipeline);
+		return NULL;
+	}
+
+	return pipeline;
+}
+
+void crenvk_compute_pipeline_destroy(VkDevice device, vkComputePipeline* pipeline) {
+	if (!pipeline) return;
+
+	if (pipeline->pipeline != VK_NULL_HANDLE) vkDestroyPipeline(device, pipeline->pipeline, NULL);
+	if (pipeline->layout != VK_NULL_HANDLE) vkDestroyPipelineLayout(device, pipeline->layout, NULL);
+	if (pipeline->descriptorSetLayout != VK_NULL_HANDLE) vkDestroyDescriptorSetLayout(device, pipeline->descriptorSetLayout, NULL);
+	if (pipeline->shaderModule != VK_NULL_HANDLE) vkDestroyShaderModule(device, pipeline->shaderModule, NULL);
+
+	crenmemory_deallocate(pipeline);
+}
+
+/// @brief retirement queue adapter for compute pipelines
+/// @param device vulkan device
+/// @param object the cren vulkan compute pipeline
+static void internal_crenvk_compute_pipeline_release(VkDevice device, void* object) {
+	crenvk_compute_pipeline_destroy(device, (vkComputePipeline*)object);
+}
+
+void crenvk_compute_pipeline_retire(CRenContext* context, vkComputePipeline* pipeline) {
+	crenvk_retire(context, internal_crenvk_compute_pipeline_release, pipeline);
+}
+
 void crenvk_renderpass_destroy(VkDevice device, vkRenderpass* renderpass) {
     if(!device || !renderpass) return;
 
-    vkDeviceWaitIdle(device);
-
     if (renderpass->descriptorPool) vkDestroyDescriptorPool(device, renderpass->descriptorPool, NULL);
     if (renderpass->renderPass) vkDestroyRenderPass(device, renderpass->renderPass, NULL);
     if (renderpass->commandBuffers) vkFreeCommandBuffers(device, renderpass->commandPool, renderpass->commandBufferCount, renderpass->commandBuffers);
@@ -1161,6 +2145,124 @@ void crenvk_renderpass_destroy(VkDevice device, vkRenderpass* renderpass) {
     crenmemory_deallocate(renderpass);
 }
 
+/// @brief retirement queue adapter for renderpasses
+/// @param device vulkan device
+/// @param object the cren vulkan renderpass
+static void internal_crenvk_renderpass_release(VkDevice device, void* object) {
+    crenvk_renderpass_destroy(device, (vkRenderpass*)object);
+}
+
+void crenvk_renderpass_retire(CRenContext* context, vkRenderpass* renderpass) {
+    crenvk_retire(context, internal_crenvk_renderpass_release, renderpass);
+}
+
+/// @brief begins a renderpass into a target, with render pass objects the target framebuffer is used, with dynamic rendering the target images are transitioned and rendered into directly
+/// @param device cren vulkan device
+/// @param renderpass cren vulkan renderpass
+/// @param cmdBuffer command buffer being recorded
+/// @param target what is rendered into this frame
+/// @param clearValues color clear value followed by the depth one when the target has depth
+/// @param clearValueCount how many clear values there are
+static void internal_crenvk_renderpass_begin(vkDevice* device, const vkRenderpass* renderpass, VkCommandBuffer cmdBuffer, const vkRenderTarget* target, const VkClearValue* clearValues, unsigned int clearValueCount) {
+    if (!renderpass->dynamic) {
+        VkRenderPassBeginInfo renderPassBeginInfo = { 0 };
+        renderPassBeginInfo.sType = VK_STRUCTURE_TYPE_RENDER_PASS_BEGIN_INFO;
+        renderPassBeginInfo.renderPass = renderpass->renderPass;
+        renderPassBeginInfo.framebuffer = target->framebuffer;
+        renderPassBeginInfo.renderArea.offset = (VkOffset2D) { 0, 0 };
+        renderPassBeginInfo.renderArea.extent = target->extent;
+        renderPassBeginInfo.clearValueCount = clearValueCount;
+        renderPassBeginInfo.pClearValues = clearValues;
+        vkCmdBeginRenderPass(cmdBuffer, &renderPassBeginInfo, VK_SUBPASS_CONTENTS_INLINE);
+        return;
+    }
+
+    VkImageSubresourceRange colorRange = { 0 };
+    colorRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+    colorRange.levelCount = 1;
+    colorRange.layerCount = 1;
+
+    // what the images had is discarded unless the color is loaded, the previous frame may still be writing or sampling them
+    const VkPipelineStageFlags previousStages = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT | VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT | VK_PIPELINE_STAGE_TRANSFER_BIT;
+    const VkAccessFlags colorAccess = VK_ACCESS_COLOR_ATTACHMENT_READ_BIT | VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT;
+    VkImageLayout colorLayout = target->loadColor ? VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL : VK_IMAGE_LAYOUT_UNDEFINED;
+    crenvk_image_memory_barrier_insert(cmdBuffer, target->colorImage, VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT, colorAccess, colorLayout, VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL, previousStages, VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT, colorRange);
+
+    if (target->resolveImage != VK_NULL_HANDLE) {
+        crenvk_image_memory_barrier_insert(cmdBuffer, target->resolveImage, VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT, colorAccess, VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL, previousStages, VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT, colorRange);
+    }
+
+    if (target->depthImage != VK_NULL_HANDLE) {
+        // every depth format cren picks has stencil, layout transitions must include both aspects
+        VkImageSubresourceRange depthRange = colorRange;
+        depthRange.aspectMask = VK_IMAGE_ASPECT_DEPTH_BIT | VK_IMAGE_ASPECT_STENCIL_BIT;
+        const VkPipelineStageFlags depthStages = VK_PIPELINE_STAGE_EARLY_FRAGMENT_TESTS_BIT | VK_PIPELINE_STAGE_LATE_FRAGMENT_TESTS_BIT;
+        crenvk_image_memory_barrier_insert(cmdBuffer, target->depthImage, VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT, VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_READ_BIT | VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT, VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL, depthStages, depthStages, depthRange);
+    }
+
+    VkRenderingAttachmentInfoKHR colorAttachment = { 0 };
+    colorAttachment.sType = VK_STRUCTURE_TYPE_RENDERING_ATTACHMENT_INFO_KHR;
+    colorAttachment.imageView = target->colorView;
+    colorAttachment.imageLayout = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
+    colorAttachment.resolveMode = target->resolveView != VK_NULL_HANDLE ? VK_RESOLVE_MODE_AVERAGE_BIT : VK_RESOLVE_MODE_NONE;
+    colorAttachment.resolveImageView = target->resolveView;
+    colorAttachment.resolveImageLayout = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
+    colorAttachment.loadOp = target->loadColor || clearValueCount == 0 ? VK_ATTACHMENT_LOAD_OP_LOAD : VK_ATTACHMENT_LOAD_OP_CLEAR;
+    colorAttachment.storeOp = target->resolveView != VK_NULL_HANDLE ? VK_ATTACHMENT_STORE_OP_DONT_CARE : VK_ATTACHMENT_STORE_OP_STORE;
+    if (clearValueCount > 0) colorAttachment.clearValue = clearValues[0];
+
+    // depth is never read once the phase ends
+    VkRenderingAttachmentInfoKHR depthAttachment = { 0 };
+    depthAttachment.sType = VK_STRUCTURE_TYPE_RENDERING_ATTACHMENT_INFO_KHR;
+    depthAttachment.imageView = target->depthView;
+    depthAttachment.imageLayout = VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL;
+    depthAttachment.resolveMode = VK_RESOLVE_MODE_NONE;
+    depthAttachment.loadOp = VK_ATTACHMENT_LOAD_OP_CLEAR;
+    depthAttachment.storeOp = VK_ATTACHMENT_STORE_OP_DONT_CARE;
+    if (clearValueCount > 1) depthAttachment.clearValue = clearValues[1];
+
+    VkRenderingInfoKHR renderingInfo = { 0 };
+    renderingInfo.sType = VK_STRUCTURE_TYPE_RENDERING_INFO_KHR;
+    renderingInfo.renderArea.offset = (VkOffset2D) { 0, 0 };
+    renderingInfo.renderArea.extent = target->extent;
+    renderingInfo.layerCount = 1;
+    renderingInfo.colorAttachmentCount = 1;
+    renderingInfo.pColorAttachments = &colorAttachment;
+    renderingInfo.pDepthAttachment = target->depthView != VK_NULL_HANDLE ? &depthAttachment : NULL;
+    renderingInfo.pStencilAttachment = NULL;
+    device->cmdBeginRendering(cmdBuffer, &renderingInfo);
+}
+
+/// @brief ends a renderpass begun with internal_crenvk_renderpass_begin, with dynamic rendering the final image is left in the target's final layout like a render pass object would
+/// @param device cren vulkan device
+/// @param renderpass cren vulkan renderpass
+/// @param cmdBuffer command buffer being recorded
+/// @param target what was rendered into
+static void internal_crenvk_renderpass_end(vkDevice* device, const vkRenderpass* renderpass, VkCommandBuffer cmdBuffer, const vkRenderTarget* target) {
+    if (!renderpass->dynamic) {
+        vkCmdEndRenderPass(cmdBuffer);
+        return;
+    }
+
+    device->cmdEndRendering(cmdBuffer);
+    if (target->finalLayout == VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL) return;
+
+    VkImageSubresourceRange colorRange = { 0 };
+    colorRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+    colorRange.levelCount = 1;
+    colorRange.layerCount = 1;
+
+    VkImage image = target->resolveImage != VK_NULL_HANDLE ? target->resolveImage : target->colorImage;
+    if (target->finalLayout == VK_IMAGE_LAYOUT_PRESENT_SRC_KHR) {
+        crenvk_image_memory_barrier_insert(cmdBuffer, image, VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT, 0, VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL, VK_IMAGE_LAYOUT_PRESENT_SRC_KHR, VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, colorRange);
+    }
+
+    else {
+        const VkPipelineStageFlags readers = VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT | VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT | VK_PIPELINE_STAGE_TRANSFER_BIT;
+        crenvk_image_memory_barrier_insert(cmdBuffer, image, VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT, VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_TRANSFER_READ_BIT, VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL, target->finalLayout, VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT, readers, colorRange);
+    }
+}
+
 vkShader crenvk_shader_create(VkDevice device, const char *name, const char *path, vkShaderType type) {
     
     vkShader shader = { 0 };
@@ -1184,7 +2286,10 @@ vkShader crenvk_shader_create(VkDevice device, const char *name, const char *pat
 
     unsigned long long spirvSize = 0;
     unsigned int* spirvCode = cren_load_file(path, &spirvSize);
-    if (spirvCode == NULL) CREN_LOG("SPIR-V code is NULL, therefore could not load file");
+    if (spirvCode == NULL) {
+        CREN_LOG("SPIR-V code is NULL, therefore could not load file");
+        return shader; // the stage has no module
+    }
 
     VkShaderModuleCreateInfo moduleCI = { 0 };
     moduleCI.sType = VK_STRUCTURE_TYPE_SHADER_MODULE_CREATE_INFO;
@@ -1193,6 +2298,7 @@ vkShader crenvk_shader_create(VkDevice device, const char *name, const char *pat
     moduleCI.codeSize = spirvSize;
     moduleCI.pCode = spirvCode;
     CREN_ASSERT(vkCreateShaderModule(device, &moduleCI, NULL, &shader.shaderStageCI.module) == VK_SUCCESS, "Failed to create shader module");
+    shader.hash = internal_crenvk_hash(CREN_HASH_SEED, spirvCode, (size_t)spirvSize);
     
     crenmemory_deallocate(spirvCode);
     return shader;
@@ -1214,6 +2320,399 @@ int crenvk_vertex_equals(vkVertex *v0, vkVertex *v1) {
            float4_equal(&v0->weights_0, &v1->weights_0) == 1;
 }
 
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Drawlist-related
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+/// @brief returns the pipeline slot used on the sort key, pipelines are numbered in the order they're first seen on the frame
+/// @param drawlist the frame's draw list
+/// @param pipeline the pipeline
+/// @return the pipeline slot
+static unsigned int internal_crenvk_drawlist_pipeline_slot(vkDrawlist* drawlist, vkPipeline* pipeline) {
+    for (unsigned int i = 0; i < drawlist->pipelineCount; i++) {
+        if (drawlist->pipelines[i] == pipeline) return i;
+    }
+
+    // too many pipelines on a single frame, the remaining ones share the last slot and are only grouped by descriptor
+    if (drawlist->pipelineCount == CREN_DRAWLIST_PIPELINES_MAX) return CREN_DRAWLIST_PIPELINES_MAX - 1;
+
+    drawlist->pipelines[drawlist->pipelineCount] = pipeline;
+    return drawlist->pipelineCount++;
+}
+
+/// @brief returns the pipeline a packet is drawn with on a stage, while the prepass is enabled packets with prepass pipelines swap their default pipeline for the equal one
+/// @param drawlist the frame's draw list
+/// @param packet the packet
+/// @param stage render stage
+/// @return the pipeline or NULL if the packet isn't drawn on the stage
+static vkPipeline* internal_crenvk_drawlist_stage_pipeline(const vkDrawlist* drawlist, const vkDrawPacket* packet, CRenRenderStage stage) {
+    int prepassed = drawlist->prepass && packet->pipeline != NULL && packet->depthPipeline != NULL && packet->equalPipeline != NULL;
+
+    switch (stage) {
+        case Default: return prepassed ? packet->equalPipeline : packet->pipeline;
+        case Picking: return packet->pickingPipeline;
+        case Prepass: return prepassed ? packet->depthPipeline : NULL;
+    }
+
+    return NULL;
+}
+
+/// @brief builds the 64-bit sort key of a packet on a stage
+/// layout for opaque pipelines:  stage(2) | blend(1) | pipeline(12) | descriptor(16) | depth(32, front-to-back)
+/// layout for blended pipelines: stage(2) | blend(1) | depth(32, back-to-front) | pipeline(12) | descriptor(16)
+/// @param drawlist the frame's draw list
+/// @param stage render stage
+/// @param pipeline pipeline used on the stage
+/// @param descriptorSet descriptor set used by the packet
+/// @param depth view-space depth of the packet
+/// @return the sort key
+static unsigned long long internal_crenvk_drawlist_make_key(vkDrawlist* drawlist, CRenRenderStage stage, vkPipeline* pipeline, VkDescriptorSet descriptorSet, float depth) {
+    unsigned long long pipelineSlot = (unsigned long long)internal_crenvk_drawlist_pipeline_slot(drawlist, pipeline) & 0xFFFULL;
+
+    // descriptor handles are only grouped, collisions just cost an extra bind
+    unsigned long long descriptorHash = (unsigned long long)descriptorSet;
+    descriptorHash ^= descriptorHash >> 33;
+    descriptorHash *= 0xFF51AFD7ED558CCDULL;
+    descriptorHash ^= descriptorHash >> 33;
+    descriptorHash &= 0xFFFFULL;
+
+    // positive floats keep their order when compared as integers
+    union { float f; unsigned int u; } depthBits;
+    depthBits.f = f_max(depth, 0.0f);
+
+    unsigned long long key = ((unsigned long long)stage & 0x3ULL) << 62;
+
+    if (pipeline->alphaBlending) {
+        key |= 1ULL << 61;
+        key |= (unsigned long long)(~depthBits.u) << 29;
+        key |= pipelineSlot << 17;
+        key |= descriptorHash << 1;
+    }
+
+    else {
+        key |= pipelineSlot << 49;
+        key |= descriptorHash << 33;
+        key |= (unsigned long long)depthBits.u;
+    }
+
+    return key;
+}
+
+/// @brief grows the draw list storage to hold at least the given ammount of packets
+/// @param drawlist the frame's draw list
+/// @param capacity desired packet capacity
+/// @return 1 on success, 0 on failure
+static int internal_crenvk_drawlist_reserve(vkDrawlist* drawlist, unsigned int capacity) {
+    if (capacity <= drawlist->packetCapacity) return 1;
+
+    unsigned int newCapacity = drawlist->packetCapacity > 0 ? drawlist->packetCapacity : CREN_DRAWLIST_INITIAL_CAPACITY;
+    while (newCapacity < capacity) newCapacity *= 2;
+
+    // every packet may produce one key per stage
+    vkDrawPacket* packets = (vkDrawPacket*)crenmemory_reallocate(drawlist->packets, sizeof(vkDrawPacket) * newCapacity);
+    if (!packets) return 0;
+    drawlist->packets = packets;
+
+    vkDrawKey* keys = (vkDrawKey*)crenmemory_reallocate(drawlist->keys, sizeof(vkDrawKey) * newCapacity * 3);
+    if (!keys) return 0;
+    drawlist->keys = keys;
+
+    vkDrawKey* scratch = (vkDrawKey*)crenmemory_reallocate(drawlist->scratch, sizeof(vkDrawKey) * newCapacity * 3);
+    if (!scratch) return 0;
+    drawlist->scratch = scratch;
+
+    unsigned int* visibility = (unsigned int*)crenmemory_reallocate(drawlist->visibility, sizeof(unsigned int) * newCapacity);
+    if (!visibility) return 0;
+    drawlist->visibility = visibility;
+
+    drawlist->packetCapacity = newCapacity;
+    return 1;
+}
+
+/// @brief returns the view-space depth of a packet's origin, the camera looks towards -z
+/// @param view camera view matrix
+/// @param model packet transformation
+/// @return the depth
+static float internal_crenvk_drawlist_depth(const mat4* view, const mat4* model) {
+    float viewZ = view->data[0][2] * model->data[3][0] + view->data[1][2] * model->data[3][1] + view->data[2][2] * model->data[3][2] + view->data[3][2];
+    return -viewZ;
+}
+
+/// @brief builds the sort keys of every packet, one per stage the packet has a pipeline for
+/// @param drawlist the frame's draw list
+/// @param view camera view matrix
+static void internal_crenvk_drawlist_build_keys(vkDrawlist* drawlist, const mat4* view) {
+    drawlist->keyCount = 0;
+    drawlist->pipelineCount = 0;
+    drawlist->hasBlended = 0;
+    drawlist->sortedView = *view;
+
+    const CRenRenderStage stages[] = { Default, Picking, Prepass };
+
+    for (unsigned int i = 0; i < drawlist->packetCount; i++) {
+        vkDrawPacket* packet = &drawlist->packets[i];
+        float depth = internal_crenvk_drawlist_depth(view, &packet->model);
+
+        for (unsigned int s = 0; s < (unsigned int)CREN_ARRAYSIZE(stages); s++) {
+            vkPipeline* pipeline = internal_crenvk_drawlist_stage_pipeline(drawlist, packet, stages[s]);
+            if (pipeline == NULL) continue;
+
+            drawlist->keys[drawlist->keyCount].key = internal_crenvk_drawlist_make_key(drawlist, stages[s], pipeline, packet->descriptorSets[0], depth);
+            drawlist->keys[drawlist->keyCount].packet = i;
+            drawlist->keyCount++;
+            drawlist->hasBlended |= pipeline->alphaBlending != 0;
+        }
+    }
+}
+
+/// @brief sorts keys with a least-significant-digit radix sort, 8 bits per pass. Passes where all keys share the same digit are skipped
+/// @param keys the keys, swapped with scratch when the sorted keys end up there
+/// @param scratch storage with room for count keys
+/// @param count how many keys to sort
+static void internal_crenvk_drawlist_radix_sort(vkDrawKey** keys, vkDrawKey** scratch, unsigned int count) {
+    if (count < 2) return;
+
+    vkDrawKey* src = *keys;
+    vkDrawKey* dst = *scratch;
+
+    for (unsigned int shift = 0; shift < 64; shift += 8) {
+        unsigned int histogram[256] = { 0 };
+
+        for (unsigned int i = 0; i < count; i++) {
+            histogram[(src[i].key >> shift) & 0xFF]++;
+        }
+
+        // every key has the same digit, the pass would not change the order
+        if (histogram[(src[0].key >> shift) & 0xFF] == count) continue;
+
+        unsigned int offset = 0;
+        for (unsigned int i = 0; i < 256; i++) {
+            unsigned int digitCount = histogram[i];
+            histogram[i] = offset;
+            offset += digitCount;
+        }
+
+        for (unsigned int i = 0; i < count; i++) {
+            dst[histogram[(src[i].key >> shift) & 0xFF]++] = src[i];
+        }
+
+        vkDrawKey* temp = src;
+        src = dst;
+        dst = temp;
+    }
+
+    *keys = src;
+    *scratch = dst;
+}
+
+/// @brief sorts the draw list keys by stage, pipeline, descriptor and depth
+/// @note an already sorted list is only sorted again if it has blended packets and the camera has moved, since their order depends on the view
+/// @param drawlist the frame's draw list
+/// @param view camera view matrix
+static void internal_crenvk_drawlist_sort(vkDrawlist* drawlist, const mat4* view) {
+    if (drawlist->sorted) {
+        if (!drawlist->hasBlended || crenmemory_compare(&drawlist->sortedView, view, sizeof(mat4)) == 0) return;
+        drawlist->version++;
+    }
+
+    internal_crenvk_drawlist_build_keys(drawlist, view);
+    internal_crenvk_drawlist_radix_sort(&drawlist->keys, &drawlist->scratch, drawlist->keyCount);
+    drawlist->sorted = 1;
+}
+
+/// @brief records the packets of a stage from a sorted key list into a command buffer, binding pipelines and descriptors only when they change. Packets the view doesn't see are skipped
+/// @param drawlist the frame's draw list
+/// @param keys sorted keys, the draw list own keys or a view's
+/// @param keyCount how many keys
+/// @param stage render stage to record
+/// @param view the view being recorded, 0 for the main camera
+/// @param currentFrame frame in flight the command buffer belongs to, selects the packets descriptor sets
+/// @param cmdBuffer the command buffer of the stage, inside it's render pass
+static void internal_crenvk_drawlist_record_keys(vkDrawlist* drawlist, const vkDrawKey* keys, unsigned int keyCount, CRenRenderStage stage, unsigned int view, unsigned int currentFrame, VkCommandBuffer cmdBuffer) {
+    VkPipeline boundPipeline = VK_NULL_HANDLE;
+    VkPipelineLayout boundLayout = VK_NULL_HANDLE;
+    VkDescriptorSet boundDescriptor = VK_NULL_HANDLE;
+    unsigned int viewBit = 1U << view;
+
+    for (unsigned int i = 0; i < keyCount; i++) {
+        unsigned int keyStage = (unsigned int)(keys[i].key >> 62);
+        if (keyStage < (unsigned int)stage) continue;
+        if (keyStage > (unsigned int)stage) break;
+        if ((drawlist->visibility[keys[i].packet] & viewBit) == 0) continue;
+
+        vkDrawPacket* packet = &drawlist->packets[keys[i].packet];
+        vkPipeline* pipeline = internal_crenvk_drawlist_stage_pipeline(drawlist, packet, stage);
+
+        if (pipeline->pipeline != boundPipeline) {
+            vkCmdBindPipeline(cmdBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, pipeline->pipeline);
+            boundPipeline = pipeline->pipeline;
+        }
+
+        // a different layout may disturb the set bindings, bind it again
+        VkDescriptorSet descriptorSet = packet->descriptorSets[currentFrame];
+        if (descriptorSet != boundDescriptor || pipeline->layout != boundLayout) {
+            vkCmdBindDescriptorSets(cmdBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, pipeline->layout, 0, 1, &descriptorSet, 0, NULL);
+            boundDescriptor = descriptorSet;
+            boundLayout = pipeline->layout;
+        }
+
+        vkPushConstant constants = { 0 };
+        constants.id = packet->id;
+        constants.model = packet->model;
+        constants.view = view;
+        vkCmdPushConstants(cmdBuffer, pipeline->layout, VK_SHADER_STAGE_VERTEX_BIT | VK_SHADER_STAGE_FRAGMENT_BIT, 0, sizeof(vkPushConstant), &constants);
+
+        vkCmdDraw(cmdBuffer, packet->vertexCount, packet->instanceCount, 0, packet->firstInstance);
+    }
+}
+
+/// @brief records the sorted packets of a stage seen by the main camera into a command buffer
+/// @param drawlist the frame's draw list, must be sorted
+/// @param stage render stage to record
+/// @param currentFrame frame in flight the command buffer belongs to
+/// @param cmdBuffer the command buffer of the stage, inside it's render pass
+static void internal_crenvk_drawlist_record(vkDrawlist* drawlist, CRenRenderStage stage, unsigned int currentFrame, VkCommandBuffer cmdBuffer) {
+    internal_crenvk_drawlist_record_keys(drawlist, drawlist->keys, drawlist->keyCount, stage, 0, currentFrame, cmdBuffer);
+}
+
+/// @brief records the depth prepass, when enabled, followed by the default stage. Both share the render pass, so the default stage tests against the prepass depth
+/// @param drawlist the frame's draw list
+/// @param keys sorted keys, the draw list own keys or a view's
+/// @param keyCount how many keys
+/// @param view the view being recorded, 0 for the main camera
+/// @param currentFrame frame in flight the command buffer belongs to
+/// @param cmdBuffer the command buffer of the phase, inside it's render pass
+static void internal_crenvk_drawlist_record_shaded(vkDrawlist* drawlist, const vkDrawKey* keys, unsigned int keyCount, unsigned int view, unsigned int currentFrame, VkCommandBuffer cmdBuffer) {
+    if (drawlist->prepass) internal_crenvk_drawlist_record_keys(drawlist, keys, keyCount, Prepass, view, currentFrame, cmdBuffer);
+    internal_crenvk_drawlist_record_keys(drawlist, keys, keyCount, Default, view, currentFrame, cmdBuffer);
+}
+
+/// @brief discards every packet submitted, keeping the storage for the next frame
+/// @param drawlist the frame's draw list
+static void internal_crenvk_drawlist_clear(vkDrawlist* drawlist) {
+    drawlist->packetCount = 0;
+    drawlist->keyCount = 0;
+    drawlist->pipelineCount = 0;
+    drawlist->hasBlended = 0;
+    drawlist->sorted = 0;
+    drawlist->version++;
+}
+
+/// @brief end of frame, the list is discarded unless it's retained
+/// @param drawlist the frame's draw list
+static void internal_crenvk_drawlist_end_frame(vkDrawlist* drawlist) {
+    if (!drawlist->retained) internal_crenvk_drawlist_clear(drawlist);
+}
+
+/// @brief checks if a phase command buffer recorded on a previous frame can be submitted again as it is
+/// @param drawlist the frame's draw list
+/// @param renderpass the phase renderpass
+/// @param currentFrame current frame in flight
+/// @param target the swapchain image view the phase renders into this frame, VK_NULL_HANDLE for phases rendering into their own images where any frame is equivalent
+/// @return 1 if the command buffer can be re-used, 0 if it must be recorded
+static int internal_crenvk_drawlist_reuse(vkDrawlist* drawlist, vkRenderpass* renderpass, unsigned int currentFrame, VkImageView target) {
+    if (!drawlist->retained) return 0;
+    if (renderpass->recordedVersion[currentFrame] != drawlist->version) return 0;
+    if (target != VK_NULL_HANDLE && renderpass->recordedTarget[currentFrame] != target) return 0;
+    return 1;
+}
+
+/// @brief remembers what a phase command buffer was recorded with
+/// @param drawlist the frame's draw list
+/// @param renderpass the phase renderpass
+/// @param currentFrame current frame in flight
+/// @param target the swapchain image view recorded, VK_NULL_HANDLE for phases rendering into their own images
+static void internal_crenvk_drawlist_recorded(vkDrawlist* drawlist, vkRenderpass* renderpass, unsigned int currentFrame, VkImageView target) {
+    renderpass->recordedVersion[currentFrame] = drawlist->version;
+    renderpass->recordedTarget[currentFrame] = target;
+}
+
+/// @brief points the packets at re-created pipelines, the previous ones were destroyed
+/// @param drawlist the frame's draw list
+/// @param previous pipelines before being re-created
+/// @param current the pipelines that replaced them, at the same index
+/// @param count how many pipelines were re-created
+static void internal_crenvk_drawlist_replace_pipelines(vkDrawlist* drawlist, vkPipeline* const* previous, vkPipeline* const* current, unsigned int count) {
+    for (unsigned int i = 0; i < drawlist->packetCount; i++) {
+        vkDrawPacket* packet = &drawlist->packets[i];
+        vkPipeline** stages[] = { &packet->pipeline, &packet->pickingPipeline, &packet->depthPipeline, &packet->equalPipeline };
+
+        // a stage is replaced once, a current pipeline may have been allocated where a previous one was
+        for (unsigned int s = 0; s < (unsigned int)CREN_ARRAYSIZE(stages); s++) {
+            for (unsigned int p = 0; p < count; p++) {
+                if (*stages[s] == NULL || *stages[s] != previous[p]) continue;
+                *stages[s] = current[p];
+                break;
+            }
+        }
+    }
+
+    drawlist->sorted = 0;
+    drawlist->version++;
+}
+
+/// @brief marks the textures of every packet as used on the given frame, keeping them away from eviction
+/// @param drawlist the frame's draw list
+/// @param frame current frame number
+static void internal_crenvk_drawlist_touch(vkDrawlist* drawlist, unsigned long long frame) {
+    for (unsigned int i = 0; i < drawlist->packetCount; i++) {
+        if (drawlist->packets[i].texture != NULL) drawlist->packets[i].texture->lastUsedFrame = frame;
+    }
+}
+
+/// @brief releases the draw list storage
+/// @param drawlist the frame's draw list
+static void internal_crenvk_drawlist_destroy(vkDrawlist* drawlist) {
+    if (drawlist->packets) crenmemory_deallocate(drawlist->packets);
+    if (drawlist->keys) crenmemory_deallocate(drawlist->keys);
+    if (drawlist->scratch) crenmemory_deallocate(drawlist->scratch);
+    if (drawlist->visibility) crenmemory_deallocate(drawlist->visibility);
+    crenmemory_zero(drawlist, sizeof(vkDrawlist));
+}
+
+int crenvk_drawlist_submit(CRenContext* context, const vkDrawPacket* packet) {
+    CRenVulkanBackend* renderer = (CRenVulkanBackend*)context->backend;
+    vkDrawlist* drawlist = &renderer->drawlist;
+
+    if (packet->pipeline == NULL && packet->pickingPipeline == NULL) return 1;
+
+    if (!internal_crenvk_drawlist_reserve(drawlist, drawlist->packetCount + 1)) {
+        cren_set_error(MemoryAllocationFailed);
+        return 0;
+    }
+
+    vkDrawPacket* dst = &drawlist->packets[drawlist->packetCount++];
+    *dst = *packet;
+    if (dst->instanceCount == 0) dst->instanceCount = 1;
+
+    drawlist->sorted = 0;
+    drawlist->version++;
+    return 1;
+}
+
+unsigned int crenvk_drawlist_get_count(CRenContext* context) {
+    CRenVulkanBackend* renderer = (CRenVulkanBackend*)context->backend;
+    return renderer->drawlist.packetCount;
+}
+
+void crenvk_drawlist_set_retained(CRenContext* context, int enabled) {
+    CRenVulkanBackend* renderer = (CRenVulkanBackend*)context->backend;
+    if (renderer->drawlist.retained == enabled) return;
+
+    renderer->drawlist.retained = enabled;
+    internal_crenvk_drawlist_clear(&renderer->drawlist);
+}
+
+void crenvk_drawlist_reset(CRenContext* context) {
+    CRenVulkanBackend* renderer = (CRenVulkanBackend*)context->backend;
+    internal_crenvk_drawlist_clear(&renderer->drawlist);
+}
+
+void crenvk_drawlist_invalidate(CRenContext* context) {
+    CRenVulkanBackend* renderer = (CRenVulkanBackend*)context->backend;
+    renderer->drawlist.version++;
+}
+
 /////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 // DefaultRenderphase-related
 /////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -1224,31 +2723,37 @@ int crenvk_vertex_equals(vkVertex *v0, vkVertex *v1) {
 /// @param format the format of the window surface
 /// @param msaa anti-alignsed sample count
 /// @param finalPhase checks if the default phase is the final phase
+/// @param dynamic renders with dynamic rendering, no render pass object is created
+/// @param mergedUI adds a second subpass where the ui is drawn over the resolved image, wich is then presented
 /// @return the default object renderphase
-static vkDefaultRenderphase internal_crenvk_renderphase_default_create(VkDevice device, VkPhysicalDevice physicalDevice, VkFormat format, VkSampleCountFlagBits msaa, int finalPhase) {
+static vkDefaultRenderphase internal_crenvk_renderphase_default_create(VkDevice device, VkPhysicalDevice physicalDevice, VkFormat format, VkSampleCountFlagBits msaa, int finalPhase, int dynamic, int mergedUI) {
     vkDefaultRenderphase renderPhase = { 0 };
     renderPhase.renderpass = (vkRenderpass*)crenmemory_allocate(sizeof(vkRenderpass), 1);
     renderPhase.renderpass->name = "Default";
     renderPhase.renderpass->surfaceFormat = format;
+    renderPhase.renderpass->depthFormat = crenvk_find_depth_format(physicalDevice);
     renderPhase.renderpass->msaa = msaa;
+    renderPhase.renderpass->dynamic = dynamic;
+    renderPhase.mergedUI = mergedUI && !dynamic;
+    if (dynamic) return renderPhase;
 
     VkAttachmentDescription attachments[3] = { 0 };
 
-    // color
+    // color, only the resolved copy is read afterwards
     attachments[0].format = format;
     attachments[0].samples = renderPhase.renderpass->msaa;
     attachments[0].loadOp = VK_ATTACHMENT_LOAD_OP_CLEAR;
-    attachments[0].storeOp = VK_ATTACHMENT_STORE_OP_STORE;
+    attachments[0].storeOp = VK_ATTACHMENT_STORE_OP_DONT_CARE;
     attachments[0].stencilLoadOp = VK_ATTACHMENT_LOAD_OP_DONT_CARE;
     attachments[0].stencilStoreOp = VK_ATTACHMENT_STORE_OP_DONT_CARE;
     attachments[0].initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
     attachments[0].finalLayout = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
 
     // depth
-    attachments[1].format = crenvk_find_depth_format(physicalDevice);
+    attachments[1].format = renderPhase.renderpass->depthFormat;
     attachments[1].samples = renderPhase.renderpass->msaa;
     attachments[1].loadOp = VK_ATTACHMENT_LOAD_OP_CLEAR;
-    attachments[1].storeOp = VK_ATTACHMENT_STORE_OP_STORE;
+    attachments[1].storeOp = VK_ATTACHMENT_STORE_OP_DONT_CARE;
     attachments[1].stencilLoadOp = VK_ATTACHMENT_LOAD_OP_CLEAR;
     attachments[1].stencilStoreOp = VK_ATTACHMENT_STORE_OP_DONT_CARE;
     attachments[1].initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
@@ -1257,12 +2762,12 @@ static vkDefaultRenderphase internal_crenvk_renderphase_default_create(VkDevice
     // resolve
     attachments[2].format = format;
     attachments[2].samples = VK_SAMPLE_COUNT_1_BIT;
-    attachments[2].loadOp = VK_ATTACHMENT_LOAD_OP_DONT_CARE;
+    attachments[2].loadOp = msaa == VK_SAMPLE_COUNT_1_BIT ? VK_ATTACHMENT_LOAD_OP_CLEAR : VK_ATTACHMENT_LOAD_OP_DONT_CARE;
     attachments[2].storeOp = VK_ATTACHMENT_STORE_OP_STORE;
     attachments[2].stencilLoadOp = VK_ATTACHMENT_LOAD_OP_DONT_CARE;
     attachments[2].stencilStoreOp = VK_ATTACHMENT_STORE_OP_DONT_CARE;
     attachments[2].initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
-    attachments[2].finalLayout = finalPhase == 1 ? VK_IMAGE_LAYOUT_PRESENT_SRC_KHR : VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
+    attachments[2].finalLayout = finalPhase == 1 || renderPhase.mergedUI ? VK_IMAGE_LAYOUT_PRESENT_SRC_KHR : VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
     // finalLayout should be present src if it's the final renderpass used, normally an UI renderpass would have such layout but we can't be sure if that'll be the case
 
     // attachments references
@@ -1275,16 +2780,26 @@ static vkDefaultRenderphase internal_crenvk_renderphase_default_create(VkDevice
     references[2].attachment = 2;
     references[2].layout = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
 
-    // subpass
-    VkSubpassDescription subpass = { 0 };
-    subpass.pipelineBindPoint = VK_PIPELINE_BIND_POINT_GRAPHICS;
-    subpass.colorAttachmentCount = 1;
-    subpass.pColorAttachments = &references[0];
-    subpass.pDepthStencilAttachment = &references[1];
-    subpass.pResolveAttachments = &references[2];
+    // subpasses, the ui one draws straight over the resolved image while it's still on-chip
+    VkSubpassDescription subpasses[2] = { 0 };
+    subpasses[0].pipelineBindPoint = VK_PIPELINE_BIND_POINT_GRAPHICS;
+    subpasses[0].colorAttachmentCount = 1;
+    subpasses[0].pColorAttachments = &references[0];
+    subpasses[0].pDepthStencilAttachment = &references[1];
+    subpasses[0].pResolveAttachments = &references[2];
+
+    // a single sample color can't be resolved, it's rendered straight into the swapchain image and the color attachment stays unused
+    if (msaa == VK_SAMPLE_COUNT_1_BIT) {
+        subpasses[0].pColorAttachments = &references[2];
+        subpasses[0].pResolveAttachments = NULL;
+    }
+
+    subpasses[1].pipelineBindPoint = VK_PIPELINE_BIND_POINT_GRAPHICS;
+    subpasses[1].colorAttachmentCount = 1;
+    subpasses[1].pColorAttachments = &references[2];
 
     // subpass dependencies for layout transitions
-    VkSubpassDependency dependencies[2] = { 0 };
+    VkSubpassDependency dependencies[4] = { 0 };
 
     dependencies[0].srcSubpass = VK_SUBPASS_EXTERNAL;
     dependencies[0].dstSubpass = 0;
@@ -1302,13 +2817,31 @@ static vkDefaultRenderphase internal_crenvk_renderphase_default_create(VkDevice
     dependencies[1].dstAccessMask = VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT | VK_ACCESS_COLOR_ATTACHMENT_READ_BIT;
     dependencies[1].dependencyFlags = 0;
 
+    // the ui blends over the resolve, wich happens at the end of the first subpass
+    dependencies[2].srcSubpass = 0;
+    dependencies[2].dstSubpass = 1;
+    dependencies[2].srcStageMask = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT;
+    dependencies[2].dstStageMask = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT;
+    dependencies[2].srcAccessMask = VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT;
+    dependencies[2].dstAccessMask = VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT | VK_ACCESS_COLOR_ATTACHMENT_READ_BIT;
+    dependencies[2].dependencyFlags = VK_DEPENDENCY_BY_REGION_BIT;
+
+    // and samples the viewport and view images, rendered earlier on the frame
+    dependencies[3].srcSubpass = VK_SUBPASS_EXTERNAL;
+    dependencies[3].dstSubpass = 1;
+    dependencies[3].srcStageMask = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT;
+    dependencies[3].dstStageMask = VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT;
+    dependencies[3].srcAccessMask = VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT;
+    dependencies[3].dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
+    dependencies[3].dependencyFlags = 0;
+
     VkRenderPassCreateInfo renderPassCI = { 0 };
     renderPassCI.sType = VK_STRUCTURE_TYPE_RENDER_PASS_CREATE_INFO;
     renderPassCI.attachmentCount = 3u;
     renderPassCI.pAttachments = attachments;
-    renderPassCI.subpassCount = 1;
-    renderPassCI.pSubpasses = &subpass;
-    renderPassCI.dependencyCount = 2u;
+    renderPassCI.subpassCount = renderPhase.mergedUI ? 2u : 1u;
+    renderPassCI.pSubpasses = subpasses;
+    renderPassCI.dependencyCount = renderPhase.mergedUI ? 4u : 2u;
     renderPassCI.pDependencies = dependencies;
     CREN_ASSERT(vkCreateRenderPass(device, &renderPassCI, NULL, &renderPhase.renderpass->renderPass) == VK_SUCCESS, "Failed to create the Default renderphase renderpass");
 
@@ -1429,6 +2962,9 @@ static int internal_crenvk_renderphase_default_framebuffers_create(vkDefaultRend
     );
     phase->depthView = crenvk_image_view_create(device->device, phase->depthImage, depthFormat, VK_IMAGE_ASPECT_DEPTH_BIT, 1, 1, VK_IMAGE_VIEW_TYPE_2D);
 
+    // dynamic rendering begins straight into the images
+    if (renderpass->dynamic) return 1;
+
     // create framebuffers
     renderpass->framebufferCount = swapchain->swapchainImageCount;
     renderpass->framebuffers = (VkFramebuffer*)crenmemory_allocate(sizeof(VkFramebuffer) * renderpass->framebufferCount, 1);
@@ -1491,7 +3027,7 @@ static vkPipeline* internal_crenvk_renderphase_default_pipeline_create(vkDefault
     ci.pushConstantsCount = 1;
     ci.pushConstants[0] = pushConstant;
     // camera buffer
-    ci.bindingsCount = 3;
+    ci.bindingsCount = 5;
     ci.bindings[0].binding = 0;
     ci.bindings[0].descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
     ci.bindings[0].descriptorCount = 1;
@@ -1509,6 +3045,14 @@ static vkPipeline* internal_crenvk_renderphase_default_pipeline_create(vkDefault
     ci.bindings[2].descriptorCount = 1;
     ci.bindings[2].stageFlags = VK_SHADER_STAGE_FRAGMENT_BIT;
     ci.bindings[2].pImmutableSamplers = NULL;
+    // clustered lights, see crenvk_lights_get_descriptor_infos
+    for (unsigned int i = 3; i < ci.bindingsCount; i++) {
+        ci.bindings[i].binding = i;
+        ci.bindings[i].descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+        ci.bindings[i].descriptorCount = 1;
+        ci.bindings[i].stageFlags = VK_SHADER_STAGE_FRAGMENT_BIT;
+        ci.bindings[i].pImmutableSamplers = NULL;
+    }
 
     // create and modify
     vkPipeline* pipeline = crenvk_pipeline_create(device, &ci);
@@ -1548,25 +3092,79 @@ static void internal_crenvk_renderphase_default_recreate(vkDefaultRenderphase* p
     internal_crenvk_renderphase_default_framebuffers_create(phase, device, swapchain);
 }
 
-/// @brief performs the update of the current frame, effectly calling the rendering callback function who draws the objects
-/// @param phase cren default render phase
-/// @param context cren context
-/// @param currentFrame current frame being processed, since multiple frames may be processing
-/// @param swapchainImageIndex swapchain image index
-/// @param usingViewport hints the usage of a custom viewport who will handle rendering in a further step
-/// @param timestep interpolation state between frames, this will be passed on to the callback
-/// @param callback render callback, a function defined by the used to handle the rendering
-static void internal_crenvk_renderphase_default_update(vkDefaultRenderphase* phase, CRenContext* context, unsigned int currentFrame, unsigned int swapchainImageIndex, int usingViewport, double timestep, CRenCallback_Render callback) {
+/// @brief changes the default render phase sample count, re-creating the renderpass handle, images, framebuffers and pipeline. The vkRenderpass and it's command buffers are kept so references to it stay valid
+/// @param phase cren vulkan default render phase
+/// @param device cren vulkan device
+/// @param swapchain cren vulkan swapchain
+/// @param msaa the new sample count
+/// @param rootPath asset's path for shader look-up
+static void internal_crenvk_renderphase_default_msaa_change(vkDefaultRenderphase* phase, vkDevice* device, vkSwapchain* swapchain, VkSampleCountFlagBits msaa, const char* rootPath) {
+    vkDeviceWaitIdle(device->device);
+
+    vkDestroyImageView(device->device, phase->depthView, NULL);
+    vkDestroyImage(device->device, phase->depthImage, NULL);
+    vkFreeMemory(device->device, phase->depthMemory, NULL);
+
+    vkDestroyImageView(device->device, phase->colorView, NULL);
+    vkDestroyImage(device->device, phase->colorImage, NULL);
+    vkFreeMemory(device->device, phase->colorMemory, NULL);
+
+    for (unsigned int i = 0; i < phase->renderpass->framebufferCount; i++) { vkDestroyFramebuffer(device->device, phase->renderpass->framebuffers[i], NULL); }
+    crenmemory_deallocate(phase->renderpass->framebuffers);
+
+    crenvk_pipeline_destroy(device->device, phase->pipeline);
+    vkDestroyRenderPass(device->device, phase->renderpass->renderPass, NULL);
+
+    // only the renderpass handle is taken from the newer phase
+    vkDefaultRenderphase newer = internal_crenvk_renderphase_default_create(device->device, device->physicalDevice, phase->renderpass->surfaceFormat, msaa, 0, phase->renderpass->dynamic, phase->mergedUI);
+    phase->renderpass->renderPass = newer.renderpass->renderPass;
+    phase->renderpass->msaa = msaa;
+    crenmemory_deallocate(newer.renderpass);
+
+    internal_crenvk_renderphase_default_framebuffers_create(phase, device, swapchain);
+    phase->pipeline = internal_crenvk_renderphase_default_pipeline_create(phase, device->device, 1, rootPath);
+}
+
+/// @brief performs the update of the current frame, effectly calling the rendering callback function who draws the objects
+/// @param phase cren default render phase
+/// @param context cren context
+/// @param currentFrame current frame being processed, since multiple frames may be processing
+/// @param swapchainImageIndex swapchain image index
+/// @param usingViewport hints the usage of a custom viewport who will handle rendering in a further step
+/// @param timestep interpolation state between frames, this will be passed on to the callback
+/// @param callback render callback, a function defined by the used to handle the rendering
+static void internal_crenvk_renderphase_default_update(vkDefaultRenderphase* phase, CRenContext* context, unsigned int currentFrame, unsigned int swapchainImageIndex, int usingViewport, double timestep, CRenCallback_Render callback) {
     
     CRenVulkanBackend* renderer = (CRenVulkanBackend*)context->backend;
-    VkClearValue clearValues[2] = { 0 };
-    const unsigned int clearValuesCount = 2;
+    VkClearValue clearValues[3] = { 0 };
+    const unsigned int clearValuesCount = 3;
     clearValues[0].color = (VkClearColorValue) { 0.0f, 0.0f, 0.0f, 1.0f };
     clearValues[1].depthStencil = (VkClearDepthStencilValue) { 1.0f, 0 };
+    clearValues[2].color = clearValues[0].color; // the swapchain image is cleared instead of resolved into without anti-aliasing
 
     VkCommandBuffer cmdBuffer = phase->renderpass->commandBuffers[currentFrame];
-    VkFramebuffer frameBuffer = phase->renderpass->framebuffers[swapchainImageIndex];
-    VkRenderPass renderPass = phase->renderpass->renderPass;
+    VkImageView swapchainView = renderer->swapchain.swapchainImageViews[swapchainImageIndex];
+
+    // retained mode, nothing has changed since this command buffer was recorded for this swapchain image. The ui changes every frame
+    if (!phase->mergedUI && internal_crenvk_drawlist_reuse(&renderer->drawlist, phase->renderpass, currentFrame, swapchainView)) return;
+
+    // multisampled color is resolved into the swapchain image, with dynamic rendering a single sample renders into it directly
+    vkRenderTarget target = { 0 };
+    target.framebuffer = phase->renderpass->dynamic ? VK_NULL_HANDLE : phase->renderpass->framebuffers[swapchainImageIndex];
+    target.extent = renderer->swapchain.swapchainExtent;
+    target.colorImage = phase->colorImage;
+    target.colorView = phase->colorView;
+    target.resolveImage = renderer->swapchain.swapchainImages[swapchainImageIndex];
+    target.resolveView = swapchainView;
+    target.depthImage = phase->depthImage;
+    target.depthView = phase->depthView;
+    target.finalLayout = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
+    if (phase->renderpass->dynamic && phase->renderpass->msaa == VK_SAMPLE_COUNT_1_BIT) {
+        target.colorImage = target.resolveImage;
+        target.colorView = target.resolveView;
+        target.resolveImage = VK_NULL_HANDLE;
+        target.resolveView = VK_NULL_HANDLE;
+    }
 
     vkResetCommandBuffer(cmdBuffer, /*VkCommandBufferResetFlagBits*/ 0);
 
@@ -1575,16 +3173,7 @@ static void internal_crenvk_renderphase_default_update(vkDefaultRenderphase* pha
     cmdBeginInfo.pNext = NULL;
     cmdBeginInfo.flags = 0;
     CREN_ASSERT(vkBeginCommandBuffer(cmdBuffer, &cmdBeginInfo) == VK_SUCCESS, "Failed to begin default renderphase command buffer");
-
-    VkRenderPassBeginInfo renderPassBeginInfo = { 0 };
-    renderPassBeginInfo.sType = VK_STRUCTURE_TYPE_RENDER_PASS_BEGIN_INFO;
-    renderPassBeginInfo.renderPass = renderPass;
-    renderPassBeginInfo.framebuffer = frameBuffer;
-    renderPassBeginInfo.renderArea.offset = (VkOffset2D) { 0, 0 };
-    renderPassBeginInfo.renderArea.extent = renderer->swapchain.swapchainExtent;
-    renderPassBeginInfo.clearValueCount = clearValuesCount;
-    renderPassBeginInfo.pClearValues = clearValues;
-    vkCmdBeginRenderPass(cmdBuffer, &renderPassBeginInfo, VK_SUBPASS_CONTENTS_INLINE);
+    internal_crenvk_renderpass_begin(&renderer->device, phase->renderpass, cmdBuffer, &target, clearValues, clearValuesCount);
 
     // set frame commandbuffer viewport
     VkViewport viewport = { 0 };
@@ -1604,15 +3193,72 @@ static void internal_crenvk_renderphase_default_update(vkDefaultRenderphase* pha
 
     // not using viewport as the final target, therefore it's time to draw the objects
     if (!usingViewport) {
+        internal_crenvk_drawlist_record_shaded(&renderer->drawlist, renderer->drawlist.keys, renderer->drawlist.keyCount, 0, currentFrame, cmdBuffer);
+
         if (callback != NULL) {
             callback(context, (CRenRenderStage)Default, timestep);
         }
     }
 
-    vkCmdEndRenderPass(cmdBuffer);
+    // the ui is drawn over the resolved image before it leaves the tile memory
+    if (phase->mergedUI) {
+        vkCmdNextSubpass(cmdBuffer, VK_SUBPASS_CONTENTS_INLINE);
+
+        CRenCallback_DrawUIRawData uiCallback = (CRenCallback_DrawUIRawData)context->drawUIRawDataCallback;
+        if (uiCallback != NULL) {
+            uiCallback(context, cmdBuffer);
+        }
+    }
+
+    internal_crenvk_renderpass_end(&renderer->device, phase->renderpass, cmdBuffer, &target);
 
     // end command buffer
     CREN_ASSERT(vkEndCommandBuffer(cmdBuffer) == VK_SUCCESS, "Failed to end default renderphase command buffer");
+    internal_crenvk_drawlist_recorded(&renderer->drawlist, phase->renderpass, currentFrame, swapchainView);
+}
+
+int crenvk_renderphase_default_set_prepass(CRenContext* context, int enabled) {
+    CRenVulkanBackend* renderer = (CRenVulkanBackend*)context->backend;
+    vkDrawlist* drawlist = &renderer->drawlist;
+    enabled = enabled != 0;
+    if (drawlist->prepass == enabled) return 1;
+
+    if (enabled && crenhashtable_lookup(renderer->pipelinesLib, CREN_PIPELINE_QUAD_DEPTH_NAME) == NULL) {
+        vkRenderpass* mainRenderpass = renderer->hint_viewport ? renderer->viewportRenderphase.renderpass : renderer->defaultRenderphase.renderpass;
+        if (!internal_crenvk_pipeline_quad_prepass_create(renderer->pipelinesLib, &renderer->pipelineRegistry, mainRenderpass, renderer->device.device, context->createInfo.assetsRoot)) return 0;
+    }
+
+    vkPipeline* quadDepthPipeline = (vkPipeline*)crenhashtable_lookup(renderer->pipelinesLib, CREN_PIPELINE_QUAD_DEPTH_NAME);
+    vkPipeline* quadEqualPipeline = (vkPipeline*)crenhashtable_lookup(renderer->pipelinesLib, CREN_PIPELINE_QUAD_EQUAL_NAME);
+    if (enabled && (quadDepthPipeline == NULL || quadEqualPipeline == NULL)) {
+        CREN_LOG("CRen: Failed to create the depth prepass pipelines");
+        return 0;
+    }
+
+    CRenTraceValue value = { enabled };
+    cren_trace_write(context, TraceRecord_SetDepthPrepass, &value, sizeof(value));
+    context->createInfo.depthPrepass = enabled;
+    drawlist->prepass = enabled;
+
+    // quads retained before the pipelines existed were submitted without them
+    vkPipeline* quadPipeline = (vkPipeline*)crenhashtable_lookup(renderer->pipelinesLib, CREN_PIPELINE_QUAD_DEFAULT_NAME);
+    for (unsigned int i = 0; enabled && i < drawlist->packetCount; i++) {
+        vkDrawPacket* packet = &drawlist->packets[i];
+        if (packet->pipeline != quadPipeline || packet->depthPipeline != NULL) continue;
+
+        packet->depthPipeline = quadDepthPipeline;
+        packet->equalPipeline = quadEqualPipeline;
+    }
+
+    // the stage pipelines changed, keys and recorded command buffers are stale
+    drawlist->sorted = 0;
+    drawlist->version++;
+    return 1;
+}
+
+int crenvk_renderphase_default_prepass_enabled(CRenContext* context) {
+    CRenVulkanBackend* renderer = (CRenVulkanBackend*)context->backend;
+    return renderer->drawlist.prepass;
 }
 
 /// @brief creates the picking render phase
@@ -1620,8 +3266,9 @@ static void internal_crenvk_renderphase_default_update(vkDefaultRenderphase* pha
 /// @param physicalDevice vulkan physical device
 /// @param format the desired format for each pixel on this phase
 /// @param msaa anti-aliasing sample count
+/// @param dynamic renders with dynamic rendering, no render pass object is created
 /// @return a cren picking render phase
-static vkPickingRenderphase internal_crenvk_renderphase_picking_create(VkDevice device, VkPhysicalDevice physicalDevice, VkFormat format, VkSampleCountFlagBits msaa) {
+static vkPickingRenderphase internal_crenvk_renderphase_picking_create(VkDevice device, VkPhysicalDevice physicalDevice, VkFormat format, VkSampleCountFlagBits msaa, int dynamic) {
     vkPickingRenderphase phase = { 0 };
     phase.renderpass = (vkRenderpass*)crenmemory_allocate(sizeof(vkRenderpass), 1);
 
@@ -1629,6 +3276,10 @@ static vkPickingRenderphase internal_crenvk_renderphase_picking_create(VkDevice
     phase.renderpass->name = "Picking";
     phase.renderpass->msaa = msaa;
     phase.depthFormat = crenvk_find_depth_format(physicalDevice);
+    phase.renderpass->surfaceFormat = phase.surfaceFormat;
+    phase.renderpass->depthFormat = phase.depthFormat;
+    phase.renderpass->dynamic = dynamic;
+    if (dynamic) return phase;
     
     // create render-pass
     VkAttachmentDescription attachments[2] = { 0 };
@@ -1839,6 +3490,9 @@ static int internal_crenvk_renderphase_picking_framebuffers_create(vkPickingRend
 
     crenvk_commandbuffer_end_singletime(device->device, phase->renderpass->commandPool, cmdBuffer, device->graphicsQueue);
 
+    // dynamic rendering begins straight into the images
+    if (phase->renderpass->dynamic) return 1;
+
     // framebuffer
     phase->renderpass->framebufferCount = swapchain->swapchainImageCount;
     phase->renderpass->framebuffers = (VkFramebuffer*)crenmemory_allocate(sizeof(VkFramebuffer) * phase->renderpass->framebufferCount, 1);
@@ -1963,6 +3617,28 @@ static void internal_crenvk_renderphase_picking_recreate(vkPickingRenderphase* p
     internal_crenvk_renderphase_picking_framebuffers_create(phase, device, swapchain);
 }
 
+/// @brief changes the picking render phase sample count, re-creating the renderpass handle, images, framebuffers and pipeline. The vkRenderpass and it's command buffers are kept so references to it stay valid
+/// @param phase cren picking render phase
+/// @param device cren vulkan device
+/// @param swapchain cren vulkan swapchain
+/// @param msaa the new sample count
+/// @param rootPath asset's path for shader look-up
+static void internal_crenvk_renderphase_picking_msaa_change(vkPickingRenderphase* phase, vkDevice* device, vkSwapchain* swapchain, VkSampleCountFlagBits msaa, const char* rootPath) {
+    vkDeviceWaitIdle(device->device);
+
+    crenvk_pipeline_destroy(device->device, phase->pipeline);
+    vkDestroyRenderPass(device->device, phase->renderpass->renderPass, NULL);
+
+    // only the renderpass handle is taken from the newer phase
+    vkPickingRenderphase newer = internal_crenvk_renderphase_picking_create(device->device, device->physicalDevice, phase->surfaceFormat, msaa, phase->renderpass->dynamic);
+    phase->renderpass->renderPass = newer.renderpass->renderPass;
+    phase->renderpass->msaa = msaa;
+    crenmemory_deallocate(newer.renderpass);
+
+    internal_crenvk_renderphase_picking_recreate(phase, device, swapchain);
+    phase->pipeline = internal_crenvk_renderphase_picking_pipeline_create(phase, device->device, 1, rootPath);
+}
+
 /// @brief performs the update of the current frame, effectly calling the rendering callback function who draws the objects
 /// @param phase cren picking render phase
 /// @param context cren context
@@ -1978,8 +3654,18 @@ static void internal_crenvk_renderphase_picking_update(vkPickingRenderphase* pha
     clearValues[1].depthStencil = (VkClearDepthStencilValue) { 1.0f,0 };
 
     VkCommandBuffer cmdBuffer = phase->renderpass->commandBuffers[currentFrame];
-    VkFramebuffer frameBuffer = phase->renderpass->framebuffers[swapchainImageIndex];
-    VkRenderPass renderPass = phase->renderpass->renderPass;
+
+    // retained mode, every picking framebuffer points to the same images so any recording of it is still valid
+    if (internal_crenvk_drawlist_reuse(&renderer->drawlist, phase->renderpass, currentFrame, VK_NULL_HANDLE)) return;
+
+    vkRenderTarget target = { 0 };
+    target.framebuffer = phase->renderpass->dynamic ? VK_NULL_HANDLE : phase->renderpass->framebuffers[swapchainImageIndex];
+    target.extent = renderer->swapchain.swapchainExtent;
+    target.colorImage = phase->colorImage;
+    target.colorView = phase->colorView;
+    target.depthImage = phase->depthImage;
+    target.depthView = phase->depthView;
+    target.finalLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
 
     vkResetCommandBuffer(cmdBuffer, /*VkCommandBufferResetFlagBits*/ 0);
 
@@ -1988,16 +3674,7 @@ static void internal_crenvk_renderphase_picking_update(vkPickingRenderphase* pha
     cmdBeginInfo.pNext = NULL;
     cmdBeginInfo.flags = 0;
     CREN_ASSERT(vkBeginCommandBuffer(cmdBuffer, &cmdBeginInfo) == VK_SUCCESS, "Failed to beging picking renderphase command buffer");
-
-    VkRenderPassBeginInfo renderPassBeginInfo = { 0 };
-    renderPassBeginInfo.sType = VK_STRUCTURE_TYPE_RENDER_PASS_BEGIN_INFO;
-    renderPassBeginInfo.renderPass = renderPass;
-    renderPassBeginInfo.framebuffer = frameBuffer;
-    renderPassBeginInfo.renderArea.offset = (VkOffset2D) { 0, 0 };
-    renderPassBeginInfo.renderArea.extent = renderer->swapchain.swapchainExtent;
-    renderPassBeginInfo.clearValueCount = (unsigned int)CREN_ARRAYSIZE(clearValues);
-    renderPassBeginInfo.pClearValues = clearValues;
-    vkCmdBeginRenderPass(cmdBuffer, &renderPassBeginInfo, VK_SUBPASS_CONTENTS_INLINE);
+    internal_crenvk_renderpass_begin(&renderer->device, phase->renderpass, cmdBuffer, &target, clearValues, (unsigned int)CREN_ARRAYSIZE(clearValues));
 
     // set frame commandbuffer viewport
     VkViewport viewport = { 0 };
@@ -2029,15 +3706,61 @@ static void internal_crenvk_renderphase_picking_update(vkPickingRenderphase* pha
         vkCmdSetScissor(cmdBuffer, 0, 1, &scissor);
     }
 
+    internal_crenvk_drawlist_record(&renderer->drawlist, Picking, currentFrame, cmdBuffer);
+
     if (callback != NULL) {
         callback(context, (CRenRenderStage)Picking, timestep);
     }
 
     // end render pass
-    vkCmdEndRenderPass(cmdBuffer);
+    internal_crenvk_renderpass_end(&renderer->device, phase->renderpass, cmdBuffer, &target);
 
     // end command buffer
     CREN_ASSERT(vkEndCommandBuffer(cmdBuffer) == VK_SUCCESS, "Failed to finish picking renderphase command buffer");
+    internal_crenvk_drawlist_recorded(&renderer->drawlist, phase->renderpass, currentFrame, VK_NULL_HANDLE);
+}
+
+int crenvk_renderphase_picking_enable(CRenContext* context) {
+    CRenVulkanBackend* renderer = (CRenVulkanBackend*)context->backend;
+    vkPickingRenderphase* phase = &renderer->pickingRenderphase;
+    if (phase->renderpass != NULL) return 1;
+
+    VkDevice device = renderer->device.device;
+    const char* rootPath = context->createInfo.assetsRoot;
+
+    int success = 1;
+    *phase = internal_crenvk_renderphase_picking_create(device, renderer->device.physicalDevice, VK_FORMAT_R32G32_UINT, renderer->defaultRenderphase.renderpass->msaa, renderer->device.dynamicRendering);
+    success &= internal_crenvk_renderphase_picking_commandpool_create(phase, &renderer->device);
+    success &= internal_crenvk_renderphase_picking_framebuffers_create(phase, &renderer->device, &renderer->swapchain);
+    phase->pipeline = internal_crenvk_renderphase_picking_pipeline_create(phase, device, 1, rootPath);
+
+    if (!success) {
+        CREN_LOG("CRen: Failed to create the picking render phase");
+        internal_crenvk_renderphase_picking_destroy(phase, device, 1, 1);
+        crenmemory_zero(phase, sizeof(vkPickingRenderphase));
+        return 0;
+    }
+
+    internal_crenvk_pipeline_quad_picking_create(renderer->pipelinesLib, &renderer->pipelineRegistry, phase->renderpass, device, rootPath);
+    context->createInfo.picking = 1;
+    cren_trace_write(context, TraceRecord_PickingEnable, NULL, 0);
+
+    // quads retained before the phase existed were submitted without a picking pipeline
+    vkPipeline* quadPipeline = (vkPipeline*)crenhashtable_lookup(renderer->pipelinesLib, CREN_PIPELINE_QUAD_DEFAULT_NAME);
+    vkPipeline* quadPickingPipeline = (vkPipeline*)crenhashtable_lookup(renderer->pipelinesLib, CREN_PIPELINE_QUAD_PICKING_NAME);
+    for (unsigned int i = 0; i < renderer->drawlist.packetCount; i++) {
+        vkDrawPacket* packet = &renderer->drawlist.packets[i];
+        if (packet->pipeline == quadPipeline && packet->pickingPipeline == NULL) packet->pickingPipeline = quadPickingPipeline;
+    }
+
+    renderer->drawlist.sorted = 0;
+    renderer->drawlist.version++;
+    return 1;
+}
+
+int crenvk_renderphase_picking_enabled(CRenContext* context) {
+    CRenVulkanBackend* renderer = (CRenVulkanBackend*)context->backend;
+    return renderer->pickingRenderphase.renderpass != NULL;
 }
 
 /// @brief creates the ui renderphase, used externally by the user on a UI setup
@@ -2045,14 +3768,19 @@ static void internal_crenvk_renderphase_picking_update(vkPickingRenderphase* pha
 /// @param format vulkan surface format
 /// @param msaa anti-aliasing sample count
 /// @param finalPhase hints if the ui is the last phase, wich it is if active
+/// @param dynamic renders with dynamic rendering, no render pass object is created
+/// @param merged the ui is drawn on the default renderphase second subpass, no render pass object is created
 /// @return tje vkUIRenderphase object
-static vkUIRenderphase internal_crenvk_renderphase_ui_create(VkDevice device, VkFormat format, VkSampleCountFlagBits msaa, int finalPhase) {
+static vkUIRenderphase internal_crenvk_renderphase_ui_create(VkDevice device, VkFormat format, VkSampleCountFlagBits msaa, int finalPhase, int dynamic, int merged) {
     vkUIRenderphase phase = { 0 };
     phase.renderpass = (vkRenderpass*)crenmemory_allocate(sizeof(vkRenderpass), 1);
 
     phase.renderpass->name = "UI";
     phase.renderpass->surfaceFormat = format;
+    phase.renderpass->depthFormat = VK_FORMAT_UNDEFINED;
     phase.renderpass->msaa = msaa;
+    phase.renderpass->dynamic = dynamic;
+    phase.merged = merged;
 
 	VkAttachmentDescription attachment = { 0 };
 	attachment.format = format;
@@ -2089,7 +3817,7 @@ static vkUIRenderphase internal_crenvk_renderphase_ui_create(VkDevice device, Vk
 	info.pSubpasses = &subpass;
 	info.dependencyCount = 1;
 	info.pDependencies = &dependency;
-	CREN_ASSERT(vkCreateRenderPass(device, &info, NULL, &phase.renderpass->renderPass) == VK_SUCCESS, "Failed to create ui renderphase renderpass");
+	if (!dynamic && !merged) CREN_ASSERT(vkCreateRenderPass(device, &info, NULL, &phase.renderpass->renderPass) == VK_SUCCESS, "Failed to create ui renderphase renderpass");
 
 	// ui descriptor set layout, follows ImGui specs
 	VkDescriptorSetLayoutBinding binding[1] = { 0 };
@@ -2193,6 +3921,9 @@ static int internal_crenvk_renderphase_ui_commandpool_create(vkUIRenderphase* ph
 /// @param swapchain cren vulkan swapchain
 /// @return 1 on success, 0 on failure
 static int internal_crenvk_renderphase_ui_framebuffers_create(vkUIRenderphase* phase, vkDevice* device, vkSwapchain* swapchain) {
+	// dynamic rendering begins straight into the swapchain images, merged the default phase framebuffers are used
+	if (phase->renderpass->dynamic || phase->merged) return 1;
+
 	phase->renderpass->framebufferCount = swapchain->swapchainImageCount;
 	phase->renderpass->framebuffers = (VkFramebuffer*)crenmemory_allocate(sizeof(VkFramebuffer) * phase->renderpass->framebufferCount, 1);
     if(!phase->renderpass->framebuffers) return 0;
@@ -2242,8 +3973,15 @@ static void internal_crenvk_renderphase_ui_recreate(vkUIRenderphase* phase,vkDev
 static void internal_crenvk_renderphase_ui_update(vkUIRenderphase* phase, CRenContext* context, unsigned int currentFrame, unsigned int swapchainImageIndex, CRenCallback_DrawUIRawData callback) {
 	CRenVulkanBackend* renderer = (CRenVulkanBackend*)context->backend;
     VkCommandBuffer cmdBuffer = phase->renderpass->commandBuffers[currentFrame];
-	VkFramebuffer frameBuffer = phase->renderpass->framebuffers[swapchainImageIndex];
-	VkRenderPass renderPass = phase->renderpass->renderPass;
+
+	// the ui is drawn over what the previous phases rendered and is the last phase, presenting the image afterwards
+	vkRenderTarget target = { 0 };
+	target.framebuffer = phase->renderpass->dynamic ? VK_NULL_HANDLE : phase->renderpass->framebuffers[swapchainImageIndex];
+	target.extent = renderer->swapchain.swapchainExtent;
+	target.colorImage = renderer->swapchain.swapchainImages[swapchainImageIndex];
+	target.colorView = renderer->swapchain.swapchainImageViews[swapchainImageIndex];
+	target.finalLayout = VK_IMAGE_LAYOUT_PRESENT_SRC_KHR;
+	target.loadColor = 1;
 
 	vkResetCommandBuffer(cmdBuffer, /*VkCommandBufferResetFlagBits*/ 0);
 
@@ -2254,23 +3992,14 @@ static void internal_crenvk_renderphase_ui_update(vkUIRenderphase* phase, CRenCo
 	CREN_ASSERT(vkBeginCommandBuffer(cmdBuffer, &cmdBeginInfo) == VK_SUCCESS, "Failed to begin ui renderphase command buffer");
 
 	VkClearValue clearValue = { 0.0f, 0.0f, 0.0f, 1.0f };
-
-	VkRenderPassBeginInfo renderPassBeginInfo = { 0 };
-	renderPassBeginInfo.sType = VK_STRUCTURE_TYPE_RENDER_PASS_BEGIN_INFO;
-	renderPassBeginInfo.renderPass = renderPass;
-	renderPassBeginInfo.framebuffer = frameBuffer;
-	renderPassBeginInfo.renderArea.offset = (VkOffset2D) { 0, 0 };
-	renderPassBeginInfo.renderArea.extent = renderer->swapchain.swapchainExtent;
-	renderPassBeginInfo.clearValueCount = 1;
-	renderPassBeginInfo.pClearValues = &clearValue;
-	vkCmdBeginRenderPass(cmdBuffer, &renderPassBeginInfo, VK_SUBPASS_CONTENTS_INLINE);
+	internal_crenvk_renderpass_begin(&renderer->device, phase->renderpass, cmdBuffer, &target, &clearValue, 1);
 
 	// render raw data
 	if (callback != NULL) {
 		callback(context, cmdBuffer);
 	}
 
-	vkCmdEndRenderPass(cmdBuffer);
+	internal_crenvk_renderpass_end(&renderer->device, phase->renderpass, cmdBuffer, &target);
 
 	CREN_ASSERT(vkEndCommandBuffer(cmdBuffer) == VK_SUCCESS, "Failed to end ui renderphase command buffer");
 }
@@ -2281,8 +4010,9 @@ static void internal_crenvk_renderphase_ui_update(vkUIRenderphase* phase, CRenCo
 /// @param physicalDevice vulkan physica device
 /// @param surfaceFormat render phase image format
 /// @param msaa anti-aliasing sample count
+/// @param dynamic renders with dynamic rendering, no render pass object is created
 /// @return the vkViewportRenderphase or asserts, since it cannot fail
-static vkViewportRenderphase internal_crenvk_renderphase_viewport_create(VkDevice device, VkPhysicalDevice physicalDevice, VkFormat surfaceFormat, VkSampleCountFlagBits msaa) {
+static vkViewportRenderphase internal_crenvk_renderphase_viewport_create(VkDevice device, VkPhysicalDevice physicalDevice, VkFormat surfaceFormat, VkSampleCountFlagBits msaa, int dynamic) {
 	vkViewportRenderphase phase = { 0 };
 
 	phase.renderpass = (vkRenderpass*)crenmemory_allocate(sizeof(vkRenderpass), 1);
@@ -2290,7 +4020,14 @@ static vkViewportRenderphase internal_crenvk_renderphase_viewport_create(VkDevic
 
 	phase.renderpass->name = "UI";
 	phase.renderpass->surfaceFormat = surfaceFormat;
+	phase.renderpass->depthFormat = crenvk_find_depth_format(physicalDevice);
 	phase.renderpass->msaa = msaa;
+	phase.renderpass->dynamic = dynamic;
+
+	phase.renderScale = 1.0f;
+	phase.resizeThreshold = CREN_VIEWPORT_RESIZE_THRESHOLD;
+	phase.targetFrameTime = 1.0 / 60.0;
+	if (dynamic) return phase;
 
 	const unsigned int attachmentsSize = 2U;
 	VkAttachmentDescription attachments[2] = { 0 };
@@ -2306,10 +4043,10 @@ static vkViewportRenderphase internal_crenvk_renderphase_viewport_create(VkDevic
 	attachments[0].finalLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
 
 	// depth attachment
-	attachments[1].format = crenvk_find_depth_format(physicalDevice);
+	attachments[1].format = phase.renderpass->depthFormat;
 	attachments[1].samples = phase.renderpass->msaa;
 	attachments[1].loadOp = VK_ATTACHMENT_LOAD_OP_CLEAR;
-	attachments[1].storeOp = VK_ATTACHMENT_STORE_OP_STORE;
+	attachments[1].storeOp = VK_ATTACHMENT_STORE_OP_DONT_CARE;
 	attachments[1].stencilLoadOp = VK_ATTACHMENT_LOAD_OP_CLEAR;
 	attachments[1].stencilStoreOp = VK_ATTACHMENT_STORE_OP_DONT_CARE;
 	attachments[1].initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
@@ -2430,59 +4167,45 @@ static int internal_crenvk_renderphase_viewport_commandpool_create(vkViewportRen
     return 1;
 }
 
-/// @brief creates the framebuffers used by the viewport render phase
+/// @brief returns the extent the viewport should be rendered with, given it's panel size and render scale
+/// @param phase viewport render phase
+/// @return the scaled extent, never smaller than 1x1
+static VkExtent2D internal_crenvk_renderphase_viewport_scaled_extent(vkViewportRenderphase* phase) {
+	VkExtent2D extent = { 0 };
+	float width = phase->vpSize.x * phase->renderScale;
+	float height = phase->vpSize.y * phase->renderScale;
+
+	extent.width = width < 1.0f ? 1U : (unsigned int)(width + 0.5f);
+	extent.height = height < 1.0f ? 1U : (unsigned int)(height + 0.5f);
+	return extent;
+}
+
+/// @brief hints the viewport images to be re-allocated if the scaled size has changed more than the threshold
+/// @param phase viewport render phase
+static void internal_crenvk_renderphase_viewport_check_extent(vkViewportRenderphase* phase) {
+	VkExtent2D extent = internal_crenvk_renderphase_viewport_scaled_extent(phase);
+	unsigned int dx = extent.width > phase->renderExtent.width ? extent.width - phase->renderExtent.width : phase->renderExtent.width - extent.width;
+	unsigned int dy = extent.height > phase->renderExtent.height ? extent.height - phase->renderExtent.height : phase->renderExtent.height - extent.height;
+
+	if (dx > phase->resizeThreshold || dy > phase->resizeThreshold) {
+		phase->hint_resize = 1;
+	}
+}
+
+/// @brief creates the images the viewport is rendered into at it's current render extent, the descriptor set the ui samples them with and the framebuffers
 /// @param phase viewport render phase
 /// @param device cren vulkan device
 /// @param swapchain cren vulkan swapchain
 /// @return 1 on success, 0 on failure
-static int internal_crenvk_renderphase_viewport_framebuffers_create(vkViewportRenderphase* phase, vkDevice* device, vkSwapchain* swapchain) {
-	phase->vpSize.x = (float)swapchain->swapchainExtent.width;
-	phase->vpSize.y = (float)swapchain->swapchainExtent.height;
-
+static int internal_crenvk_renderphase_viewport_targets_create(vkViewportRenderphase* phase, vkDevice* device, vkSwapchain* swapchain) {
 	unsigned int imageCount = swapchain->swapchainImageCount;
 	VkFormat depthFormat = crenvk_find_depth_format(device->physicalDevice);
 
-	// descriptor pool
-	VkDescriptorPoolSize poolSizes[] = { { VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, 2 } };
-	VkDescriptorPoolCreateInfo poolCI = { 0 };
-	poolCI.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
-	poolCI.pNext = NULL;
-	poolCI.flags = VK_DESCRIPTOR_POOL_CREATE_FREE_DESCRIPTOR_SET_BIT;
-	poolCI.maxSets = (unsigned int)(2 * CREN_ARRAYSIZE(poolSizes));
-	poolCI.poolSizeCount = (unsigned int)CREN_ARRAYSIZE(poolSizes);
-	poolCI.pPoolSizes = poolSizes;
-	CREN_ASSERT(vkCreateDescriptorPool(device->device, &poolCI, NULL, &phase->descriptorPool) == VK_SUCCESS, "Failed to create vulkan descriptor pool for the viewport render phase");
-
-	// descriptor set layout
-	VkDescriptorSetLayoutBinding binding[1] = { 0 };
-	binding[0].descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
-	binding[0].descriptorCount = 1;
-	binding[0].stageFlags = VK_SHADER_STAGE_FRAGMENT_BIT;
-
-	VkDescriptorSetLayoutCreateInfo info = { 0 };
-	info.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO;
-	info.bindingCount = 1;
-	info.pBindings = binding;
-	CREN_ASSERT(vkCreateDescriptorSetLayout(device->device, &info, NULL, &phase->descriptorSetLayout) == VK_SUCCESS, "Failed to create vulkan descriptor set layout for the viewport render phase");
-
-	// sampler
-	phase->sampler = crenvk_image_sampler_create
-	(
-		device->device,
-		device->physicalDevice,
-		VK_FILTER_LINEAR,
-		VK_FILTER_LINEAR,
-		VK_SAMPLER_ADDRESS_MODE_REPEAT,
-		VK_SAMPLER_ADDRESS_MODE_REPEAT,
-		VK_SAMPLER_ADDRESS_MODE_REPEAT,
-		1.0f
-	);
-
 	// color image
 	crenvk_image_create
 	(
-		swapchain->swapchainExtent.width,
-		swapchain->swapchainExtent.height,
+		phase->renderExtent.width,
+		phase->renderExtent.height,
 		1,
 		1,
 		device->device,
@@ -2502,8 +4225,8 @@ static int internal_crenvk_renderphase_viewport_framebuffers_create(vkViewportRe
 	// depth buffer
 	crenvk_image_create
 	(
-		swapchain->swapchainExtent.width,
-		swapchain->swapchainExtent.height,
+		phase->renderExtent.width,
+		phase->renderExtent.height,
 		1,
 		1,
 		device->device,
@@ -2519,8 +4242,87 @@ static int internal_crenvk_renderphase_viewport_framebuffers_create(vkViewportRe
 	);
 
 	phase->depthView = crenvk_image_view_create(device->device, phase->depthImage, depthFormat, VK_IMAGE_ASPECT_DEPTH_BIT, 1, 1, VK_IMAGE_VIEW_TYPE_2D);
+	phase->descriptorSet = crenvk_image_descriptor_set_create(device->device, phase->descriptorPool, phase->descriptorSetLayout, phase->sampler, phase->colorView);
+
+	// dynamic rendering begins straight into the images
+	if (phase->renderpass->dynamic) return 1;
+
+	// framebuffer
+	phase->renderpass->framebufferCount = swapchain->swapchainImageCount;
+	phase->renderpass->framebuffers = (VkFramebuffer*)crenmemory_allocate(sizeof(VkFramebuffer) * phase->renderpass->framebufferCount, 1);
+
+	for (size_t i = 0; i < imageCount; i++) {
+		const VkImageView attachments[2] = { phase->colorView, phase->depthView };
+
+		VkFramebufferCreateInfo framebufferCI = { 0 };
+		framebufferCI.sType = VK_STRUCTURE_TYPE_FRAMEBUFFER_CREATE_INFO;
+		framebufferCI.renderPass = phase->renderpass->renderPass;
+		framebufferCI.attachmentCount = (unsigned int)CREN_ARRAYSIZE(attachments);
+		framebufferCI.pAttachments = attachments;
+		framebufferCI.width = phase->renderExtent.width;
+		framebufferCI.height = phase->renderExtent.height;
+		framebufferCI.layers = 1;
+		CREN_ASSERT(vkCreateFramebuffer(device->device, &framebufferCI, NULL, &phase->renderpass->framebuffers[i]) == VK_SUCCESS, "Failed to create viewport renderphase framebuffer");
+	}
+
+    return 1;
+}
+
+/// @brief creates the framebuffers used by the viewport render phase
+/// @param phase viewport render phase
+/// @param device cren vulkan device
+/// @param swapchain cren vulkan swapchain
+/// @return 1 on success, 0 on failure
+static int internal_crenvk_renderphase_viewport_framebuffers_create(vkViewportRenderphase* phase, vkDevice* device, vkSwapchain* swapchain) {
+	// until the panel size is informed the viewport covers the entire window
+	if (phase->vpSize.x < 1.0f || phase->vpSize.y < 1.0f) {
+		phase->vpSize.x = (float)swapchain->swapchainExtent.width;
+		phase->vpSize.y = (float)swapchain->swapchainExtent.height;
+	}
+
+	phase->renderExtent = internal_crenvk_renderphase_viewport_scaled_extent(phase);
+	phase->hint_resize = 0;
+
+	// descriptor pool, a resize allocates the new set while the frames in flight may still sample the old ones
+	const unsigned int setCount = CREN_CONCURRENTLY_RENDERED_FRAMES + 1;
+	VkDescriptorPoolSize poolSizes[] = { { VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, setCount } };
+	VkDescriptorPoolCreateInfo poolCI = { 0 };
+	poolCI.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
+	poolCI.pNext = NULL;
+	poolCI.flags = VK_DESCRIPTOR_POOL_CREATE_FREE_DESCRIPTOR_SET_BIT;
+	poolCI.maxSets = setCount;
+	poolCI.poolSizeCount = (unsigned int)CREN_ARRAYSIZE(poolSizes);
+	poolCI.pPoolSizes = poolSizes;
+	CREN_ASSERT(vkCreateDescriptorPool(device->device, &poolCI, NULL, &phase->descriptorPool) == VK_SUCCESS, "Failed to create vulkan descriptor pool for the viewport render phase");
+
+	// descriptor set layout
+	VkDescriptorSetLayoutBinding binding[1] = { 0 };
+	binding[0].descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+	binding[0].descriptorCount = 1;
+	binding[0].stageFlags = VK_SHADER_STAGE_FRAGMENT_BIT;
+
+	VkDescriptorSetLayoutCreateInfo info = { 0 };
+	info.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO;
+	info.bindingCount = 1;
+	info.pBindings = binding;
+	CREN_ASSERT(vkCreateDescriptorSetLayout(device->device, &info, NULL, &phase->descriptorSetLayout) == VK_SUCCESS, "Failed to create vulkan descriptor set layout for the viewport render phase");
+
+	// sampler
+	phase->sampler = crenvk_image_sampler_create
+	(
+		device->device,
+		device->physicalDevice,
+		VK_FILTER_LINEAR,
+		VK_FILTER_LINEAR,
+		VK_SAMPLER_ADDRESS_MODE_REPEAT,
+		VK_SAMPLER_ADDRESS_MODE_REPEAT,
+		VK_SAMPLER_ADDRESS_MODE_REPEAT,
+		1.0f
+	);
 
-	// command buffer
+	internal_crenvk_renderphase_viewport_targets_create(phase, device, swapchain);
+
+	// the ui may sample the image before the first frame renders into it
 	VkCommandBuffer command = crenvk_commandbuffer_begin_singletime(device->device, phase->renderpass->commandPool);
 
 	VkImageSubresourceRange subresourceRange = { 0 };
@@ -2544,43 +4346,63 @@ static int internal_crenvk_renderphase_viewport_framebuffers_create(vkViewportRe
 	);
 
 	crenvk_commandbuffer_end_singletime(device->device, phase->renderpass->commandPool, command, device->graphicsQueue);
+    return 1;
+}
 
-	phase->descriptorSet = crenvk_image_descriptor_set_create(device->device, phase->descriptorPool, phase->descriptorSetLayout, phase->sampler, phase->colorView);
+/// @brief retirement queue adapter for the viewport images replaced by a resize
+/// @param device vulkan device
+/// @param object the retired viewport targets
+static void internal_crenvk_renderphase_viewport_targets_release(VkDevice device, void* object) {
+	vkRetiredViewportTargets* retired = (vkRetiredViewportTargets*)object;
 
-	// framebuffer
-	phase->renderpass->framebufferCount = swapchain->swapchainImageCount;
-	phase->renderpass->framebuffers = (VkFramebuffer*)crenmemory_allocate(sizeof(VkFramebuffer) * phase->renderpass->framebufferCount, 1);
+	for (unsigned int i = 0; i < retired->framebufferCount; i++) {
+		vkDestroyFramebuffer(device, retired->framebuffers[i], NULL);
+	}
+	if (retired->framebuffers) crenmemory_deallocate(retired->framebuffers);
 
-	for (size_t i = 0; i < imageCount; i++) {
-		const VkImageView attachments[2] = { phase->colorView, phase->depthView };
+	vkFreeDescriptorSets(device, retired->descriptorPool, 1, &retired->descriptorSet);
 
-		VkFramebufferCreateInfo framebufferCI = { 0 };
-		framebufferCI.sType = VK_STRUCTURE_TYPE_FRAMEBUFFER_CREATE_INFO;
-		framebufferCI.renderPass = phase->renderpass->renderPass;
-		framebufferCI.attachmentCount = (unsigned int)CREN_ARRAYSIZE(attachments);
-		framebufferCI.pAttachments = attachments;
-		framebufferCI.width = swapchain->swapchainExtent.width;
-		framebufferCI.height = swapchain->swapchainExtent.height;
-		framebufferCI.layers = 1;
-		CREN_ASSERT(vkCreateFramebuffer(device->device, &framebufferCI, NULL, &phase->renderpass->framebuffers[i]) == VK_SUCCESS, "Failed to create viewport renderphase framebuffer");
-	}
+	vkDestroyImageView(device, retired->depthView, NULL);
+	vkDestroyImage(device, retired->depthImage, NULL);
+	vkFreeMemory(device, retired->depthMemory, NULL);
 
-    return 1;
+	vkDestroyImageView(device, retired->colorView, NULL);
+	vkDestroyImage(device, retired->colorImage, NULL);
+	vkFreeMemory(device, retired->colorMemory, NULL);
+	crenmemory_deallocate(retired);
 }
 
-/// @brief recreates the viewport render phase
+/// @brief recreates the viewport images at the current render extent, the old ones are retired instead of waiting for the frames that sample them
 /// @param phase cren viewport render phase
-/// @param device cren vulkan device
-/// @param swapchain cren vulkan swapchain
-static void internal_crenvk_renderphase_viewport_recreate(vkViewportRenderphase* phase, vkDevice* device, vkSwapchain* swapchain) {
-	internal_crenvk_renderphase_viewport_destroy(phase, device->device, 0);
+/// @param context cren context
+static void internal_crenvk_renderphase_viewport_recreate(vkViewportRenderphase* phase, CRenContext* context) {
+	CRenVulkanBackend* renderer = (CRenVulkanBackend*)context->backend;
 
-	for (unsigned int i = 0; i < phase->renderpass->framebufferCount; i++) {
-		vkDestroyFramebuffer(device->device, phase->renderpass->framebuffers[i], NULL);
+	// out of memory, the current images are kept and the resize is tried again next frame
+	vkRetiredViewportTargets* retired = (vkRetiredViewportTargets*)crenmemory_allocate(sizeof(vkRetiredViewportTargets), 1);
+	if (!retired) {
+		cren_set_error(MemoryAllocationFailed);
+		phase->hint_resize = 1;
+		return;
 	}
-	crenmemory_deallocate(phase->renderpass->framebuffers);
 
-	internal_crenvk_renderphase_viewport_framebuffers_create(phase, device, swapchain);
+	retired->colorImage = phase->colorImage;
+	retired->colorMemory = phase->colorMemory;
+	retired->colorView = phase->colorView;
+	retired->depthImage = phase->depthImage;
+	retired->depthMemory = phase->depthMemory;
+	retired->depthView = phase->depthView;
+	retired->framebuffers = phase->renderpass->framebuffers;
+	retired->framebufferCount = phase->renderpass->framebufferCount;
+	retired->descriptorPool = phase->descriptorPool;
+	retired->descriptorSet = phase->descriptorSet;
+	phase->renderpass->framebuffers = NULL;
+	phase->renderpass->framebufferCount = 0;
+
+	phase->renderExtent = internal_crenvk_renderphase_viewport_scaled_extent(phase);
+	phase->hint_resize = 0;
+	internal_crenvk_renderphase_viewport_targets_create(phase, &renderer->device, &renderer->swapchain);
+	crenvk_retire(context, internal_crenvk_renderphase_viewport_targets_release, retired);
 }
 
 // vkDefaultRenderphase* phase, CRenContext* context, unsigned int currentFrame, unsigned int swapchainImageIndex, int usingViewport, double timestep, CRenCallback_Render callback
@@ -2593,8 +4415,18 @@ static void internal_crenvk_renderphase_viewport_update(vkViewportRenderphase* p
 	clearValues[1].depthStencil = (VkClearDepthStencilValue) { 1.0f,  0 };
 
 	VkCommandBuffer cmdBuffer = phase->renderpass->commandBuffers[currentFrame];
-	VkFramebuffer framebuffer = phase->renderpass->framebuffers[swapchainImageIndex];
-	VkRenderPass renderPass = phase->renderpass->renderPass;
+
+	// retained mode, every viewport framebuffer points to the same images so any recording of it is still valid
+	if (internal_crenvk_drawlist_reuse(&renderer->drawlist, phase->renderpass, currentFrame, VK_NULL_HANDLE)) return;
+
+	vkRenderTarget target = { 0 };
+	target.framebuffer = phase->renderpass->dynamic ? VK_NULL_HANDLE : phase->renderpass->framebuffers[swapchainImageIndex];
+	target.extent = phase->renderExtent;
+	target.colorImage = phase->colorImage;
+	target.colorView = phase->colorView;
+	target.depthImage = phase->depthImage;
+	target.depthView = phase->depthView;
+	target.finalLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
 
 	vkResetCommandBuffer(cmdBuffer, /*VkCommandBufferResetFlagBits*/ 0);
 
@@ -2603,23 +4435,14 @@ static void internal_crenvk_renderphase_viewport_update(vkViewportRenderphase* p
 	cmdBeginInfo.pNext = NULL;
 	cmdBeginInfo.flags = 0;
 	CREN_ASSERT(vkBeginCommandBuffer(cmdBuffer, &cmdBeginInfo) == VK_SUCCESS, "Failed to begin viewport renderphase command buffer");
-
-	VkRenderPassBeginInfo renderPassBeginInfo = { 0 };
-	renderPassBeginInfo.sType = VK_STRUCTURE_TYPE_RENDER_PASS_BEGIN_INFO;
-	renderPassBeginInfo.renderPass = renderPass;
-	renderPassBeginInfo.framebuffer = framebuffer;
-	renderPassBeginInfo.renderArea.offset = (VkOffset2D) { 0, 0 };
-	renderPassBeginInfo.renderArea.extent = renderer->swapchain.swapchainExtent;
-	renderPassBeginInfo.clearValueCount = (unsigned int)CREN_ARRAYSIZE(clearValues);
-	renderPassBeginInfo.pClearValues = clearValues;
-	vkCmdBeginRenderPass(cmdBuffer, &renderPassBeginInfo, VK_SUBPASS_CONTENTS_INLINE);
+	internal_crenvk_renderpass_begin(&renderer->device, phase->renderpass, cmdBuffer, &target, clearValues, (unsigned int)CREN_ARRAYSIZE(clearValues));
 
 	// set frame commandbuffer viewport
 	VkViewport viewport = { 0 };
 	viewport.x = 0.0f;
 	viewport.y = 0.0f;
-	viewport.width = (float)renderer->swapchain.swapchainExtent.width;
-	viewport.height = (float)renderer->swapchain.swapchainExtent.height;
+	viewport.width = (float)phase->renderExtent.width;
+	viewport.height = (float)phase->renderExtent.height;
 	viewport.minDepth = 0.0f;
 	viewport.maxDepth = 1.0f;
 	vkCmdSetViewport(cmdBuffer, 0, 1, &viewport);
@@ -2627,77 +4450,3550 @@ static void internal_crenvk_renderphase_viewport_update(vkViewportRenderphase* p
 	// set frame commandbuffer scissor
 	VkRect2D scissor = { 0 };
 	scissor.offset = (VkOffset2D) { 0, 0 };
-	scissor.extent = renderer->swapchain.swapchainExtent;
+	scissor.extent = phase->renderExtent;
 	vkCmdSetScissor(cmdBuffer, 0, 1, &scissor);
 
 	// render objects
+	internal_crenvk_drawlist_record_shaded(&renderer->drawlist, renderer->drawlist.keys, renderer->drawlist.keyCount, 0, currentFrame, cmdBuffer);
 	if (callback != NULL) callback(context, (CRenRenderStage)Default, timestep);
 
-	vkCmdEndRenderPass(cmdBuffer);
+	internal_crenvk_renderpass_end(&renderer->device, phase->renderpass, cmdBuffer, &target);
 
 	// end command buffer
 	CREN_ASSERT(vkEndCommandBuffer(cmdBuffer) == VK_SUCCESS, "Failed to end viewport renderphase command buffer");
+	internal_crenvk_drawlist_recorded(&renderer->drawlist, phase->renderpass, currentFrame, VK_NULL_HANDLE);
 }
 
-/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
-// Core-related
-/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+void crenvk_renderphase_viewport_set_boundaries(CRenContext* context, float2 position, float2 size) {
+	CRenVulkanBackend* renderer = (CRenVulkanBackend*)context->backend;
+	if (!renderer->hint_viewport) return;
 
-int cren_vulkan_init(CRenVulkanBackend *backend, CRenCreateInfo* ci) {
+	// a collapsed/hidden panel, keep the last known size
+	if (size.x < 1.0f || size.y < 1.0f) return;
 
-    backend->hint_viewport = ci->smallerViewport;
+	vkViewportRenderphase* phase = &renderer->viewportRenderphase;
+	phase->vpPosition = position;
+	phase->vpSize = size;
+	phase->vpMin = position;
+	phase->vpMax = (float2){ position.x + size.x, position.y + size.y };
 
-    int success = 1;
-    success &= internal_crenvk_instance_create(&backend->instance, ci->appName, ci->appVersion, ci->apiVersion, ci->validations);
-    success &= internal_crenvk_device_create(backend, ci->nativeWindow, ci->validations);
-    success &= internal_crenvk_swapchain_create(&backend->swapchain, backend->device.device, backend->device.physicalDevice, backend->device.surface, ci->width, ci->height, ci->vsync);
-    // swapchain does not have a pre-defined pipeline
+	internal_crenvk_renderphase_viewport_check_extent(phase);
+}
 
-    backend->defaultRenderphase = internal_crenvk_renderphase_default_create (backend->device.device, backend->device.physicalDevice, backend->swapchain.swapchainFormat.format, (VkSampleCountFlagBits)ci->msaa, 0);
-    success &= internal_crenvk_renderphase_default_commandpool_create(&backend->defaultRenderphase, &backend->device);
-    success &= internal_crenvk_renderphase_default_framebuffers_create(&backend->defaultRenderphase, &backend->device, &backend->swapchain);
-    backend->defaultRenderphase.pipeline = internal_crenvk_renderphase_default_pipeline_create(&backend->defaultRenderphase, backend->device.device, 1, ci->assetsRoot);
+void crenvk_renderphase_viewport_set_render_scale(CRenContext* context, float scale) {
+	CRenVulkanBackend* renderer = (CRenVulkanBackend*)context->backend;
+	if (!renderer->hint_viewport) return;
 
-    backend->pickingRenderphase = internal_crenvk_renderphase_picking_create(backend->device.device, backend->device.physicalDevice, VK_FORMAT_R32G32_UINT, (VkSampleCountFlagBits)ci->msaa);
-    success &= internal_crenvk_renderphase_picking_commandpool_create(&backend->pickingRenderphase, &backend->device);
-    success &= internal_crenvk_renderphase_picking_framebuffers_create(&backend->pickingRenderphase, &backend->device, &backend->swapchain);
-    backend->pickingRenderphase.pipeline = internal_crenvk_renderphase_picking_pipeline_create(&backend->pickingRenderphase, backend->device.device, 1, ci->assetsRoot);
+	vkViewportRenderphase* phase = &renderer->viewportRenderphase;
+	phase->renderScale = f_max(CREN_VIEWPORT_RENDER_SCALE_MIN, f_min(scale, CREN_VIEWPORT_RENDER_SCALE_MAX));
 
-    backend->uiRenderphase = internal_crenvk_renderphase_ui_create(backend->device.device, backend->swapchain.swapchainFormat.format, VK_SAMPLE_COUNT_1_BIT, 1);
-    success &= internal_crenvk_renderphase_ui_commandpool_create(&backend->uiRenderphase, &backend->device);
-    success &= internal_crenvk_renderphase_ui_framebuffers_create(&backend->uiRenderphase, &backend->device, &backend->swapchain);
-    // ui does not have a pre-defined pipeline
+	internal_crenvk_renderphase_viewport_check_extent(phase);
+}
 
-    if(backend->hint_viewport) {
-        backend->viewportRenderphase = internal_crenvk_renderphase_viewport_create(backend->device.device, backend->device.physicalDevice, backend->swapchain.swapchainFormat.format, VK_SAMPLE_COUNT_1_BIT);
-        success &= internal_crenvk_renderphase_viewport_commandpool_create(&backend->viewportRenderphase, &backend->device);
-        success &= internal_crenvk_renderphase_viewport_framebuffers_create(&backend->viewportRenderphase, &backend->device, &backend->swapchain);
-        // viewport does not have a pre-defined pipeline
-    }
+void crenvk_renderphase_viewport_set_auto_scale(CRenContext* context, int enabled, double targetFrameTime) {
+	CRenVulkanBackend* renderer = (CRenVulkanBackend*)context->backend;
+	if (!renderer->hint_viewport) return;
 
-    // buffers
-    backend->buffersLib = crenhashtable_create();
-    crenhashtable_insert(backend->buffersLib, "Camera", crenvk_buffer_create(backend->device.device, backend->device.physicalDevice,  VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, sizeof(vkBufferCamera)));
+	vkViewportRenderphase* phase = &renderer->viewportRenderphase;
+	phase->autoScale = enabled;
+	phase->targetFrameTime = targetFrameTime > 0.0 ? targetFrameTime : 1.0 / 60.0;
+	phase->averageFrameTime = phase->targetFrameTime;
+	phase->autoScaleCooldown = 0;
+}
+
+void crenvk_renderphase_viewport_auto_scale_update(CRenContext* context, double frameTime) {
+	CRenVulkanBackend* renderer = (CRenVulkanBackend*)context->backend;
+	if (!renderer->hint_viewport || !renderer->viewportRenderphase.autoScale) return;
+
+	vkViewportRenderphase* phase = &renderer->viewportRenderphase;
+
+	// exponential moving average smooths single-frame spikes out
+	phase->averageFrameTime += (frameTime - phase->averageFrameTime) * 0.1;
+
+	if (phase->autoScaleCooldown > 0) {
+		phase->autoScaleCooldown--;
+		return;
+	}
+
+	// lower fast when over budget, raise slowly when well under it (hysteresis band between 85% and 105% of the target)
+	float scale = phase->renderScale;
+	if (phase->averageFrameTime > phase->targetFrameTime * 1.05) scale *= 0.9f;
+	else if (phase->averageFrameTime < phase->targetFrameTime * 0.85) scale *= 1.05f;
+	else return;
+
+	// the automatic controller never super-samples
+	scale = f_max(CREN_VIEWPORT_RENDER_SCALE_MIN, f_min(scale, 1.0f));
+	if (scale == phase->renderScale) return;
+
+	phase->renderScale = scale;
+	phase->autoScaleCooldown = 30;
+	internal_crenvk_renderphase_viewport_check_extent(phase);
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// View-related
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+/// @brief creates the renderpass shared by every view, compatible with the main renderpass (same formats and sample count) so the quad pipelines draw on it
+/// @param set the views
+/// @param device cren vulkan device
+/// @param format color format
+/// @param msaa sample count
+/// @return 1 on success, 0 on failure
+static int internal_crenvk_views_renderpass_create(vkViewSet* set, vkDevice* device, VkFormat format, VkSampleCountFlagBits msaa) {
+    set->renderpass = (vkRenderpass*)crenmemory_allocate(sizeof(vkRenderpass), 1);
+    if (set->renderpass == NULL) {
+        cren_set_error(MemoryAllocationFailed);
+        return 0;
+    }
+
+    set->renderpass->name = "View";
+    set->renderpass->surfaceFormat = format;
+    set->renderpass->msaa = msaa;
+    set->renderpass->dynamic = device->dynamicRendering;
+    set->depthFormat = crenvk_find_depth_format(device->physicalDevice);
+    set->renderpass->depthFormat = set->depthFormat;
+    int multisampled = msaa != VK_SAMPLE_COUNT_1_BIT;
+
+    VkAttachmentDescription attachments[3] = { 0 };
+
+    // color, only the resolved copy is kept when multisampled
+    attachments[0].format = format;
+    attachments[0].samples = msaa;
+    attachments[0].loadOp = VK_ATTACHMENT_LOAD_OP_CLEAR;
+    attachments[0].storeOp = multisampled ? VK_ATTACHMENT_STORE_OP_DONT_CARE : VK_ATTACHMENT_STORE_OP_STORE;
+    attachments[0].stencilLoadOp = VK_ATTACHMENT_LOAD_OP_DONT_CARE;
+    attachments[0].stencilStoreOp = VK_ATTACHMENT_STORE_OP_DONT_CARE;
+    attachments[0].initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+    attachments[0].finalLayout = multisampled ? VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL : VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+
+    // depth
+    attachments[1].format = set->depthFormat;
+    attachments[1].samples = msaa;
+    attachments[1].loadOp = VK_ATTACHMENT_LOAD_OP_CLEAR;
+    attachments[1].storeOp = VK_ATTACHMENT_STORE_OP_DONT_CARE;
+    attachments[1].stencilLoadOp = VK_ATTACHMENT_LOAD_OP_CLEAR;
+    attachments[1].stencilStoreOp = VK_ATTACHMENT_STORE_OP_DONT_CARE;
+    attachments[1].initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+    attachments[1].finalLayout = VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL;
+
+    // resolve
+    attachments[2].format = format;
+    attachments[2].samples = VK_SAMPLE_COUNT_1_BIT;
+    attachments[2].loadOp = VK_ATTACHMENT_LOAD_OP_DONT_CARE;
+    attachments[2].storeOp = VK_ATTACHMENT_STORE_OP_STORE;
+    attachments[2].stencilLoadOp = VK_ATTACHMENT_LOAD_OP_DONT_CARE;
+    attachments[2].stencilStoreOp = VK_ATTACHMENT_STORE_OP_DONT_CARE;
+    attachments[2].initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+    attachments[2].finalLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+
+    VkAttachmentReference references[3] = { 0 };
+    references[0].attachment = 0;
+    references[0].layout = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
+    references[1].attachment = 1;
+    references[1].layout = VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL;
+    references[2].attachment = 2;
+    references[2].layout = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
+
+    // single subpass renderpasses ignore resolve attachments when checking compatibility
+    VkSubpassDescription subpass = { 0 };
+    subpass.pipelineBindPoint = VK_PIPELINE_BIND_POINT_GRAPHICS;
+    subpass.colorAttachmentCount = 1;
+    subpass.pColorAttachments = &references[0];
+    subpass.pDepthStencilAttachment = &references[1];
+    subpass.pResolveAttachments = multisampled ? &references[2] : NULL;
+
+    // the ui samples the view image after it's rendered
+    VkSubpassDependency dependencies[3] = { 0 };
+
+    dependencies[0].srcSubpass = VK_SUBPASS_EXTERNAL;
+    dependencies[0].dstSubpass = 0;
+    dependencies[0].srcStageMask = VK_PIPELINE_STAGE_EARLY_FRAGMENT_TESTS_BIT | VK_PIPELINE_STAGE_LATE_FRAGMENT_TESTS_BIT;
+    dependencies[0].dstStageMask = VK_PIPELINE_STAGE_EARLY_FRAGMENT_TESTS_BIT | VK_PIPELINE_STAGE_LATE_FRAGMENT_TESTS_BIT;
+    dependencies[0].srcAccessMask = VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT;
+    dependencies[0].dstAccessMask = VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT | VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_READ_BIT;
+
+    dependencies[1].srcSubpass = VK_SUBPASS_EXTERNAL;
+    dependencies[1].dstSubpass = 0;
+    dependencies[1].srcStageMask = VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT | VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT;
+    dependencies[1].dstStageMask = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT;
+    dependencies[1].srcAccessMask = 0;
+    dependencies[1].dstAccessMask = VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT | VK_ACCESS_COLOR_ATTACHMENT_READ_BIT;
+
+    dependencies[2].srcSubpass = 0;
+    dependencies[2].dstSubpass = VK_SUBPASS_EXTERNAL;
+    dependencies[2].srcStageMask = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT;
+    dependencies[2].dstStageMask = VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT;
+    dependencies[2].srcAccessMask = VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT;
+    dependencies[2].dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
+
+    VkRenderPassCreateInfo renderPassCI = { 0 };
+    renderPassCI.sType = VK_STRUCTURE_TYPE_RENDER_PASS_CREATE_INFO;
+    renderPassCI.attachmentCount = multisampled ? 3U : 2U;
+    renderPassCI.pAttachments = attachments;
+    renderPassCI.subpassCount = 1;
+    renderPassCI.pSubpasses = &subpass;
+    renderPassCI.dependencyCount = 3U;
+    renderPassCI.pDependencies = dependencies;
+    if (!set->renderpass->dynamic && vkCreateRenderPass(device->device, &renderPassCI, NULL, &set->renderpass->renderPass) != VK_SUCCESS) {
+        CREN_LOG("CRen: Failed to create the view renderpass");
+        crenvk_renderpass_destroy(device->device, set->renderpass);
+        set->renderpass = NULL;
+        return 0;
+    }
+
+    // views allocate their own command buffers from it
+    vkQueueFamilyIndices indices = internal_crenvk_find_queue_families(device->physicalDevice, device->surface);
+    VkCommandPoolCreateInfo cmdPoolInfo = { 0 };
+    cmdPoolInfo.sType = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO;
+    cmdPoolInfo.queueFamilyIndex = indices.graphicFamily;
+    cmdPoolInfo.flags = VK_COMMAND_POOL_CREATE_RESET_COMMAND_BUFFER_BIT;
+    if (vkCreateCommandPool(device->device, &cmdPoolInfo, NULL, &set->renderpass->commandPool) != VK_SUCCESS) {
+        cren_set_error(Vulkan_CommandPoolCreationFailed);
+        crenvk_renderpass_destroy(device->device, set->renderpass);
+        set->renderpass = NULL;
+        return 0;
+    }
+
+    return 1;
+}
+
+/// @brief creates what every view samples it's image with, only done once
+/// @param set the views
+/// @param device cren vulkan device
+/// @return 1 on success, 0 on failure
+static int internal_crenvk_views_descriptors_create(vkViewSet* set, vkDevice* device) {
+    if (set->descriptorPool != VK_NULL_HANDLE) return 1;
+
+    // resized and destroyed views hold their previous set until the frames in flight are done with it
+    VkDescriptorPoolSize poolSizes[] = { { VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, CREN_VIEWS_MAX * (CREN_CONCURRENTLY_RENDERED_FRAMES + 1) } };
+    VkDescriptorPoolCreateInfo poolCI = { 0 };
+    poolCI.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
+    poolCI.flags = VK_DESCRIPTOR_POOL_CREATE_FREE_DESCRIPTOR_SET_BIT;
+    poolCI.maxSets = CREN_VIEWS_MAX * (CREN_CONCURRENTLY_RENDERED_FRAMES + 1);
+    poolCI.poolSizeCount = (unsigned int)CREN_ARRAYSIZE(poolSizes);
+    poolCI.pPoolSizes = poolSizes;
+    if (vkCreateDescriptorPool(device->device, &poolCI, NULL, &set->descriptorPool) != VK_SUCCESS) {
+        CREN_LOG("CRen: Failed to create the view descriptor pool");
+        return 0;
+    }
+
+    VkDescriptorSetLayoutBinding binding = { 0 };
+    binding.descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+    binding.descriptorCount = 1;
+    binding.stageFlags = VK_SHADER_STAGE_FRAGMENT_BIT;
+
+    VkDescriptorSetLayoutCreateInfo layoutCI = { 0 };
+    layoutCI.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO;
+    layoutCI.bindingCount = 1;
+    layoutCI.pBindings = &binding;
+    if (vkCreateDescriptorSetLayout(device->device, &layoutCI, NULL, &set->descriptorSetLayout) != VK_SUCCESS) {
+        CREN_LOG("CRen: Failed to create the view descriptor set layout");
+        return 0;
+    }
+
+    set->sampler = crenvk_image_sampler_create(device->device, device->physicalDevice, VK_FILTER_LINEAR, VK_FILTER_LINEAR, VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE, VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE, VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE, 1.0f);
+    return 1;
+}
+
+/// @brief destroys a view images, framebuffer and descriptor set. The gpu must not be using them
+/// @param set the views
+/// @param device vulkan device
+/// @param view the view
+static void internal_crenvk_view_targets_destroy(vkViewSet* set, VkDevice device, vkView* view) {
+    if (view->descriptorSet != VK_NULL_HANDLE) vkFreeDescriptorSets(device, set->descriptorPool, 1, &view->descriptorSet);
+    if (view->framebuffer != VK_NULL_HANDLE) vkDestroyFramebuffer(device, view->framebuffer, NULL);
+
+    VkImageView views[3] = { view->colorView, view->resolveView, view->depthView };
+    VkImage images[3] = { view->colorImage, view->resolveImage, view->depthImage };
+    VkDeviceMemory memories[3] = { view->colorMemory, view->resolveMemory, view->depthMemory };
+    for (unsigned int i = 0; i < 3; i++) {
+        if (views[i] != VK_NULL_HANDLE) vkDestroyImageView(device, views[i], NULL);
+        if (images[i] != VK_NULL_HANDLE) vkDestroyImage(device, images[i], NULL);
+        if (memories[i] != VK_NULL_HANDLE) vkFreeMemory(device, memories[i], NULL);
+    }
+
+    view->descriptorSet = VK_NULL_HANDLE;
+    view->framebuffer = VK_NULL_HANDLE;
+    view->colorView = view->resolveView = view->depthView = VK_NULL_HANDLE;
+    view->colorImage = view->resolveImage = view->depthImage = VK_NULL_HANDLE;
+    view->colorMemory = view->resolveMemory = view->depthMemory = VK_NULL_HANDLE;
+}
+
+/// @brief retirement queue adapter for view targets, releases the images, framebuffer, descriptor set and command buffers of a resized or destroyed view
+/// @param device vulkan device
+/// @param object the retired targets
+static void internal_crenvk_view_targets_release(VkDevice device, void* object) {
+    vkRetiredViewTargets* retired = (vkRetiredViewTargets*)object;
+
+    if (retired->commandBuffers[0] != VK_NULL_HANDLE) vkFreeCommandBuffers(device, retired->commandPool, CREN_CONCURRENTLY_RENDERED_FRAMES, retired->commandBuffers);
+    if (retired->descriptorSet != VK_NULL_HANDLE) vkFreeDescriptorSets(device, retired->descriptorPool, 1, &retired->descriptorSet);
+    if (retired->framebuffer != VK_NULL_HANDLE) vkDestroyFramebuffer(device, retired->framebuffer, NULL);
+
+    for (unsigned int i = 0; i < 3; i++) {
+        if (retired->views[i] != VK_NULL_HANDLE) vkDestroyImageView(device, retired->views[i], NULL);
+        if (retired->images[i] != VK_NULL_HANDLE) vkDestroyImage(device, retired->images[i], NULL);
+        if (retired->memories[i] != VK_NULL_HANDLE) vkFreeMemory(device, retired->memories[i], NULL);
+    }
+
+    crenmemory_deallocate(retired);
+}
+
+/// @brief hands a view images, framebuffer and descriptor set to the retirement queue, the frames in flight may still be rendering or sampling them
+/// @param context cren context
+/// @param view the view, it's targets are left empty
+/// @param commandBuffers also retires the view command buffers, used when the view is destroyed
+static void internal_crenvk_view_targets_retire(CRenContext* context, vkView* view, int commandBuffers) {
+    CRenVulkanBackend* renderer = (CRenVulkanBackend*)context->backend;
+    vkViewSet* set = &renderer->viewSet;
+
+    vkRetiredViewTargets* retired = (vkRetiredViewTargets*)crenmemory_allocate(sizeof(vkRetiredViewTargets), 1);
+    if (retired == NULL) {
+        cren_set_error(MemoryAllocationFailed);
+        vkDeviceWaitIdle(renderer->device.device);
+        internal_crenvk_view_targets_destroy(set, renderer->device.device, view);
+        if (commandBuffers && view->commandBuffers[0] != VK_NULL_HANDLE) vkFreeCommandBuffers(renderer->device.device, set->renderpass->commandPool, CREN_CONCURRENTLY_RENDERED_FRAMES, view->commandBuffers);
+        if (commandBuffers) crenmemory_zero(view->commandBuffers, sizeof(view->commandBuffers));
+        return;
+    }
+
+    retired->images[0] = view->colorImage;
+    retired->images[1] = view->resolveImage;
+    retired->images[2] = view->depthImage;
+    retired->memories[0] = view->colorMemory;
+    retired->memories[1] = view->resolveMemory;
+    retired->memories[2] = view->depthMemory;
+    retired->views[0] = view->colorView;
+    retired->views[1] = view->resolveView;
+    retired->views[2] = view->depthView;
+    retired->framebuffer = view->framebuffer;
+    retired->descriptorPool = set->descriptorPool;
+    retired->descriptorSet = view->descriptorSet;
+
+    if (commandBuffers) {
+        retired->commandPool = set->renderpass->commandPool;
+        crenmemory_copy(retired->commandBuffers, view->commandBuffers, sizeof(view->commandBuffers));
+        crenmemory_zero(view->commandBuffers, sizeof(view->commandBuffers));
+    }
+
+    view->descriptorSet = VK_NULL_HANDLE;
+    view->framebuffer = VK_NULL_HANDLE;
+    view->colorView = view->resolveView = view->depthView = VK_NULL_HANDLE;
+    view->colorImage = view->resolveImage = view->depthImage = VK_NULL_HANDLE;
+    view->colorMemory = view->resolveMemory = view->depthMemory = VK_NULL_HANDLE;
+    crenvk_retire(context, internal_crenvk_view_targets_release, retired);
+}
+
+/// @brief creates a view images, framebuffer and descriptor set with the view extent
+/// @param set the views
+/// @param device cren vulkan device
+/// @param view the view
+/// @return 1 on success, 0 on failure
+static int internal_crenvk_view_targets_create(vkViewSet* set, vkDevice* device, vkView* view) {
+    vkRenderpass* renderpass = set->renderpass;
+    int multisampled = renderpass->msaa != VK_SAMPLE_COUNT_1_BIT;
+    int success = 1;
+
+    VkImageUsageFlags colorUsage = multisampled ? VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT | VK_IMAGE_USAGE_TRANSIENT_ATTACHMENT_BIT : VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT | VK_IMAGE_USAGE_SAMPLED_BIT;
+    success &= crenvk_image_create(view->extent.width, view->extent.height, 1, 1, device->device, device->physicalDevice, &view->colorImage, &view->colorMemory, renderpass->surfaceFormat, renderpass->msaa, VK_IMAGE_TILING_OPTIMAL, colorUsage, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, 0);
+    success &= crenvk_image_create(view->extent.width, view->extent.height, 1, 1, device->device, device->physicalDevice, &view->depthImage, &view->depthMemory, set->depthFormat, renderpass->msaa, VK_IMAGE_TILING_OPTIMAL, VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, 0);
+    if (multisampled) success &= crenvk_image_create(view->extent.width, view->extent.height, 1, 1, device->device, device->physicalDevice, &view->resolveImage, &view->resolveMemory, renderpass->surfaceFormat, VK_SAMPLE_COUNT_1_BIT, VK_IMAGE_TILING_OPTIMAL, VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT | VK_IMAGE_USAGE_SAMPLED_BIT, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, 0);
+
+    if (!success) {
+        CREN_LOG("CRen: Failed to create the view images");
+        internal_crenvk_view_targets_destroy(set, device->device, view);
+        return 0;
+    }
+
+    view->colorView = crenvk_image_view_create(device->device, view->colorImage, renderpass->surfaceFormat, VK_IMAGE_ASPECT_COLOR_BIT, 1, 1, VK_IMAGE_VIEW_TYPE_2D);
+    view->depthView = crenvk_image_view_create(device->device, view->depthImage, set->depthFormat, VK_IMAGE_ASPECT_DEPTH_BIT, 1, 1, VK_IMAGE_VIEW_TYPE_2D);
+    if (multisampled) view->resolveView = crenvk_image_view_create(device->device, view->resolveImage, renderpass->surfaceFormat, VK_IMAGE_ASPECT_COLOR_BIT, 1, 1, VK_IMAGE_VIEW_TYPE_2D);
+
+    // dynamic rendering begins straight into the images
+    const VkImageView attachments[3] = { view->colorView, view->depthView, view->resolveView };
+    VkFramebufferCreateInfo framebufferCI = { 0 };
+    framebufferCI.sType = VK_STRUCTURE_TYPE_FRAMEBUFFER_CREATE_INFO;
+    framebufferCI.renderPass = renderpass->renderPass;
+    framebufferCI.attachmentCount = multisampled ? 3U : 2U;
+    framebufferCI.pAttachments = attachments;
+    framebufferCI.width = view->extent.width;
+    framebufferCI.height = view->extent.height;
+    framebufferCI.layers = 1;
+    if (!renderpass->dynamic && vkCreateFramebuffer(device->device, &framebufferCI, NULL, &view->framebuffer) != VK_SUCCESS) {
+        CREN_LOG("CRen: Failed to create the view framebuffer");
+        internal_crenvk_view_targets_destroy(set, device->device, view);
+        return 0;
+    }
+
+    // the ui may sample a disabled view before it was ever rendered
+    VkImage sampledImage = multisampled ? view->resolveImage : view->colorImage;
+    VkImageSubresourceRange subresourceRange = { 0 };
+    subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+    subresourceRange.levelCount = 1;
+    subresourceRange.layerCount = 1;
+
+    VkCommandBuffer command = crenvk_commandbuffer_begin_singletime(device->device, renderpass->commandPool);
+    crenvk_image_memory_barrier_insert(command, sampledImage, 0, VK_ACCESS_SHADER_READ_BIT, VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT, subresourceRange);
+    crenvk_commandbuffer_end_singletime(device->device, renderpass->commandPool, command, device->graphicsQueue);
+
+    view->descriptorSet = crenvk_image_descriptor_set_create(device->device, set->descriptorPool, set->descriptorSetLayout, set->sampler, multisampled ? view->resolveView : view->colorView);
+
+    // whatever was recorded points to the old framebuffer
+    view->listVersion++;
+    return 1;
+}
+
+/// @brief allocates a view command buffers from the views command pool
+/// @param set the views
+/// @param device vulkan device
+/// @param view the view
+/// @return 1 on success, 0 on failure
+static int internal_crenvk_view_commandbuffers_create(vkViewSet* set, VkDevice device, vkView* view) {
+    VkCommandBufferAllocateInfo cmdBufferAllocInfo = { 0 };
+    cmdBufferAllocInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
+    cmdBufferAllocInfo.commandPool = set->renderpass->commandPool;
+    cmdBufferAllocInfo.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
+    cmdBufferAllocInfo.commandBufferCount = CREN_CONCURRENTLY_RENDERED_FRAMES;
+    if (vkAllocateCommandBuffers(device, &cmdBufferAllocInfo, view->commandBuffers) != VK_SUCCESS) {
+        cren_set_error(Vulkan_CommandBufferAllocationFailed);
+        return 0;
+    }
+
+    return 1;
+}
+
+/// @brief releases everything a view holds and frees it's slot
+/// @param set the views
+/// @param device vulkan device
+/// @param view the view
+static void internal_crenvk_view_release(vkViewSet* set, VkDevice device, vkView* view) {
+    internal_crenvk_view_targets_destroy(set, device, view);
+    if (view->commandBuffers[0] != VK_NULL_HANDLE) vkFreeCommandBuffers(device, set->renderpass->commandPool, CREN_CONCURRENTLY_RENDERED_FRAMES, view->commandBuffers);
+    if (view->keys) crenmemory_deallocate(view->keys);
+    if (view->scratch) crenmemory_deallocate(view->scratch);
+    crenmemory_zero(view, sizeof(vkView));
+}
+
+/// @brief destroys every view and what they share
+/// @param renderer cren vulkan backend
+static void internal_crenvk_views_destroy(CRenVulkanBackend* renderer) {
+    vkViewSet* set = &renderer->viewSet;
+    VkDevice device = renderer->device.device;
+
+    for (unsigned int i = 1; i < CREN_VIEWS_MAX; i++) {
+        if (set->views[i].used) internal_crenvk_view_release(set, device, &set->views[i]);
+    }
+
+    if (set->renderpass != NULL) crenvk_renderpass_destroy(device, set->renderpass);
+    if (set->sampler != VK_NULL_HANDLE) vkDestroySampler(device, set->sampler, NULL);
+    if (set->descriptorPool != VK_NULL_HANDLE) vkDestroyDescriptorPool(device, set->descriptorPool, NULL);
+    if (set->descriptorSetLayout != VK_NULL_HANDLE) vkDestroyDescriptorSetLayout(device, set->descriptorSetLayout, NULL);
+    crenmemory_zero(set, sizeof(vkViewSet));
+}
+
+/// @brief re-creates the views renderpass and images with the main renderpass new sample count
+/// @param renderer cren vulkan backend
+/// @param msaa new sample count
+static void internal_crenvk_views_msaa_change(CRenVulkanBackend* renderer, VkSampleCountFlagBits msaa) {
+    vkViewSet* set = &renderer->viewSet;
+    if (set->renderpass == NULL || set->renderpass->msaa == msaa) return;
+
+    VkDevice device = renderer->device.device;
+    VkFormat format = set->renderpass->surfaceFormat;
+    vkDeviceWaitIdle(device);
+
+    // retired view command buffers go back into the pool about to be destroyed
+    internal_crenvk_retirement_collect(&renderer->retirement, device, 1);
+
+    // command buffers go away with the pool
+    for (unsigned int i = 1; i < CREN_VIEWS_MAX; i++) {
+        if (!set->views[i].used) continue;
+        internal_crenvk_view_targets_destroy(set, device, &set->views[i]);
+        crenmemory_zero(set->views[i].commandBuffers, sizeof(set->views[i].commandBuffers));
+    }
+
+    crenvk_renderpass_destroy(device, set->renderpass);
+    set->renderpass = NULL;
+    if (!internal_crenvk_views_renderpass_create(set, &renderer->device, format, msaa)) return;
+
+    for (unsigned int i = 1; i < CREN_VIEWS_MAX; i++) {
+        vkView* view = &set->views[i];
+        if (!view->used) continue;
+
+        // a view that can't be re-created stays disabled
+        if (!internal_crenvk_view_commandbuffers_create(set, device, view) || !internal_crenvk_view_targets_create(set, &renderer->device, view)) {
+            view->enabled = 0;
+        }
+    }
+}
+
+/// @brief extracts the normalized frustum planes of a camera, pointing inwards
+/// @param viewProj the camera projection times it's view (without the vulkan y flip)
+/// @param planes output planes, xyz is the normal and w the distance
+static void internal_crenvk_view_frustum_planes(const mat4* viewProj, float4 planes[6]) {
+    // planes are sums/differences of the matrix rows, the near one is the opengl one which also contains the zero-to-one depth range
+    for (unsigned int i = 0; i < 3; i++) {
+        for (unsigned int j = 0; j < 4; j++) {
+            planes[i * 2 + 0].data[j] = viewProj->data[j][3] + viewProj->data[j][i];
+            planes[i * 2 + 1].data[j] = viewProj->data[j][3] - viewProj->data[j][i];
+        }
+    }
+
+    for (unsigned int i = 0; i < 6; i++) {
+        float length = float3_length((float3) { planes[i].x, planes[i].y, planes[i].z });
+        if (length > EPSILON_ZERO) planes[i] = float4_scalar(planes[i], 1.0f / length);
+    }
+}
+
+/// @brief computes what every enabled view (and the main camera) sees on a single pass over the draw list, packets are tested against every frustum while their bounds are at hand
+/// nothing is computed if neither the draw list nor any camera changed since the last pass
+/// @param renderer cren vulkan backend
+/// @param mainCamera the context main camera
+static void internal_crenvk_views_cull(CRenVulkanBackend* renderer, const CRenCamera* mainCamera) {
+    vkViewSet* set = &renderer->viewSet;
+    vkDrawlist* drawlist = &renderer->drawlist;
+
+    vkView* active[CREN_VIEWS_MAX] = { 0 };
+    unsigned int activeCount = 0;
+    unsigned int activeMask = 0;
+    int changed = set->culledVersion != drawlist->version;
+
+    for (unsigned int i = 0; i < CREN_VIEWS_MAX; i++) {
+        vkView* view = &set->views[i];
+        if (i > 0 && (!view->used || !view->enabled)) continue;
+
+        const CRenCamera* camera = i == 0 ? mainCamera : &view->camera;
+        mat4 viewProj = mat4_mul(camera->view, camera->perspective);
+        if (crenmemory_compare(&view->culledViewProj, &viewProj, sizeof(mat4)) != 0) {
+            view->culledViewProj = viewProj;
+            internal_crenvk_view_frustum_planes(&viewProj, view->planes);
+            changed = 1;
+        }
+
+        active[activeCount++] = view;
+        activeMask |= 1U << i;
+    }
+
+    if (!changed) return;
+
+    unsigned long long hashes[CREN_VIEWS_MAX];
+    unsigned int counts[CREN_VIEWS_MAX] = { 0 };
+    for (unsigned int i = 0; i < activeCount; i++) hashes[i] = CREN_HASH_SEED;
+
+    for (unsigned int p = 0; p < drawlist->packetCount; p++) {
+        const vkDrawPacket* packet = &drawlist->packets[p];
+        unsigned int mask = activeMask;
+
+        if (packet->radius > 0.0f) {
+            const mat4* model = &packet->model;
+            float3 center = { model->data[3][0], model->data[3][1], model->data[3][2] };
+
+            // the sphere grows with the largest axis scale
+            float3 axes[3];
+            float largest = 0.0f;
+            unsigned int largestAxis = 0;
+            for (unsigned int a = 0; a < 3; a++) {
+                axes[a] = (float3) { model->data[a][0], model->data[a][1], model->data[a][2] };
+                float lengthSq = axes[a].x * axes[a].x + axes[a].y * axes[a].y + axes[a].z * axes[a].z;
+                if (lengthSq > largest) { largest = lengthSq; largestAxis = a; }
+            }
+            float radius = packet->radius * float3_length(axes[largestAxis]);
+
+            mask = 0;
+            for (unsigned int v = 0; v < activeCount; v++) {
+                const float4* planes = active[v]->planes;
+                unsigned int inside = 1;
+                for (unsigned int i = 0; i < 6 && inside; i++) {
+                    inside = planes[i].x * center.x + planes[i].y * center.y + planes[i].z * center.z + planes[i].w >= -radius;
+                }
+                if (inside) mask |= 1U << active[v]->index;
+            }
+        }
+
+        drawlist->visibility[p] = mask;
+        for (unsigned int v = 0; v < activeCount; v++) {
+            if ((mask & (1U << active[v]->index)) == 0) continue;
+            hashes[v] = internal_crenvk_hash(hashes[v], &p, sizeof(p));
+            counts[v]++;
+        }
+    }
+
+    for (unsigned int v = 0; v < activeCount; v++) {
+        // the main phases are recorded again only when what the main camera sees has changed
+        if (active[v]->index == 0 && (active[v]->visibleHash != hashes[v] || active[v]->visibleCount != counts[v])) drawlist->version++;
+        active[v]->visibleHash = hashes[v];
+        active[v]->visibleCount = counts[v];
+    }
+
+    set->culledVersion = drawlist->version;
+}
+
+/// @brief builds the sorted list of the packets a view sees, keys are built with the view's own depth
+/// @param drawlist the frame's draw list, already sorted
+/// @param view the view
+/// @return 1 on success, 0 if the list couldn't grow
+static int internal_crenvk_view_sort(vkDrawlist* drawlist, vkView* view) {
+    // visible packets may also be on the prepass
+    unsigned int capacity = view->visibleCount * 2;
+    if (capacity > view->keyCapacity) {
+        vkDrawKey* keys = (vkDrawKey*)crenmemory_reallocate(view->keys, sizeof(vkDrawKey) * capacity);
+        if (!keys) return 0;
+        view->keys = keys;
+
+        vkDrawKey* scratch = (vkDrawKey*)crenmemory_reallocate(view->scratch, sizeof(vkDrawKey) * capacity);
+        if (!scratch) return 0;
+        view->scratch = scratch;
+
+        view->keyCapacity = capacity;
+    }
+
+    const CRenRenderStage stages[] = { Default, Prepass };
+    unsigned int viewBit = 1U << view->index;
+    view->keyCount = 0;
+
+    for (unsigned int i = 0; i < drawlist->packetCount; i++) {
+        vkDrawPacket* packet = &drawlist->packets[i];
+        if ((drawlist->visibility[i] & viewBit) == 0) continue;
+
+        float depth = internal_crenvk_drawlist_depth(&view->camera.view, &packet->model);
+        for (unsigned int s = 0; s < (unsigned int)CREN_ARRAYSIZE(stages) && view->keyCount < view->keyCapacity; s++) {
+            vkPipeline* pipeline = internal_crenvk_drawlist_stage_pipeline(drawlist, packet, stages[s]);
+            if (pipeline == NULL) continue;
+
+            view->keys[view->keyCount].key = internal_crenvk_drawlist_make_key(drawlist, stages[s], pipeline, packet->descriptorSets[0], depth);
+            view->keys[view->keyCount].packet = i;
+            view->keyCount++;
+        }
+    }
+
+    internal_crenvk_drawlist_radix_sort(&view->keys, &view->scratch, view->keyCount);
+    view->sortedVersion = drawlist->version;
+    view->sortedHash = view->visibleHash;
+    view->sortedView = view->camera.view;
+    view->listVersion++;
+    return 1;
+}
+
+/// @brief picks the list a view records, a view seeing the same packets as the main camera or a previous view records their list instead of sorting it's own
+/// lists are only shared without blended packets, since their order depends on the camera and opaque ones only lose the front-to-back order
+/// @param renderer cren vulkan backend
+/// @param view the view
+/// @return 1 on success, 0 if the view's own list couldn't be built
+static int internal_crenvk_view_prepare(CRenVulkanBackend* renderer, vkView* view) {
+    vkViewSet* set = &renderer->viewSet;
+    vkDrawlist* drawlist = &renderer->drawlist;
+    unsigned int owner = view->index;
+
+    if (!drawlist->hasBlended) {
+        for (unsigned int i = 0; i < view->index; i++) {
+            vkView* other = &set->views[i];
+            if (i > 0 && (!other->used || !other->enabled || other->listOwner != i)) continue;
+            if (other->visibleHash != view->visibleHash || other->visibleCount != view->visibleCount) continue;
+
+            owner = i;
+            break;
+        }
+    }
+
+    if (owner != view->listOwner) {
+        view->listOwner = owner;
+        view->listVersion++;
+    }
+
+    if (owner != view->index) {
+        set->sharedLists++;
+        return 1;
+    }
+
+    int moved = crenmemory_compare(&view->sortedView, &view->camera.view, sizeof(mat4)) != 0;
+    if (view->sortedVersion == drawlist->version && view->sortedHash == view->visibleHash && (!drawlist->hasBlended || !moved)) return 1;
+    return internal_crenvk_view_sort(drawlist, view);
+}
+
+/// @brief records every enabled view into it's command buffer, on retained mode views whose list didn't change re-submit their previous recording
+/// @param renderer cren vulkan backend
+/// @param currentFrame current frame in flight
+/// @param cmdBuffers output command buffers, room for CREN_VIEWS_MAX - 1
+/// @return how many command buffers were written
+static unsigned int internal_crenvk_views_record(CRenVulkanBackend* renderer, unsigned int currentFrame, VkCommandBuffer* cmdBuffers) {
+    vkViewSet* set = &renderer->viewSet;
+    vkDrawlist* drawlist = &renderer->drawlist;
+    unsigned int count = 0;
+
+    set->sharedLists = 0;
+    if (set->renderpass == NULL) return 0;
+
+    for (unsigned int i = 1; i < CREN_VIEWS_MAX; i++) {
+        vkView* view = &set->views[i];
+        if (!view->used || !view->enabled) continue;
+        if (!internal_crenvk_view_prepare(renderer, view)) continue;
+
+        VkCommandBuffer cmdBuffer = view->commandBuffers[currentFrame];
+        cmdBuffers[count++] = cmdBuffer;
+
+        // shared lists change with their owner
+        vkView* owner = &set->views[view->listOwner];
+        unsigned long long listVersion = view->listOwner == i ? view->listVersion : view->listVersion + owner->listVersion;
+        if (drawlist->retained && view->recordedVersion[currentFrame] == drawlist->version && view->recordedListVersion[currentFrame] == listVersion) continue;
+
+        vkResetCommandBuffer(cmdBuffer, 0);
+
+        VkCommandBufferBeginInfo cmdBeginInfo = { 0 };
+        cmdBeginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+        CREN_ASSERT(vkBeginCommandBuffer(cmdBuffer, &cmdBeginInfo) == VK_SUCCESS, "Failed to begin view command buffer");
+
+        VkClearValue clearValues[2] = { 0 };
+        clearValues[0].color = (VkClearColorValue) { 0.0f, 0.0f, 0.0f, 1.0f };
+        clearValues[1].depthStencil = (VkClearDepthStencilValue) { 1.0f, 0 };
+
+        // the ui samples the view image after it's rendered
+        vkRenderTarget target = { 0 };
+        target.framebuffer = view->framebuffer;
+        target.extent = view->extent;
+        target.colorImage = view->colorImage;
+        target.colorView = view->colorView;
+        target.resolveImage = view->resolveImage;
+        target.resolveView = view->resolveView;
+        target.depthImage = view->depthImage;
+        target.depthView = view->depthView;
+        target.finalLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+        internal_crenvk_renderpass_begin(&renderer->device, set->renderpass, cmdBuffer, &target, clearValues, (unsigned int)CREN_ARRAYSIZE(clearValues));
+
+        VkViewport viewport = { 0 };
+        viewport.width = (float)view->extent.width;
+        viewport.height = (float)view->extent.height;
+        viewport.maxDepth = 1.0f;
+        vkCmdSetViewport(cmdBuffer, 0, 1, &viewport);
+
+        VkRect2D scissor = { 0 };
+        scissor.extent = view->extent;
+        vkCmdSetScissor(cmdBuffer, 0, 1, &scissor);
+
+        // the main camera list holds every stage, only it's prepass and default ones are recorded
+        if (view->listOwner == 0) internal_crenvk_drawlist_record_shaded(drawlist, drawlist->keys, drawlist->keyCount, i, currentFrame, cmdBuffer);
+        else internal_crenvk_drawlist_record_shaded(drawlist, owner->keys, owner->keyCount, i, currentFrame, cmdBuffer);
+
+        internal_crenvk_renderpass_end(&renderer->device, set->renderpass, cmdBuffer, &target);
+        CREN_ASSERT(vkEndCommandBuffer(cmdBuffer) == VK_SUCCESS, "Failed to end view command buffer");
+
+        view->recordedVersion[currentFrame] = drawlist->version;
+        view->recordedListVersion[currentFrame] = listVersion;
+    }
+
+    return count;
+}
+
+vkView* crenvk_view_create(CRenContext* context, unsigned int width, unsigned int height) {
+    CRenVulkanBackend* renderer = (CRenVulkanBackend*)context->backend;
+    vkViewSet* set = &renderer->viewSet;
+
+    vkView* view = NULL;
+    for (unsigned int i = 1; i < CREN_VIEWS_MAX && view == NULL; i++) {
+        if (!set->views[i].used) view = &set->views[i];
+    }
+
+    if (view == NULL) {
+        CREN_LOG("CRen: Every view slot is in use");
+        return NULL;
+    }
+
+    // the quad pipelines were built against the merged renderpass, single subpass renderpasses aren't compatible with it
+    if (!renderer->hint_viewport && renderer->defaultRenderphase.mergedUI) {
+        CREN_LOG("CRen: Views need the smaller viewport while the ui is merged into the default renderphase");
+        return NULL;
+    }
+
+    // the renderpass follows the one the quad pipelines were built against
+    if (set->renderpass == NULL) {
+        vkRenderpass* mainRenderpass = renderer->hint_viewport ? renderer->viewportRenderphase.renderpass : renderer->defaultRenderphase.renderpass;
+        if (!internal_crenvk_views_renderpass_create(set, &renderer->device, mainRenderpass->surfaceFormat, mainRenderpass->msaa)) return NULL;
+    }
+
+    if (!internal_crenvk_views_descriptors_create(set, &renderer->device)) return NULL;
+
+    crenmemory_zero(view, sizeof(vkView));
+    view->index = (unsigned int)(view - set->views);
+    view->extent.width = width > 0 ? width : 1;
+    view->extent.height = height > 0 ? height : 1;
+    view->camera = cren_camera_create(CAMERA_TYPE_FREE_LOOK, (float)view->extent.width / (float)view->extent.height);
+
+    if (!internal_crenvk_view_commandbuffers_create(set, renderer->device.device, view)) return NULL;
+
+    if (!internal_crenvk_view_targets_create(set, &renderer->device, view)) {
+        vkFreeCommandBuffers(renderer->device.device, set->renderpass->commandPool, CREN_CONCURRENTLY_RENDERED_FRAMES, view->commandBuffers);
+        crenmemory_zero(view, sizeof(vkView));
+        return NULL;
+    }
+
+    view->used = 1;
+    view->enabled = 1;
+    view->listOwner = view->index;
+    return view;
+}
+
+void crenvk_view_destroy(CRenContext* context, vkView* view) {
+    if (view == NULL || !view->used) return;
+
+    // the frames in flight may still render the view or sample it on the ui
+    CRenVulkanBackend* renderer = (CRenVulkanBackend*)context->backend;
+    internal_crenvk_view_targets_retire(context, view, 1);
+    internal_crenvk_view_release(&renderer->viewSet, renderer->device.device, view);
+}
+
+void crenvk_view_resize(CRenContext* context, vkView* view, unsigned int width, unsigned int height) {
+    if (view == NULL || !view->used) return;
+    if (width == 0) width = 1;
+    if (height == 0) height = 1;
+    if (view->extent.width == width && view->extent.height == height) return;
+
+    CRenVulkanBackend* renderer = (CRenVulkanBackend*)context->backend;
+    internal_crenvk_view_targets_retire(context, view, 0);
+
+    view->extent.width = width;
+    view->extent.height = height;
+    cren_camera_set_aspect_ratio(&view->camera, (float)width / (float)height);
+    if (!internal_crenvk_view_targets_create(&renderer->viewSet, &renderer->device, view)) view->enabled = 0;
+}
+
+void crenvk_view_set_enabled(vkView* view, int enabled) {
+    if (view == NULL || !view->used) return;
+
+    // disabled views are left out of the visibility pass, their bits are stale
+    if (enabled && !view->enabled) crenmemory_zero(&view->culledViewProj, sizeof(mat4));
+    view->enabled = enabled;
+}
+
+CRenCamera* crenvk_view_get_camera(vkView* view) {
+    return view != NULL ? &view->camera : NULL;
+}
+
+VkDescriptorSet crenvk_view_get_descriptor(vkView* view) {
+    return view != NULL ? view->descriptorSet : VK_NULL_HANDLE;
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Mipmap-related
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+/// @brief creates a command pool on a queue family, used by the mipmap generator
+/// @param device vulkan device
+/// @param family queue family index
+/// @param pool output command pool
+/// @return 1 on success, 0 on failure
+static int internal_crenvk_mipmaps_commandpool_create(VkDevice device, unsigned int family, VkCommandPool* pool) {
+    VkCommandPoolCreateInfo cmdPoolInfo = { 0 };
+    cmdPoolInfo.sType = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO;
+    cmdPoolInfo.queueFamilyIndex = family;
+    cmdPoolInfo.flags = VK_COMMAND_POOL_CREATE_RESET_COMMAND_BUFFER_BIT;
+    if (vkCreateCommandPool(device, &cmdPoolInfo, NULL, pool) != VK_SUCCESS) {
+        cren_set_error(Vulkan_CommandPoolCreationFailed);
+        return 0;
+    }
+
+    return 1;
+}
+
+/// @brief checks if the device can run the single pass downsampler
+/// @param physicalDevice vulkan physical device
+/// @return 1 if it can, 0 otherwise
+static int internal_crenvk_mipmaps_device_suitable(VkPhysicalDevice physicalDevice) {
+    VkPhysicalDeviceProperties props;
+    vkGetPhysicalDeviceProperties(physicalDevice, &props);
+
+    if (props.limits.maxComputeWorkGroupInvocations < 256 || props.limits.maxComputeWorkGroupSize[0] < 256) return 0;
+    if (props.limits.maxPerStageDescriptorStorageImages < CREN_MIPMAP_COMPUTE_LEVELS_MAX + 1) return 0;
+
+    VkFormatProperties formatProps;
+    vkGetPhysicalDeviceFormatProperties(physicalDevice, VK_FORMAT_R8G8B8A8_UNORM, &formatProps);
+    if (!(formatProps.optimalTilingFeatures & VK_FORMAT_FEATURE_STORAGE_IMAGE_BIT)) return 0;
+
+    return 1;
+}
+
+/// @brief creates the compute pipeline and resources of the mipmap generator, the generator falls back to blits if anything is missing
+/// @param generator the mipmap generator
+/// @param device cren vulkan device
+/// @param rootPath assets root path
+/// @return 1 on success (even if compute is not supported), 0 on failure
+static int internal_crenvk_mipmaps_create(vkMipmapGenerator* generator, vkDevice* device, const char* rootPath) {
+    vkQueueFamilyIndices indices = internal_crenvk_find_queue_families(device->physicalDevice, device->surface);
+    generator->graphicsFamily = (unsigned int)indices.graphicFamily;
+    generator->queueFamily = generator->graphicsFamily;
+    generator->queue = device->graphicsQueue;
+
+    if (!internal_crenvk_mipmaps_commandpool_create(device->device, generator->graphicsFamily, &generator->graphicsCommandPool)) return 0;
+    if (!internal_crenvk_mipmaps_commandpool_create(device->device, generator->queueFamily, &generator->commandPool)) return 0;
+
+    if (!internal_crenvk_mipmaps_device_suitable(device->physicalDevice)) {
+        CREN_LOG("CRen: Device can't run the compute mipmap generator, using blits");
+        return 1;
+    }
+
+    char path[CREN_PATH_MAX_SIZE];
+    cren_get_path("shader/compiled/mipmap.comp.spv", rootPath, 0, path, sizeof(path));
+
+    unsigned long long spirvSize = 0;
+    unsigned int* spirvCode = cren_load_file(path, &spirvSize);
+    if (spirvCode == NULL) {
+        CREN_LOG("CRen: Could not load the mipmap compute shader, using blits");
+        return 1;
+    }
+
+    VkShaderModule module = VK_NULL_HANDLE;
+    VkShaderModuleCreateInfo moduleCI = { 0 };
+    moduleCI.sType = VK_STRUCTURE_TYPE_SHADER_MODULE_CREATE_INFO;
+    moduleCI.codeSize = spirvSize;
+    moduleCI.pCode = spirvCode;
+    VkResult res = vkCreateShaderModule(device->device, &moduleCI, NULL, &module);
+    crenmemory_deallocate(spirvCode);
+    if (res != VK_SUCCESS) return 1;
+
+    // 0: base level, 1: generated levels, 2: atomic counters
+    VkDescriptorSetLayoutBinding bindings[3] = { 0 };
+    bindings[0].binding = 0;
+    bindings[0].descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_IMAGE;
+    bindings[0].descriptorCount = 1;
+    bindings[0].stageFlags = VK_SHADER_STAGE_COMPUTE_BIT;
+    bindings[1].binding = 1;
+    bindings[1].descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_IMAGE;
+    bindings[1].descriptorCount = CREN_MIPMAP_COMPUTE_LEVELS_MAX;
+    bindings[1].stageFlags = VK_SHADER_STAGE_COMPUTE_BIT;
+    bindings[2].binding = 2;
+    bindings[2].descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+    bindings[2].descriptorCount = 1;
+    bindings[2].stageFlags = VK_SHADER_STAGE_COMPUTE_BIT;
+
+    VkDescriptorSetLayoutCreateInfo setLayoutCI = { 0 };
+    setLayoutCI.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO;
+    setLayoutCI.bindingCount = (unsigned int)CREN_ARRAYSIZE(bindings);
+    setLayoutCI.pBindings = bindings;
+    res = vkCreateDescriptorSetLayout(device->device, &setLayoutCI, NULL, &generator->descriptorSetLayout);
+
+    VkPushConstantRange pushConstant = { 0 };
+    pushConstant.stageFlags = VK_SHADER_STAGE_COMPUTE_BIT;
+    pushConstant.offset = 0;
+    pushConstant.size = sizeof(vkMipmapPushConstant);
+
+    VkPipelineLayoutCreateInfo layoutCI = { 0 };
+    layoutCI.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
+    layoutCI.setLayoutCount = 1;
+    layoutCI.pSetLayouts = &generator->descriptorSetLayout;
+    layoutCI.pushConstantRangeCount = 1;
+    layoutCI.pPushConstantRanges = &pushConstant;
+    if (res == VK_SUCCESS) res = vkCreatePipelineLayout(device->device, &layoutCI, NULL, &generator->layout);
+
+    VkComputePipelineCreateInfo pipelineCI = { 0 };
+    pipelineCI.sType = VK_STRUCTURE_TYPE_COMPUTE_PIPELINE_CREATE_INFO;
+    pipelineCI.stage.sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
+    pipelineCI.stage.stage = VK_SHADER_STAGE_COMPUTE_BIT;
+    pipelineCI.stage.module = module;
+    pipelineCI.stage.pName = "main";
+    pipelineCI.layout = generator->layout;
+    if (res == VK_SUCCESS) res = vkCreateComputePipelines(device->device, VK_NULL_HANDLE, 1, &pipelineCI, NULL, &generator->pipeline);
+    vkDestroyShaderModule(device->device, module, NULL);
+
+    VkDescriptorPoolSize poolSizes[2] = { 0 };
+    poolSizes[0].type = VK_DESCRIPTOR_TYPE_STORAGE_IMAGE;
+    poolSizes[0].descriptorCount = CREN_MIPMAP_BATCH_MAX * (CREN_MIPMAP_COMPUTE_LEVELS_MAX + 1);
+    poolSizes[1].type = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+    poolSizes[1].descriptorCount = CREN_MIPMAP_BATCH_MAX;
+
+    VkDescriptorPoolCreateInfo poolCI = { 0 };
+    poolCI.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
+    poolCI.maxSets = CREN_MIPMAP_BATCH_MAX;
+    poolCI.poolSizeCount = (unsigned int)CREN_ARRAYSIZE(poolSizes);
+    poolCI.pPoolSizes = poolSizes;
+    if (res == VK_SUCCESS) res = vkCreateDescriptorPool(device->device, &poolCI, NULL, &generator->descriptorPool);
+
+    if (res == VK_SUCCESS) {
+        VkBufferUsageFlags usage = VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT;
+        VkDeviceSize size = sizeof(unsigned int) * CREN_MIPMAP_BATCH_MAX;
+        if (!crenvk_device_create_buffer(device->device, device->physicalDevice, usage, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, size, &generator->counterBuffer, &generator->counterMemory, NULL)) res = VK_ERROR_OUT_OF_DEVICE_MEMORY;
+    }
+
+    if (res != VK_SUCCESS) {
+        CREN_LOG("CRen: Failed to create the mipmap compute pipeline, using blits");
+        return 1;
+    }
+
+    generator->supported = 1;
+    return 1;
+}
+
+/// @brief releases all resources used by the mipmap generator
+/// @param generator the mipmap generator
+/// @param device vulkan device
+static void internal_crenvk_mipmaps_destroy(vkMipmapGenerator* generator, VkDevice device) {
+    if (generator->counterBuffer != VK_NULL_HANDLE) vkDestroyBuffer(device, generator->counterBuffer, NULL);
+    if (generator->counterMemory != VK_NULL_HANDLE) vkFreeMemory(device, generator->counterMemory, NULL);
+    if (generator->descriptorPool != VK_NULL_HANDLE) vkDestroyDescriptorPool(device, generator->descriptorPool, NULL);
+    if (generator->pipeline != VK_NULL_HANDLE) vkDestroyPipeline(device, generator->pipeline, NULL);
+    if (generator->layout != VK_NULL_HANDLE) vkDestroyPipelineLayout(device, generator->layout, NULL);
+    if (generator->descriptorSetLayout != VK_NULL_HANDLE) vkDestroyDescriptorSetLayout(device, generator->descriptorSetLayout, NULL);
+    if (generator->commandPool != VK_NULL_HANDLE) vkDestroyCommandPool(device, generator->commandPool, NULL);
+    if (generator->graphicsCommandPool != VK_NULL_HANDLE) vkDestroyCommandPool(device, generator->graphicsCommandPool, NULL);
+    crenmemory_zero(generator, sizeof(vkMipmapGenerator));
+}
+
+/// @brief records a layout transition of every level of the requested images, optionally transfering queue family ownership
+/// @param cmdBuffer command buffer to record into
+/// @param generator the mipmap generator
+/// @param oldLayout current layout
+/// @param newLayout desired layout
+/// @param srcAccess access flags to make available
+/// @param dstAccess access flags to make visible
+/// @param srcStage stage to wait
+/// @param dstStage stage that waits
+/// @param srcFamily queue family releasing ownership, VK_QUEUE_FAMILY_IGNORED when not transfering
+/// @param dstFamily queue family acquiring ownership, VK_QUEUE_FAMILY_IGNORED when not transfering
+static void internal_crenvk_mipmaps_barrier(VkCommandBuffer cmdBuffer, vkMipmapGenerator* generator, VkImageLayout oldLayout, VkImageLayout newLayout, VkAccessFlags srcAccess, VkAccessFlags dstAccess, VkPipelineStageFlags srcStage, VkPipelineStageFlags dstStage, unsigned int srcFamily, unsigned int dstFamily) {
+    VkImageMemoryBarrier barriers[CREN_MIPMAP_BATCH_MAX] = { 0 };
+
+    for (unsigned int i = 0; i < generator->requestCount; i++) {
+        barriers[i].sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+        barriers[i].image = generator->requests[i].image;
+        barriers[i].oldLayout = oldLayout;
+        barriers[i].newLayout = newLayout;
+        barriers[i].srcAccessMask = srcAccess;
+        barriers[i].dstAccessMask = dstAccess;
+        barriers[i].srcQueueFamilyIndex = srcFamily;
+        barriers[i].dstQueueFamilyIndex = dstFamily;
+        barriers[i].subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+        barriers[i].subresourceRange.baseMipLevel = 0;
+        barriers[i].subresourceRange.levelCount = generator->requests[i].mipLevels;
+        barriers[i].subresourceRange.baseArrayLayer = 0;
+        barriers[i].subresourceRange.layerCount = 1;
+    }
+
+    vkCmdPipelineBarrier(cmdBuffer, srcStage, dstStage, 0, 0, NULL, 0, NULL, generator->requestCount, barriers);
+}
+
+/// @brief creates the per-level views and the descriptor set of a request
+/// @param generator the mipmap generator
+/// @param device vulkan device
+/// @param request the request
+static void internal_crenvk_mipmaps_request_prepare(vkMipmapGenerator* generator, VkDevice device, vkMipmapRequest* request) {
+    for (unsigned int level = 0; level < request->mipLevels; level++) {
+        VkImageViewCreateInfo viewCI = { 0 };
+        viewCI.sType = VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO;
+        viewCI.image = request->image;
+        viewCI.viewType = VK_IMAGE_VIEW_TYPE_2D;
+        viewCI.format = VK_FORMAT_R8G8B8A8_UNORM;
+        viewCI.subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+        viewCI.subresourceRange.baseMipLevel = level;
+        viewCI.subresourceRange.levelCount = 1;
+        viewCI.subresourceRange.baseArrayLayer = 0;
+        viewCI.subresourceRange.layerCount = 1;
+        CREN_ASSERT(vkCreateImageView(device, &viewCI, NULL, &request->views[level]) == VK_SUCCESS, "Failed to create mipmap level image view");
+    }
+
+    VkDescriptorSetAllocateInfo allocInfo = { 0 };
+    allocInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
+    allocInfo.descriptorPool = generator->descriptorPool;
+    allocInfo.descriptorSetCount = 1;
+    allocInfo.pSetLayouts = &generator->descriptorSetLayout;
+    CREN_ASSERT(vkAllocateDescriptorSets(device, &allocInfo, &request->descriptorSet) == VK_SUCCESS, "Failed to allocate mipmap descriptor set");
+
+    // levels the texture doesn't have are never touched by the shader, but every array element must be valid
+    VkDescriptorImageInfo imageInfos[CREN_MIPMAP_COMPUTE_LEVELS_MAX + 1] = { 0 };
+    for (unsigned int i = 0; i < CREN_MIPMAP_COMPUTE_LEVELS_MAX + 1; i++) {
+        imageInfos[i].imageView = request->views[i < request->mipLevels ? i : request->mipLevels - 1];
+        imageInfos[i].imageLayout = VK_IMAGE_LAYOUT_GENERAL;
+    }
+
+    VkDescriptorBufferInfo counterInfo = { 0 };
+    counterInfo.buffer = generator->counterBuffer;
+    counterInfo.offset = 0;
+    counterInfo.range = VK_WHOLE_SIZE;
+
+    VkWriteDescriptorSet writes[3] = { 0 };
+    writes[0].sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+    writes[0].dstSet = request->descriptorSet;
+    writes[0].dstBinding = 0;
+    writes[0].descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_IMAGE;
+    writes[0].descriptorCount = 1;
+    writes[0].pImageInfo = &imageInfos[0];
+    writes[1].sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+    writes[1].dstSet = request->descriptorSet;
+    writes[1].dstBinding = 1;
+    writes[1].descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_IMAGE;
+    writes[1].descriptorCount = CREN_MIPMAP_COMPUTE_LEVELS_MAX;
+    writes[1].pImageInfo = &imageInfos[1];
+    writes[2].sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+    writes[2].dstSet = request->descriptorSet;
+    writes[2].dstBinding = 2;
+    writes[2].descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+    writes[2].descriptorCount = 1;
+    writes[2].pBufferInfo = &counterInfo;
+    vkUpdateDescriptorSets(device, (unsigned int)CREN_ARRAYSIZE(writes), writes, 0, NULL);
+
+}
+
+/// @brief generates the mips of every pending request on a single submission and waits for it
+/// @param generator the mipmap generator
+/// @param device cren vulkan device
+static void internal_crenvk_mipmaps_flush(vkMipmapGenerator* generator, vkDevice* device) {
+    if (generator->requestCount == 0) return;
+
+    const int transferOwnership = generator->queueFamily != generator->graphicsFamily;
+    const unsigned int srcFamily = transferOwnership ? generator->graphicsFamily : VK_QUEUE_FAMILY_IGNORED;
+    const unsigned int dstFamily = transferOwnership ? generator->queueFamily : VK_QUEUE_FAMILY_IGNORED;
+
+    for (unsigned int i = 0; i < generator->requestCount; i++) {
+        internal_crenvk_mipmaps_request_prepare(generator, device->device, &generator->requests[i]);
+    }
+
+    // dispatches
+    VkCommandBuffer cmdBuffer = crenvk_commandbuffer_begin_singletime(device->device, generator->commandPool);
+
+    vkCmdFillBuffer(cmdBuffer, generator->counterBuffer, 0, VK_WHOLE_SIZE, 0);
+
+    VkBufferMemoryBarrier counterBarrier = { 0 };
+    counterBarrier.sType = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER;
+    counterBarrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+    counterBarrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT;
+    counterBarrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    counterBarrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    counterBarrier.buffer = generator->counterBuffer;
+    counterBarrier.offset = 0;
+    counterBarrier.size = VK_WHOLE_SIZE;
+    vkCmdPipelineBarrier(cmdBuffer, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, 0, 0, NULL, 1, &counterBarrier, 0, NULL);
+
+    // acquire the images (on the same queue the upload happened this just makes the upload visible)
+    if (transferOwnership) {
+        internal_crenvk_mipmaps_barrier(cmdBuffer, generator, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, VK_IMAGE_LAYOUT_GENERAL, 0, VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, srcFamily, dstFamily);
+    }
+
+    else {
+        internal_crenvk_mipmaps_barrier(cmdBuffer, generator, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, VK_IMAGE_LAYOUT_GENERAL, VK_ACCESS_TRANSFER_WRITE_BIT, VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_QUEUE_FAMILY_IGNORED, VK_QUEUE_FAMILY_IGNORED);
+    }
+
+    vkCmdBindPipeline(cmdBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, generator->pipeline);
+
+    for (unsigned int i = 0; i < generator->requestCount; i++) {
+        vkMipmapRequest* request = &generator->requests[i];
+        unsigned int groupsX = (request->width + 63) / 64;
+        unsigned int groupsY = (request->height + 63) / 64;
+
+        vkMipmapPushConstant constants = { 0 };
+        constants.size[0] = (int)request->width;
+        constants.size[1] = (int)request->height;
+        constants.mipCount = request->mipLevels - 1;
+        constants.workGroupCount = groupsX * groupsY;
+        constants.counterIndex = i;
+        constants.srgb = (unsigned int)request->srgb;
+
+        vkCmdBindDescriptorSets(cmdBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, generator->layout, 0, 1, &request->descriptorSet, 0, NULL);
+        vkCmdPushConstants(cmdBuffer, generator->layout, VK_SHADER_STAGE_COMPUTE_BIT, 0, sizeof(vkMipmapPushConstant), &constants);
+        vkCmdDispatch(cmdBuffer, groupsX, groupsY, 1);
+    }
+
+    // release the images back to graphics, ready to be sampled
+    if (transferOwnership) {
+        internal_crenvk_mipmaps_barrier(cmdBuffer, generator, VK_IMAGE_LAYOUT_GENERAL, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL, VK_ACCESS_SHADER_WRITE_BIT, 0, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, dstFamily, srcFamily);
+    }
+
+    else {
+        internal_crenvk_mipmaps_barrier(cmdBuffer, generator, VK_IMAGE_LAYOUT_GENERAL, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL, VK_ACCESS_SHADER_WRITE_BIT, VK_ACCESS_SHADER_READ_BIT, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT, VK_QUEUE_FAMILY_IGNORED, VK_QUEUE_FAMILY_IGNORED);
+    }
+
+    vkEndCommandBuffer(cmdBuffer);
+
+    if (transferOwnership) {
+        // graphics releases the uploaded images to the compute family, compute generates and releases them back, graphics acquires them
+        VkCommandBuffer releaseCmd = crenvk_commandbuffer_begin_singletime(device->device, generator->graphicsCommandPool);
+        internal_crenvk_mipmaps_barrier(releaseCmd, generator, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, VK_IMAGE_LAYOUT_GENERAL, VK_ACCESS_TRANSFER_WRITE_BIT, 0, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, srcFamily, dstFamily);
+        vkEndCommandBuffer(releaseCmd);
+
+        VkCommandBuffer acquireCmd = crenvk_commandbuffer_begin_singletime(device->device, generator->graphicsCommandPool);
+        internal_crenvk_mipmaps_barrier(acquireCmd, generator, VK_IMAGE_LAYOUT_GENERAL, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL, 0, VK_ACCESS_SHADER_READ_BIT, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT, dstFamily, srcFamily);
+        vkEndCommandBuffer(acquireCmd);
+
+        VkSemaphore semaphores[2] = { VK_NULL_HANDLE, VK_NULL_HANDLE };
+        VkSemaphoreCreateInfo semaphoreCI = { 0 };
+        semaphoreCI.sType = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO;
+        vkCreateSemaphore(device->device, &semaphoreCI, NULL, &semaphores[0]);
+        vkCreateSemaphore(device->device, &semaphoreCI, NULL, &semaphores[1]);
+
+        VkFence fence = VK_NULL_HANDLE;
+        VkFenceCreateInfo fenceCI = { 0 };
+        fenceCI.sType = VK_STRUCTURE_TYPE_FENCE_CREATE_INFO;
+        vkCreateFence(device->device, &fenceCI, NULL, &fence);
+
+        VkPipelineStageFlags computeWait = VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT;
+        VkPipelineStageFlags graphicsWait = VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT;
+
+        VkSubmitInfo submits[3] = { 0 };
+        submits[0].sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+        submits[0].commandBufferCount = 1;
+        submits[0].pCommandBuffers = &releaseCmd;
+        submits[0].signalSemaphoreCount = 1;
+        submits[0].pSignalSemaphores = &semaphores[0];
+
+        submits[1].sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+        submits[1].waitSemaphoreCount = 1;
+        submits[1].pWaitSemaphores = &semaphores[0];
+        submits[1].pWaitDstStageMask = &computeWait;
+        submits[1].commandBufferCount = 1;
+        submits[1].pCommandBuffers = &cmdBuffer;
+        submits[1].signalSemaphoreCount = 1;
+        submits[1].pSignalSemaphores = &semaphores[1];
+
+        submits[2].sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+        submits[2].waitSemaphoreCount = 1;
+        submits[2].pWaitSemaphores = &semaphores[1];
+        submits[2].pWaitDstStageMask = &graphicsWait;
+        submits[2].commandBufferCount = 1;
+        submits[2].pCommandBuffers = &acquireCmd;
+
+        vkQueueSubmit(device->graphicsQueue, 1, &submits[0], VK_NULL_HANDLE);
+        vkQueueSubmit(generator->queue, 1, &submits[1], VK_NULL_HANDLE);
+        vkQueueSubmit(device->graphicsQueue, 1, &submits[2], fence);
+        vkWaitForFences(device->device, 1, &fence, VK_TRUE, UINT64_MAX);
+
+        vkDestroyFence(device->device, fence, NULL);
+        vkDestroySemaphore(device->device, semaphores[0], NULL);
+        vkDestroySemaphore(device->device, semaphores[1], NULL);
+        vkFreeCommandBuffers(device->device, generator->graphicsCommandPool, 1, &releaseCmd);
+        vkFreeCommandBuffers(device->device, generator->graphicsCommandPool, 1, &acquireCmd);
+        vkFreeCommandBuffers(device->device, generator->commandPool, 1, &cmdBuffer);
+    }
+
+    else {
+        VkSubmitInfo submitInfo = { 0 };
+        submitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+        submitInfo.commandBufferCount = 1;
+        submitInfo.pCommandBuffers = &cmdBuffer;
+        vkQueueSubmit(generator->queue, 1, &submitInfo, VK_NULL_HANDLE);
+        vkQueueWaitIdle(generator->queue);
+        vkFreeCommandBuffers(device->device, generator->commandPool, 1, &cmdBuffer);
+    }
+
+    // views and descriptors were only needed by the dispatches
+    for (unsigned int i = 0; i < generator->requestCount; i++) {
+        for (unsigned int level = 0; level < generator->requests[i].mipLevels; level++) {
+            vkDestroyImageView(device->device, generator->requests[i].views[level], NULL);
+        }
+    }
+
+    vkResetDescriptorPool(device->device, generator->descriptorPool, 0);
+    crenmemory_zero(generator->requests, sizeof(generator->requests));
+    generator->requestCount = 0;
+}
+
+int crenvk_mipmaps_compute_supported(CRenContext* context) {
+    CRenVulkanBackend* renderer = (CRenVulkanBackend*)context->backend;
+    return renderer->mipmapGenerator.supported;
+}
+
+void crenvk_mipmaps_generate(CRenContext* context, VkImage image, unsigned int width, unsigned int height, unsigned int mipLevels, int srgb) {
+    CRenVulkanBackend* renderer = (CRenVulkanBackend*)context->backend;
+    vkMipmapGenerator* generator = &renderer->mipmapGenerator;
+
+    // blits also handle the single level case, wich only needs the layout transition
+    if (!generator->supported || mipLevels <= 1 || mipLevels - 1 > CREN_MIPMAP_COMPUTE_LEVELS_MAX) {
+        crenvk_image_mipmaps_create(renderer->device.device, renderer->device.graphicsQueue, generator->graphicsCommandPool, (int)width, (int)height, (int)mipLevels, image);
+        return;
+    }
+
+    if (generator->requestCount == CREN_MIPMAP_BATCH_MAX) internal_crenvk_mipmaps_flush(generator, &renderer->device);
+
+    vkMipmapRequest* request = &generator->requests[generator->requestCount++];
+    request->image = image;
+    request->width = width;
+    request->height = height;
+    request->mipLevels = mipLevels;
+    request->srgb = srgb;
+
+    if (!generator->batching) internal_crenvk_mipmaps_flush(generator, &renderer->device);
+}
+
+void crenvk_mipmaps_begin_batch(CRenContext* context) {
+    CRenVulkanBackend* renderer = (CRenVulkanBackend*)context->backend;
+    renderer->mipmapGenerator.batching = 1;
+}
+
+void crenvk_mipmaps_end_batch(CRenContext* context) {
+    CRenVulkanBackend* renderer = (CRenVulkanBackend*)context->backend;
+    renderer->mipmapGenerator.batching = 0;
+    internal_crenvk_mipmaps_flush(&renderer->mipmapGenerator, &renderer->device);
+}
+
+void crenvk_mipmaps_set_async_compute(CRenContext* context, int enabled) {
+    CRenVulkanBackend* renderer = (CRenVulkanBackend*)context->backend;
+    vkMipmapGenerator* generator = &renderer->mipmapGenerator;
+    if (!generator->supported || generator->asyncCompute == enabled) return;
+
+    vkQueueFamilyIndices indices = internal_crenvk_find_queue_families(renderer->device.physicalDevice, renderer->device.surface);
+    if (enabled && (indices.computeFamily == -1 || indices.computeFamily == indices.graphicFamily)) {
+        CREN_LOG("CRen: There's no separate compute queue family, mipmaps stay on the graphics queue");
+        return;
+    }
+
+    // pending requests were meant for the current queue
+    internal_crenvk_mipmaps_flush(generator, &renderer->device);
+
+    unsigned int family = enabled ? (unsigned int)indices.computeFamily : generator->graphicsFamily;
+    VkCommandPool pool = VK_NULL_HANDLE;
+    if (!internal_crenvk_mipmaps_commandpool_create(renderer->device.device, family, &pool)) return;
+
+    vkDestroyCommandPool(renderer->device.device, generator->commandPool, NULL);
+    generator->commandPool = pool;
+    generator->queueFamily = family;
+    generator->queue = enabled ? renderer->device.computeQueue : renderer->device.graphicsQueue;
+    generator->asyncCompute = enabled;
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Memory-related
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+/// @brief reads the heap layout of the device, the texture heap is the largest device-local one
+/// @param budget memory budget
+/// @param memoryProperties physical device memory properties
+static void internal_crenvk_memory_budget_create(vkMemoryBudget* budget, const VkPhysicalDeviceMemoryProperties* memoryProperties) {
+    budget->heapCount = memoryProperties->memoryHeapCount;
+    budget->textureHeap = 0;
+
+    for (unsigned int i = 0; i < budget->heapCount; i++) {
+        budget->heapSize[i] = memoryProperties->memoryHeaps[i].size;
+        budget->heapFlags[i] = memoryProperties->memoryHeaps[i].flags;
+
+        int deviceLocal = (budget->heapFlags[i] & VK_MEMORY_HEAP_DEVICE_LOCAL_BIT) != 0;
+        int textureHeapLocal = (budget->heapFlags[budget->textureHeap] & VK_MEMORY_HEAP_DEVICE_LOCAL_BIT) != 0;
+        if (deviceLocal && (!textureHeapLocal || budget->heapSize[i] > budget->heapSize[budget->textureHeap])) budget->textureHeap = i;
+    }
+}
+
+/// @brief queries the current usage and budget of every heap
+/// @param renderer cren vulkan backend
+static void internal_crenvk_memory_budget_query(CRenVulkanBackend* renderer) {
+    vkMemoryBudget* budget = &renderer->memoryBudget;
+
+    if (budget->budgetExtension) {
+        VkPhysicalDeviceMemoryBudgetPropertiesEXT budgetProps = { 0 };
+        budgetProps.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_MEMORY_BUDGET_PROPERTIES_EXT;
+
+        VkPhysicalDeviceMemoryProperties2KHR props = { 0 };
+        props.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_MEMORY_PROPERTIES_2_KHR;
+        props.pNext = &budgetProps;
+        budget->getMemoryProperties2(renderer->device.physicalDevice, &props);
+
+        for (unsigned int i = 0; i < budget->heapCount; i++) {
+            budget->heapBudget[i] = budgetProps.heapBudget[i];
+            budget->heapUsage[i] = budgetProps.heapUsage[i];
+        }
+    }
+
+    // without the extension there's no way to know what other processes use, leave some room for them
+    else {
+        for (unsigned int i = 0; i < budget->heapCount; i++) {
+            budget->heapBudget[i] = budget->heapSize[i] / 10 * 8;
+            budget->heapUsage[i] = i == budget->textureHeap ? renderer->textureResidency.residentBytes : 0;
+        }
+    }
+
+    budget->updatedFrame = renderer->retirement.frameNumber;
+}
+
+/// @brief starts tracking a texture
+/// @param residency texture residency
+/// @param texture the texture backend
+/// @return 1 on success, 0 on failure
+static int internal_crenvk_residency_insert(vkTextureResidency* residency, CRenTexture2DBackend* texture) {
+    if (residency->count == residency->capacity) {
+        unsigned int newCapacity = residency->capacity > 0 ? residency->capacity * 2 : 64;
+        CRenTexture2DBackend** textures = (CRenTexture2DBackend**)crenmemory_reallocate(residency->textures, sizeof(CRenTexture2DBackend*) * newCapacity);
+        if (!textures) return 0;
+
+        residency->textures = textures;
+        residency->capacity = newCapacity;
+    }
+
+    texture->residencyIndex = residency->count;
+    residency->textures[residency->count++] = texture;
+    residency->residentBytes += texture->size;
+    return 1;
+}
+
+/// @brief stops tracking a texture
+/// @param residency texture residency
+/// @param texture the texture backend
+static void internal_crenvk_residency_remove(vkTextureResidency* residency, CRenTexture2DBackend* texture) {
+    unsigned int index = texture->residencyIndex;
+    if (index >= residency->count || residency->textures[index] != texture) return;
+
+    // swap with the last one, order doesn't matter
+    residency->count--;
+    residency->textures[index] = residency->textures[residency->count];
+    residency->textures[index]->residencyIndex = index;
+    residency->residentBytes -= texture->size;
+}
+
+/// @brief records the copy of every level but the top one of a texture into a new image, half it's size
+/// @param cmdBuffer command buffer being recorded
+/// @param texture the texture backend
+/// @param image the new image, with one level less
+/// @param width the new image width
+/// @param height the new image height
+/// @param mipLevels the new image levels
+static void internal_crenvk_texture2d_record_drop(VkCommandBuffer cmdBuffer, CRenTexture2DBackend* texture, VkImage image, unsigned int width, unsigned int height, unsigned int mipLevels) {
+    VkImageMemoryBarrier barriers[2] = { 0 };
+    barriers[0].sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+    barriers[0].image = texture->image;
+    barriers[0].oldLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+    barriers[0].newLayout = VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL;
+    barriers[0].srcAccessMask = VK_ACCESS_SHADER_READ_BIT;
+    barriers[0].dstAccessMask = VK_ACCESS_TRANSFER_READ_BIT;
+    barriers[0].srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    barriers[0].dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    barriers[0].subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+    barriers[0].subresourceRange.baseMipLevel = 1;
+    barriers[0].subresourceRange.levelCount = mipLevels;
+    barriers[0].subresourceRange.layerCount = 1;
+
+    barriers[1] = barriers[0];
+    barriers[1].image = image;
+    barriers[1].oldLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+    barriers[1].newLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+    barriers[1].srcAccessMask = 0;
+    barriers[1].dstAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+    barriers[1].subresourceRange.baseMipLevel = 0;
+    vkCmdPipelineBarrier(cmdBuffer, VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT, 0, 0, NULL, 0, NULL, 2, barriers);
+
+    // level N + 1 of the old image is level N of the new one
+    VkImageCopy regions[32] = { 0 };
+    for (unsigned int level = 0; level < mipLevels; level++) {
+        regions[level].srcSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+        regions[level].srcSubresource.mipLevel = level + 1;
+        regions[level].srcSubresource.layerCount = 1;
+        regions[level].dstSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+        regions[level].dstSubresource.mipLevel = level;
+        regions[level].dstSubresource.layerCount = 1;
+        regions[level].extent.width = uint_max(width >> level, 1);
+        regions[level].extent.height = uint_max(height >> level, 1);
+        regions[level].extent.depth = 1;
+    }
+    vkCmdCopyImage(cmdBuffer, texture->image, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL, image, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, mipLevels, regions);
+
+    // the old image is still sampled until every descriptor set points to the new one
+    barriers[0].oldLayout = VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL;
+    barriers[0].newLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+    barriers[0].srcAccessMask = VK_ACCESS_TRANSFER_READ_BIT;
+    barriers[0].dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
+
+    barriers[1].oldLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+    barriers[1].newLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+    barriers[1].srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+    barriers[1].dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
+    vkCmdPipelineBarrier(cmdBuffer, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT, 0, 0, NULL, 0, NULL, 2, barriers);
+}
+
+/// @brief re-creates a texture without it's top mip level, copying the remaining levels over. The device must be idle
+/// @param renderer cren vulkan backend
+/// @param texture the texture backend
+/// @return 1 on success, 0 on failure
+static int internal_crenvk_texture2d_drop_level(CRenVulkanBackend* renderer, CRenTexture2DBackend* texture) {
+    VkDevice device = renderer->device.device;
+    VkCommandPool cmdPool = renderer->mipmapGenerator.graphicsCommandPool;
+    unsigned int width = uint_max(texture->width >> 1, 1);
+    unsigned int height = uint_max(texture->height >> 1, 1);
+    unsigned int mipLevels = texture->mipLevels - 1;
+
+    VkImage image = VK_NULL_HANDLE;
+    VkDeviceMemory memory = VK_NULL_HANDLE;
+    if (!crenvk_image_create(width, height, mipLevels, 1, device, renderer->device.physicalDevice, &image, &memory, texture->format, VK_SAMPLE_COUNT_1_BIT, VK_IMAGE_TILING_OPTIMAL, texture->usage, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, texture->flags)) {
+        return 0;
+    }
+
+    VkCommandBuffer cmdBuffer = crenvk_commandbuffer_begin_singletime(device, cmdPool);
+    internal_crenvk_texture2d_record_drop(cmdBuffer, texture, image, width, height, mipLevels);
+    crenvk_commandbuffer_end_singletime(device, cmdPool, cmdBuffer, renderer->device.graphicsQueue);
+
+    // swap the resources
+    vkDestroyImageView(device, texture->view, NULL);
+    vkDestroyImage(device, texture->image, NULL);
+    vkFreeMemory(device, texture->memory, NULL);
+
+    VkMemoryRequirements memRequirements;
+    vkGetImageMemoryRequirements(device, image, &memRequirements);
+    renderer->textureResidency.residentBytes -= texture->size;
+    renderer->textureResidency.residentBytes += memRequirements.size;
+    renderer->textureResidency.evictedLevels++;
+
+    texture->image = image;
+    texture->memory = memory;
+    texture->view = crenvk_image_view_create(device, image, VK_FORMAT_R8G8B8A8_SRGB, VK_IMAGE_ASPECT_COLOR_BIT, mipLevels, 1, VK_IMAGE_VIEW_TYPE_2D);
+    texture->width = width;
+    texture->height = height;
+    texture->mipLevels = mipLevels;
+    texture->evictedLevels++;
+    texture->size = memRequirements.size;
+
+    // descriptor sets sampling the texture must point to the new view
+    VkDescriptorImageInfo imageInfo = { 0 };
+    imageInfo.sampler = texture->sampler;
+    imageInfo.imageView = texture->view;
+    imageInfo.imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+
+    VkWriteDescriptorSet write = { 0 };
+    write.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+    write.descriptorCount = 1;
+    write.descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+    write.pImageInfo = &imageInfo;
+
+    for (unsigned int i = 0; i < CREN_CONCURRENTLY_RENDERED_FRAMES; i++) {
+        if (texture->boundSets[i] == VK_NULL_HANDLE) continue;
+        write.dstSet = texture->boundSets[i];
+        write.dstBinding = texture->boundBinding;
+        vkUpdateDescriptorSets(device, 1, &write, 0, NULL);
+    }
+
+    if (texture->uiDescriptor != VK_NULL_HANDLE) {
+        write.dstSet = texture->uiDescriptor;
+        write.dstBinding = 0;
+        vkUpdateDescriptorSets(device, 1, &write, 0, NULL);
+    }
+
+    return 1;
+}
+
+/// @brief starts re-building a texture without it's top mip level on the gpu, the descriptor sets switch over to it as a streaming job and the old image is retired
+/// @param renderer cren vulkan backend
+/// @param texture the texture backend
+/// @param newSize returns the size the texture will have once the job finishes
+/// @return 1 on success, 0 on failure or if no job is available
+static int internal_crenvk_texture2d_drop_level_async(CRenVulkanBackend* renderer, CRenTexture2DBackend* texture, VkDeviceSize* newSize) {
+    vkTextureStreamer* streamer = &renderer->textureStreamer;
+    if (streamer->jobCount == CREN_TEXTURE_STREAMING_JOBS_MAX) return 0;
+
+    VkDevice device = renderer->device.device;
+    vkStreamingJob* job = &streamer->jobs[streamer->jobCount];
+    crenmemory_zero(job, sizeof(vkStreamingJob));
+    job->texture = texture;
+    job->baseLevel = texture->evictedLevels + 1;
+    job->width = uint_max(texture->width >> 1, 1);
+    job->height = uint_max(texture->height >> 1, 1);
+    job->mipLevels = texture->mipLevels - 1;
+
+    if (!crenvk_image_create(job->width, job->height, job->mipLevels, 1, device, renderer->device.physicalDevice, &job->image, &job->memory, texture->format, VK_SAMPLE_COUNT_1_BIT, VK_IMAGE_TILING_OPTIMAL, texture->usage, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, texture->flags)) {
+        return 0;
+    }
+
+    VkCommandBufferAllocateInfo cmdBufferAllocInfo = { 0 };
+    cmdBufferAllocInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
+    cmdBufferAllocInfo.commandPool = renderer->mipmapGenerator.graphicsCommandPool;
+    cmdBufferAllocInfo.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
+    cmdBufferAllocInfo.commandBufferCount = 1;
+    vkAllocateCommandBuffers(device, &cmdBufferAllocInfo, &job->cmdBuffer);
+
+    VkCommandBufferBeginInfo beginInfo = { 0 };
+    beginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+    beginInfo.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+    vkBeginCommandBuffer(job->cmdBuffer, &beginInfo);
+    internal_crenvk_texture2d_record_drop(job->cmdBuffer, texture, job->image, job->width, job->height, job->mipLevels);
+    vkEndCommandBuffer(job->cmdBuffer);
+
+    VkFenceCreateInfo fenceCI = { 0 };
+    fenceCI.sType = VK_STRUCTURE_TYPE_FENCE_CREATE_INFO;
+    vkCreateFence(device, &fenceCI, NULL, &job->fence);
+
+    VkSubmitInfo submitInfo = { 0 };
+    submitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+    submitInfo.commandBufferCount = 1;
+    submitInfo.pCommandBuffers = &job->cmdBuffer;
+    vkQueueSubmit(renderer->device.graphicsQueue, 1, &submitInfo, job->fence);
+
+    job->view = crenvk_image_view_create(device, job->image, VK_FORMAT_R8G8B8A8_SRGB, VK_IMAGE_ASPECT_COLOR_BIT, job->mipLevels, 1, VK_IMAGE_VIEW_TYPE_2D);
+
+    VkMemoryRequirements memRequirements;
+    vkGetImageMemoryRequirements(device, job->image, &memRequirements);
+    *newSize = memRequirements.size;
+
+    streamer->jobCount++;
+    texture->streaming = 1;
+    renderer->textureResidency.evictedLevels++;
+    return 1;
+}
+
+void crenvk_memory_budget_update(CRenContext* context) {
+    CRenVulkanBackend* renderer = (CRenVulkanBackend*)context->backend;
+    internal_crenvk_memory_budget_query(renderer);
+}
+
+unsigned int crenvk_memory_evict_textures(CRenContext* context, VkDeviceSize incomingBytes, int force) {
+    CRenVulkanBackend* renderer = (CRenVulkanBackend*)context->backend;
+    vkMemoryBudget* budget = &renderer->memoryBudget;
+    vkTextureResidency* residency = &renderer->textureResidency;
+
+    internal_crenvk_memory_budget_query(renderer);
+
+    // keep 10% of the budget as headroom for everything that's not a texture
+    const unsigned int heap = budget->textureHeap;
+    const VkDeviceSize target = budget->heapBudget[heap] / 10 * 9;
+    VkDeviceSize usage = budget->heapUsage[heap] + incomingBytes;
+    if (usage <= target && !force) return 0;
+
+    const unsigned long long frame = renderer->retirement.frameNumber;
+    const unsigned long long minIdleFrames = force ? 0 : CREN_TEXTURE_EVICTION_FRAMES;
+    unsigned int dropped = 0;
+
+    // forcing always drops at least a level, the budget is just an estimate when an allocation fails anyway
+    while (usage > target || (force && dropped == 0)) {
+        // least recently used texture that still has levels to spare
+        CRenTexture2DBackend* victim = NULL;
+        for (unsigned int i = 0; i < residency->count; i++) {
+            CRenTexture2DBackend* texture = residency->textures[i];
+            if (texture->shared || texture->streaming || texture->mipLevels < 2 || uint_max(texture->width, texture->height) / 2 < CREN_TEXTURE_EVICTION_MIN_SIZE) continue;
+            if (texture->lastUsedFrame + minIdleFrames > frame) continue;
+            if (victim == NULL || texture->lastUsedFrame < victim->lastUsedFrame) victim = texture;
+        }
+
+        if (victim == NULL) break;
+
+        // the periodic check never stalls, the texture is re-built on the gpu and switched over as frames finish
+        VkDeviceSize previousSize = victim->size;
+        if (!force) {
+            VkDeviceSize newSize = 0;
+            if (!internal_crenvk_texture2d_drop_level_async(renderer, victim, &newSize)) break;
+
+            usage -= previousSize - newSize;
+            dropped++;
+            continue;
+        }
+
+        // an allocation failed, the memory must be back before it's retried. Descriptor sets are re-written, nothing in flight may be using them
+        if (dropped == 0) vkDeviceWaitIdle(renderer->device.device);
+        if (!internal_crenvk_texture2d_drop_level(renderer, victim)) break;
+
+        usage -= previousSize - victim->size;
+        dropped++;
+    }
+
+    if (dropped > 0) {
+        CREN_LOG("CRen: Over the memory budget, dropped %u texture mip levels", dropped);
+        renderer->drawlist.version++; // recorded command buffers bound the re-written descriptor sets
+        internal_crenvk_memory_budget_query(renderer);
+    }
+
+    return dropped;
+}
+
+/// @brief retirement queue adapter for images replaced by streaming, only the image, view and memory of the holder are used
+/// @param device vulkan device
+/// @param object a texture backend holding the replaced objects
+static void internal_crenvk_streaming_image_release(VkDevice device, void* object) {
+    CRenTexture2DBackend* holder = (CRenTexture2DBackend*)object;
+
+    if (holder->view != VK_NULL_HANDLE) vkDestroyImageView(device, holder->view, NULL);
+    if (holder->image != VK_NULL_HANDLE) vkDestroyImage(device, holder->image, NULL);
+    if (holder->memory != VK_NULL_HANDLE) vkFreeMemory(device, holder->memory, NULL);
+
+    crenmemory_deallocate(holder);
+}
+
+/// @brief retires an image, it's view and memory once the frames in flight are done with them
+/// @param context cren context
+/// @param image the image
+/// @param view the image view
+/// @param memory the image memory
+static void internal_crenvk_streaming_image_retire(CRenContext* context, VkImage image, VkImageView view, VkDeviceMemory memory) {
+    CRenTexture2DBackend* holder = (CRenTexture2DBackend*)crenmemory_allocate(sizeof(CRenTexture2DBackend), 1);
+    if (!holder) {
+        CRenVulkanBackend* renderer = (CRenVulkanBackend*)context->backend;
+        vkDeviceWaitIdle(renderer->device.device);
+        vkDestroyImageView(renderer->device.device, view, NULL);
+        vkDestroyImage(renderer->device.device, image, NULL);
+        vkFreeMemory(renderer->device.device, memory, NULL);
+        return;
+    }
+
+    holder->image = image;
+    holder->view = view;
+    holder->memory = memory;
+    crenvk_retire(context, internal_crenvk_streaming_image_release, holder);
+}
+
+/// @brief retirement queue adapter for descriptor sets replaced by streaming
+/// @param device vulkan device
+/// @param object the retired descriptor set
+static void internal_crenvk_streaming_descriptor_release(VkDevice device, void* object) {
+    vkRetiredDescriptorSet* retired = (vkRetiredDescriptorSet*)object;
+    vkFreeDescriptorSets(device, retired->pool, 1, &retired->set);
+    crenmemory_deallocate(retired);
+}
+
+/// @brief returns the first level of a mip chain that is not larger than the streaming tail size
+/// @param width base level width
+/// @param height base level height
+/// @param mipLevels levels on the full chain
+/// @return the tail's first level
+static unsigned int internal_crenvk_streaming_tail_level(unsigned int width, unsigned int height, unsigned int mipLevels) {
+    unsigned int level = 0;
+    unsigned int size = uint_max(width, height);
+    while ((size >> level) > CREN_TEXTURE_STREAMING_TAIL_SIZE && level + 1 < mipLevels) level++;
+    return level;
+}
+
+/// @brief box-filters a rgba8 image into half it's size
+/// @param src source texels
+/// @param width source width
+/// @param height source height
+/// @param dst destination texels, must hold max(width / 2, 1) * max(height / 2, 1) texels
+static void internal_crenvk_streaming_halve(const unsigned char* src, unsigned int width, unsigned int height, unsigned char* dst) {
+    unsigned int dstWidth = uint_max(width / 2, 1);
+    unsigned int dstHeight = uint_max(height / 2, 1);
+
+    for (unsigned int y = 0; y < dstHeight; y++) {
+        unsigned int y0 = uint_min(y * 2, height - 1);
+        unsigned int y1 = uint_min(y * 2 + 1, height - 1);
+
+        for (unsigned int x = 0; x < dstWidth; x++) {
+            unsigned int x0 = uint_min(x * 2, width - 1);
+            unsigned int x1 = uint_min(x * 2 + 1, width - 1);
+
+            for (unsigned int c = 0; c < 4; c++) {
+                unsigned int sum = src[(y0 * width + x0) * 4 + c] + src[(y0 * width + x1) * 4 + c] + src[(y1 * width + x0) * 4 + c] + src[(y1 * width + x1) * 4 + c];
+                dst[(y * dstWidth + x) * 4 + c] = (unsigned char)((sum + 2) / 4);
+            }
+        }
+    }
+}
+
+/// @brief builds the mip chain of a texture from a base level on, uploading it to a new image. The upload is submitted but not waited on
+/// @param renderer cren vulkan backend
+/// @param job the streaming job, it's texture and base level must be set
+/// @param pixels full resolution rgba8 texels
+/// @return 1 on success, 0 on failure
+static int internal_crenvk_streaming_build(CRenVulkanBackend* renderer, vkStreamingJob* job, const unsigned char* pixels) {
+    CRenTexture2DBackend* texture = job->texture;
+    VkDevice device = renderer->device.device;
+    VkCommandPool cmdPool = renderer->mipmapGenerator.graphicsCommandPool;
+
+    job->width = uint_max(texture->fullWidth >> job->baseLevel, 1);
+    job->height = uint_max(texture->fullHeight >> job->baseLevel, 1);
+    job->mipLevels = texture->fullMipLevels - job->baseLevel;
+
+    // every level is generated on the cpu, one after the other, so the whole chain is a single copy
+    VkDeviceSize chainSize = 0;
+    for (unsigned int level = 0; level < job->mipLevels; level++) {
+        chainSize += (VkDeviceSize)uint_max(job->width >> level, 1) * uint_max(job->height >> level, 1) * 4;
+    }
+
+    // the levels above the base are only needed to get to it
+    unsigned int width = texture->fullWidth;
+    unsigned int height = texture->fullHeight;
+    unsigned char* scratch = NULL;
+    const unsigned char* base = pixels;
+
+    if (job->baseLevel > 0) {
+        scratch = (unsigned char*)crenmemory_allocate((VkDeviceSize)uint_max(width / 2, 1) * uint_max(height / 2, 1) * 4 * 2, 0);
+        if (!scratch) return 0;
+
+        unsigned char* halves[2] = { scratch, scratch + (VkDeviceSize)uint_max(width / 2, 1) * uint_max(height / 2, 1) * 4 };
+        for (unsigned int level = 0; level < job->baseLevel; level++) {
+            unsigned char* dst = halves[level % 2];
+            internal_crenvk_streaming_halve(base, width, height, dst);
+            base = dst;
+            width = uint_max(width / 2, 1);
+            height = uint_max(height / 2, 1);
+        }
+    }
+
+    unsigned char* chain = (unsigned char*)crenmemory_allocate(chainSize, 0);
+    if (!chain) {
+        if (scratch) crenmemory_deallocate(scratch);
+        return 0;
+    }
+
+    VkBufferImageCopy regions[32] = { 0 };
+    VkDeviceSize offset = 0;
+    for (unsigned int level = 0; level < job->mipLevels; level++) {
+        unsigned int levelWidth = uint_max(job->width >> level, 1);
+        unsigned int levelHeight = uint_max(job->height >> level, 1);
+
+        if (level == 0) crenmemory_copy(chain, base, (size_t)levelWidth * levelHeight * 4);
+        else internal_crenvk_streaming_halve(chain + regions[level - 1].bufferOffset, uint_max(job->width >> (level - 1), 1), uint_max(job->height >> (level - 1), 1), chain + offset);
+
+        regions[level].bufferOffset = offset;
+        regions[level].imageSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+        regions[level].imageSubresource.mipLevel = level;
+        regions[level].imageSubresource.layerCount = 1;
+        regions[level].imageExtent.width = levelWidth;
+        regions[level].imageExtent.height = levelHeight;
+        regions[level].imageExtent.depth = 1;
+        offset += (VkDeviceSize)levelWidth * levelHeight * 4;
+    }
+
+    if (scratch) crenmemory_deallocate(scratch);
+
+    int success = crenvk_device_create_buffer(device, renderer->device.physicalDevice, VK_BUFFER_USAGE_TRANSFER_SRC_BIT, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, chainSize, &job->staging, &job->stagingMemory, chain);
+    crenmemory_deallocate(chain);
+    if (!success) return 0;
+
+    if (!crenvk_image_create(job->width, job->height, job->mipLevels, 1, device, renderer->device.physicalDevice, &job->image, &job->memory, texture->format, VK_SAMPLE_COUNT_1_BIT, VK_IMAGE_TILING_OPTIMAL, texture->usage, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, texture->flags)) {
+        vkDestroyBuffer(device, job->staging, NULL);
+        vkFreeMemory(device, job->stagingMemory, NULL);
+        return 0;
+    }
+
+    VkCommandBufferAllocateInfo cmdBufferAllocInfo = { 0 };
+    cmdBufferAllocInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
+    cmdBufferAllocInfo.commandPool = cmdPool;
+    cmdBufferAllocInfo.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
+    cmdBufferAllocInfo.commandBufferCount = 1;
+    vkAllocateCommandBuffers(device, &cmdBufferAllocInfo, &job->cmdBuffer);
+
+    VkCommandBufferBeginInfo beginInfo = { 0 };
+    beginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+    beginInfo.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+    vkBeginCommandBuffer(job->cmdBuffer, &beginInfo);
+
+    VkImageMemoryBarrier barrier = { 0 };
+    barrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+    barrier.image = job->image;
+    barrier.oldLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+    barrier.newLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+    barrier.srcAccessMask = 0;
+    barrier.dstAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+    barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    barrier.subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+    barrier.subresourceRange.levelCount = job->mipLevels;
+    barrier.subresourceRange.layerCount = 1;
+    vkCmdPipelineBarrier(job->cmdBuffer, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT, 0, 0, NULL, 0, NULL, 1, &barrier);
+
+    vkCmdCopyBufferToImage(job->cmdBuffer, job->staging, job->image, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, job->mipLevels, regions);
+
+    barrier.oldLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+    barrier.newLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+    barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+    barrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
+    vkCmdPipelineBarrier(job->cmdBuffer, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT, 0, 0, NULL, 0, NULL, 1, &barrier);
+
+    vkEndCommandBuffer(job->cmdBuffer);
+
+    VkFenceCreateInfo fenceCI = { 0 };
+    fenceCI.sType = VK_STRUCTURE_TYPE_FENCE_CREATE_INFO;
+    vkCreateFence(device, &fenceCI, NULL, &job->fence);
+
+    VkSubmitInfo submitInfo = { 0 };
+    submitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+    submitInfo.commandBufferCount = 1;
+    submitInfo.pCommandBuffers = &job->cmdBuffer;
+    vkQueueSubmit(renderer->device.graphicsQueue, 1, &submitInfo, job->fence);
+
+    job->view = crenvk_image_view_create(device, job->image, VK_FORMAT_R8G8B8A8_SRGB, VK_IMAGE_ASPECT_COLOR_BIT, job->mipLevels, 1, VK_IMAGE_VIEW_TYPE_2D);
+    return 1;
+}
+
+/// @brief releases the upload resources of a job, it's upload must have finished
+/// @param renderer cren vulkan backend
+/// @param job the streaming job
+static void internal_crenvk_streaming_upload_release(CRenVulkanBackend* renderer, vkStreamingJob* job) {
+    VkDevice device = renderer->device.device;
+
+    if (job->fence != VK_NULL_HANDLE) vkDestroyFence(device, job->fence, NULL);
+    if (job->cmdBuffer != VK_NULL_HANDLE) vkFreeCommandBuffers(device, renderer->mipmapGenerator.graphicsCommandPool, 1, &job->cmdBuffer);
+    if (job->staging != VK_NULL_HANDLE) vkDestroyBuffer(device, job->staging, NULL);
+    if (job->stagingMemory != VK_NULL_HANDLE) vkFreeMemory(device, job->stagingMemory, NULL);
+
+    job->fence = VK_NULL_HANDLE;
+    job->cmdBuffer = VK_NULL_HANDLE;
+    job->staging = VK_NULL_HANDLE;
+    job->stagingMemory = VK_NULL_HANDLE;
+}
+
+/// @brief makes the job's image the texture's image, every descriptor set must already point to it
+/// @param context cren context
+/// @param job the streaming job
+static void internal_crenvk_streaming_finish(CRenContext* context, vkStreamingJob* job) {
+    CRenVulkanBackend* renderer = (CRenVulkanBackend*)context->backend;
+    CRenTexture2DBackend* texture = job->texture;
+
+    if (job->baseLevel < texture->evictedLevels) renderer->textureStreamer.streamedIn++;
+    else renderer->textureStreamer.streamedOut++;
+
+    internal_crenvk_streaming_image_retire(context, texture->image, texture->view, texture->memory);
+
+    // the ui descriptor set is used by every frame, a new one is allocated instead of re-writing it
+    if (texture->uiDescriptor != VK_NULL_HANDLE) {
+        vkRetiredDescriptorSet* retired = (vkRetiredDescriptorSet*)crenmemory_allocate(sizeof(vkRetiredDescriptorSet), 1);
+        if (retired) {
+            retired->pool = renderer->uiRenderphase.descPool;
+            retired->set = texture->uiDescriptor;
+            crenvk_retire(context, internal_crenvk_streaming_descriptor_release, retired);
+            texture->uiDescriptor = crenvk_image_descriptor_set_create(renderer->device.device, renderer->uiRenderphase.descPool, renderer->uiRenderphase.descSetLayout, texture->sampler, job->view);
+        }
+    }
+
+    VkMemoryRequirements memRequirements;
+    vkGetImageMemoryRequirements(renderer->device.device, job->image, &memRequirements);
+    renderer->textureResidency.residentBytes -= texture->size;
+    renderer->textureResidency.residentBytes += memRequirements.size;
+
+    texture->image = job->image;
+    texture->view = job->view;
+    texture->memory = job->memory;
+    texture->width = job->width;
+    texture->height = job->height;
+    texture->mipLevels = job->mipLevels;
+    texture->evictedLevels = job->baseLevel;
+    texture->size = memRequirements.size;
+    texture->streaming = 0;
+}
+
+/// @brief re-writes the descriptor sets of the frame slots that aren't in flight anymore to sample the job's image
+/// @param renderer cren vulkan backend
+/// @param job the streaming job
+static void internal_crenvk_streaming_switch_slots(CRenVulkanBackend* renderer, vkStreamingJob* job) {
+    CRenTexture2DBackend* texture = job->texture;
+
+    VkDescriptorImageInfo imageInfo = { 0 };
+    imageInfo.sampler = texture->sampler;
+    imageInfo.imageView = job->view;
+    imageInfo.imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+
+    VkWriteDescriptorSet write = { 0 };
+    write.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+    write.dstBinding = texture->boundBinding;
+    write.descriptorCount = 1;
+    write.descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+    write.pImageInfo = &imageInfo;
+
+    for (unsigned int slot = 0; slot < CREN_CONCURRENTLY_RENDERED_FRAMES; slot++) {
+        if (!(job->pendingSlots & (1u << slot))) continue;
+        if (vkGetFenceStatus(renderer->device.device, renderer->device.framesInFlightFences[slot]) != VK_SUCCESS) continue;
+
+        if (texture->boundSets[slot] != VK_NULL_HANDLE) {
+            write.dstSet = texture->boundSets[slot];
+            vkUpdateDescriptorSets(renderer->device.device, 1, &write, 0, NULL);
+            renderer->drawlist.version++; // recorded command buffers bound the re-written set
+        }
+
+        job->pendingSlots &= ~(1u << slot);
+    }
+}
+
+/// @brief stops a texture's streaming job, if any
+/// @param context cren context
+/// @param texture the texture backend
+static void internal_crenvk_streaming_cancel(CRenContext* context, CRenTexture2DBackend* texture) {
+    if (!texture->streaming) return;
+
+    CRenVulkanBackend* renderer = (CRenVulkanBackend*)context->backend;
+    vkTextureStreamer* streamer = &renderer->textureStreamer;
+
+    for (unsigned int i = 0; i < streamer->jobCount; i++) {
+        vkStreamingJob* job = &streamer->jobs[i];
+        if (job->texture != texture) continue;
+
+        if (job->fence != VK_NULL_HANDLE) vkWaitForFences(renderer->device.device, 1, &job->fence, VK_TRUE, UINT64_MAX);
+        internal_crenvk_streaming_upload_release(renderer, job);
+        internal_crenvk_streaming_image_retire(context, job->image, job->view, job->memory);
+
+        streamer->jobs[i] = streamer->jobs[--streamer->jobCount];
+        break;
+    }
+
+    texture->streaming = 0;
+}
+
+/// @brief starts re-building a texture with a new base level, the source is re-loaded from the texture's path
+/// @param context cren context
+/// @param texture the texture backend
+/// @param baseLevel the new resident base level
+/// @return 1 on success, 0 on failure
+static int internal_crenvk_streaming_start(CRenContext* context, CRenTexture2DBackend* texture, unsigned int baseLevel) {
+    CRenVulkanBackend* renderer = (CRenVulkanBackend*)context->backend;
+    vkTextureStreamer* streamer = &renderer->textureStreamer;
+
+    int width = 0, height = 0, channels = 0;
+    unsigned char* pixels = cren_stbimage_load_from_file(texture->path, 4, &width, &height, &channels);
+
+    // the file is gone or changed, the texture stays as it is
+    if (pixels == NULL || (unsigned int)width != texture->fullWidth || (unsigned int)height != texture->fullHeight) {
+        if (pixels != NULL) cren_stbimage_destroy(pixels);
+        texture->streamable = 0;
+        return 0;
+    }
+
+    vkStreamingJob* job = &streamer->jobs[streamer->jobCount];
+    crenmemory_zero(job, sizeof(vkStreamingJob));
+    job->texture = texture;
+    job->baseLevel = baseLevel;
+
+    int success = internal_crenvk_streaming_build(renderer, job, pixels);
+    cren_stbimage_destroy(pixels);
+    if (!success) return 0;
+
+    streamer->jobCount++;
+    texture->streaming = 1;
+    return 1;
+}
+
+/// @brief records the finest level a texture needs given how big it's drawn on screen
+/// @param context cren context
+/// @param texture the texture backend
+/// @param model transformation of the object sampling it
+static void internal_crenvk_streaming_request(CRenContext* context, CRenTexture2DBackend* texture, const mat4* model) {
+    if (texture == NULL || !texture->streamable) return;
+
+    CRenVulkanBackend* renderer = (CRenVulkanBackend*)context->backend;
+    unsigned long long frame = renderer->retirement.frameNumber;
+    float viewportHeight = renderer->hint_viewport ? (float)renderer->viewportRenderphase.renderExtent.height : (float)renderer->swapchain.swapchainExtent.height;
+
+    // projected size of the object's largest axis, in pixels
+    float3 axisX = { model->data[0][0], model->data[0][1], model->data[0][2] };
+    float3 axisY = { model->data[1][0], model->data[1][1], model->data[1][2] };
+    float worldSize = f_max(float3_length(axisX), float3_length(axisY));
+    float depth = f_max(internal_crenvk_drawlist_depth(&context->camera.view, model), context->camera.near);
+    float pixels = worldSize * context->camera.perspective.data[1][1] * 0.5f * viewportHeight / depth;
+
+    // coarsest level that still has at least a texel per pixel
+    unsigned int level = 0;
+    unsigned int size = uint_max(texture->fullWidth, texture->fullHeight);
+    while (level + 1 < texture->fullMipLevels && (float)(size >> (level + 1)) >= pixels) level++;
+
+    if (texture->requestedFrame != frame) {
+        texture->requestedFrame = frame;
+        texture->requestedLevel = level;
+    }
+
+    else texture->requestedLevel = uint_min(texture->requestedLevel, level);
+}
+
+/// @brief advances the streaming jobs and starts new ones, must be called after the frame's fence was waited
+/// @param context cren context
+static void internal_crenvk_streaming_update(CRenContext* context) {
+    CRenVulkanBackend* renderer = (CRenVulkanBackend*)context->backend;
+    vkTextureStreamer* streamer = &renderer->textureStreamer;
+    vkTextureResidency* residency = &renderer->textureResidency;
+    const unsigned long long frame = renderer->retirement.frameNumber;
+
+    // finished uploads switch the descriptor sets over, slot by slot as frames leave the gpu
+    for (unsigned int i = 0; i < streamer->jobCount;) {
+        vkStreamingJob* job = &streamer->jobs[i];
+
+        if (!job->uploaded) {
+            if (vkGetFenceStatus(renderer->device.device, job->fence) != VK_SUCCESS) { i++; continue; }
+
+            internal_crenvk_streaming_upload_release(renderer, job);
+            job->uploaded = 1;
+            job->pendingSlots = (1u << CREN_CONCURRENTLY_RENDERED_FRAMES) - 1;
+        }
+
+        internal_crenvk_streaming_switch_slots(renderer, job);
+        if (job->pendingSlots != 0) { i++; continue; }
+
+        internal_crenvk_streaming_finish(context, job);
+        streamer->jobs[i] = streamer->jobs[--streamer->jobCount];
+    }
+
+    // requests made through the draw list
+    for (unsigned int i = 0; i < renderer->drawlist.packetCount; i++) {
+        internal_crenvk_streaming_request(context, renderer->drawlist.packets[i].texture, &renderer->drawlist.packets[i].model);
+    }
+
+    if (streamer->jobCount == CREN_TEXTURE_STREAMING_JOBS_MAX) return;
+
+    // the texture furthest from the level it needs is streamed first, at most one per frame since the source is decoded here
+    CRenTexture2DBackend* candidate = NULL;
+    unsigned int candidateLevel = 0;
+    unsigned int candidateDistance = 0;
+
+    for (unsigned int i = 0; i < residency->count; i++) {
+        CRenTexture2DBackend* texture = residency->textures[i];
+        if (!texture->streamable || texture->streaming) continue;
+
+        // textures off-screen for a while go back to their tail
+        unsigned int tailLevel = internal_crenvk_streaming_tail_level(texture->fullWidth, texture->fullHeight, texture->fullMipLevels);
+        unsigned int desired = texture->requestedFrame + CREN_TEXTURE_STREAMING_IDLE_FRAMES >= frame ? uint_min(texture->requestedLevel, tailLevel) : tailLevel;
+
+        // streaming out waits for a two levels difference, so a texture right at the edge of a level doesn't ping-pong
+        unsigned int distance = 0;
+        if (desired < texture->evictedLevels) distance = (texture->evictedLevels - desired) * 2;
+        else if (desired > texture->evictedLevels + 1) distance = desired - texture->evictedLevels;
+
+        if (distance > candidateDistance) {
+            candidate = texture;
+            candidateLevel = desired;
+            candidateDistance = distance;
+        }
+    }
+
+    if (candidate == NULL) return;
+
+    // streaming in must fit the budget, evicting idle textures if needed
+    if (candidateLevel < candidate->evictedLevels) {
+        VkDeviceSize width = uint_max(candidate->fullWidth >> candidateLevel, 1);
+        VkDeviceSize height = uint_max(candidate->fullHeight >> candidateLevel, 1);
+        VkDeviceSize incoming = width * height * 4 * 4 / 3;
+
+        crenvk_memory_evict_textures(context, incoming, 0);
+
+        vkMemoryBudget* budget = &renderer->memoryBudget;
+        if (budget->heapUsage[budget->textureHeap] + incoming > budget->heapBudget[budget->textureHeap] / 10 * 9) return;
+    }
+
+    internal_crenvk_streaming_start(context, candidate, candidateLevel);
+}
+
+/// @brief releases every streaming job right away, the device must be idle
+/// @param renderer cren vulkan backend
+static void internal_crenvk_streaming_destroy(CRenVulkanBackend* renderer) {
+    vkTextureStreamer* streamer = &renderer->textureStreamer;
+
+    for (unsigned int i = 0; i < streamer->jobCount; i++) {
+        vkStreamingJob* job = &streamer->jobs[i];
+        internal_crenvk_streaming_upload_release(renderer, job);
+        vkDestroyImageView(renderer->device.device, job->view, NULL);
+        vkDestroyImage(renderer->device.device, job->image, NULL);
+        vkFreeMemory(renderer->device.device, job->memory, NULL);
+        job->texture->streaming = 0;
+    }
+
+    streamer->jobCount = 0;
+}
+
+void crenvk_texture_streaming_set_enabled(CRenContext* context, int enabled) {
+    CRenVulkanBackend* renderer = (CRenVulkanBackend*)context->backend;
+    renderer->textureStreamer.enabled = enabled;
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Capture-related
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+/// @brief encodes a slot's texels and hands the file to the capture callback
+/// @param slot the capture slot, owned by the worker
+static void internal_crenvk_capture_encode(vkCaptureSlot* slot) {
+    CRenCapture capture = { 0 };
+    capture.format = slot->format;
+    capture.width = slot->width;
+    capture.height = slot->height;
+    capture.frame = slot->frame;
+
+    // the frame's alpha is meaningless once presented, captures are always opaque
+    size_t texelCount = (size_t)slot->width * slot->height;
+    unsigned char* rgba = (unsigned char*)crenmemory_allocate(texelCount * 4, 0);
+
+    if (rgba != NULL) {
+        const unsigned char* src = (const unsigned char*)slot->mapped;
+        for (size_t i = 0; i < texelCount; i++) {
+            rgba[i * 4 + 0] = src[i * 4 + (slot->bgra ? 2 : 0)];
+            rgba[i * 4 + 1] = src[i * 4 + 1];
+            rgba[i * 4 + 2] = src[i * 4 + (slot->bgra ? 0 : 2)];
+            rgba[i * 4 + 3] = 255;
+        }
+
+        unsigned long long size = 0;
+        unsigned char* file = cren_stbimage_encode(rgba, (int)slot->width, (int)slot->height, 4, slot->format == Capture_JPEG, CREN_CAPTURE_JPEG_QUALITY, &size);
+        crenmemory_deallocate(rgba);
+
+        capture.success = file != NULL;
+        capture.data = file;
+        capture.size = size;
+        slot->callback(&capture, slot->userData);
+        cren_stbimage_encoded_destroy(file);
+        return;
+    }
+
+    slot->callback(&capture, slot->userData);
+}
+
+/// @brief converts a slot's texels into it's place on the frame sequence file and starts writing them back to disk
+/// @param sequence the frame sequence, it's file stays open while the slot is owned by the worker
+/// @param slot the capture slot, owned by the worker
+static void internal_crenvk_capture_write(vkCaptureSequence* sequence, vkCaptureSlot* slot) {
+    unsigned long long offset = sequence->headerSize + slot->sequenceIndex * sequence->frameSize;
+    unsigned char* dst = sequence->data + offset;
+    const unsigned char* src = (const unsigned char*)slot->mapped;
+    const size_t texelCount = (size_t)slot->width * slot->height;
+    const int red = slot->bgra ? 2 : 0;
+    const int blue = slot->bgra ? 0 : 2;
+
+    if (sequence->format == Sequence_Raw) {
+        for (size_t i = 0; i < texelCount; i++) {
+            dst[i * 4 + 0] = src[i * 4 + red];
+            dst[i * 4 + 1] = src[i * 4 + 1];
+            dst[i * 4 + 2] = src[i * 4 + blue];
+            dst[i * 4 + 3] = 255;
+        }
+    }
+
+    // bt.601 limited range, the bias keeps every sum positive before shifting
+    else {
+        crenmemory_copy(dst, "FRAME\n", 6);
+        unsigned char* y = dst + 6;
+        unsigned char* u = y + texelCount;
+        unsigned char* v = u + texelCount;
+
+        for (size_t i = 0; i < texelCount; i++) {
+            int r = src[i * 4 + red];
+            int g = src[i * 4 + 1];
+            int b = src[i * 4 + blue];
+            y[i] = (unsigned char)((66 * r + 129 * g + 25 * b + 4224) >> 8);
+            u[i] = (unsigned char)((-38 * r - 74 * g + 112 * b + 32896) >> 8);
+            v[i] = (unsigned char)((112 * r - 94 * g - 18 * b + 32896) >> 8);
+        }
+    }
+
+    cren_file_map_flush(sequence->file, offset, sequence->frameSize);
+}
+
+/// @brief capture worker entry point, encodes slots as they're copied until the ring shuts down
+/// @param argument the capture ring
+/// @return 0
+static int internal_crenvk_capture_worker(void* argument) {
+    vkCaptureRing* ring = (vkCaptureRing*)argument;
+
+    cren_mutex_lock(ring->mutex);
+
+    while (1) {
+        vkCaptureSlot* slot = NULL;
+        for (unsigned int i = 0; i < CREN_CAPTURE_RING_SIZE; i++) {
+            if (ring->slots[i].state == CaptureSlot_Encoding) {
+                slot = &ring->slots[i];
+                break;
+            }
+        }
+
+        // pending encodings are still delivered when shutting down
+        if (slot == NULL) {
+            if (!ring->running) break;
+            cren_condition_wait(ring->condition, ring->mutex);
+            continue;
+        }
+
+        cren_mutex_unlock(ring->mutex);
+        if (slot->sequence) internal_crenvk_capture_write(&ring->sequence, slot);
+        else internal_crenvk_capture_encode(slot);
+        cren_mutex_lock(ring->mutex);
+
+        if (slot->sequence) ring->sequence.written++;
+        slot->state = CaptureSlot_Free;
+    }
+
+    cren_mutex_unlock(ring->mutex);
+    return 0;
+}
+
+/// @brief makes sure a slot's readback buffer can hold an image, the slot must not be in use by the gpu or the worker
+/// @param renderer cren vulkan backend
+/// @param slot the capture slot
+/// @param size required size in bytes
+/// @return 1 on success, 0 on failure
+static int internal_crenvk_capture_slot_reserve(CRenVulkanBackend* renderer, vkCaptureSlot* slot, VkDeviceSize size) {
+    VkDevice device = renderer->device.device;
+
+    if (slot->cmdBuffer == VK_NULL_HANDLE) {
+        VkCommandBufferAllocateInfo cmdBufferAllocInfo = { 0 };
+        cmdBufferAllocInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
+        cmdBufferAllocInfo.commandPool = renderer->mipmapGenerator.graphicsCommandPool;
+        cmdBufferAllocInfo.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
+        cmdBufferAllocInfo.commandBufferCount = 1;
+        if (vkAllocateCommandBuffers(device, &cmdBufferAllocInfo, &slot->cmdBuffer) != VK_SUCCESS) return 0;
+    }
+
+    if (slot->buffer != VK_NULL_HANDLE && slot->size >= size) return 1;
+
+    if (slot->buffer != VK_NULL_HANDLE) {
+        vkUnmapMemory(device, slot->memory);
+        vkDestroyBuffer(device, slot->buffer, NULL);
+        vkFreeMemory(device, slot->memory, NULL);
+        slot->buffer = VK_NULL_HANDLE;
+        slot->memory = VK_NULL_HANDLE;
+        slot->mapped = NULL;
+        slot->size = 0;
+    }
+
+    // host cached memory would be faster to read, but coherent is always available
+    if (!crenvk_device_create_buffer(device, renderer->device.physicalDevice, VK_BUFFER_USAGE_TRANSFER_DST_BIT, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, size, &slot->buffer, &slot->memory, NULL)) {
+        return 0;
+    }
+
+    vkMapMemory(device, slot->memory, 0, size, 0, &slot->mapped);
+    slot->size = size;
+    return 1;
+}
+
+/// @brief returns the image captured on the current frame, the viewport image is sampled by the ui and the swapchain image is about to be presented
+/// @param renderer cren vulkan backend
+/// @param image output image
+/// @param layout output layout the image is on at the end of the frame
+/// @return the image extent
+static VkExtent2D internal_crenvk_capture_source(CRenVulkanBackend* renderer, VkImage* image, VkImageLayout* layout) {
+    if (renderer->hint_viewport) {
+        if (image) *image = renderer->viewportRenderphase.colorImage;
+        if (layout) *layout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+        return renderer->viewportRenderphase.renderExtent;
+    }
+
+    if (image) *image = renderer->swapchain.swapchainImages[renderer->device.imageIndex];
+    if (layout) *layout = VK_IMAGE_LAYOUT_PRESENT_SRC_KHR;
+    return renderer->swapchain.swapchainExtent;
+}
+
+/// @brief requests a slot for the frame sequence when the current frame must be captured, must be called with the ring locked
+/// @param ring the capture ring
+/// @param extent the captured image extent
+static void internal_crenvk_capture_sequence_request(vkCaptureRing* ring, VkExtent2D extent) {
+    vkCaptureSequence* sequence = &ring->sequence;
+    if (!sequence->recording || sequence->frameCounter++ % sequence->interval != 0) return;
+
+    if (sequence->assigned == sequence->frameCapacity) {
+        CREN_LOG("CRen: Frame sequence is full, %llu frames written", sequence->assigned);
+        sequence->recording = 0;
+        return;
+    }
+
+    // the container holds a single size, resized frames can't be written
+    if (extent.width != sequence->width || extent.height != sequence->height) {
+        sequence->dropped++;
+        return;
+    }
+
+    for (unsigned int i = 0; i < CREN_CAPTURE_RING_SIZE; i++) {
+        vkCaptureSlot* slot = &ring->slots[i];
+        if (slot->state != CaptureSlot_Free) continue;
+
+        slot->state = CaptureSlot_Requested;
+        slot->sequence = 1;
+        slot->callback = NULL;
+        slot->userData = NULL;
+        return;
+    }
+
+    // every slot is still being copied or written, the disk isn't keeping up
+    sequence->dropped++;
+}
+
+/// @brief records the copies of the requested captures, their command buffers are submitted after the frame's ones
+/// @param renderer cren vulkan backend
+/// @param cmdBuffers where the capture command buffers are written to
+/// @return how many command buffers were recorded
+static unsigned int internal_crenvk_capture_record(CRenVulkanBackend* renderer, VkCommandBuffer* cmdBuffers) {
+    vkCaptureRing* ring = &renderer->captureRing;
+    if (ring->worker == NULL) return 0;
+
+    VkImage image = VK_NULL_HANDLE;
+    VkImageLayout layout = VK_IMAGE_LAYOUT_UNDEFINED;
+    VkExtent2D extent = internal_crenvk_capture_source(renderer, &image, &layout);
+    VkFormat format = renderer->swapchain.swapchainFormat.format;
+    int bgra = format == VK_FORMAT_B8G8R8A8_UNORM || format == VK_FORMAT_B8G8R8A8_SRGB;
+
+    unsigned int count = 0;
+    cren_mutex_lock(ring->mutex);
+    internal_crenvk_capture_sequence_request(ring, extent);
+
+    for (unsigned int i = 0; i < CREN_CAPTURE_RING_SIZE; i++) {
+        vkCaptureSlot* slot = &ring->slots[i];
+        if (slot->state != CaptureSlot_Requested) continue;
+
+        if (!internal_crenvk_capture_slot_reserve(renderer, slot, (VkDeviceSize)extent.width * extent.height * 4)) {
+            CREN_LOG("CRen: Failed to allocate the frame capture readback buffer");
+            if (slot->sequence) ring->sequence.dropped++;
+            slot->state = CaptureSlot_Free;
+            continue;
+        }
+
+        VkCommandBufferBeginInfo beginInfo = { 0 };
+        beginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+        beginInfo.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+        vkBeginCommandBuffer(slot->cmdBuffer, &beginInfo);
+
+        VkImageMemoryBarrier barrier = { 0 };
+        barrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+        barrier.image = image;
+        barrier.oldLayout = layout;
+        barrier.newLayout = VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL;
+        barrier.srcAccessMask = VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT;
+        barrier.dstAccessMask = VK_ACCESS_TRANSFER_READ_BIT;
+        barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+        barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+        barrier.subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+        barrier.subresourceRange.levelCount = 1;
+        barrier.subresourceRange.layerCount = 1;
+        vkCmdPipelineBarrier(slot->cmdBuffer, VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT | VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT, 0, 0, NULL, 0, NULL, 1, &barrier);
+
+        VkBufferImageCopy region = { 0 };
+        region.imageSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+        region.imageSubresource.layerCount = 1;
+        region.imageExtent.width = extent.width;
+        region.imageExtent.height = extent.height;
+        region.imageExtent.depth = 1;
+        vkCmdCopyImageToBuffer(slot->cmdBuffer, image, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL, slot->buffer, 1, &region);
+
+        // back to where the frame expects it, the host reads the buffer once the frame fence signals
+        barrier.oldLayout = VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL;
+        barrier.newLayout = layout;
+        barrier.srcAccessMask = VK_ACCESS_TRANSFER_READ_BIT;
+        barrier.dstAccessMask = 0;
+
+        VkBufferMemoryBarrier bufferBarrier = { 0 };
+        bufferBarrier.sType = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER;
+        bufferBarrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+        bufferBarrier.dstAccessMask = VK_ACCESS_HOST_READ_BIT;
+        bufferBarrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+        bufferBarrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+        bufferBarrier.buffer = slot->buffer;
+        bufferBarrier.size = VK_WHOLE_SIZE;
+        vkCmdPipelineBarrier(slot->cmdBuffer, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT | VK_PIPELINE_STAGE_HOST_BIT, 0, 0, NULL, 1, &bufferBarrier, 1, &barrier);
+
+        vkEndCommandBuffer(slot->cmdBuffer);
+
+        slot->frame = renderer->retirement.frameNumber;
+        slot->width = extent.width;
+        slot->height = extent.height;
+        slot->bgra = bgra;
+        slot->state = CaptureSlot_Copying;
+        if (slot->sequence) slot->sequenceIndex = ring->sequence.assigned++;
+        cmdBuffers[count++] = slot->cmdBuffer;
+    }
+
+    cren_mutex_unlock(ring->mutex);
+    return count;
+}
+
+/// @brief closes the frame sequence file once it stopped recording and every captured frame was written, must be called with the ring locked
+/// @param ring the capture ring
+static void internal_crenvk_capture_sequence_close(vkCaptureRing* ring) {
+    vkCaptureSequence* sequence = &ring->sequence;
+    if (sequence->file == NULL || sequence->recording) return;
+
+    for (unsigned int i = 0; i < CREN_CAPTURE_RING_SIZE; i++) {
+        if (ring->slots[i].sequence && ring->slots[i].state != CaptureSlot_Free) return;
+    }
+
+    // the file was allocated for every frame, only the written ones are kept
+    cren_file_map_destroy(sequence->file, sequence->headerSize + sequence->written * sequence->frameSize);
+    CREN_LOG("CRen: Frame sequence closed, %llu frames written and %llu dropped", sequence->written, sequence->dropped);
+    sequence->file = NULL;
+    sequence->data = NULL;
+
+    for (unsigned int i = 0; i < CREN_CAPTURE_RING_SIZE; i++) {
+        ring->slots[i].sequence = 0;
+    }
+}
+
+/// @brief hands the slots whose frame left the gpu to the worker
+/// @param renderer cren vulkan backend
+/// @param all hands every copying slot, used when the device is idle
+static void internal_crenvk_capture_collect(CRenVulkanBackend* renderer, int all) {
+    vkCaptureRing* ring = &renderer->captureRing;
+    if (ring->worker == NULL) return;
+
+    const unsigned long long frame = renderer->retirement.frameNumber;
+    int ready = 0;
+
+    cren_mutex_lock(ring->mutex);
+
+    for (unsigned int i = 0; i < CREN_CAPTURE_RING_SIZE; i++) {
+        vkCaptureSlot* slot = &ring->slots[i];
+        if (slot->state != CaptureSlot_Copying) continue;
+        if (!all && slot->frame + CREN_CONCURRENTLY_RENDERED_FRAMES > frame) continue;
+
+        slot->state = CaptureSlot_Encoding;
+        ready = 1;
+    }
+
+    if (ready) cren_condition_signal(ring->condition);
+    internal_crenvk_capture_sequence_close(ring);
+    cren_mutex_unlock(ring->mutex);
+}
+
+/// @brief stops the worker once every pending capture is delivered and releases the ring, the device must be idle
+/// @param renderer cren vulkan backend
+static void internal_crenvk_capture_destroy(CRenVulkanBackend* renderer) {
+    vkCaptureRing* ring = &renderer->captureRing;
+    if (ring->worker == NULL) return;
+
+    internal_crenvk_capture_collect(renderer, 1);
+
+    cren_mutex_lock(ring->mutex);
+    ring->running = 0;
+    cren_condition_signal(ring->condition);
+    cren_mutex_unlock(ring->mutex);
+    cren_thread_join(ring->worker);
+
+    ring->sequence.recording = 0;
+    internal_crenvk_capture_sequence_close(ring);
+
+    for (unsigned int i = 0; i < CREN_CAPTURE_RING_SIZE; i++) {
+        vkCaptureSlot* slot = &ring->slots[i];
+
+        if (slot->cmdBuffer != VK_NULL_HANDLE) vkFreeCommandBuffers(renderer->device.device, renderer->mipmapGenerator.graphicsCommandPool, 1, &slot->cmdBuffer);
+
+        if (slot->buffer != VK_NULL_HANDLE) {
+            vkUnmapMemory(renderer->device.device, slot->memory);
+            vkDestroyBuffer(renderer->device.device, slot->buffer, NULL);
+            vkFreeMemory(renderer->device.device, slot->memory, NULL);
+        }
+    }
+
+    cren_condition_destroy(ring->condition);
+    cren_mutex_destroy(ring->mutex);
+    crenmemory_zero(ring, sizeof(vkCaptureRing));
+}
+
+/// @brief starts the capture worker if it's not running yet, the worker only exists once something is captured
+/// @param ring the capture ring
+/// @return 1 on success, 0 on failure
+static int internal_crenvk_capture_start(vkCaptureRing* ring) {
+    if (ring->worker != NULL) return 1;
+
+    ring->mutex = cren_mutex_create();
+    ring->condition = cren_condition_create();
+    ring->running = 1;
+    ring->worker = ring->mutex && ring->condition ? cren_thread_create(internal_crenvk_capture_worker, ring) : NULL;
+    if (ring->worker != NULL) return 1;
+
+    CREN_LOG("CRen: Failed to start the frame capture worker");
+    cren_condition_destroy(ring->condition);
+    cren_mutex_destroy(ring->mutex);
+    crenmemory_zero(ring, sizeof(vkCaptureRing));
+    return 0;
+}
+
+int crenvk_capture_request(CRenContext* context, CRenCaptureFormat format, CRenCallback_Capture callback, void* userData) {
+    CRenVulkanBackend* renderer = (CRenVulkanBackend*)context->backend;
+    vkCaptureRing* ring = &renderer->captureRing;
+    if (!internal_crenvk_capture_start(ring)) return 0;
+
+    int queued = 0;
+    cren_mutex_lock(ring->mutex);
+
+    for (unsigned int i = 0; i < CREN_CAPTURE_RING_SIZE; i++) {
+        vkCaptureSlot* slot = &ring->slots[i];
+        if (slot->state != CaptureSlot_Free) continue;
+
+        slot->state = CaptureSlot_Requested;
+        slot->sequence = 0;
+        slot->format = format;
+        slot->callback = callback;
+        slot->userData = userData;
+        queued = 1;
+        break;
+    }
+
+    cren_mutex_unlock(ring->mutex);
+    return queued;
+}
+
+int crenvk_capture_sequence_begin(CRenContext* context, const char* path, CRenSequenceFormat format, unsigned int interval, unsigned int fps, unsigned int maxFrames) {
+    CRenVulkanBackend* renderer = (CRenVulkanBackend*)context->backend;
+    vkCaptureRing* ring = &renderer->captureRing;
+    if (!internal_crenvk_capture_start(ring)) return 0;
+
+    cren_mutex_lock(ring->mutex);
+
+    // the previous sequence is still being written
+    if (ring->sequence.file != NULL) {
+        cren_mutex_unlock(ring->mutex);
+        return 0;
+    }
+
+    VkExtent2D extent = internal_crenvk_capture_source(renderer, NULL, NULL);
+    unsigned long long texelCount = (unsigned long long)extent.width * extent.height;
+
+    char header[128] = { 0 };
+    int headerSize = 0;
+    if (format == Sequence_Y4M) headerSize = snprintf(header, sizeof(header), "YUV4MPEG2 W%u H%u F%u:1 Ip A1:1 C444\n", extent.width, extent.height, fps);
+
+    vkCaptureSequence* sequence = &ring->sequence;
+    crenmemory_zero(sequence, sizeof(vkCaptureSequence));
+    sequence->format = format;
+    sequence->interval = interval;
+    sequence->width = extent.width;
+    sequence->height = extent.height;
+    sequence->headerSize = (unsigned long long)headerSize;
+    sequence->frameSize = format == Sequence_Y4M ? 6 + texelCount * 3 : texelCount * 4;
+    sequence->frameCapacity = maxFrames;
+    sequence->file = cren_file_map_create(path, sequence->headerSize + sequence->frameSize * sequence->frameCapacity, &sequence->data);
+
+    if (sequence->file == NULL) {
+        CREN_LOG("CRen: Failed to create the frame sequence file %s", path);
+        cren_mutex_unlock(ring->mutex);
+        return 0;
+    }
+
+    crenmemory_copy(sequence->data, header, (size_t)headerSize);
+    sequence->recording = 1;
+    cren_mutex_unlock(ring->mutex);
+
+    CREN_LOG("CRen: Frame sequence started, %ux%u every %u frames into %s", extent.width, extent.height, interval, path);
+    return 1;
+}
+
+void crenvk_capture_sequence_end(CRenContext* context) {
+    CRenVulkanBackend* renderer = (CRenVulkanBackend*)context->backend;
+    vkCaptureRing* ring = &renderer->captureRing;
+    if (ring->mutex == NULL) return;
+
+    cren_mutex_lock(ring->mutex);
+    ring->sequence.recording = 0;
+    cren_mutex_unlock(ring->mutex);
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Timestamp-related
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+/// @brief releases the timestamp query pool and it's command buffers, also used to clean-up a partially created timer
+/// @param renderer cren vulkan backend
+static void internal_crenvk_frame_timer_destroy(CRenVulkanBackend* renderer) {
+    vkFrameTimer* timer = &renderer->frameTimer;
+    VkDevice device = renderer->device.device;
+
+    for (unsigned int i = 0; i < CREN_CONCURRENTLY_RENDERED_FRAMES; i++) {
+        if (timer->beginCmds[i] != VK_NULL_HANDLE) vkFreeCommandBuffers(device, renderer->mipmapGenerator.graphicsCommandPool, 1, &timer->beginCmds[i]);
+        if (timer->endCmds[i] != VK_NULL_HANDLE) vkFreeCommandBuffers(device, renderer->mipmapGenerator.graphicsCommandPool, 1, &timer->endCmds[i]);
+    }
+
+    if (timer->queryPool != VK_NULL_HANDLE) vkDestroyQueryPool(device, timer->queryPool, NULL);
+    crenmemory_zero(timer, sizeof(vkFrameTimer));
+}
+
+/// @brief creates the timestamp query pool and the command buffers writing to it, the timer only exists once it's enabled
+/// @param renderer cren vulkan backend
+/// @return 1 on success, 0 if timestamps aren't supported or on failure
+static int internal_crenvk_frame_timer_create(CRenVulkanBackend* renderer) {
+    vkFrameTimer* timer = &renderer->frameTimer;
+    if (timer->supported) return 1;
+
+    VkDevice device = renderer->device.device;
+    unsigned int graphicsFamily = renderer->mipmapGenerator.graphicsFamily;
+
+    unsigned int familyCount = 0;
+    vkGetPhysicalDeviceQueueFamilyProperties(renderer->device.physicalDevice, &familyCount, NULL);
+    VkQueueFamilyProperties* families = (VkQueueFamilyProperties*)crenmemory_allocate(familyCount * sizeof(VkQueueFamilyProperties), 1);
+    if (!families) return 0;
+
+    vkGetPhysicalDeviceQueueFamilyProperties(renderer->device.physicalDevice, &familyCount, families);
+    unsigned int validBits = graphicsFamily < familyCount ? families[graphicsFamily].timestampValidBits : 0;
+    crenmemory_deallocate(families);
+
+    float period = renderer->device.physicalDeviceProperties.limits.timestampPeriod;
+    if (validBits == 0 || period <= 0.0f) {
+        CREN_LOG("CRen: The graphics queue doesn't support timestamps, gpu frame times are unavailable");
+        return 0;
+    }
+
+    timer->period = (double)period;
+    timer->validMask = validBits >= 64 ? ~0ULL : (1ULL << validBits) - 1ULL;
+
+    VkQueryPoolCreateInfo queryPoolCI = { 0 };
+    queryPoolCI.sType = VK_STRUCTURE_TYPE_QUERY_POOL_CREATE_INFO;
+    queryPoolCI.queryType = VK_QUERY_TYPE_TIMESTAMP;
+    queryPoolCI.queryCount = CREN_CONCURRENTLY_RENDERED_FRAMES * 2;
+    if (vkCreateQueryPool(device, &queryPoolCI, NULL, &timer->queryPool) != VK_SUCCESS) {
+        internal_crenvk_frame_timer_destroy(renderer);
+        return 0;
+    }
+
+    VkCommandBufferAllocateInfo cmdBufferAllocInfo = { 0 };
+    cmdBufferAllocInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
+    cmdBufferAllocInfo.commandPool = renderer->mipmapGenerator.graphicsCommandPool;
+    cmdBufferAllocInfo.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
+    cmdBufferAllocInfo.commandBufferCount = CREN_CONCURRENTLY_RENDERED_FRAMES;
+
+    if (vkAllocateCommandBuffers(device, &cmdBufferAllocInfo, timer->beginCmds) != VK_SUCCESS || vkAllocateCommandBuffers(device, &cmdBufferAllocInfo, timer->endCmds) != VK_SUCCESS) {
+        internal_crenvk_frame_timer_destroy(renderer);
+        return 0;
+    }
+
+    timer->supported = 1;
+    return 1;
+}
+
+/// @brief records the timestamps of the frame about to be submitted, the slot being re-used belongs to a frame the gpu is done with
+/// @param renderer cren vulkan backend
+/// @param beginCmd output command buffer to be submitted before every other on the frame
+/// @param endCmd output command buffer to be submitted after every other on the frame
+/// @return 1 if the frame is measured, 0 otherwise
+static int internal_crenvk_frame_timer_record(CRenVulkanBackend* renderer, VkCommandBuffer* beginCmd, VkCommandBuffer* endCmd) {
+    vkFrameTimer* timer = &renderer->frameTimer;
+    if (!timer->enabled) return 0;
+
+    unsigned long long frame = renderer->retirement.frameNumber;
+    unsigned int slot = (unsigned int)(frame % CREN_CONCURRENTLY_RENDERED_FRAMES);
+    *beginCmd = timer->beginCmds[slot];
+    *endCmd = timer->endCmds[slot];
+
+    VkCommandBufferBeginInfo beginInfo = { 0 };
+    beginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+    beginInfo.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+
+    vkBeginCommandBuffer(*beginCmd, &beginInfo);
+    vkCmdResetQueryPool(*beginCmd, timer->queryPool, slot * 2, 2);
+    vkCmdWriteTimestamp(*beginCmd, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, timer->queryPool, slot * 2);
+    vkEndCommandBuffer(*beginCmd);
+
+    vkBeginCommandBuffer(*endCmd, &beginInfo);
+    vkCmdWriteTimestamp(*endCmd, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, timer->queryPool, slot * 2 + 1);
+    vkEndCommandBuffer(*endCmd);
+
+    timer->frames[slot] = frame + 1;
+    return 1;
+}
+
+int crenvk_frame_timer_set_enabled(CRenContext* context, int enabled) {
+    CRenVulkanBackend* renderer = (CRenVulkanBackend*)context->backend;
+    vkFrameTimer* timer = &renderer->frameTimer;
+
+    if (enabled && !internal_crenvk_frame_timer_create(renderer)) return 0;
+
+    timer->enabled = enabled;
+    return enabled;
+}
+
+int crenvk_frame_timer_get(CRenContext* context, unsigned long long frame, double* milliseconds) {
+    CRenVulkanBackend* renderer = (CRenVulkanBackend*)context->backend;
+    vkFrameTimer* timer = &renderer->frameTimer;
+    if (!timer->supported || !milliseconds) return 0;
+
+    unsigned int slot = (unsigned int)(frame % CREN_CONCURRENTLY_RENDERED_FRAMES);
+    if (timer->frames[slot] != frame + 1) return 0;
+
+    // never waits, the frame may still be on the gpu
+    unsigned long long timestamps[2] = { 0 };
+    VkResult res = vkGetQueryPoolResults(renderer->device.device, timer->queryPool, slot * 2, 2, sizeof(timestamps), timestamps, sizeof(unsigned long long), VK_QUERY_RESULT_64_BIT);
+    if (res != VK_SUCCESS) return 0;
+
+    unsigned long long ticks = (timestamps[1] - timestamps[0]) & timer->validMask;
+    *milliseconds = (double)ticks * timer->period / 1000000.0;
+    return 1;
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Compute-related
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+/// @brief releases the per-frame compute objects, the gpu must be done with them
+/// @param compute the compute queue
+/// @param device vulkan device
+static void internal_crenvk_compute_destroy_slots(vkComputeQueue* compute, VkDevice device) {
+    for (unsigned int i = 0; i < CREN_CONCURRENTLY_RENDERED_FRAMES; i++) {
+        if (compute->cmdBuffers[i] != VK_NULL_HANDLE) vkFreeCommandBuffers(device, compute->commandPools[i], 1, &compute->cmdBuffers[i]);
+        if (compute->commandPools[i] != VK_NULL_HANDLE) vkDestroyCommandPool(device, compute->commandPools[i], NULL);
+        if (compute->semaphores[i] != VK_NULL_HANDLE) vkDestroySemaphore(device, compute->semaphores[i], NULL);
+        if (compute->fences[i] != VK_NULL_HANDLE) vkDestroyFence(device, compute->fences[i], NULL);
+        compute->cmdBuffers[i] = VK_NULL_HANDLE;
+        compute->commandPools[i] = VK_NULL_HANDLE;
+        compute->semaphores[i] = VK_NULL_HANDLE;
+        compute->fences[i] = VK_NULL_HANDLE;
+    }
+    compute->recording = 0;
+}
+
+/// @brief creates the per-frame compute objects on a queue family
+/// @param compute the compute queue
+/// @param device vulkan device
+/// @param family queue family the dispatches run on
+/// @return 1 on success, 0 on failure
+static int internal_crenvk_compute_create_slots(vkComputeQueue* compute, VkDevice device, unsigned int family) {
+    VkSemaphoreCreateInfo semaphoreCI = { 0 };
+    semaphoreCI.sType = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO;
+
+    VkFenceCreateInfo fenceCI = { 0 };
+    fenceCI.sType = VK_STRUCTURE_TYPE_FENCE_CREATE_INFO;
+    fenceCI.flags = VK_FENCE_CREATE_SIGNALED_BIT;
+
+    // one pool per frame in flight, a pool is only reset once the gpu is done with every command buffer allocated from it
+    VkCommandPoolCreateInfo cmdPoolCI = { 0 };
+    cmdPoolCI.sType = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO;
+    cmdPoolCI.flags = VK_COMMAND_POOL_CREATE_TRANSIENT_BIT;
+    cmdPoolCI.queueFamilyIndex = family;
+
+    for (unsigned int i = 0; i < CREN_CONCURRENTLY_RENDERED_FRAMES; i++) {
+        if (vkCreateCommandPool(device, &cmdPoolCI, NULL, &compute->commandPools[i]) != VK_SUCCESS) {
+            cren_set_error(Vulkan_CommandPoolCreationFailed);
+            internal_crenvk_compute_destroy_slots(compute, device);
+            return 0;
+        }
+
+        VkCommandBufferAllocateInfo cmdBufferAllocInfo = { 0 };
+        cmdBufferAllocInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
+        cmdBufferAllocInfo.commandPool = compute->commandPools[i];
+        cmdBufferAllocInfo.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
+        cmdBufferAllocInfo.commandBufferCount = 1;
+        if (vkAllocateCommandBuffers(device, &cmdBufferAllocInfo, &compute->cmdBuffers[i]) != VK_SUCCESS) {
+            cren_set_error(Vulkan_CommandBufferAllocationFailed);
+            internal_crenvk_compute_destroy_slots(compute, device);
+            return 0;
+        }
+
+        if (vkCreateSemaphore(device, &semaphoreCI, NULL, &compute->semaphores[i]) != VK_SUCCESS) {
+            cren_set_error(Vulkan_SemaphoreCreationFailed);
+            internal_crenvk_compute_destroy_slots(compute, device);
+            return 0;
+        }
+
+        if (vkCreateFence(device, &fenceCI, NULL, &compute->fences[i]) != VK_SUCCESS) {
+            cren_set_error(Vulkan_FenceCreationFailed);
+            internal_crenvk_compute_destroy_slots(compute, device);
+            return 0;
+        }
+    }
+
+    compute->family = family;
+    return 1;
+}
+
+/// @brief creates the compute queue objects, dispatches start on the graphics queue
+/// @param renderer cren vulkan backend
+/// @return 1 on success, 0 on failure
+static int internal_crenvk_compute_create(CRenVulkanBackend* renderer) {
+    vkComputeQueue* compute = &renderer->compute;
+    compute->graphicsFamily = renderer->mipmapGenerator.graphicsFamily;
+    compute->queue = renderer->device.graphicsQueue;
+    compute->async = 0;
+    return internal_crenvk_compute_create_slots(compute, renderer->device.device, compute->graphicsFamily);
+}
+
+/// @brief releases the compute queue objects
+/// @param renderer cren vulkan backend
+static void internal_crenvk_compute_destroy(CRenVulkanBackend* renderer) {
+    internal_crenvk_compute_destroy_slots(&renderer->compute, renderer->device.device);
+    crenmemory_zero(&renderer->compute, sizeof(vkComputeQueue));
+}
+
+/// @brief submits the compute work recorded for the frame about to be submitted
+/// @param renderer cren vulkan backend
+/// @param semaphore output semaphore the graphics submit must wait on, NULL signals none
+/// @return 1 if there was work, 0 otherwise
+static int internal_crenvk_compute_submit(CRenVulkanBackend* renderer, VkSemaphore* semaphore) {
+    vkComputeQueue* compute = &renderer->compute;
+    if (!compute->recording) return 0;
+
+    unsigned int slot = compute->slot;
+    compute->recording = 0;
+    if (vkEndCommandBuffer(compute->cmdBuffers[slot]) != VK_SUCCESS) return 0;
+
+    VkSubmitInfo submitInfo = { 0 };
+    submitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+    submitInfo.commandBufferCount = 1;
+    submitInfo.pCommandBuffers = &compute->cmdBuffers[slot];
+    submitInfo.signalSemaphoreCount = semaphore != NULL ? 1 : 0;
+    submitInfo.pSignalSemaphores = &compute->semaphores[slot];
+
+    vkResetFences(renderer->device.device, 1, &compute->fences[slot]);
+    if (vkQueueSubmit(compute->queue, 1, &submitInfo, compute->fences[slot]) != VK_SUCCESS) {
+        CREN_LOG("CRen: Failed to submit the frame's compute work");
+        return 0;
+    }
+
+    if (semaphore != NULL) *semaphore = compute->semaphores[slot];
+    return 1;
+}
+
+/// @brief submits the compute work recorded on a frame that is skipped (minimized, out of date swapchain), so it runs on that frame instead of being carried into the next one
+/// @param renderer cren vulkan backend
+static void internal_crenvk_compute_flush(CRenVulkanBackend* renderer) {
+    vkComputeQueue* compute = &renderer->compute;
+    if (!internal_crenvk_compute_submit(renderer, NULL)) return;
+
+    // no graphics work waits on it, the next frame must already see it's results
+    vkWaitForFences(renderer->device.device, 1, &compute->fences[compute->slot], VK_TRUE, UINT64_MAX);
+}
+
+VkCommandBuffer crenvk_compute_get_command_buffer(CRenContext* context) {
+    CRenVulkanBackend* renderer = (CRenVulkanBackend*)context->backend;
+    vkComputeQueue* compute = &renderer->compute;
+
+    if (compute->recording) return compute->cmdBuffers[compute->slot];
+
+    // the slot was last submitted CREN_CONCURRENTLY_RENDERED_FRAMES frames ago, this rarely waits
+    unsigned int slot = (unsigned int)(renderer->retirement.frameNumber % CREN_CONCURRENTLY_RENDERED_FRAMES);
+    VkDevice device = renderer->device.device;
+    vkWaitForFences(device, 1, &compute->fences[slot], VK_TRUE, UINT64_MAX);
+    vkResetCommandPool(device, compute->commandPools[slot], 0);
+
+    VkCommandBufferBeginInfo beginInfo = { 0 };
+    beginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+    beginInfo.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+    if (vkBeginCommandBuffer(compute->cmdBuffers[slot], &beginInfo) != VK_SUCCESS) return VK_NULL_HANDLE;
+
+    compute->slot = slot;
+    compute->recording = 1;
+    return compute->cmdBuffers[slot];
+}
+
+int crenvk_compute_dispatch(CRenContext* context, vkComputePipeline* pipeline, VkDescriptorSet descriptorSet, const void* pushConstants, unsigned int pushConstantsSize, unsigned int groupsX, unsigned int groupsY, unsigned int groupsZ) {
+    if (!pipeline || groupsX == 0 || groupsY == 0 || groupsZ == 0) return 0;
+
+    VkCommandBuffer cmdBuffer = crenvk_compute_get_command_buffer(context);
+    if (cmdBuffer == VK_NULL_HANDLE) return 0;
+
+    vkCmdBindPipeline(cmdBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, pipeline->pipeline);
+    if (descriptorSet != VK_NULL_HANDLE) vkCmdBindDescriptorSets(cmdBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, pipeline->layout, 0, 1, &descriptorSet, 0, NULL);
+    if (pushConstants && pushConstantsSize > 0) vkCmdPushConstants(cmdBuffer, pipeline->layout, VK_SHADER_STAGE_COMPUTE_BIT, 0, pushConstantsSize, pushConstants);
+    vkCmdDispatch(cmdBuffer, groupsX, groupsY, groupsZ);
+    return 1;
+}
+
+void crenvk_compute_barrier(CRenContext* context) {
+    VkCommandBuffer cmdBuffer = crenvk_compute_get_command_buffer(context);
+    if (cmdBuffer == VK_NULL_HANDLE) return;
+
+    VkMemoryBarrier barrier = { 0 };
+    barrier.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+    barrier.srcAccessMask = VK_ACCESS_SHADER_WRITE_BIT;
+    barrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT | VK_ACCESS_INDIRECT_COMMAND_READ_BIT;
+    vkCmdPipelineBarrier(cmdBuffer, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT | VK_PIPELINE_STAGE_DRAW_INDIRECT_BIT, 0, 1, &barrier, 0, NULL, 0, NULL);
+}
+
+int crenvk_compute_set_async(CRenContext* context, int enabled) {
+    CRenVulkanBackend* renderer = (CRenVulkanBackend*)context->backend;
+    vkComputeQueue* compute = &renderer->compute;
+    if (compute->async == enabled) return compute->async;
+
+    if (compute->recording) {
+        CREN_LOG("CRen: The compute queue can't change while the frame's compute work is being recorded");
+        return compute->async;
+    }
+
+    vkQueueFamilyIndices indices = internal_crenvk_find_queue_families(renderer->device.physicalDevice, renderer->device.surface);
+    if (enabled && (indices.computeFamily == -1 || indices.computeFamily == indices.graphicFamily)) {
+        CREN_LOG("CRen: There's no separate compute queue family, dispatches stay on the graphics queue");
+        return 0;
+    }
+
+    // command pools belong to a family, the in-flight work must finish before they're re-created
+    VkDevice device = renderer->device.device;
+    vkWaitForFences(device, CREN_CONCURRENTLY_RENDERED_FRAMES, compute->fences, VK_TRUE, UINT64_MAX);
+    internal_crenvk_compute_destroy_slots(compute, device);
+
+    unsigned int family = enabled ? (unsigned int)indices.computeFamily : compute->graphicsFamily;
+    if (!internal_crenvk_compute_create_slots(compute, device, family)) {
+        // fallback to the graphics queue, it was working before
+        enabled = 0;
+        if (!internal_crenvk_compute_create_slots(compute, device, compute->graphicsFamily)) return 0;
+    }
+
+    compute->queue = enabled ? renderer->device.computeQueue : renderer->device.graphicsQueue;
+    compute->async = enabled;
+    return enabled;
+}
+
+unsigned int crenvk_compute_get_queue_families(CRenContext* context, unsigned int families[2]) {
+    CRenVulkanBackend* renderer = (CRenVulkanBackend*)context->backend;
+    vkComputeQueue* compute = &renderer->compute;
+
+    families[0] = compute->graphicsFamily;
+    if (!compute->async) return 1;
+
+    families[1] = compute->family;
+    return 2;
+}
+
+/// @brief creates a buffer shared with the compute queue when dispatches run on it
+/// @param context cren context
+/// @param usage buffer usage
+/// @param memoryFlags buffer memory properties, device-local for buffers only the gpu touches
+/// @param size buffer size in bytes
+/// @param buffer output buffer
+/// @param memory output buffer memory
+/// @return 1 on success, 0 on failure
+static int internal_crenvk_compute_buffer_create(CRenContext* context, VkBufferUsageFlags usage, VkMemoryPropertyFlags memoryFlags, VkDeviceSize size, VkBuffer* buffer, VkDeviceMemory* memory) {
+    CRenVulkanBackend* renderer = (CRenVulkanBackend*)context->backend;
+    VkDevice device = renderer->device.device;
+
+    unsigned int families[2] = { 0 };
+    unsigned int familyCount = crenvk_compute_get_queue_families(context, families);
+
+    VkBufferCreateInfo bufferCI = { 0 };
+    bufferCI.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
+    bufferCI.size = size;
+    bufferCI.usage = usage;
+    bufferCI.sharingMode = familyCount > 1 ? VK_SHARING_MODE_CONCURRENT : VK_SHARING_MODE_EXCLUSIVE;
+    bufferCI.queueFamilyIndexCount = familyCount > 1 ? familyCount : 0;
+    bufferCI.pQueueFamilyIndices = familyCount > 1 ? families : NULL;
+    if (vkCreateBuffer(device, &bufferCI, NULL, buffer) != VK_SUCCESS) return 0;
+
+    VkMemoryRequirements memRequirements = { 0 };
+    vkGetBufferMemoryRequirements(device, *buffer, &memRequirements);
+
+    VkMemoryAllocateInfo allocInfo = { 0 };
+    allocInfo.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
+    allocInfo.allocationSize = memRequirements.size;
+    allocInfo.memoryTypeIndex = internal_crenvk_find_memory_type(renderer->device.physicalDevice, memRequirements.memoryTypeBits, memoryFlags);
+    if (vkAllocateMemory(device, &allocInfo, NULL, memory) != VK_SUCCESS) {
+        vkDestroyBuffer(device, *buffer, NULL);
+        *buffer = VK_NULL_HANDLE;
+        return 0;
+    }
+
+    vkBindBufferMemory(device, *buffer, *memory, 0);
+    return 1;
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Pick-related
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+/// @brief creates one of the rectangle pick pipelines, both read the same bindings
+/// @param device vulkan device
+/// @param name shader name
+/// @param path compiled shader disk path
+/// @return the pipeline or NULL if the shader couldn't be loaded
+static vkComputePipeline* internal_crenvk_pick_rect_pipeline_create(VkDevice device, const char* name, const char* path) {
+    vkComputePipelineCreateInfo ci = { 0 };
+    ci.computeShader = crenvk_shader_create(device, name, path, SHADER_TYPE_COMPUTE);
+    if (ci.computeShader.shaderStageCI.module == VK_NULL_HANDLE) return NULL;
+
+    ci.pushConstantsCount = 1;
+    ci.pushConstants[0].offset = 0;
+    ci.pushConstants[0].size = sizeof(vkPickRectPushConstant);
+    ci.pushConstants[0].stageFlags = VK_SHADER_STAGE_COMPUTE_BIT;
+
+    // 0: picking image, 1: counters and tile ids, 2: distinct ids
+    ci.bindingsCount = 3;
+    for (unsigned int i = 0; i < ci.bindingsCount; i++) {
+        ci.bindings[i].binding = i;
+        ci.bindings[i].descriptorType = i == 0 ? VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE : VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+        ci.bindings[i].descriptorCount = 1;
+        ci.bindings[i].stageFlags = VK_SHADER_STAGE_COMPUTE_BIT;
+        ci.bindings[i].pImmutableSamplers = NULL;
+    }
+
+    return crenvk_compute_pipeline_create(device, &ci);
+}
+
+/// @brief releases the rectangle pick objects, also used to clean-up a partially started one. The gpu must be done with them
+/// @param renderer cren vulkan backend
+static void internal_crenvk_pick_rect_destroy(CRenVulkanBackend* renderer) {
+    vkPickRect* pick = &renderer->pickRect;
+    VkDevice device = renderer->device.device;
+
+    if (pick->cmdBuffer != VK_NULL_HANDLE) vkFreeCommandBuffers(device, renderer->mipmapGenerator.graphicsCommandPool, 1, &pick->cmdBuffer);
+    if (pick->mapped != NULL) vkUnmapMemory(device, pick->resultMemory);
+    if (pick->resultBuffer != VK_NULL_HANDLE) vkDestroyBuffer(device, pick->resultBuffer, NULL);
+    if (pick->resultMemory != VK_NULL_HANDLE) vkFreeMemory(device, pick->resultMemory, NULL);
+    if (pick->workBuffer != VK_NULL_HANDLE) vkDestroyBuffer(device, pick->workBuffer, NULL);
+    if (pick->workMemory != VK_NULL_HANDLE) vkFreeMemory(device, pick->workMemory, NULL);
+    if (pick->descriptorPool != VK_NULL_HANDLE) vkDestroyDescriptorPool(device, pick->descriptorPool, NULL);
+    crenvk_compute_pipeline_destroy(device, pick->pipeline);
+    crenvk_compute_pipeline_destroy(device, pick->multisampledPipeline);
+
+    crenmemory_zero(pick, sizeof(vkPickRect));
+}
+
+/// @brief creates the rectangle pick objects if they don't exist yet, they only exist once something is picked
+/// @param renderer cren vulkan backend
+/// @param rootPath assets root path
+/// @return 1 on success, 0 on failure
+static int internal_crenvk_pick_rect_start(CRenVulkanBackend* renderer, const char* rootPath) {
+    vkPickRect* pick = &renderer->pickRect;
+    if (pick->pipeline != NULL) return 1;
+
+    VkDevice device = renderer->device.device;
+    char singleComp[CREN_PATH_MAX_SIZE], multiComp[CREN_PATH_MAX_SIZE];
+    cren_get_path("shader/compiled/pick_rect.comp.spv", rootPath, 0, singleComp, sizeof(singleComp));
+    cren_get_path("shader/compiled/pick_rect_ms.comp.spv", rootPath, 0, multiComp, sizeof(multiComp));
+    pick->pipeline = internal_crenvk_pick_rect_pipeline_create(device, "pick_rect.comp", singleComp);
+    pick->multisampledPipeline = internal_crenvk_pick_rect_pipeline_create(device, "pick_rect_ms.comp", multiComp);
+    VkResult res = pick->pipeline != NULL && pick->multisampledPipeline != NULL ? VK_SUCCESS : VK_ERROR_INITIALIZATION_FAILED;
+
+    VkDescriptorPoolSize poolSizes[2] = { 0 };
+    poolSizes[0].type = VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE;
+    poolSizes[0].descriptorCount = 1;
+    poolSizes[1].type = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+    poolSizes[1].descriptorCount = 2;
+
+    VkDescriptorPoolCreateInfo poolCI = { 0 };
+    poolCI.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
+    poolCI.maxSets = 1;
+    poolCI.poolSizeCount = (unsigned int)CREN_ARRAYSIZE(poolSizes);
+    poolCI.pPoolSizes = poolSizes;
+    if (res == VK_SUCCESS) res = vkCreateDescriptorPool(device, &poolCI, NULL, &pick->descriptorPool);
+
+    // both pipelines have identical set layouts, so the set is compatible with either
+    VkDescriptorSetAllocateInfo allocInfo = { 0 };
+    allocInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
+    allocInfo.descriptorPool = pick->descriptorPool;
+    allocInfo.descriptorSetCount = 1;
+    allocInfo.pSetLayouts = pick->pipeline ? &pick->pipeline->descriptorSetLayout : NULL;
+    if (res == VK_SUCCESS) res = vkAllocateDescriptorSets(device, &allocInfo, &pick->descriptorSet);
+
+    if (res == VK_SUCCESS) {
+        VkBufferUsageFlags usage = VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT;
+        VkDeviceSize workSize = sizeof(unsigned int) * 4 + sizeof(unsigned int) * 2 * CREN_PICK_RECT_CANDIDATES_MAX;
+        VkDeviceSize resultSize = sizeof(unsigned int) * 2 + sizeof(unsigned int) * 2 * CREN_PICK_RECT_IDS_MAX;
+
+        if (!crenvk_device_create_buffer(device, renderer->device.physicalDevice, usage, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, workSize, &pick->workBuffer, &pick->workMemory, NULL)) res = VK_ERROR_OUT_OF_DEVICE_MEMORY;
+        else if (!crenvk_device_create_buffer(device, renderer->device.physicalDevice, usage, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, resultSize, &pick->resultBuffer, &pick->resultMemory, NULL)) res = VK_ERROR_OUT_OF_HOST_MEMORY;
+        else res = vkMapMemory(device, pick->resultMemory, 0, resultSize, 0, &pick->mapped);
+    }
+
+    VkCommandBufferAllocateInfo cmdBufferAllocInfo = { 0 };
+    cmdBufferAllocInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
+    cmdBufferAllocInfo.commandPool = renderer->mipmapGenerator.graphicsCommandPool;
+    cmdBufferAllocInfo.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
+    cmdBufferAllocInfo.commandBufferCount = 1;
+    if (res == VK_SUCCESS) res = vkAllocateCommandBuffers(device, &cmdBufferAllocInfo, &pick->cmdBuffer);
+
+    if (res != VK_SUCCESS) {
+        CREN_LOG("CRen: Failed to create the rectangle pick objects");
+        internal_crenvk_pick_rect_destroy(renderer);
+        return 0;
+    }
+
+    return 1;
+}
+
+/// @brief records the requested rectangle pick, it's command buffer is submitted right after the picking phase
+/// @param renderer cren vulkan backend
+/// @param cmdBuffer output command buffer
+/// @return 1 if the pick was recorded, 0 otherwise
+static int internal_crenvk_pick_rect_record(CRenVulkanBackend* renderer, VkCommandBuffer* cmdBuffer) {
+    vkPickRect* pick = &renderer->pickRect;
+    if (pick->state != PickRect_Requested) return 0;
+
+    // the swapchain may have been resized since the request
+    VkExtent2D extent = renderer->swapchain.swapchainExtent;
+    int left = pick->x > 0 ? pick->x : 0;
+    int top = pick->y > 0 ? pick->y : 0;
+    int right = pick->x + pick->width < (int)extent.width ? pick->x + pick->width : (int)extent.width;
+    int bottom = pick->y + pick->height < (int)extent.height ? pick->y + pick->height : (int)extent.height;
+
+    // the rectangle is outside the image, there's nothing to pick. The result buffer isn't in use by the gpu
+    if (right <= left || bottom <= top) {
+        crenmemory_zero(pick->mapped, sizeof(unsigned int) * 2);
+        pick->state = PickRect_Ready;
+        return 0;
+    }
+
+    vkPickingRenderphase* phase = &renderer->pickingRenderphase;
+    vkComputePipeline* pipeline = phase->renderpass->msaa > VK_SAMPLE_COUNT_1_BIT ? pick->multisampledPipeline : pick->pipeline;
+
+    // the picking image is re-created on resizes and anti-aliasing changes, the set is only in use while a pick is in flight
+    VkDescriptorImageInfo imageInfo = { 0 };
+    imageInfo.imageView = phase->colorView;
+    imageInfo.imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+
+    VkDescriptorBufferInfo bufferInfos[2] = { 0 };
+    bufferInfos[0].buffer = pick->workBuffer;
+    bufferInfos[0].range = VK_WHOLE_SIZE;
+    bufferInfos[1].buffer = pick->resultBuffer;
+    bufferInfos[1].range = VK_WHOLE_SIZE;
+
+    VkWriteDescriptorSet writes[3] = { 0 };
+    for (unsigned int i = 0; i < 3; i++) {
+        writes[i].sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+        writes[i].dstSet = pick->descriptorSet;
+        writes[i].dstBinding = i;
+        writes[i].descriptorCount = 1;
+        writes[i].descriptorType = i == 0 ? VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE : VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+        if (i == 0) writes[i].pImageInfo = &imageInfo;
+        else writes[i].pBufferInfo = &bufferInfos[i - 1];
+    }
+    vkUpdateDescriptorSets(renderer->device.device, 3, writes, 0, NULL);
+
+    VkCommandBufferBeginInfo beginInfo = { 0 };
+    beginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+    beginInfo.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+    if (vkBeginCommandBuffer(pick->cmdBuffer, &beginInfo) != VK_SUCCESS) return 0;
+
+    // only the counters are reset, the lists are written up to them
+    vkCmdFillBuffer(pick->cmdBuffer, pick->workBuffer, 0, sizeof(unsigned int) * 4, 0);
+    vkCmdFillBuffer(pick->cmdBuffer, pick->resultBuffer, 0, sizeof(unsigned int) * 2, 0);
+
+    VkBufferMemoryBarrier bufferBarriers[2] = { 0 };
+    for (unsigned int i = 0; i < 2; i++) {
+        bufferBarriers[i].sType = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER;
+        bufferBarriers[i].srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+        bufferBarriers[i].dstAccessMask = VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT;
+        bufferBarriers[i].srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+        bufferBarriers[i].dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+        bufferBarriers[i].buffer = i == 0 ? pick->workBuffer : pick->resultBuffer;
+        bufferBarriers[i].size = VK_WHOLE_SIZE;
+    }
+
+    // the picking pass leaves the image ready to be sampled, it's writes must still be made visible
+    VkImageMemoryBarrier imageBarrier = { 0 };
+    imageBarrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+    imageBarrier.image = phase->colorImage;
+    imageBarrier.oldLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+    imageBarrier.newLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+    imageBarrier.srcAccessMask = VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT;
+    imageBarrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
+    imageBarrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    imageBarrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    imageBarrier.subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+    imageBarrier.subresourceRange.levelCount = 1;
+    imageBarrier.subresourceRange.layerCount = 1;
+    vkCmdPipelineBarrier(pick->cmdBuffer, VK_PIPELINE_STAGE_TRANSFER_BIT | VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, 0, 0, NULL, 2, bufferBarriers, 1, &imageBarrier);
+
+    vkPickRectPushConstant constants = { 0 };
+    constants.offset[0] = left;
+    constants.offset[1] = top;
+    constants.size[0] = right - left;
+    constants.size[1] = bottom - top;
+
+    unsigned int groupsX = ((unsigned int)constants.size[0] + CREN_PICK_RECT_TILE_SIZE - 1) / CREN_PICK_RECT_TILE_SIZE;
+    unsigned int groupsY = ((unsigned int)constants.size[1] + CREN_PICK_RECT_TILE_SIZE - 1) / CREN_PICK_RECT_TILE_SIZE;
+    constants.workGroupCount = groupsX * groupsY;
+    constants.maxCandidates = CREN_PICK_RECT_CANDIDATES_MAX;
+    constants.maxIds = CREN_PICK_RECT_IDS_MAX;
+
+    vkCmdBindPipeline(pick->cmdBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, pipeline->pipeline);
+    vkCmdBindDescriptorSets(pick->cmdBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, pipeline->layout, 0, 1, &pick->descriptorSet, 0, NULL);
+    vkCmdPushConstants(pick->cmdBuffer, pipeline->layout, VK_SHADER_STAGE_COMPUTE_BIT, 0, sizeof(constants), &constants);
+    vkCmdDispatch(pick->cmdBuffer, groupsX, groupsY, 1);
+
+    // the host reads the ids once the frame fence signals
+    VkBufferMemoryBarrier resultBarrier = bufferBarriers[1];
+    resultBarrier.srcAccessMask = VK_ACCESS_SHADER_WRITE_BIT;
+    resultBarrier.dstAccessMask = VK_ACCESS_HOST_READ_BIT;
+    vkCmdPipelineBarrier(pick->cmdBuffer, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_PIPELINE_STAGE_HOST_BIT, 0, 0, NULL, 1, &resultBarrier, 0, NULL);
+
+    if (vkEndCommandBuffer(pick->cmdBuffer) != VK_SUCCESS) return 0;
+
+    pick->frame = renderer->retirement.frameNumber;
+    pick->state = PickRect_Picking;
+    *cmdBuffer = pick->cmdBuffer;
+    return 1;
+}
+
+/// @brief marks the rectangle pick as ready once it's frame left the gpu
+/// @param renderer cren vulkan backend
+static void internal_crenvk_pick_rect_collect(CRenVulkanBackend* renderer) {
+    vkPickRect* pick = &renderer->pickRect;
+    if (pick->state != PickRect_Picking) return;
+    if (pick->frame + CREN_CONCURRENTLY_RENDERED_FRAMES > renderer->retirement.frameNumber) return;
+
+    pick->state = PickRect_Ready;
+}
+
+int crenvk_pick_rect_request(CRenContext* context, int x, int y, int width, int height) {
+    CRenVulkanBackend* renderer = (CRenVulkanBackend*)context->backend;
+    vkPickRect* pick = &renderer->pickRect;
+
+    if (width <= 0 || height <= 0) return 0;
+    if (pick->state == PickRect_Requested || pick->state == PickRect_Picking) return 0;
+    if (!crenvk_renderphase_picking_enable(context)) return 0;
+    if (!internal_crenvk_pick_rect_start(renderer, context->createInfo.assetsRoot)) return 0;
+
+    // a finished pick that was never read is discarded
+    pick->x = x;
+    pick->y = y;
+    pick->width = width;
+    pick->height = height;
+    pick->state = PickRect_Requested;
+    return 1;
+}
+
+int crenvk_pick_rect_result(CRenContext* context, unsigned long long* ids, unsigned int capacity, unsigned int* count) {
+    CRenVulkanBackend* renderer = (CRenVulkanBackend*)context->backend;
+    vkPickRect* pick = &renderer->pickRect;
+    if (pick->state != PickRect_Ready) return 0;
+
+    // count of distinct ids, then how many the tiles found, then the ids as low/high words
+    const unsigned int* header = (const unsigned int*)pick->mapped;
+    const unsigned int* words = header + 2;
+    unsigned int found = header[0];
+
+    if (header[1] > CREN_PICK_RECT_CANDIDATES_MAX) {
+        CREN_LOG("CRen: Rectangle pick found %u ids on it's tiles, only %u were kept", header[1], CREN_PICK_RECT_CANDIDATES_MAX);
+    }
+
+    unsigned int written = found < CREN_PICK_RECT_IDS_MAX ? found : CREN_PICK_RECT_IDS_MAX;
+    if (written > capacity) written = capacity;
+
+    for (unsigned int i = 0; ids != NULL && i < written; i++) {
+        ids[i] = (unsigned long long)words[i * 2] | ((unsigned long long)words[i * 2 + 1] << 32);
+    }
+
+    if (count) *count = found;
+    pick->state = PickRect_Free;
+    return 1;
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Light-related
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+/// @brief releases the light clustering objects, also used to clean-up partially created ones. The gpu must be done with them
+/// @param renderer cren vulkan backend
+static void internal_crenvk_lights_destroy(CRenVulkanBackend* renderer) {
+    vkLightClusters* lights = &renderer->lights;
+    VkDevice device = renderer->device.device;
+
+    for (unsigned int i = 0; i < CREN_CONCURRENTLY_RENDERED_FRAMES; i++) {
+        if (lights->mapped[i] != NULL) vkUnmapMemory(device, lights->lightMemories[i]);
+        if (lights->lightBuffers[i] != VK_NULL_HANDLE) vkDestroyBuffer(device, lights->lightBuffers[i], NULL);
+        if (lights->lightMemories[i] != VK_NULL_HANDLE) vkFreeMemory(device, lights->lightMemories[i], NULL);
+        if (lights->clusterBuffers[i] != VK_NULL_HANDLE) vkDestroyBuffer(device, lights->clusterBuffers[i], NULL);
+        if (lights->clusterMemories[i] != VK_NULL_HANDLE) vkFreeMemory(device, lights->clusterMemories[i], NULL);
+    }
+
+    if (lights->descriptorPool != VK_NULL_HANDLE) vkDestroyDescriptorPool(device, lights->descriptorPool, NULL);
+    crenvk_compute_pipeline_destroy(device, lights->pipeline);
+    if (lights->lights != NULL) crenmemory_deallocate(lights->lights);
+
+    crenmemory_zero(lights, sizeof(vkLightClusters));
+}
+
+/// @brief creates the light clustering objects if they don't exist yet, they only exist once a light is submitted or it's buffers are requested
+/// @param context cren context
+/// @return 1 on success, 0 on failure
+static int internal_crenvk_lights_start(CRenContext* context) {
+    CRenVulkanBackend* renderer = (CRenVulkanBackend*)context->backend;
+    vkLightClusters* lights = &renderer->lights;
+    if (lights->pipeline != NULL) return 1;
+
+    VkDevice device = renderer->device.device;
+    char comp[CREN_PATH_MAX_SIZE];
+    cren_get_path("shader/compiled/light_cluster.comp.spv", context->createInfo.assetsRoot, 0, comp, sizeof(comp));
+
+    vkComputePipelineCreateInfo ci = { 0 };
+    ci.computeShader = crenvk_shader_create(device, "light_cluster.comp", comp, SHADER_TYPE_COMPUTE);
+    ci.pushConstantsCount = 1;
+    ci.pushConstants[0].offset = 0;
+    ci.pushConstants[0].size = sizeof(vkLightClusterPushConstant);
+    ci.pushConstants[0].stageFlags = VK_SHADER_STAGE_COMPUTE_BIT;
+
+    // 0: lights, 1: clusters
+    ci.bindingsCount = 2;
+    for (unsigned int i = 0; i < ci.bindingsCount; i++) {
+        ci.bindings[i].binding = i;
+        ci.bindings[i].descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+        ci.bindings[i].descriptorCount = 1;
+        ci.bindings[i].stageFlags = VK_SHADER_STAGE_COMPUTE_BIT;
+        ci.bindings[i].pImmutableSamplers = NULL;
+    }
+
+    if (ci.computeShader.shaderStageCI.module != VK_NULL_HANDLE) lights->pipeline = crenvk_compute_pipeline_create(device, &ci);
+    lights->lights = (vkPointLight*)crenmemory_allocate(sizeof(vkPointLight) * CREN_LIGHTS_MAX, 1);
+    int success = lights->pipeline != NULL && lights->lights != NULL;
+
+    // the lights are written by the cpu every frame, the clusters never leave the gpu
+    VkDeviceSize lightsSize = sizeof(vkPointLight) * CREN_LIGHTS_MAX;
+    VkDeviceSize clustersSize = sizeof(float4) + sizeof(unsigned int) * 4 + sizeof(unsigned int) * CREN_LIGHT_CLUSTERS_X * CREN_LIGHT_CLUSTERS_Y * CREN_LIGHT_CLUSTERS_Z * (1 + CREN_LIGHTS_PER_CLUSTER_MAX);
+    for (unsigned int i = 0; success && i < CREN_CONCURRENTLY_RENDERED_FRAMES; i++) {
+        success &= internal_crenvk_compute_buffer_create(context, VK_BUFFER_USAGE_STORAGE_BUFFER_BIT, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, lightsSize, &lights->lightBuffers[i], &lights->lightMemories[i]);
+        success &= internal_crenvk_compute_buffer_create(context, VK_BUFFER_USAGE_STORAGE_BUFFER_BIT, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, clustersSize, &lights->clusterBuffers[i], &lights->clusterMemories[i]);
+        if (success && vkMapMemory(device, lights->lightMemories[i], 0, lightsSize, 0, &lights->mapped[i]) != VK_SUCCESS) success = 0;
+    }
+
+    VkDescriptorPoolSize poolSize = { 0 };
+    poolSize.type = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+    poolSize.descriptorCount = CREN_CONCURRENTLY_RENDERED_FRAMES * 2;
+
+    VkDescriptorPoolCreateInfo poolCI = { 0 };
+    poolCI.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
+    poolCI.maxSets = CREN_CONCURRENTLY_RENDERED_FRAMES;
+    poolCI.poolSizeCount = 1;
+    poolCI.pPoolSizes = &poolSize;
+    if (success && vkCreateDescriptorPool(device, &poolCI, NULL, &lights->descriptorPool) != VK_SUCCESS) success = 0;
+
+    VkDescriptorSetLayout layouts[CREN_CONCURRENTLY_RENDERED_FRAMES] = { 0 };
+    for (unsigned int i = 0; success && i < CREN_CONCURRENTLY_RENDERED_FRAMES; i++) layouts[i] = lights->pipeline->descriptorSetLayout;
+
+    VkDescriptorSetAllocateInfo allocInfo = { 0 };
+    allocInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
+    allocInfo.descriptorPool = lights->descriptorPool;
+    allocInfo.descriptorSetCount = CREN_CONCURRENTLY_RENDERED_FRAMES;
+    allocInfo.pSetLayouts = layouts;
+    if (success && vkAllocateDescriptorSets(device, &allocInfo, lights->descriptorSets) != VK_SUCCESS) success = 0;
+
+    if (!success) {
+        CREN_LOG("CRen: Failed to create the light clustering objects, is light_cluster.comp compiled?");
+        internal_crenvk_lights_destroy(renderer);
+        return 0;
+    }
+
+    for (unsigned int i = 0; i < CREN_CONCURRENTLY_RENDERED_FRAMES; i++) {
+        VkDescriptorBufferInfo infos[2] = { 0 };
+        infos[0].buffer = lights->lightBuffers[i];
+        infos[0].range = VK_WHOLE_SIZE;
+        infos[1].buffer = lights->clusterBuffers[i];
+        infos[1].range = VK_WHOLE_SIZE;
+
+        VkWriteDescriptorSet writes[2] = { 0 };
+        for (unsigned int j = 0; j < 2; j++) {
+            writes[j].sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+            writes[j].dstSet = lights->descriptorSets[i];
+            writes[j].dstBinding = j;
+            writes[j].descriptorCount = 1;
+            writes[j].descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+            writes[j].pBufferInfo = &infos[j];
+        }
+        vkUpdateDescriptorSets(device, 2, writes, 0, NULL);
+    }
+
+    return 1;
+}
+
+/// @brief uploads the frame's lights and records the clustering dispatch on the frame's compute work, the submitted lights are cleared afterwards
+/// @param context cren context
+/// @param currentFrame current frame in flight, it's fence was already waited on
+static void internal_crenvk_lights_cluster(CRenContext* context, unsigned int currentFrame) {
+    CRenVulkanBackend* renderer = (CRenVulkanBackend*)context->backend;
+    vkLightClusters* lights = &renderer->lights;
+    if (lights->pipeline == NULL) return;
+
+    // the dispatch runs even without lights, the clusters then tell the fragment shaders to stay unlit
+    crenmemory_copy(lights->mapped[currentFrame], lights->lights, sizeof(vkPointLight) * lights->lightCount);
+
+    // the projection holds the frustum slopes, 1 / (tan(fov / 2) * aspect) and 1 / tan(fov / 2)
+    const mat4* proj = &context->camera.perspective;
+    vkLightClusterPushConstant pc = { 0 };
+    pc.view = context->camera.view;
+    pc.frustum = (float4){ context->camera.near, context->camera.far, 1.0f / proj->data[0][0], 1.0f / proj->data[1][1] };
+    pc.lightCount = lights->lightCount;
+
+    unsigned int clusterCount = CREN_LIGHT_CLUSTERS_X * CREN_LIGHT_CLUSTERS_Y * CREN_LIGHT_CLUSTERS_Z;
+    unsigned int groups = (clusterCount + CREN_LIGHT_CLUSTER_WORKGROUP_SIZE - 1) / CREN_LIGHT_CLUSTER_WORKGROUP_SIZE;
+    crenvk_compute_dispatch(context, lights->pipeline, lights->descriptorSets[currentFrame], &pc, sizeof(pc), groups, 1, 1);
+
+    lights->lightCount = 0;
+}
+
+int crenvk_light_submit(CRenContext* context, const vkPointLight* light) {
+    CRenVulkanBackend* renderer = (CRenVulkanBackend*)context->backend;
+    vkLightClusters* lights = &renderer->lights;
+
+    if (light == NULL || lights->lightCount >= CREN_LIGHTS_MAX) return 0;
+    if (!internal_crenvk_lights_start(context)) return 0;
+
+    lights->lights[lights->lightCount++] = *light;
+    return 1;
+}
+
+unsigned int crenvk_light_count(CRenContext* context) {
+    CRenVulkanBackend* renderer = (CRenVulkanBackend*)context->backend;
+    return renderer->lights.lightCount;
+}
+
+int crenvk_lights_get_descriptor_infos(CRenContext* context, unsigned int frame, VkDescriptorBufferInfo* lights, VkDescriptorBufferInfo* clusters) {
+    CRenVulkanBackend* renderer = (CRenVulkanBackend*)context->backend;
+    if (frame >= CREN_CONCURRENTLY_RENDERED_FRAMES) return 0;
+    if (!internal_crenvk_lights_start(context)) return 0;
+
+    if (lights) {
+        lights->buffer = renderer->lights.lightBuffers[frame];
+        lights->offset = 0;
+        lights->range = VK_WHOLE_SIZE;
+    }
+
+    if (clusters) {
+        clusters->buffer = renderer->lights.clusterBuffers[frame];
+        clusters->offset = 0;
+        clusters->range = VK_WHOLE_SIZE;
+    }
+
+    return 1;
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Core-related
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+int cren_vulkan_init(CRenVulkanBackend *backend, CRenCreateInfo* ci) {
+
+    backend->hint_viewport = ci->smallerViewport;
+    backend->drawlist.version = 1; // phases were never recorded (version 0)
+
+    int success = 1;
+    success &= internal_crenvk_instance_create(&backend->instance, ci->appName, ci->appVersion, ci->apiVersion, ci->validations, ci->nativeWindow == NULL);
+    success &= internal_crenvk_device_create(backend, ci->nativeWindow, ci->validations, ci->apiVersion, ci->dynamicRendering);
+    success &= internal_crenvk_mipmaps_create(&backend->mipmapGenerator, &backend->device, ci->assetsRoot);
+    success &= internal_crenvk_compute_create(backend);
+    internal_crenvk_memory_budget_create(&backend->memoryBudget, &backend->device.physicalDeviceMemoryProperties);
+    internal_crenvk_memory_budget_query(backend);
+    ci->msaa = (int)internal_crenvk_choose_msaa(backend->device.physicalDevice, ci->msaa);
+    ci->dynamicRendering = backend->device.dynamicRendering;
+    if (ci->mergedUI && backend->device.dynamicRendering) {
+        CREN_LOG("CRen: The merged ui needs render pass objects, it's ignored with dynamic rendering");
+        ci->mergedUI = 0;
+    }
+    success &= internal_crenvk_swapchain_create(&backend->swapchain, backend->device.device, backend->device.physicalDevice, backend->device.surface, ci->width, ci->height, ci->vsync);
+    // swapchain does not have a pre-defined pipeline
+
+    backend->defaultRenderphase = internal_crenvk_renderphase_default_create (backend->device.device, backend->device.physicalDevice, backend->swapchain.swapchainFormat.format, (VkSampleCountFlagBits)ci->msaa, 0, backend->device.dynamicRendering, ci->mergedUI);
+    success &= internal_crenvk_renderphase_default_commandpool_create(&backend->defaultRenderphase, &backend->device);
+    success &= internal_crenvk_renderphase_default_framebuffers_create(&backend->defaultRenderphase, &backend->device, &backend->swapchain);
+    backend->defaultRenderphase.pipeline = internal_crenvk_renderphase_default_pipeline_create(&backend->defaultRenderphase, backend->device.device, 1, ci->assetsRoot);
+
+    // picking is otherwise created on first use, see crenvk_renderphase_picking_enable
+    if (ci->picking) {
+        backend->pickingRenderphase = internal_crenvk_renderphase_picking_create(backend->device.device, backend->device.physicalDevice, VK_FORMAT_R32G32_UINT, (VkSampleCountFlagBits)ci->msaa, backend->device.dynamicRendering);
+        success &= internal_crenvk_renderphase_picking_commandpool_create(&backend->pickingRenderphase, &backend->device);
+        success &= internal_crenvk_renderphase_picking_framebuffers_create(&backend->pickingRenderphase, &backend->device, &backend->swapchain);
+        backend->pickingRenderphase.pipeline = internal_crenvk_renderphase_picking_pipeline_create(&backend->pickingRenderphase, backend->device.device, 1, ci->assetsRoot);
+    }
+
+    backend->uiRenderphase = internal_crenvk_renderphase_ui_create(backend->device.device, backend->swapchain.swapchainFormat.format, VK_SAMPLE_COUNT_1_BIT, 1, backend->device.dynamicRendering, ci->mergedUI);
+    success &= internal_crenvk_renderphase_ui_commandpool_create(&backend->uiRenderphase, &backend->device);
+    success &= internal_crenvk_renderphase_ui_framebuffers_create(&backend->uiRenderphase, &backend->device, &backend->swapchain);
+    // ui does not have a pre-defined pipeline
+
+    if(backend->hint_viewport) {
+        backend->viewportRenderphase = internal_crenvk_renderphase_viewport_create(backend->device.device, backend->device.physicalDevice, backend->swapchain.swapchainFormat.format, VK_SAMPLE_COUNT_1_BIT, backend->device.dynamicRendering);
+        success &= internal_crenvk_renderphase_viewport_commandpool_create(&backend->viewportRenderphase, &backend->device);
+        success &= internal_crenvk_renderphase_viewport_framebuffers_create(&backend->viewportRenderphase, &backend->device, &backend->swapchain);
+        // viewport does not have a pre-defined pipeline
+    }
+
+    // buffers
+    backend->buffersLib = crenhashtable_create();
+    crenhashtable_insert(backend->buffersLib, "Camera", crenvk_buffer_create(backend->device.device, backend->device.physicalDevice,  VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, sizeof(vkBufferCamera) * CREN_VIEWS_MAX));
     
     // pipelines
     vkRenderpass* mainRenderpass = backend->hint_viewport ? backend->viewportRenderphase.renderpass : backend->defaultRenderphase.renderpass;
     backend->pipelinesLib = crenhashtable_create();
-    internal_crenvk_pipeline_quad_create(backend->pipelinesLib, mainRenderpass,  backend->pickingRenderphase.renderpass, backend->device.device, ci->assetsRoot);
+    internal_crenvk_pipeline_quad_create(backend->pipelinesLib, &backend->pipelineRegistry, mainRenderpass,  backend->pickingRenderphase.renderpass, backend->device.device, ci->assetsRoot);
+
+    // the prepass is otherwise created on first enable, see crenvk_renderphase_default_set_prepass
+    if (ci->depthPrepass) {
+        backend->drawlist.prepass = internal_crenvk_pipeline_quad_prepass_create(backend->pipelinesLib, &backend->pipelineRegistry, mainRenderpass, backend->device.device, ci->assetsRoot);
+        if (!backend->drawlist.prepass) {
+            CREN_LOG("CRen: Failed to create the depth prepass pipelines, rendering without it");
+            ci->depthPrepass = 0;
+        }
+    }
 
     return success;
 }
 
 void cren_vulkan_shutdown(CRenVulkanBackend *backend) {
 
-    crenvk_pipeline_destroy(backend->device.device, (vkPipeline*)crenhashtable_lookup(backend->pipelinesLib, CREN_PIPELINE_QUAD_DEFAULT_NAME));
-    crenvk_pipeline_destroy(backend->device.device, (vkPipeline*)crenhashtable_lookup(backend->pipelinesLib, CREN_PIPELINE_QUAD_PICKING_NAME));
+    // nothing is destroyed while in use from here on
+    vkDeviceWaitIdle(backend->device.device);
+    internal_crenvk_streaming_destroy(backend);
+    internal_crenvk_capture_destroy(backend);
+    internal_crenvk_pick_rect_destroy(backend);
+    internal_crenvk_lights_destroy(backend);
+    internal_crenvk_frame_timer_destroy(backend);
+    internal_crenvk_compute_destroy(backend);
+    internal_crenvk_retirement_destroy(&backend->retirement, backend->device.device);
+    internal_crenvk_drawlist_destroy(&backend->drawlist);
+    internal_crenvk_views_destroy(backend);
+    if (backend->textureResidency.textures) crenmemory_deallocate(backend->textureResidency.textures);
+    internal_crenvk_mipmaps_destroy(&backend->mipmapGenerator, backend->device.device);
+
+    // the picking pipeline only exists once the picking phase was created, the prepass ones once it was enabled and the particle pipelines once an emitter was created (NULL isn't released)
+    vkPipeline* internalPipelines[5] = { 0 };
+    internalPipelines[0] = (vkPipeline*)crenhashtable_lookup(backend->pipelinesLib, CREN_PIPELINE_QUAD_DEFAULT_NAME);
+    internalPipelines[1] = (vkPipeline*)crenhashtable_lookup(backend->pipelinesLib, CREN_PIPELINE_QUAD_PICKING_NAME);
+    internalPipelines[2] = (vkPipeline*)crenhashtable_lookup(backend->pipelinesLib, CREN_PIPELINE_QUAD_DEPTH_NAME);
+    internalPipelines[3] = (vkPipeline*)crenhashtable_lookup(backend->pipelinesLib, CREN_PIPELINE_QUAD_EQUAL_NAME);
+    internalPipelines[4] = (vkPipeline*)crenhashtable_lookup(backend->pipelinesLib, CREN_PIPELINE_PARTICLE_DEFAULT_NAME);
+    for (unsigned int i = 0; i < (unsigned int)CREN_ARRAYSIZE(internalPipelines); i++) {
+        if (internal_crenvk_pipeline_registry_remove(&backend->pipelineRegistry, backend->device.device, internalPipelines[i])) crenvk_pipeline_destroy(backend->device.device, internalPipelines[i]);
+    }
+    internal_crenvk_pipeline_registry_destroy(&backend->pipelineRegistry, backend->device.device);
+    crenvk_compute_pipeline_destroy(backend->device.device, (vkComputePipeline*)crenhashtable_lookup(backend->pipelinesLib, CREN_PIPELINE_PARTICLE_SIMULATE_NAME));
 
     crenvk_buffer_destroy((vkBuffer*)crenhashtable_lookup(backend->buffersLib, "Camera"), backend->device.device);
 
     if (backend->hint_viewport) internal_crenvk_renderphase_viewport_destroy(&backend->viewportRenderphase, backend->device.device, 1);
 
     internal_crenvk_renderphase_ui_destroy(&backend->uiRenderphase, backend->device.device, 1);
-    internal_crenvk_renderphase_picking_destroy(&backend->pickingRenderphase, backend->device.device, 1, 1);
+    if (backend->pickingRenderphase.renderpass != NULL) internal_crenvk_renderphase_picking_destroy(&backend->pickingRenderphase, backend->device.device, 1, 1);
     internal_crenvk_renderphase_default_destroy(&backend->defaultRenderphase, backend->device.device, 1, 1);
     internal_crenvk_swapchain_destroy(&backend->swapchain, backend->device.device);
     internal_crenvk_device_destroy(&backend->instance, &backend->device);
@@ -2708,88 +8004,193 @@ void cren_vulkan_update(CRenContext* context, double timestep) {
     CRenVulkanBackend* renderer = (CRenVulkanBackend*)context->backend;
     if (renderer->hint_minimized) return;
 
-    vkBufferCamera cameraData = { 0 };
-    cameraData.view = context->camera.view;
-    cameraData.viewInverse = mat4_inverse(context->camera.view);
-    cameraData.proj = context->camera.perspective;
+    // slot 0 is the main camera, views cameras are updated alongside it
+    vkBufferCamera cameraData[CREN_VIEWS_MAX] = { 0 };
+    for (unsigned int i = 0; i < CREN_VIEWS_MAX; i++) {
+        vkView* view = &renderer->viewSet.views[i];
+        if (i > 0 && !view->used) continue;
+
+        CRenCamera* camera = i == 0 ? &context->camera : &view->camera;
+        if (i > 0) cren_camera_update(camera, timestep);
+
+        cameraData[i].view = camera->view;
+        cameraData[i].viewInverse = mat4_inverse(camera->view);
+        cameraData[i].proj = camera->perspective;
+        cameraData[i].time = (float)context->time;
 
-    cameraData.proj.data[1] [1] *= -1.0f; // flyp y because vulkan
+        cameraData[i].proj.data[1] [1] *= -1.0f; // flyp y because vulkan
+    }
 
     vkBuffer* cameraBuffer = (vkBuffer*)crenhashtable_lookup(renderer->buffersLib, "Camera");
-    crenmemory_copy(cameraBuffer->mappedData->data[renderer->device.currentFrame], &cameraData, sizeof(cameraData));
+    crenmemory_copy(cameraBuffer->mappedData->data[renderer->device.currentFrame], cameraData, sizeof(cameraData));
+}
+
+/// @brief re-creates everything that depends on the anti-aliasing sample count
+/// @param context cren context
+static void internal_crenvk_msaa_recreate(CRenContext* context) {
+    CRenVulkanBackend* renderer = (CRenVulkanBackend*)context->backend;
+
+    VkSampleCountFlagBits msaa = internal_crenvk_choose_msaa(renderer->device.physicalDevice, context->createInfo.msaa);
+    context->createInfo.msaa = (int)msaa;
+    if (msaa == renderer->defaultRenderphase.renderpass->msaa) return;
+
+    // the ui pipelines were built against the merged renderpass, a new sample count would make it incompatible with them
+    if (renderer->defaultRenderphase.mergedUI) {
+        CREN_LOG("CRen: The sample count can't change while the ui is merged into the default renderphase");
+        context->createInfo.msaa = (int)renderer->defaultRenderphase.renderpass->msaa;
+        return;
+    }
+
+    // retained packets point at the pipelines about to be destroyed
+    const char* packetPipelines[] = { CREN_PIPELINE_QUAD_DEFAULT_NAME, CREN_PIPELINE_QUAD_PICKING_NAME, CREN_PIPELINE_QUAD_DEPTH_NAME, CREN_PIPELINE_QUAD_EQUAL_NAME };
+    vkPipeline* previousPipelines[CREN_ARRAYSIZE(packetPipelines)] = { 0 };
+    vkPipeline* currentPipelines[CREN_ARRAYSIZE(packetPipelines)] = { 0 };
+    for (unsigned int i = 0; i < (unsigned int)CREN_ARRAYSIZE(packetPipelines); i++) {
+        previousPipelines[i] = (vkPipeline*)crenhashtable_lookup(renderer->pipelinesLib, packetPipelines[i]);
+    }
+
+    internal_crenvk_renderphase_default_msaa_change(&renderer->defaultRenderphase, &renderer->device, &renderer->swapchain, msaa, context->createInfo.assetsRoot);
+    if (renderer->pickingRenderphase.renderpass != NULL) {
+        internal_crenvk_renderphase_picking_msaa_change(&renderer->pickingRenderphase, &renderer->device, &renderer->swapchain, msaa, context->createInfo.assetsRoot);
+    }
+
+    // quad pipelines multisample state must match their renderpasses
+    vkRenderpass* mainRenderpass = renderer->hint_viewport ? renderer->viewportRenderphase.renderpass : renderer->defaultRenderphase.renderpass;
+    internal_crenvk_pipeline_quad_create(renderer->pipelinesLib, &renderer->pipelineRegistry, mainRenderpass, renderer->pickingRenderphase.renderpass, renderer->device.device, context->createInfo.assetsRoot);
+    if (crenhashtable_lookup(renderer->pipelinesLib, CREN_PIPELINE_QUAD_DEPTH_NAME) != NULL) {
+        if (!internal_crenvk_pipeline_quad_prepass_create(renderer->pipelinesLib, &renderer->pipelineRegistry, mainRenderpass, renderer->device.device, context->createInfo.assetsRoot)) {
+            CREN_LOG("CRen: Failed to re-create the depth prepass pipelines, rendering without it");
+            context->createInfo.depthPrepass = 0;
+            renderer->drawlist.prepass = 0;
+        }
+    }
+    if (crenhashtable_lookup(renderer->pipelinesLib, CREN_PIPELINE_PARTICLE_DEFAULT_NAME) != NULL) {
+        internal_crenvk_pipeline_particle_create(renderer->pipelinesLib, &renderer->pipelineRegistry, mainRenderpass, renderer->device.device, context->createInfo.assetsRoot);
+    }
+
+    for (unsigned int i = 0; i < (unsigned int)CREN_ARRAYSIZE(packetPipelines); i++) {
+        currentPipelines[i] = (vkPipeline*)crenhashtable_lookup(renderer->pipelinesLib, packetPipelines[i]);
+    }
+    internal_crenvk_drawlist_replace_pipelines(&renderer->drawlist, previousPipelines, currentPipelines, (unsigned int)CREN_ARRAYSIZE(packetPipelines));
+
+    // views draw with the same pipelines
+    internal_crenvk_views_msaa_change(renderer, mainRenderpass->msaa);
 }
 
 void cren_vulkan_render(CRenContext* context, double timestep) {
     CRenVulkanBackend* renderer = (CRenVulkanBackend*)context->backend;
 
     // window is hinted as minimized
-    if (renderer->hint_minimized) return;
+    if (renderer->hint_minimized) {
+        internal_crenvk_compute_flush(renderer);
+        internal_crenvk_drawlist_end_frame(&renderer->drawlist);
+        renderer->lights.lightCount = 0;
+        return;
+    }
 
     unsigned int currentFrame = renderer->device.currentFrame;
     vkWaitForFences(renderer->device.device, 1, &renderer->device.framesInFlightFences[currentFrame], VK_TRUE, UINT64_MAX);
+    internal_crenvk_retirement_collect(&renderer->retirement, renderer->device.device, 0);
+    internal_crenvk_capture_collect(renderer, 0);
+    internal_crenvk_pick_rect_collect(renderer);
+
+    // every once in a while check if the scene still fits the memory budget
+    if (renderer->retirement.frameNumber >= renderer->memoryBudget.evictionCheckFrame + CREN_MEMORY_BUDGET_INTERVAL) {
+        renderer->memoryBudget.evictionCheckFrame = renderer->retirement.frameNumber;
+        crenvk_memory_evict_textures(context, 0, 0);
+    }
+
+    internal_crenvk_streaming_update(context);
+
     VkResult res = vkAcquireNextImageKHR(renderer->device.device, renderer->swapchain.swapchain, UINT64_MAX, renderer->device.imageAvailableSemaphores[currentFrame], VK_NULL_HANDLE, &renderer->device.imageIndex);
     
     if (res == VK_ERROR_OUT_OF_DATE_KHR) {
         internal_crenvk_renderphase_default_recreate(&renderer->defaultRenderphase, &renderer->device, &renderer->swapchain, context->createInfo.width, context->createInfo.height, context->createInfo.vsync);
-        internal_crenvk_renderphase_picking_recreate(&renderer->pickingRenderphase, &renderer->device, &renderer->swapchain);
+        if (renderer->pickingRenderphase.renderpass != NULL) internal_crenvk_renderphase_picking_recreate(&renderer->pickingRenderphase, &renderer->device, &renderer->swapchain);
         internal_crenvk_renderphase_ui_recreate(&renderer->uiRenderphase, &renderer->device, &renderer->swapchain);
     
         if (renderer->hint_viewport) {
-            internal_crenvk_renderphase_viewport_recreate(&renderer->viewportRenderphase, &renderer->device, &renderer->swapchain);
+            internal_crenvk_renderphase_viewport_recreate(&renderer->viewportRenderphase, context);
         }
         
+        // recorded command buffers point to destroyed framebuffers
+        renderer->drawlist.version++;
+        internal_crenvk_compute_flush(renderer);
+        internal_crenvk_drawlist_end_frame(&renderer->drawlist);
+        renderer->lights.lightCount = 0;
         return;
     }
 
     CREN_ASSERT(res == VK_SUCCESS || res == VK_SUBOPTIMAL_KHR, "Renderer update was not able to aquire an image from the swapchain");
     vkResetFences(renderer->device.device, 1, &renderer->device.framesInFlightFences[currentFrame]);
 
-    // manage renderpasses/render phases
+    // manage renderpasses/render phases, the draw list is sorted once and replayed by every phase
     int usingViewport = renderer->hint_viewport;
+    internal_crenvk_drawlist_sort(&renderer->drawlist, &context->camera.view);
+    internal_crenvk_drawlist_touch(&renderer->drawlist, renderer->retirement.frameNumber);
+    internal_crenvk_views_cull(renderer, &context->camera);
     internal_crenvk_renderphase_default_update(&renderer->defaultRenderphase, context, currentFrame, renderer->device.imageIndex, usingViewport, timestep, (CRenCallback_Render)context->renderCallback);
     internal_crenvk_renderphase_viewport_update(&renderer->viewportRenderphase, context, currentFrame, renderer->device.imageIndex, usingViewport, timestep, (CRenCallback_Render)context->renderCallback);
-    internal_crenvk_renderphase_picking_update(&renderer->pickingRenderphase, context, currentFrame, renderer->device.imageIndex, usingViewport, timestep, (CRenCallback_Render)context->renderCallback);
-    internal_crenvk_renderphase_ui_update(&renderer->uiRenderphase, context, currentFrame, renderer->device.imageIndex, (CRenCallback_DrawUIRawData)context->drawUIRawDataCallback);
+    int usingPicking = renderer->pickingRenderphase.renderpass != NULL;
+    if (usingPicking) internal_crenvk_renderphase_picking_update(&renderer->pickingRenderphase, context, currentFrame, renderer->device.imageIndex, usingViewport, timestep, (CRenCallback_Render)context->renderCallback);
+    if (!renderer->uiRenderphase.merged) internal_crenvk_renderphase_ui_update(&renderer->uiRenderphase, context, currentFrame, renderer->device.imageIndex, (CRenCallback_DrawUIRawData)context->drawUIRawDataCallback);
+
+    // compute work recorded for this frame goes first, graphics only waits on it where it's results may be consumed
+    internal_crenvk_lights_cluster(context, currentFrame);
+    VkSemaphore computeSemaphore = VK_NULL_HANDLE;
+    int computed = internal_crenvk_compute_submit(renderer, &computeSemaphore);
 
     // submit command buffers
     VkSwapchainKHR swapChains[] = { renderer->swapchain.swapchain };
-    VkSemaphore waitSemaphores[] = { renderer->device.imageAvailableSemaphores[currentFrame]};
+    VkSemaphore waitSemaphores[] = { renderer->device.imageAvailableSemaphores[currentFrame], computeSemaphore };
     VkSemaphore signalSemaphores[] = { renderer->device.finishedRenderingSemaphores[currentFrame]};
-    VkPipelineStageFlags waitStages[] = { VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT };
+    VkPipelineStageFlags waitStages[] = { VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT, VK_PIPELINE_STAGE_DRAW_INDIRECT_BIT | VK_PIPELINE_STAGE_VERTEX_INPUT_BIT | VK_PIPELINE_STAGE_VERTEX_SHADER_BIT | VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT };
 
     VkSubmitInfo submitInfo = { 0 };
     submitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
     submitInfo.pNext = NULL;
-    submitInfo.waitSemaphoreCount = 1;
+    submitInfo.waitSemaphoreCount = computed ? 2 : 1;
     submitInfo.pWaitSemaphores = waitSemaphores;
     submitInfo.pWaitDstStageMask = waitStages;
     submitInfo.signalSemaphoreCount = 1;
     submitInfo.pSignalSemaphores = signalSemaphores;
 
-    if (usingViewport) {
-        const VkCommandBuffer commandBuffers[] = {
-            renderer->defaultRenderphase.renderpass->commandBuffers[currentFrame],
-            renderer->pickingRenderphase.renderpass->commandBuffers[currentFrame],
-            renderer->viewportRenderphase.renderpass->commandBuffers[currentFrame],
-            renderer->uiRenderphase.renderpass->commandBuffers[currentFrame]
-        };
-
-        submitInfo.commandBufferCount = (unsigned int)CREN_ARRAYSIZE(commandBuffers);
-        submitInfo.pCommandBuffers = commandBuffers;
+    // the frame timer brackets every other command buffer of the frame
+    VkCommandBuffer timerBeginCmd = VK_NULL_HANDLE;
+    VkCommandBuffer timerEndCmd = VK_NULL_HANDLE;
+    int timed = internal_crenvk_frame_timer_record(renderer, &timerBeginCmd, &timerEndCmd);
+
+    VkCommandBuffer commandBuffers[7 + CREN_VIEWS_MAX + CREN_CAPTURE_RING_SIZE] = { 0 };
+    unsigned int commandBufferCount = 0;
+    if (timed) commandBuffers[commandBufferCount++] = timerBeginCmd;
+    int mergedUI = renderer->defaultRenderphase.mergedUI;
+    if (!mergedUI) commandBuffers[commandBufferCount++] = renderer->defaultRenderphase.renderpass->commandBuffers[currentFrame];
+    if (usingPicking) {
+        commandBuffers[commandBufferCount++] = renderer->pickingRenderphase.renderpass->commandBuffers[currentFrame];
+
+        // rectangle picks read the picking image as soon as it's rendered
+        VkCommandBuffer pickCmd = VK_NULL_HANDLE;
+        if (internal_crenvk_pick_rect_record(renderer, &pickCmd)) commandBuffers[commandBufferCount++] = pickCmd;
     }
 
-    else {
-        const VkCommandBuffer commandBuffers[] = {
-            renderer->defaultRenderphase.renderpass->commandBuffers[currentFrame],
-            renderer->pickingRenderphase.renderpass->commandBuffers[currentFrame],
-            renderer->uiRenderphase.renderpass->commandBuffers[currentFrame]
-        };
+    if (usingViewport) commandBuffers[commandBufferCount++] = renderer->viewportRenderphase.renderpass->commandBuffers[currentFrame];
 
-        submitInfo.commandBufferCount = (unsigned int)CREN_ARRAYSIZE(commandBuffers);
-        submitInfo.pCommandBuffers = commandBuffers;
-    }
+    // views are rendered before the ui, wich may display them
+    commandBufferCount += internal_crenvk_views_record(renderer, currentFrame, &commandBuffers[commandBufferCount]);
+
+    // merged, the default phase draws the ui and goes after them as well
+    vkRenderpass* lastRenderpass = mergedUI ? renderer->defaultRenderphase.renderpass : renderer->uiRenderphase.renderpass;
+    commandBuffers[commandBufferCount++] = lastRenderpass->commandBuffers[currentFrame];
+
+    // frame captures copy the finished image, before the present waits on the frame's semaphore
+    commandBufferCount += internal_crenvk_capture_record(renderer, &commandBuffers[commandBufferCount]);
+    if (timed) commandBuffers[commandBufferCount++] = timerEndCmd;
+    submitInfo.commandBufferCount = commandBufferCount;
+    submitInfo.pCommandBuffers = commandBuffers;
     
     CREN_ASSERT(vkQueueSubmit(renderer->device.graphicsQueue, 1, &submitInfo, renderer->device.framesInFlightFences[currentFrame]) == VK_SUCCESS, "Renderer update was not able to submit frame to graphics queue");
+    internal_crenvk_drawlist_end_frame(&renderer->drawlist);
+    renderer->retirement.frameNumber++;
 
     // present the image
     VkPresentInfoKHR presentInfo = { 0 };
@@ -2804,16 +8205,18 @@ void cren_vulkan_render(CRenContext* context, double timestep) {
 
     if (res == VK_ERROR_OUT_OF_DATE_KHR || res == VK_SUBOPTIMAL_KHR || renderer->hint_resize) {
         renderer->hint_resize = 0;
+        renderer->drawlist.version++;
 
         internal_crenvk_renderphase_default_recreate(&renderer->defaultRenderphase, &renderer->device, &renderer->swapchain, context->createInfo.width, context->createInfo.height, context->createInfo.vsync);
-        internal_crenvk_renderphase_picking_recreate(&renderer->pickingRenderphase, &renderer->device, &renderer->swapchain);
+        if (renderer->pickingRenderphase.renderpass != NULL) internal_crenvk_renderphase_picking_recreate(&renderer->pickingRenderphase, &renderer->device, &renderer->swapchain);
         internal_crenvk_renderphase_ui_recreate(&renderer->uiRenderphase, &renderer->device, &renderer->swapchain);
         
         if (renderer->hint_viewport) {
-            internal_crenvk_renderphase_viewport_recreate(&renderer->viewportRenderphase, &renderer->device, &renderer->swapchain);
+            internal_crenvk_renderphase_viewport_recreate(&renderer->viewportRenderphase, context);
         }
 
         float aspect = (float)context->createInfo.width / (float)context->createInfo.height;
+        if (renderer->hint_viewport) aspect = renderer->viewportRenderphase.vpSize.x / renderer->viewportRenderphase.vpSize.y;
         cren_camera_set_aspect_ratio(&context->camera, aspect);
 
         CRenCallback_ImageCount fnImageCount = (CRenCallback_ImageCount)context->imageCountCallback;
@@ -2825,6 +8228,22 @@ void cren_vulkan_render(CRenContext* context, double timestep) {
     else if (res != VK_SUCCESS) {
         CREN_ASSERT(1, "Renderer update was not able to properly presnet the graphics queue frame");
     }
+
+    // anti-aliasing has changed, phases with multisampled attachments and their pipelines must be re-created
+    if (renderer->hint_msaa) {
+        renderer->hint_msaa = 0;
+        renderer->drawlist.version++;
+        internal_crenvk_msaa_recreate(context);
+    }
+
+    // the viewport panel has changed it's size/render scale, images are re-allocated after presenting so the ui picks the new descriptor on the next frame
+    if (renderer->hint_viewport && renderer->viewportRenderphase.hint_resize) {
+        renderer->drawlist.version++;
+        internal_crenvk_renderphase_viewport_recreate(&renderer->viewportRenderphase, context);
+
+        float aspect = renderer->viewportRenderphase.vpSize.x / renderer->viewportRenderphase.vpSize.y;
+        cren_camera_set_aspect_ratio(&context->camera, aspect);
+    }
 }
 
 /////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -3308,9 +8727,91 @@ int crenvk_commandbuffer_end(VkDevice device, VkCommandPool cmdPool, VkCommandBu
 // Texture-related
 /////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 
+/// @brief allocates the texture image and starts tracking it's residency, other textures are evicted first if it wouldn't fit the memory budget
+/// @param context cren context
+/// @param tex the texture, it's backend format, usage and flags must be set
+static void internal_crenvk_texture2d_image_create(CRenContext* context, CRenTexture2D* tex) {
+	CRenVulkanBackend* renderer = (CRenVulkanBackend*)context->backend;
+	CRenTexture2DBackend* backend = tex->backend;
+
+	// a full mip chain adds a third of the base level
+	VkDeviceSize estimate = (VkDeviceSize)tex->width * (VkDeviceSize)tex->height * 4;
+	if (tex->mipLevels > 1) estimate = estimate * 4 / 3;
+	crenvk_memory_evict_textures(context, estimate, 0);
+
+	int created = crenvk_image_create(tex->width, tex->height, tex->mipLevels, 1, renderer->device.device, renderer->device.physicalDevice, &backend->image, &backend->memory, backend->format, VK_SAMPLE_COUNT_1_BIT, VK_IMAGE_TILING_OPTIMAL, backend->usage, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, backend->flags);
+
+	// out of memory, shrink whatever is resident and try again
+	if (!created && crenvk_memory_evict_textures(context, estimate, 1) > 0) {
+		created = crenvk_image_create(tex->width, tex->height, tex->mipLevels, 1, renderer->device.device, renderer->device.physicalDevice, &backend->image, &backend->memory, backend->format, VK_SAMPLE_COUNT_1_BIT, VK_IMAGE_TILING_OPTIMAL, backend->usage, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, backend->flags);
+	}
+
+	if (!created) {
+		cren_set_error(Vulkan_ImageCreationFailed);
+		CREN_ASSERT(created, "Failed to create texture image, device is out of memory");
+		return;
+	}
+
+	VkMemoryRequirements memRequirements;
+	vkGetImageMemoryRequirements(renderer->device.device, backend->image, &memRequirements);
+	backend->width = (unsigned int)tex->width;
+	backend->height = (unsigned int)tex->height;
+	backend->mipLevels = (unsigned int)tex->mipLevels;
+	backend->size = memRequirements.size;
+	backend->lastUsedFrame = renderer->retirement.frameNumber;
+	internal_crenvk_residency_insert(&renderer->textureResidency, backend);
+}
+
+/// @brief creates a streamed texture with only it's mip tail resident, the remaining levels are streamed in once it's seen on screen
+/// @param context cren context
+/// @param tex the texture, it's path and full dimensions must be set
+/// @param pixels full resolution rgba8 texels
+/// @return 1 on success, 0 on failure
+static int internal_crenvk_texture2d_create_streamed(CRenContext* context, CRenTexture2D* tex, const unsigned char* pixels) {
+	CRenVulkanBackend* renderer = (CRenVulkanBackend*)context->backend;
+	CRenTexture2DBackend* backend = tex->backend;
+
+	// levels are generated on the cpu, the image is never written by compute shaders
+	backend->format = VK_FORMAT_R8G8B8A8_SRGB;
+	backend->usage = VK_IMAGE_USAGE_TRANSFER_SRC_BIT | VK_IMAGE_USAGE_TRANSFER_DST_BIT | VK_IMAGE_USAGE_SAMPLED_BIT;
+	backend->flags = 0;
+	backend->fullWidth = (unsigned int)tex->width;
+	backend->fullHeight = (unsigned int)tex->height;
+	backend->fullMipLevels = (unsigned int)tex->mipLevels;
+	cren_strncpy(backend->path, tex->path, sizeof(backend->path) - 1);
+
+	vkStreamingJob job = { 0 };
+	job.texture = backend;
+	job.baseLevel = internal_crenvk_streaming_tail_level(backend->fullWidth, backend->fullHeight, backend->fullMipLevels);
+
+	VkDeviceSize estimate = (VkDeviceSize)uint_max(backend->fullWidth >> job.baseLevel, 1) * uint_max(backend->fullHeight >> job.baseLevel, 1) * 4 * 4 / 3;
+	crenvk_memory_evict_textures(context, estimate, 0);
+
+	if (!internal_crenvk_streaming_build(renderer, &job, pixels)) return 0;
+
+	vkWaitForFences(renderer->device.device, 1, &job.fence, VK_TRUE, UINT64_MAX);
+	internal_crenvk_streaming_upload_release(renderer, &job);
+
+	VkMemoryRequirements memRequirements;
+	vkGetImageMemoryRequirements(renderer->device.device, job.image, &memRequirements);
+	backend->image = job.image;
+	backend->memory = job.memory;
+	backend->view = job.view;
+	backend->width = job.width;
+	backend->height = job.height;
+	backend->mipLevels = job.mipLevels;
+	backend->evictedLevels = job.baseLevel;
+	backend->size = memRequirements.size;
+	backend->lastUsedFrame = renderer->retirement.frameNumber;
+	backend->streamable = 1;
+	internal_crenvk_residency_insert(&renderer->textureResidency, backend);
+
+	return 1;
+}
+
 CRenTexture2D crenvk_texture2d_create_from_path(CRenContext* context, const char* path, int gui) {
     CRenTexture2D tex = { 0 };
-    tex.backend = (CRenTexture2DBackend*)crenmemory_allocate(sizeof(CRenTexture2DBackend), 0);
+    tex.backend = (CRenTexture2DBackend*)crenmemory_allocate(sizeof(CRenTexture2DBackend), 1);
 	cren_strncpy(tex.path, path, sizeof(tex.path) - 1);
 
 	int channels = 0;
@@ -3319,7 +8820,22 @@ CRenTexture2D crenvk_texture2d_create_from_path(CRenContext* context, const char
 
 	tex.mipLevels = gui == 1 ? 1 : (int)d_floor(d_log2(int_max(tex.width, tex.height))) + 1;
 
+	if (cren_trace_recording(context)) {
+		CRenTraceTexture record = { (unsigned long long)(uintptr_t)tex.backend, gui, tex.width, tex.height, { 0 } };
+		cren_strncpy(record.path, tex.path, sizeof(record.path) - 1);
+		cren_trace_write(context, TraceRecord_TextureCreate, &record, sizeof(record));
+	}
+
 	CRenVulkanBackend* renderer = (CRenVulkanBackend*)context->backend;
+
+	// with streaming only the mip tail is uploaded now, the sampler allows the whole chain for when the remaining levels stream in
+	if (pixels != NULL && gui == 0 && tex.mipLevels > 1 && renderer->textureStreamer.enabled && internal_crenvk_texture2d_create_streamed(context, &tex, pixels)) {
+		cren_stbimage_destroy(pixels);
+		tex.backend->sampler = crenvk_image_sampler_create(renderer->device.device, renderer->device.physicalDevice, VK_FILTER_LINEAR, VK_FILTER_LINEAR, VK_SAMPLER_ADDRESS_MODE_REPEAT, VK_SAMPLER_ADDRESS_MODE_REPEAT, VK_SAMPLER_ADDRESS_MODE_REPEAT, (float)tex.mipLevels);
+		tex.backend->uiDescriptor = crenvk_image_descriptor_set_create(renderer->device.device, renderer->uiRenderphase.descPool, renderer->uiRenderphase.descSetLayout, tex.backend->sampler, tex.backend->view);
+		return tex;
+	}
+
 	VkDeviceSize imgSize = (VkDeviceSize)(tex.width * tex.height * 4);
 	VkBuffer stagingBuffer;
 	VkDeviceMemory stagingMemory;
@@ -3345,23 +8861,12 @@ CRenTexture2D crenvk_texture2d_create_from_path(CRenContext* context, const char
 
 	vkRenderpass* renderpass = renderer->hint_viewport == 1 ? renderer->viewportRenderphase.renderpass : renderer->defaultRenderphase.renderpass;
 
-	crenvk_image_create
-	(
-		tex.width,
-		tex.height,
-		tex.mipLevels,
-		1,
-		renderer->device.device,
-		renderer->device.physicalDevice,
-		&tex.backend->image,
-		&tex.backend->memory,
-		VK_FORMAT_R8G8B8A8_SRGB,
-		gui == 1 ? VK_SAMPLE_COUNT_1_BIT : renderpass->msaa,
-		VK_IMAGE_TILING_OPTIMAL,
-		VK_IMAGE_USAGE_TRANSFER_SRC_BIT | VK_IMAGE_USAGE_TRANSFER_DST_BIT | VK_IMAGE_USAGE_SAMPLED_BIT,
-		VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
-		0
-	);
+	// levels are generated by compute shaders when possible, storage images can't be sRGB so the image is created as unorm with a sRGB view for sampling
+	int computeMips = crenvk_mipmaps_compute_supported(context) && tex.mipLevels > 1 && tex.mipLevels - 1 <= CREN_MIPMAP_COMPUTE_LEVELS_MAX;
+	tex.backend->format = computeMips ? VK_FORMAT_R8G8B8A8_UNORM : VK_FORMAT_R8G8B8A8_SRGB;
+	tex.backend->usage = VK_IMAGE_USAGE_TRANSFER_SRC_BIT | VK_IMAGE_USAGE_TRANSFER_DST_BIT | VK_IMAGE_USAGE_SAMPLED_BIT | (computeMips ? VK_IMAGE_USAGE_STORAGE_BIT : 0);
+	tex.backend->flags = computeMips ? VK_IMAGE_CREATE_MUTABLE_FORMAT_BIT : 0;
+	internal_crenvk_texture2d_image_create(context, &tex);
 
 	// transition layout to data transfer
 	crenvk_image_transition_layout
@@ -3398,16 +8903,7 @@ CRenTexture2D crenvk_texture2d_create_from_path(CRenContext* context, const char
 	crenvk_commandbuffer_end_singletime(renderer->device.device, renderpass->commandPool, cmdBuffer, renderer->device.graphicsQueue);
 
 	// mipmap generation
-	crenvk_image_mipmaps_create
-	(
-		renderer->device.device,
-		renderer->device.graphicsQueue,
-		renderpass->commandPool,
-		tex.width,
-		tex.height,
-		tex.mipLevels,
-		tex.backend->image
-	);
+	crenvk_mipmaps_generate(context, tex.backend->image, (unsigned int)tex.width, (unsigned int)tex.height, (unsigned int)tex.mipLevels, 1);
 
 	vkDestroyBuffer(renderer->device.device, stagingBuffer, NULL);
 	vkFreeMemory(renderer->device.device, stagingMemory, NULL);
@@ -3422,11 +8918,17 @@ CRenTexture2D crenvk_texture2d_create_from_path(CRenContext* context, const char
 
 CRenTexture2D crenvk_texture2d_create_from_buffer(CRenContext* context, CrenTexture2DBuffer* bufferInfo, int gui) {
     CRenTexture2D tex = { 0 };
-	tex.backend = (CRenTexture2DBackend*)crenmemory_allocate(sizeof(CRenTexture2DBackend), 0);
+	tex.backend = (CRenTexture2DBackend*)crenmemory_allocate(sizeof(CRenTexture2DBackend), 1);
 	tex.width = bufferInfo->width;
 	tex.height = bufferInfo->height;
 	tex.mipLevels = gui == 1 ? 1 : (int)d_floor(d_log2(int_max(tex.width, tex.height))) + 1;
 
+	// the texels aren't recorded, the replay uploads a blank texture of the same size
+	if (cren_trace_recording(context)) {
+		CRenTraceTexture record = { (unsigned long long)(uintptr_t)tex.backend, gui, tex.width, tex.height, { 0 } };
+		cren_trace_write(context, TraceRecord_TextureCreate, &record, sizeof(record));
+	}
+
 	VkDeviceSize imgSize = (VkDeviceSize)bufferInfo->lenght;
 
 	// create staging buffer for image
@@ -3454,23 +8956,12 @@ CRenTexture2D crenvk_texture2d_create_from_buffer(CRenContext* context, CrenText
 	vkUnmapMemory(renderer->device.device, stagingMemory);
 
 	// create image resource
-	crenvk_image_create
-	(
-		tex.width,
-		tex.height,
-		tex.mipLevels,
-		1,
-		renderer->device.device,
-		renderer->device.physicalDevice,
-		&tex.backend->image,
-		&tex.backend->memory,
-		VK_FORMAT_R8G8B8A8_SRGB,
-		renderpass->msaa,
-		VK_IMAGE_TILING_OPTIMAL,
-		VK_IMAGE_USAGE_TRANSFER_SRC_BIT | VK_IMAGE_USAGE_TRANSFER_DST_BIT | VK_IMAGE_USAGE_SAMPLED_BIT,
-		VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
-		0
-	);
+	// levels are generated by compute shaders when possible, storage images can't be sRGB so the image is created as unorm with a sRGB view for sampling
+	int computeMips = crenvk_mipmaps_compute_supported(context) && tex.mipLevels > 1 && tex.mipLevels - 1 <= CREN_MIPMAP_COMPUTE_LEVELS_MAX;
+	tex.backend->format = computeMips ? VK_FORMAT_R8G8B8A8_UNORM : VK_FORMAT_R8G8B8A8_SRGB;
+	tex.backend->usage = VK_IMAGE_USAGE_TRANSFER_SRC_BIT | VK_IMAGE_USAGE_TRANSFER_DST_BIT | VK_IMAGE_USAGE_SAMPLED_BIT | (computeMips ? VK_IMAGE_USAGE_STORAGE_BIT : 0);
+	tex.backend->flags = computeMips ? VK_IMAGE_CREATE_MUTABLE_FORMAT_BIT : 0;
+	internal_crenvk_texture2d_image_create(context, &tex);
 
 	// transition layout to transfer data
 	crenvk_image_transition_layout
@@ -3510,7 +9001,7 @@ CRenTexture2D crenvk_texture2d_create_from_buffer(CRenContext* context, CrenText
 	vkDestroyBuffer(renderer->device.device, stagingBuffer, NULL);
 	vkFreeMemory(renderer->device.device, stagingMemory, NULL);
 
-	crenvk_image_mipmaps_create(renderer->device.device, renderer->device.graphicsQueue, renderpass->commandPool, tex.width, tex.height, tex.mipLevels, tex.backend->image);
+	crenvk_mipmaps_generate(context, tex.backend->image, (unsigned int)tex.width, (unsigned int)tex.height, (unsigned int)tex.mipLevels, 1);
 
 	// image view and sampler
 	tex.backend->view = crenvk_image_view_create(renderer->device.device, tex.backend->image, VK_FORMAT_R8G8B8A8_SRGB, VK_IMAGE_ASPECT_COLOR_BIT, tex.mipLevels, 1, VK_IMAGE_VIEW_TYPE_2D);
@@ -3520,17 +9011,32 @@ CRenTexture2D crenvk_texture2d_create_from_buffer(CRenContext* context, CrenText
 	return tex;
 }
 
+/// @brief retirement queue adapter for textures, releases the texture vulkan objects
+/// @param device vulkan device
+/// @param object the texture backend
+static void internal_crenvk_texture2d_release(VkDevice device, void* object) {
+	CRenTexture2DBackend* backend = (CRenTexture2DBackend*)object;
+
+	vkDestroyImageView(device, backend->view, NULL);
+	vkDestroyImage(device, backend->image, NULL);
+	vkFreeMemory(device, backend->memory, NULL);
+	vkDestroySampler(device, backend->sampler, NULL);
+
+	crenmemory_deallocate(backend);
+}
+
 void crenvk_texture2d_destroy(CRenContext* context, CRenTexture2D* texture)
 {
-    CRenVulkanBackend* renderer = (CRenVulkanBackend*)context->backend;
+	if (texture == NULL || texture->backend == NULL) return;
 
-	vkDeviceWaitIdle(renderer->device.device);
-	vkDestroyImageView(renderer->device.device, texture->backend->view, NULL);
-	vkDestroyImage(renderer->device.device, texture->backend->image, NULL);
-	vkFreeMemory(renderer->device.device, texture->backend->memory, NULL);
-	vkDestroySampler(renderer->device.device, texture->backend->sampler, NULL);
+	CRenTraceHandle record = { (unsigned long long)(uintptr_t)texture->backend };
+	cren_trace_write(context, TraceRecord_TextureDestroy, &record, sizeof(record));
 
-	crenmemory_deallocate(context->backend);
+	CRenVulkanBackend* renderer = (CRenVulkanBackend*)context->backend;
+	internal_crenvk_streaming_cancel(context, texture->backend);
+	internal_crenvk_residency_remove(&renderer->textureResidency, texture->backend);
+	crenvk_retire(context, internal_crenvk_texture2d_release, texture->backend);
+	texture->backend = NULL;
 }
 
 VkSampler crenvk_texture2d_get_sampler(CRenTexture2D* texture) {
@@ -3554,6 +9060,353 @@ VkDescriptorSet crenvk_texture2d_get_descriptor(CRenTexture2D *texture) {
 	return texture->backend->uiDescriptor;
 }
 
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Atlas-related
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+/// @brief grows the atlas storage to hold one more texture
+/// @param atlas the atlas
+/// @return 1 on success, 0 on failure
+static int internal_crenvk_atlas_reserve(CRenAtlas* atlas) {
+    if (atlas->count < atlas->capacity) return 1;
+
+    unsigned int newCapacity = atlas->capacity > 0 ? atlas->capacity * 2 : 64;
+
+    vkAtlasEntry* entries = (vkAtlasEntry*)crenmemory_reallocate(atlas->entries, sizeof(vkAtlasEntry) * newCapacity);
+    if (!entries) return 0;
+    atlas->entries = entries;
+
+    CRenAtlasRegion* regions = (CRenAtlasRegion*)crenmemory_reallocate(atlas->regions, sizeof(CRenAtlasRegion) * newCapacity);
+    if (!regions) return 0;
+    atlas->regions = regions;
+
+    atlas->capacity = newCapacity;
+    return 1;
+}
+
+/// @brief copies a texture into it's page region and extends it's edges over the padding
+/// @param page the page texels
+/// @param pageSize page width and height
+/// @param padding texels around the region
+/// @param entry the texture
+/// @param region where the texture was packed
+static void internal_crenvk_atlas_blit(unsigned char* page, int pageSize, int padding, const vkAtlasEntry* entry, const CRenAtlasRegion* region) {
+    for (int y = -padding; y < entry->height + padding; y++) {
+        int srcY = int_min(int_max(y, 0), entry->height - 1);
+        int dstY = region->y + y;
+
+        for (int x = -padding; x < entry->width + padding; x++) {
+            int srcX = int_min(int_max(x, 0), entry->width - 1);
+            int dstX = region->x + x;
+            crenmemory_copy(&page[((size_t)dstY * pageSize + dstX) * 4], &entry->pixels[((size_t)srcY * entry->width + srcX) * 4], 4);
+        }
+    }
+}
+
+/// @brief retirement queue adapter for atlas pages, releases the page params buffer and descriptor sets
+/// @param device vulkan device
+/// @param object the atlas page
+static void internal_crenvk_atlas_page_release(VkDevice device, void* object) {
+    vkAtlasPage* page = (vkAtlasPage*)object;
+
+    if (page->descriptorPool != VK_NULL_HANDLE) vkDestroyDescriptorPool(device, page->descriptorPool, NULL);
+    if (page->params != NULL) crenvk_buffer_destroy(page->params, device);
+    if (page->freeSlots != NULL) crenmemory_deallocate(page->freeSlots);
+    crenmemory_deallocate(page);
+}
+
+/// @brief retirement queue adapter for atlas slots, hands the slot out again
+/// @param device vulkan device
+/// @param object the retired slot
+static void internal_crenvk_atlas_slot_release(VkDevice device, void* object) {
+    (void)device;
+    vkRetiredAtlasSlot* retired = (vkRetiredAtlasSlot*)object;
+
+    retired->page->freeSlots[retired->page->freeCount++] = retired->slot;
+    crenmemory_deallocate(retired);
+}
+
+/// @brief creates what the quads of an atlas page share, the params buffer and a descriptor set per frame sampling the page
+/// @param context cren context
+/// @param texture the page texture
+/// @return the atlas page or NULL on failure
+static vkAtlasPage* internal_crenvk_atlas_page_create(CRenContext* context, CRenTexture2D* texture) {
+    CRenVulkanBackend* renderer = (CRenVulkanBackend*)context->backend;
+    VkDevice device = renderer->device.device;
+
+    if (texture->backend == NULL) return NULL;
+
+    vkAtlasPage* page = (vkAtlasPage*)crenmemory_allocate(sizeof(vkAtlasPage), 1);
+    if (!page) return NULL;
+
+    page->freeSlots = (unsigned int*)crenmemory_allocate(sizeof(unsigned int) * CREN_ATLAS_PAGE_QUADS_MAX, 0);
+    page->params = crenvk_buffer_create(device, renderer->device.physicalDevice, VK_BUFFER_USAGE_STORAGE_BUFFER_BIT, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, sizeof(QuadParams) * CREN_ATLAS_PAGE_QUADS_MAX);
+    if (!page->freeSlots || !page->params) {
+        internal_crenvk_atlas_page_release(device, page);
+        return NULL;
+    }
+
+    VkDescriptorPoolSize poolSizes[3] = { 0 };
+    poolSizes[0].type = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
+    poolSizes[0].descriptorCount = CREN_CONCURRENTLY_RENDERED_FRAMES;
+    poolSizes[1].type = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+    poolSizes[1].descriptorCount = CREN_CONCURRENTLY_RENDERED_FRAMES;
+    poolSizes[2].type = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+    poolSizes[2].descriptorCount = CREN_CONCURRENTLY_RENDERED_FRAMES;
+
+    VkDescriptorPoolCreateInfo descriptorPoolCI = { 0 };
+    descriptorPoolCI.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
+    descriptorPoolCI.poolSizeCount = (unsigned int)CREN_ARRAYSIZE(poolSizes);
+    descriptorPoolCI.pPoolSizes = poolSizes;
+    descriptorPoolCI.maxSets = CREN_CONCURRENTLY_RENDERED_FRAMES;
+    if (vkCreateDescriptorPool(device, &descriptorPoolCI, NULL, &page->descriptorPool) != VK_SUCCESS) {
+        internal_crenvk_atlas_page_release(device, page);
+        return NULL;
+    }
+
+    vkPipeline* pipeline = (vkPipeline*)crenhashtable_lookup(renderer->pipelinesLib, CREN_PIPELINE_QUAD_DEFAULT_NAME);
+    VkDescriptorSetLayout layouts[CREN_CONCURRENTLY_RENDERED_FRAMES] = { pipeline->descriptorSetLayout, pipeline->descriptorSetLayout };
+
+    VkDescriptorSetAllocateInfo descSetAllocInfo = { 0 };
+    descSetAllocInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
+    descSetAllocInfo.descriptorPool = page->descriptorPool;
+    descSetAllocInfo.descriptorSetCount = (unsigned int)CREN_ARRAYSIZE(layouts);
+    descSetAllocInfo.pSetLayouts = layouts;
+    if (vkAllocateDescriptorSets(device, &descSetAllocInfo, page->descriptorSets) != VK_SUCCESS) {
+        internal_crenvk_atlas_page_release(device, page);
+        return NULL;
+    }
+
+    vkBuffer* cameraBuffer = (vkBuffer*)crenhashtable_lookup(renderer->buffersLib, "Camera");
+    for (unsigned int i = 0; i < CREN_CONCURRENTLY_RENDERED_FRAMES; i++) {
+        VkDescriptorBufferInfo camInfo = { 0 };
+        camInfo.buffer = cameraBuffer->buffers[i];
+        camInfo.offset = 0;
+        camInfo.range = sizeof(vkBufferCamera) * CREN_VIEWS_MAX;
+
+        VkDescriptorBufferInfo paramsInfo = { 0 };
+        paramsInfo.buffer = page->params->buffers[i];
+        paramsInfo.offset = 0;
+        paramsInfo.range = VK_WHOLE_SIZE;
+
+        VkDescriptorImageInfo pageInfo = { 0 };
+        pageInfo.imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+        pageInfo.imageView = crenvk_texture2d_get_image_view(texture);
+        pageInfo.sampler = crenvk_texture2d_get_sampler(texture);
+
+        VkWriteDescriptorSet writes[3] = { 0 };
+        for (unsigned int w = 0; w < 3; w++) {
+            writes[w].sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+            writes[w].dstSet = page->descriptorSets[i];
+            writes[w].dstBinding = w;
+            writes[w].dstArrayElement = 0;
+            writes[w].descriptorCount = 1;
+        }
+
+        writes[0].descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
+        writes[0].pBufferInfo = &camInfo;
+        writes[1].descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+        writes[1].pBufferInfo = &paramsInfo;
+        writes[2].descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+        writes[2].pImageInfo = &pageInfo;
+        vkUpdateDescriptorSets(device, 3, writes, 0, NULL);
+    }
+
+    return page;
+}
+
+CRenAtlas* crenvk_atlas_create(int pageSize, int padding) {
+    CRenAtlas* atlas = (CRenAtlas*)crenmemory_allocate(sizeof(CRenAtlas), 1);
+    if (!atlas) return NULL;
+
+    atlas->pageSize = pageSize > 0 ? pageSize : CREN_ATLAS_PAGE_SIZE;
+    atlas->padding = padding >= 0 ? padding : CREN_ATLAS_PADDING;
+    return atlas;
+}
+
+void crenvk_atlas_destroy(CRenContext* context, CRenAtlas* atlas) {
+    if (atlas == NULL) return;
+
+    for (unsigned int i = 0; i < atlas->count; i++) {
+        if (atlas->entries[i].pixels) crenmemory_deallocate(atlas->entries[i].pixels);
+    }
+
+    // queued after the quads released their slots, the frames in flight may still be drawing the pages
+    for (unsigned int i = 0; i < atlas->pageCount; i++) {
+        if (atlas->pageBatches[i] != NULL) crenvk_retire(context, internal_crenvk_atlas_page_release, atlas->pageBatches[i]);
+        crenvk_texture2d_destroy(context, &atlas->pages[i]);
+    }
+
+    if (atlas->entries) crenmemory_deallocate(atlas->entries);
+    if (atlas->regions) crenmemory_deallocate(atlas->regions);
+    if (atlas->pages) crenmemory_deallocate(atlas->pages);
+    if (atlas->pageBatches) crenmemory_deallocate(atlas->pageBatches);
+    crenmemory_deallocate(atlas);
+}
+
+int crenvk_atlas_add_from_path(CRenAtlas* atlas, const char* path) {
+    int width = 0, height = 0, channels = 0;
+    unsigned char* pixels = cren_stbimage_load_from_file(path, 4, &width, &height, &channels);
+    if (pixels == NULL) {
+        CREN_LOG("CRen: Failed to load atlas texture %s", path);
+        return -1;
+    }
+
+    CrenTexture2DBuffer bufferInfo = { 0 };
+    bufferInfo.data = (char*)pixels;
+    bufferInfo.lenght = (size_t)width * height * 4;
+    bufferInfo.width = width;
+    bufferInfo.height = height;
+
+    int index = crenvk_atlas_add_from_buffer(atlas, &bufferInfo);
+    cren_stbimage_destroy(pixels);
+    return index;
+}
+
+int crenvk_atlas_add_from_buffer(CRenAtlas* atlas, CrenTexture2DBuffer* bufferInfo) {
+    if (atlas->built || bufferInfo->width <= 0 || bufferInfo->height <= 0) return -1;
+    if (bufferInfo->lenght < (size_t)bufferInfo->width * bufferInfo->height * 4) return -1;
+    if (!internal_crenvk_atlas_reserve(atlas)) return -1;
+
+    vkAtlasEntry* entry = &atlas->entries[atlas->count];
+    entry->width = bufferInfo->width;
+    entry->height = bufferInfo->height;
+    entry->pixels = (unsigned char*)crenmemory_allocate((size_t)entry->width * entry->height * 4, 0);
+    if (!entry->pixels) return -1;
+
+    crenmemory_copy(entry->pixels, bufferInfo->data, (size_t)entry->width * entry->height * 4);
+    crenmemory_zero(&atlas->regions[atlas->count], sizeof(CRenAtlasRegion));
+    return (int)atlas->count++;
+}
+
+int crenvk_atlas_build(CRenContext* context, CRenAtlas* atlas) {
+    if (atlas->built) return 1;
+    if (atlas->count == 0) return 0;
+
+    const int pageSize = atlas->pageSize;
+    const int padding = atlas->padding;
+
+    stbrp_rect* rects = (stbrp_rect*)crenmemory_allocate(sizeof(stbrp_rect) * atlas->count, 1);
+    stbrp_node* nodes = (stbrp_node*)crenmemory_allocate(sizeof(stbrp_node) * pageSize, 0);
+    unsigned char* texels = (unsigned char*)crenmemory_allocate((size_t)pageSize * pageSize * 4, 0);
+
+    if (!rects || !nodes || !texels) {
+        if (rects) crenmemory_deallocate(rects);
+        if (nodes) crenmemory_deallocate(nodes);
+        if (texels) crenmemory_deallocate(texels);
+        cren_set_error(MemoryAllocationFailed);
+        return 0;
+    }
+
+    // textures bigger than a page are never packed
+    unsigned int remaining = 0;
+    for (unsigned int i = 0; i < atlas->count; i++) {
+        int width = atlas->entries[i].width + padding * 2;
+        int height = atlas->entries[i].height + padding * 2;
+
+        if (width > pageSize || height > pageSize) {
+            CREN_LOG("CRen: Atlas texture %u (%dx%d) doesn't fit a %d page", i, atlas->entries[i].width, atlas->entries[i].height, pageSize);
+            continue;
+        }
+
+        rects[remaining].id = (int)i;
+        rects[remaining].w = width;
+        rects[remaining].h = height;
+        remaining++;
+    }
+
+    // every page is packed with whatever didn't fit the previous ones
+    int success = 1;
+    while (remaining > 0) {
+        stbrp_context packer;
+        stbrp_init_target(&packer, pageSize, pageSize, nodes, pageSize);
+        stbrp_pack_rects(&packer, rects, (int)remaining);
+
+        CRenTexture2D* pages = (CRenTexture2D*)crenmemory_reallocate(atlas->pages, sizeof(CRenTexture2D) * (atlas->pageCount + 1));
+        if (!pages) {
+            cren_set_error(MemoryAllocationFailed);
+            success = 0;
+            break;
+        }
+
+        atlas->pages = pages;
+
+        vkAtlasPage** pageBatches = (vkAtlasPage**)crenmemory_reallocate(atlas->pageBatches, sizeof(vkAtlasPage*) * (atlas->pageCount + 1));
+        if (!pageBatches) {
+            cren_set_error(MemoryAllocationFailed);
+            success = 0;
+            break;
+        }
+
+        atlas->pageBatches = pageBatches;
+        crenmemory_zero(texels, (size_t)pageSize * pageSize * 4);
+
+        unsigned int left = 0;
+        for (unsigned int i = 0; i < remaining; i++) {
+            if (!rects[i].was_packed) {
+                rects[left++] = rects[i];
+                continue;
+            }
+
+            const vkAtlasEntry* entry = &atlas->entries[rects[i].id];
+            CRenAtlasRegion* region = &atlas->regions[rects[i].id];
+            region->packed = 1;
+            region->page = atlas->pageCount;
+            region->x = rects[i].x + padding;
+            region->y = rects[i].y + padding;
+            region->width = entry->width;
+            region->height = entry->height;
+
+            // the quad shader computes (uv + offset) * scale
+            region->uv_scale.x = (float)entry->width / (float)pageSize;
+            region->uv_scale.y = (float)entry->height / (float)pageSize;
+            region->uv_offset.x = (float)region->x / (float)entry->width;
+            region->uv_offset.y = (float)region->y / (float)entry->height;
+
+            internal_crenvk_atlas_blit(texels, pageSize, padding, entry, region);
+        }
+
+        CrenTexture2DBuffer bufferInfo = { 0 };
+        bufferInfo.data = (char*)texels;
+        bufferInfo.lenght = (size_t)pageSize * pageSize * 4;
+        bufferInfo.width = pageSize;
+        bufferInfo.height = pageSize;
+
+        CRenTexture2D* page = &atlas->pages[atlas->pageCount];
+        *page = crenvk_texture2d_create_from_buffer(context, &bufferInfo, 0);
+        if (page->backend != NULL) page->backend->shared = 1;
+
+        // quads moved into the page are drawn with it's descriptor sets
+        atlas->pageBatches[atlas->pageCount] = internal_crenvk_atlas_page_create(context, page);
+        if (atlas->pageBatches[atlas->pageCount] == NULL) {
+            CREN_LOG("CRen: Failed to create the descriptors of atlas page %u", atlas->pageCount);
+            success = 0;
+        }
+
+        atlas->pageCount++;
+
+        remaining = left;
+    }
+
+    crenmemory_deallocate(rects);
+    crenmemory_deallocate(nodes);
+    crenmemory_deallocate(texels);
+
+    // the texels now live on the pages
+    for (unsigned int i = 0; i < atlas->count; i++) {
+        crenmemory_deallocate(atlas->entries[i].pixels);
+        atlas->entries[i].pixels = NULL;
+    }
+
+    atlas->built = 1;
+    return success;
+}
+
+const CRenAtlasRegion* crenvk_atlas_get_region(CRenAtlas* atlas, int index) {
+    if (atlas == NULL || index < 0 || (unsigned int)index >= atlas->count) return NULL;
+    return &atlas->regions[index];
+}
+
 /////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 // Quad-related
 /////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -3572,7 +9425,7 @@ static void internal_crenvk_quad_update_descriptors(CRenContext* context, CRenQu
 		VkDescriptorBufferInfo camInfo = { 0 };
 		camInfo.buffer = cameraBuffer->buffers[i];
 		camInfo.offset = 0;
-		camInfo.range = sizeof(vkBufferCamera);
+		camInfo.range = sizeof(vkBufferCamera) * CREN_VIEWS_MAX;
 		
 		VkWriteDescriptorSet camDesc = { 0 };
 		camDesc.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
@@ -3584,7 +9437,7 @@ static void internal_crenvk_quad_update_descriptors(CRenContext* context, CRenQu
 		camDesc.pBufferInfo = &camInfo;
 		vkUpdateDescriptorSets(renderer->device.device, 1, &camDesc, 0, NULL);
 
-		// 1: quad data
+		// 1: quad data, a single instance
 		VkDescriptorBufferInfo quadInfo = { 0 };
 		quadInfo.buffer = backend->buffer->buffers[i];
 		quadInfo.offset = 0;
@@ -3595,17 +9448,23 @@ static void internal_crenvk_quad_update_descriptors(CRenContext* context, CRenQu
 		quadDesc.dstSet = backend->descriptorSets[i];
 		quadDesc.dstBinding = 1;
 		quadDesc.dstArrayElement = 0;
-		quadDesc.descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
+		quadDesc.descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
 		quadDesc.descriptorCount = 1;
 		quadDesc.pBufferInfo = &quadInfo;
 		vkUpdateDescriptorSets(renderer->device.device, 1, &quadDesc, 0, NULL);
 
-		// 2: color map
+		// 2: color map, quads moved into an atlas page are drawn with the page descriptor sets instead
 		VkDescriptorImageInfo colorMapInfo = { 0 };
 		colorMapInfo.imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
 		colorMapInfo.imageView = (VkImageView)crenvk_texture2d_get_image_view(&backend->colormap);
 		colorMapInfo.sampler = (VkSampler)crenvk_texture2d_get_sampler(&backend->colormap);
 
+		// the texture re-writes it if it's ever evicted
+		if (backend->colormap.backend != NULL) {
+			backend->colormap.backend->boundSets[i] = backend->descriptorSets[i];
+			backend->colormap.backend->boundBinding = 2;
+		}
+
 		VkWriteDescriptorSet desc = { 0 };
 		desc.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
 		desc.dstSet = backend->descriptorSets[i];
@@ -3635,7 +9494,7 @@ CRenQuad* crenvk_quad_create(CRenContext* context, const char* albedoPath) {
     }
 
 	
-	quad->backend->buffer = crenvk_buffer_create(renderer->device.device, renderer->device.physicalDevice, VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, sizeof(QuadParams));
+	quad->backend->buffer = crenvk_buffer_create(renderer->device.device, renderer->device.physicalDevice, VK_BUFFER_USAGE_STORAGE_BUFFER_BIT, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, sizeof(QuadParams));
     if(!quad->backend->buffer) {
         crenmemory_deallocate(quad->backend);
         crenmemory_deallocate(quad);
@@ -3648,7 +9507,7 @@ CRenQuad* crenvk_quad_create(CRenContext* context, const char* albedoPath) {
 	VkDescriptorPoolSize poolSizes[3] = { 0 };
 	poolSizes[0].type = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
 	poolSizes[0].descriptorCount = CREN_CONCURRENTLY_RENDERED_FRAMES;
-	poolSizes[1].type = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
+	poolSizes[1].type = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
 	poolSizes[1].descriptorCount = CREN_CONCURRENTLY_RENDERED_FRAMES;
 	poolSizes[2].type = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
 	poolSizes[2].descriptorCount = CREN_CONCURRENTLY_RENDERED_FRAMES;
@@ -3681,37 +9540,153 @@ CRenQuad* crenvk_quad_create(CRenContext* context, const char* albedoPath) {
         return NULL;
     }
 
-	// load colormap and update descriptors
+	// load colormap and update descriptors, the colormap is part of the quad on traces
+	cren_trace_suspend(context);
 	quad->backend->colormap = crenvk_texture2d_create_from_path(context, albedoPath, 0);
+	cren_trace_resume(context);
 	internal_crenvk_quad_update_descriptors(context, quad);
 
+	if (cren_trace_recording(context)) {
+		CRenTraceQuadCreate record = { (unsigned long long)(uintptr_t)quad, { 0 } };
+		cren_strncpy(record.albedoPath, albedoPath, sizeof(record.albedoPath) - 1);
+		cren_trace_write(context, TraceRecord_QuadCreate, &record, sizeof(record));
+	}
+
 	return quad;
 }
 
-void crenvk_quad_destroy(CRenContext* context, CRenQuad* quad) {
-    CRenVulkanBackend* renderer = (CRenVulkanBackend*)context->backend;
-	vkQuadBackend* backend = (vkQuadBackend*)quad->backend;
+/// @brief retirement queue adapter for quads, releases the quad vulkan objects
+/// @param device vulkan device
+/// @param object the quad backend
+static void internal_crenvk_quad_release(VkDevice device, void* object) {
+	vkQuadBackend* backend = (vkQuadBackend*)object;
+
+	vkDestroyDescriptorPool(device, backend->descriptorPool, NULL);
+	if (backend->colormap.backend != NULL) internal_crenvk_texture2d_release(device, backend->colormap.backend);
+	crenvk_buffer_destroy(backend->buffer, device);
+
+	crenmemory_deallocate(backend);
+}
+
+/// @brief gives the quad atlas slot back to it's page once the frames in flight are done drawing it
+/// @param context cren context
+/// @param backend the quad backend
+static void internal_crenvk_quad_release_slot(CRenContext* context, vkQuadBackend* backend) {
+	if (backend->atlasBatch == NULL) return;
+
+	vkRetiredAtlasSlot* retired = (vkRetiredAtlasSlot*)crenmemory_allocate(sizeof(vkRetiredAtlasSlot), 1);
+	if (retired == NULL) {
+		cren_set_error(MemoryAllocationFailed); // the slot is lost, the page just holds one quad less
+	}
+	else {
+		retired->page = backend->atlasBatch;
+		retired->slot = backend->atlasSlot;
+		crenvk_retire(context, internal_crenvk_atlas_slot_release, retired);
+	}
+
+	backend->atlasBatch = NULL;
+	backend->atlasSlot = 0;
+}
+
+/// @brief points the retained packets of a quad to it's current descriptor sets and params
+/// @param context cren context
+/// @param quad the quad
+static void internal_crenvk_quad_update_packets(CRenContext* context, CRenQuad* quad) {
+	CRenVulkanBackend* renderer = (CRenVulkanBackend*)context->backend;
+	vkQuadBackend* backend = quad->backend;
+	vkDrawlist* drawlist = &renderer->drawlist;
+
+	for (unsigned int i = 0; i < drawlist->packetCount; i++) {
+		vkDrawPacket* packet = &drawlist->packets[i];
+		if (packet->id != quad->id) continue;
+
+		crenmemory_copy(packet->descriptorSets, backend->atlasBatch != NULL ? backend->atlasBatch->descriptorSets : backend->descriptorSets, sizeof(packet->descriptorSets));
+		packet->firstInstance = backend->atlasSlot;
+		packet->texture = backend->atlasPage != NULL ? backend->atlasPage->backend : backend->colormap.backend;
+	}
+
+	drawlist->sorted = 0;
+	drawlist->version++;
+}
 
-	vkDeviceWaitIdle(renderer->device.device);
-	vkDestroyDescriptorPool(renderer->device.device, backend->descriptorPool, NULL);
+void crenvk_quad_destroy(CRenContext* context, CRenQuad* quad) {
+	if (quad == NULL) return;
 
-	crenvk_texture2d_destroy(context, &backend->colormap);
-    crenvk_buffer_destroy(quad->backend->buffer, renderer->device.device);
+	CRenTraceHandle record = { (unsigned long long)(uintptr_t)quad };
+	cren_trace_write(context, TraceRecord_QuadDestroy, &record, sizeof(record));
 
-	crenmemory_deallocate(quad->backend);
+	// the quad itself is cpu-only, the vulkan objects wait until the frames in flight are done with them
+	CRenVulkanBackend* renderer = (CRenVulkanBackend*)context->backend;
+	if (quad->backend->colormap.backend != NULL) {
+		internal_crenvk_streaming_cancel(context, quad->backend->colormap.backend);
+		internal_crenvk_residency_remove(&renderer->textureResidency, quad->backend->colormap.backend);
+	}
+	internal_crenvk_quad_release_slot(context, quad->backend);
+	crenvk_retire(context, internal_crenvk_quad_release, quad->backend);
 	crenmemory_deallocate(quad);
 }
 
+int crenvk_quad_set_atlas_region(CRenContext* context, CRenQuad* quad, CRenAtlas* atlas, int index) {
+	const CRenAtlasRegion* region = crenvk_atlas_get_region(atlas, index);
+	if (region == NULL || !region->packed) return 0;
+
+	vkQuadBackend* backend = quad->backend;
+	vkAtlasPage* batch = atlas->pageBatches[region->page];
+	if (batch == NULL) return 0;
+
+	// a fresh slot, the one the quad had may still be read by the frames in flight
+	unsigned int slot = 0;
+	if (batch->freeCount > 0) slot = batch->freeSlots[--batch->freeCount];
+	else if (batch->slotCount < CREN_ATLAS_PAGE_QUADS_MAX) slot = batch->slotCount++;
+	else {
+		CREN_LOG("CRen: Atlas page %u has no free quad slots", region->page);
+		return 0;
+	}
+
+	// the quad's own texture isn't needed anymore
+	cren_trace_suspend(context);
+	if (backend->colormap.backend != NULL) crenvk_texture2d_destroy(context, &backend->colormap);
+	cren_trace_resume(context);
+
+	internal_crenvk_quad_release_slot(context, backend);
+	backend->atlasPage = &atlas->pages[region->page];
+	backend->atlasBatch = batch;
+	backend->atlasSlot = slot;
+	quad->params.uv_offset = region->uv_offset;
+	quad->params.uv_scale = region->uv_scale;
+
+	// no frame in flight reads the new slot, every frame samples the new region and not just the current one
+	for (unsigned int i = 0; i < CREN_CONCURRENTLY_RENDERED_FRAMES; i++) {
+		unsigned char* where = (unsigned char*)crenarray_at(batch->params->mappedData, i);
+		if (where != NULL) crenmemory_copy(where + sizeof(QuadParams) * slot, &quad->params, sizeof(QuadParams));
+	}
+
+	internal_crenvk_quad_update_packets(context, quad);
+	return 1;
+}
+
 void crenvk_quad_apply_buffer_changes(CRenContext* context, CRenQuad* quad) {
     CRenVulkanBackend* renderer = (CRenVulkanBackend*)context->backend;
     vkQuadBackend* backend = (vkQuadBackend*)quad->backend;
 	vkBuffer* quadParams = backend->buffer;
 
+	if (cren_trace_recording(context)) {
+		CRenTraceQuadParams record = { (unsigned long long)(uintptr_t)quad, quad->id, quad->params };
+		cren_trace_write(context, TraceRecord_QuadParams, &record, sizeof(record));
+	}
+
+	// quads on an atlas page write their slot of the page buffer
+	VkDeviceSize offset = 0;
+	if (backend->atlasBatch != NULL) {
+		quadParams = backend->atlasBatch->params;
+		offset = sizeof(QuadParams) * backend->atlasSlot;
+	}
+
 	if (quadParams) {
-		void* where = crenarray_at(quadParams->mappedData, renderer->device.currentFrame);
+		unsigned char* where = (unsigned char*)crenarray_at(quadParams->mappedData, renderer->device.currentFrame);
 
 		if (where != NULL) {
-			crenmemory_copy(where, &quad->params, sizeof(QuadParams));
+			crenmemory_copy(where + offset, &quad->params, sizeof(QuadParams));
 		}
 	}
 }
@@ -3725,6 +9700,11 @@ void crenvk_quad_render(CRenContext* context, CRenRenderStage stage, CRenQuad* q
 	VkPipeline pipelinePtr = VK_NULL_HANDLE;
 	unsigned int currentFrame = renderer->device.currentFrame;
 
+	if (cren_trace_recording(context)) {
+		CRenTraceQuadDraw record = { (unsigned long long)(uintptr_t)quad, quad->id, (int)stage, transform };
+		cren_trace_write(context, TraceRecord_QuadRender, &record, sizeof(record));
+	}
+
 	switch (stage) {
 		case Default:
 		{
@@ -3739,6 +9719,7 @@ void crenvk_quad_render(CRenContext* context, CRenRenderStage stage, CRenQuad* q
         case Picking:
 		{
 			vkPipeline* pipeline = (vkPipeline*)crenhashtable_lookup(renderer->pipelinesLib, CREN_PIPELINE_QUAD_PICKING_NAME);
+			if (pipeline == NULL) return; // the picking phase wasn't created
 
 			cmdBuffer = renderer->pickingRenderphase.renderpass->commandBuffers[currentFrame];
 			pipelineLayout = pipeline->layout;
@@ -3749,12 +9730,330 @@ void crenvk_quad_render(CRenContext* context, CRenRenderStage stage, CRenQuad* q
 		default: { break; }
 	}
 
+	CRenTexture2DBackend* colormap = backend->atlasPage != NULL ? backend->atlasPage->backend : backend->colormap.backend;
+	if (colormap != NULL) colormap->lastUsedFrame = renderer->retirement.frameNumber;
+
 	vkPushConstant constants = { 0 };
 	constants.id = quad->id;
 	constants.model = transform;
 	vkCmdPushConstants(cmdBuffer, pipelineLayout, VK_SHADER_STAGE_VERTEX_BIT | VK_SHADER_STAGE_FRAGMENT_BIT, 0, sizeof(vkPushConstant), &constants);
 
-	vkCmdBindDescriptorSets(cmdBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, pipelineLayout, 0, 1, &backend->descriptorSets[currentFrame], 0, NULL);
+	VkDescriptorSet* descriptorSets = backend->atlasBatch != NULL ? backend->atlasBatch->descriptorSets : backend->descriptorSets;
+	vkCmdBindDescriptorSets(cmdBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, pipelineLayout, 0, 1, &descriptorSets[currentFrame], 0, NULL);
 	vkCmdBindPipeline(cmdBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, pipelinePtr);
-	vkCmdDraw(cmdBuffer, 6, 1, 0, 0);
+	vkCmdDraw(cmdBuffer, 6, 1, 0, backend->atlasSlot);
+}
+
+void crenvk_quad_submit(CRenContext* context, CRenQuad* quad, const mat4 transform) {
+	CRenVulkanBackend* renderer = (CRenVulkanBackend*)context->backend;
+
+	if (cren_trace_recording(context)) {
+		CRenTraceQuadDraw record = { (unsigned long long)(uintptr_t)quad, quad->id, 0, transform };
+		cren_trace_write(context, TraceRecord_QuadSubmit, &record, sizeof(record));
+	}
+
+	vkDrawPacket packet = { 0 };
+	packet.pipeline = (vkPipeline*)crenhashtable_lookup(renderer->pipelinesLib, CREN_PIPELINE_QUAD_DEFAULT_NAME);
+	packet.pickingPipeline = (vkPipeline*)crenhashtable_lookup(renderer->pipelinesLib, CREN_PIPELINE_QUAD_PICKING_NAME);
+	packet.depthPipeline = (vkPipeline*)crenhashtable_lookup(renderer->pipelinesLib, CREN_PIPELINE_QUAD_DEPTH_NAME);
+	packet.equalPipeline = (vkPipeline*)crenhashtable_lookup(renderer->pipelinesLib, CREN_PIPELINE_QUAD_EQUAL_NAME);
+	// quads of the same atlas page share the descriptor sets, their params are selected by the instance
+	crenmemory_copy(packet.descriptorSets, quad->backend->atlasBatch != NULL ? quad->backend->atlasBatch->descriptorSets : quad->backend->descriptorSets, sizeof(packet.descriptorSets));
+	packet.texture = quad->backend->atlasPage != NULL ? quad->backend->atlasPage->backend : quad->backend->colormap.backend;
+	packet.id = quad->id;
+	packet.model = transform;
+	packet.vertexCount = 6;
+	packet.instanceCount = 1;
+	packet.firstInstance = quad->backend->atlasSlot;
+	packet.radius = 1.41421356f; // the quad corners are at (+-1, +-1)
+	crenvk_drawlist_submit(context, &packet);
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Particle-related
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+/// @brief retirement queue adapter for emitters, releases the emitter vulkan objects
+/// @param device vulkan device
+/// @param object the emitter backend
+static void internal_crenvk_particles_release(VkDevice device, void* object) {
+	vkParticleBackend* backend = (vkParticleBackend*)object;
+
+	if (backend->descriptorPool != VK_NULL_HANDLE) vkDestroyDescriptorPool(device, backend->descriptorPool, NULL);
+	if (backend->colormap.backend != NULL) internal_crenvk_texture2d_release(device, backend->colormap.backend);
+
+	for (unsigned int i = 0; i < 2; i++) {
+		if (backend->particleBuffers[i] != VK_NULL_HANDLE) vkDestroyBuffer(device, backend->particleBuffers[i], NULL);
+		if (backend->particleMemories[i] != VK_NULL_HANDLE) vkFreeMemory(device, backend->particleMemories[i], NULL);
+	}
+
+	if (backend->drawBuffer != VK_NULL_HANDLE) vkDestroyBuffer(device, backend->drawBuffer, NULL);
+	if (backend->drawMemory != VK_NULL_HANDLE) vkFreeMemory(device, backend->drawMemory, NULL);
+
+	crenmemory_deallocate(backend);
+}
+
+/// @brief writes the emitter descriptor sets
+/// @param context cren context
+/// @param emitter the emitter
+static void internal_crenvk_particles_update_descriptors(CRenContext* context, CRenParticleEmitter* emitter) {
+	CRenVulkanBackend* renderer = (CRenVulkanBackend*)context->backend;
+	vkParticleBackend* backend = emitter->backend;
+	vkBuffer* cameraBuffer = (vkBuffer*)crenhashtable_lookup(renderer->buffersLib, "Camera");
+
+	VkDescriptorBufferInfo particleInfos[2] = { 0 };
+	for (unsigned int i = 0; i < 2; i++) {
+		particleInfos[i].buffer = backend->particleBuffers[i];
+		particleInfos[i].offset = 0;
+		particleInfos[i].range = VK_WHOLE_SIZE;
+	}
+
+	VkDescriptorBufferInfo drawInfo = { 0 };
+	drawInfo.buffer = backend->drawBuffer;
+	drawInfo.offset = 0;
+	drawInfo.range = VK_WHOLE_SIZE;
+
+	// simulation, reads one buffer and writes the other
+	for (unsigned int target = 0; target < 2; target++) {
+		VkDescriptorBufferInfo* infos[3] = { &particleInfos[1 - target], &particleInfos[target], &drawInfo };
+		VkWriteDescriptorSet writes[3] = { 0 };
+
+		for (unsigned int i = 0; i < 3; i++) {
+			writes[i].sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+			writes[i].dstSet = backend->simulateSets[target];
+			writes[i].dstBinding = i;
+			writes[i].dstArrayElement = 0;
+			writes[i].descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+			writes[i].descriptorCount = 1;
+			writes[i].pBufferInfo = infos[i];
+		}
+		vkUpdateDescriptorSets(renderer->device.device, 3, writes, 0, NULL);
+	}
+
+	// rendering, binds both buffers and the push constant picks the one last written
+	for (unsigned int i = 0; i < CREN_CONCURRENTLY_RENDERED_FRAMES; i++) {
+		VkDescriptorBufferInfo camInfo = { 0 };
+		camInfo.buffer = cameraBuffer->buffers[i];
+		camInfo.offset = 0;
+		camInfo.range = sizeof(vkBufferCamera) * CREN_VIEWS_MAX;
+
+		VkDescriptorImageInfo colorMapInfo = { 0 };
+		colorMapInfo.imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+		colorMapInfo.imageView = (VkImageView)crenvk_texture2d_get_image_view(&backend->colormap);
+		colorMapInfo.sampler = (VkSampler)crenvk_texture2d_get_sampler(&backend->colormap);
+
+		// the texture re-writes it if it's ever evicted
+		if (backend->colormap.backend != NULL) {
+			backend->colormap.backend->boundSets[i] = backend->drawSets[i];
+			backend->colormap.backend->boundBinding = 2;
+		}
+
+		VkWriteDescriptorSet writes[4] = { 0 };
+		for (unsigned int w = 0; w < 4; w++) {
+			writes[w].sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+			writes[w].dstSet = backend->drawSets[i];
+			writes[w].dstBinding = w;
+			writes[w].dstArrayElement = 0;
+			writes[w].descriptorCount = 1;
+		}
+
+		writes[0].descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
+		writes[0].pBufferInfo = &camInfo;
+		writes[1].descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+		writes[1].pBufferInfo = &particleInfos[0];
+		writes[2].descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+		writes[2].pImageInfo = &colorMapInfo;
+		writes[3].descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+		writes[3].pBufferInfo = &particleInfos[1];
+		vkUpdateDescriptorSets(renderer->device.device, 4, writes, 0, NULL);
+	}
+}
+
+CRenParticleEmitter* crenvk_particles_create(CRenContext* context, const char* albedoPath, unsigned int maxParticles) {
+	CRenVulkanBackend* renderer = (CRenVulkanBackend*)context->backend;
+	VkDevice device = renderer->device.device;
+	if (maxParticles == 0) return NULL;
+
+	// apps that never use particles don't pay for their pipelines
+	vkRenderpass* mainRenderpass = renderer->hint_viewport ? renderer->viewportRenderphase.renderpass : renderer->defaultRenderphase.renderpass;
+	if (crenhashtable_lookup(renderer->pipelinesLib, CREN_PIPELINE_PARTICLE_DEFAULT_NAME) == NULL || crenhashtable_lookup(renderer->pipelinesLib, CREN_PIPELINE_PARTICLE_SIMULATE_NAME) == NULL) {
+		if (!internal_crenvk_pipeline_particle_create(renderer->pipelinesLib, &renderer->pipelineRegistry, mainRenderpass, device, context->createInfo.assetsRoot)) {
+			CREN_LOG("CRen: Failed to create the particle pipelines, are the particle shaders compiled?");
+			return NULL;
+		}
+	}
+
+	CRenParticleEmitter* emitter = (CRenParticleEmitter*)crenmemory_allocate(sizeof(CRenParticleEmitter), 1);
+	if (!emitter) return NULL;
+
+	vkParticleBackend* backend = (vkParticleBackend*)crenmemory_allocate(sizeof(vkParticleBackend), 1);
+	if (!backend) {
+		crenmemory_deallocate(emitter);
+		return NULL;
+	}
+
+	emitter->id = crenid_generate();
+	emitter->backend = backend;
+	backend->maxParticles = maxParticles;
+	backend->seed = (unsigned int)emitter->id;
+
+	// something visible by default
+	emitter->params.velocity = (float4){ 0.0f, 1.0f, 0.0f, 0.25f };
+	emitter->params.startColor = (float4){ 1.0f, 1.0f, 1.0f, 1.0f };
+	emitter->params.endColor = (float4){ 1.0f, 1.0f, 1.0f, 0.0f };
+	emitter->params.size = (float2){ 0.1f, 0.1f };
+	emitter->params.lifetime = (float2){ 1.0f, 2.0f };
+	emitter->params.billboard = 1;
+	emitter->params.spawnRate = 100.0f;
+
+	// one particle is 32 bytes, see particle.glsl
+	int success = 1;
+	VkDeviceSize particlesSize = (VkDeviceSize)maxParticles * sizeof(float4) * 2;
+	success &= internal_crenvk_compute_buffer_create(context, VK_BUFFER_USAGE_STORAGE_BUFFER_BIT, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, particlesSize, &backend->particleBuffers[0], &backend->particleMemories[0]);
+	success &= internal_crenvk_compute_buffer_create(context, VK_BUFFER_USAGE_STORAGE_BUFFER_BIT, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, particlesSize, &backend->particleBuffers[1], &backend->particleMemories[1]);
+	success &= internal_crenvk_compute_buffer_create(context, VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_INDIRECT_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, sizeof(VkDrawIndirectCommand) * 2, &backend->drawBuffer, &backend->drawMemory);
+
+	// descriptors
+	VkDescriptorPoolSize poolSizes[3] = { 0 };
+	poolSizes[0].type = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
+	poolSizes[0].descriptorCount = CREN_CONCURRENTLY_RENDERED_FRAMES;
+	poolSizes[1].type = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+	poolSizes[1].descriptorCount = 2 * 3 + CREN_CONCURRENTLY_RENDERED_FRAMES * 2;
+	poolSizes[2].type = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+	poolSizes[2].descriptorCount = CREN_CONCURRENTLY_RENDERED_FRAMES;
+
+	VkDescriptorPoolCreateInfo descriptorPoolCI = { 0 };
+	descriptorPoolCI.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
+	descriptorPoolCI.poolSizeCount = (unsigned int)CREN_ARRAYSIZE(poolSizes);
+	descriptorPoolCI.pPoolSizes = poolSizes;
+	descriptorPoolCI.maxSets = 2 + CREN_CONCURRENTLY_RENDERED_FRAMES;
+	if (success && vkCreateDescriptorPool(device, &descriptorPoolCI, NULL, &backend->descriptorPool) != VK_SUCCESS) success = 0;
+
+	vkComputePipeline* simulatePipeline = (vkComputePipeline*)crenhashtable_lookup(renderer->pipelinesLib, CREN_PIPELINE_PARTICLE_SIMULATE_NAME);
+	vkPipeline* drawPipeline = (vkPipeline*)crenhashtable_lookup(renderer->pipelinesLib, CREN_PIPELINE_PARTICLE_DEFAULT_NAME);
+	VkDescriptorSetLayout simulateLayouts[2] = { simulatePipeline->descriptorSetLayout, simulatePipeline->descriptorSetLayout };
+	VkDescriptorSetLayout drawLayouts[CREN_CONCURRENTLY_RENDERED_FRAMES] = { drawPipeline->descriptorSetLayout, drawPipeline->descriptorSetLayout };
+
+	VkDescriptorSetAllocateInfo descSetAllocInfo = { 0 };
+	descSetAllocInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
+	descSetAllocInfo.descriptorPool = backend->descriptorPool;
+	descSetAllocInfo.descriptorSetCount = 2;
+	descSetAllocInfo.pSetLayouts = simulateLayouts;
+	if (success && vkAllocateDescriptorSets(device, &descSetAllocInfo, backend->simulateSets) != VK_SUCCESS) success = 0;
+
+	descSetAllocInfo.descriptorSetCount = CREN_CONCURRENTLY_RENDERED_FRAMES;
+	descSetAllocInfo.pSetLayouts = drawLayouts;
+	if (success && vkAllocateDescriptorSets(device, &descSetAllocInfo, backend->drawSets) != VK_SUCCESS) success = 0;
+
+	if (!success) {
+		CREN_LOG("CRen: Failed to create the particle emitter resources");
+		internal_crenvk_particles_release(device, backend);
+		crenmemory_deallocate(emitter);
+		return NULL;
+	}
+
+	// particles are not traced yet, neither is their colormap
+	cren_trace_suspend(context);
+	backend->colormap = crenvk_texture2d_create_from_path(context, albedoPath, 0);
+	cren_trace_resume(context);
+	internal_crenvk_particles_update_descriptors(context, emitter);
+
+	return emitter;
+}
+
+void crenvk_particles_destroy(CRenContext* context, CRenParticleEmitter* emitter) {
+	if (emitter == NULL) return;
+
+	// the emitter itself is cpu-only, the vulkan objects wait until the frames in flight are done with them
+	CRenVulkanBackend* renderer = (CRenVulkanBackend*)context->backend;
+	if (emitter->backend->colormap.backend != NULL) {
+		internal_crenvk_streaming_cancel(context, emitter->backend->colormap.backend);
+		internal_crenvk_residency_remove(&renderer->textureResidency, emitter->backend->colormap.backend);
+	}
+	crenvk_retire(context, internal_crenvk_particles_release, emitter->backend);
+	crenmemory_deallocate(emitter);
+}
+
+void crenvk_particles_simulate(CRenContext* context, CRenParticleEmitter* emitter, double timestep) {
+	CRenVulkanBackend* renderer = (CRenVulkanBackend*)context->backend;
+	vkParticleBackend* backend = emitter->backend;
+	vkComputePipeline* pipeline = (vkComputePipeline*)crenhashtable_lookup(renderer->pipelinesLib, CREN_PIPELINE_PARTICLE_SIMULATE_NAME);
+
+	VkCommandBuffer cmdBuffer = crenvk_compute_get_command_buffer(context);
+	if (cmdBuffer == VK_NULL_HANDLE || pipeline == NULL) return;
+
+	// whole particles are spawned, the remainder is carried to the next simulation
+	backend->spawnAccumulator += (double)emitter->params.spawnRate * timestep;
+	if (backend->spawnAccumulator > (double)backend->maxParticles) backend->spawnAccumulator = (double)backend->maxParticles;
+	if (backend->spawnAccumulator < 0.0) backend->spawnAccumulator = 0.0;
+	unsigned int spawnCount = (unsigned int)backend->spawnAccumulator;
+	backend->spawnAccumulator -= (double)spawnCount;
+
+	unsigned int target = 1 - backend->target;
+	backend->seed = backend->seed * 1664525u + 1013904223u;
+
+	// the previous simulation wrote what this one reads and resets
+	VkMemoryBarrier barrier = { 0 };
+	barrier.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+	barrier.srcAccessMask = VK_ACCESS_SHADER_WRITE_BIT | VK_ACCESS_TRANSFER_WRITE_BIT;
+	barrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT | VK_ACCESS_TRANSFER_WRITE_BIT;
+	vkCmdPipelineBarrier(cmdBuffer, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT | VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT | VK_PIPELINE_STAGE_TRANSFER_BIT, 0, 1, &barrier, 0, NULL, 0, NULL);
+
+	// the target's instance count is it's alive counter, both draw commands start empty
+	if (!backend->simulated) {
+		VkDrawIndirectCommand draws[2] = { { 6, 0, 0, 0 }, { 6, 0, 0, 0 } };
+		vkCmdUpdateBuffer(cmdBuffer, backend->drawBuffer, 0, sizeof(draws), draws);
+	}
+	else {
+		VkDeviceSize offset = target * sizeof(VkDrawIndirectCommand) + offsetof(VkDrawIndirectCommand, instanceCount);
+		vkCmdFillBuffer(cmdBuffer, backend->drawBuffer, offset, sizeof(unsigned int), 0);
+	}
+
+	barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+	barrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT;
+	vkCmdPipelineBarrier(cmdBuffer, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, 0, 1, &barrier, 0, NULL, 0, NULL);
+
+	vkParticleSimulatePushConstant constants = { 0 };
+	constants.origin = emitter->params.origin;
+	constants.velocity = emitter->params.velocity;
+	constants.acceleration = emitter->params.acceleration;
+	constants.lifetime = emitter->params.lifetime;
+	constants.timestep = (float)timestep;
+	constants.spawnCount = spawnCount;
+	constants.seed = backend->seed;
+	constants.maxParticles = backend->maxParticles;
+	constants.target = target;
+
+	unsigned int groups = (backend->maxParticles + CREN_PARTICLE_WORKGROUP_SIZE - 1) / CREN_PARTICLE_WORKGROUP_SIZE;
+	if (!crenvk_compute_dispatch(context, pipeline, backend->simulateSets[target], &constants, sizeof(constants), groups, 1, 1)) return;
+
+	backend->target = target;
+	backend->simulated = 1;
 }
+
+void crenvk_particles_render(CRenContext* context, CRenRenderStage stage, CRenParticleEmitter* emitter) {
+	CRenVulkanBackend* renderer = (CRenVulkanBackend*)context->backend;
+	vkParticleBackend* backend = emitter->backend;
+	if (stage != Default || !backend->simulated) return;
+
+	vkPipeline* pipeline = (vkPipeline*)crenhashtable_lookup(renderer->pipelinesLib, CREN_PIPELINE_PARTICLE_DEFAULT_NAME);
+	if (pipeline == NULL) return;
+
+	unsigned int currentFrame = renderer->device.currentFrame;
+	VkCommandBuffer cmdBuffer = renderer->hint_viewport == 1 ? renderer->viewportRenderphase.renderpass->commandBuffers[currentFrame] : renderer->defaultRenderphase.renderpass->commandBuffers[currentFrame];
+	if (backend->colormap.backend != NULL) backend->colormap.backend->lastUsedFrame = renderer->retirement.frameNumber;
+
+	vkParticleDrawPushConstant constants = { 0 };
+	constants.startColor = emitter->params.startColor;
+	constants.endColor = emitter->params.endColor;
+	constants.size = emitter->params.size;
+	constants.lockAxis = emitter->params.lockAxis;
+	constants.billboard = emitter->params.billboard;
+	constants.source = backend->target;
+
+	// the simulation wrote the instance count, the cpu never knows how many particles are alive
+	vkCmdBindPipeline(cmdBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, pipeline->pipeline);
+	vkCmdBindDescriptorSets(cmdBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, pipeline->layout, 0, 1, &backend->drawSets[currentFrame], 0, NULL);
+	vkCmdPushConstants(cmdBuffer, pipeline->layout, VK_SHADER_STAGE_VERTEX_BIT, 0, sizeof(vkParticleDrawPushConstant), &constants);
+	vkCmdDrawIndirect(cmdBuffer, backend->drawBuffer, backend->target * sizeof(VkDrawIndirectCommand), 1, sizeof(VkDrawIndirectCommand));
+}
\ No newline at end of file
@@ -0,0 +1,529 @@
+// replays a trace recorded with cren_trace_begin (or CRenCreateInfo's tracePath) on a headless renderer and reports how long every frame took on the cpu and on the gpu
+// usage: cren_replay <trace> [assetsRoot] [--quiet] [--prepass | --no-prepass] [--dynamic-rendering] [--merged-ui] [--validations]
+// --prepass/--no-prepass replay the whole trace with the depth prepass on/off regardless of what was recorded, comparing both runs measures the overdraw it saves
+// --dynamic-rendering replays with dynamic rendering instead of render pass objects, when the device supports it
+// --merged-ui resolves the anti-aliasing and runs the (empty) ui subpass on the default render pass, the gpu time is what tile-based gpus save without the extra phase
+// --validations enables the vulkan validation layers, timings are meaningless but every replayed call is checked against the spec
+
+#include <stdio.h>
+#include <string.h>
+#include <cren.h>
+
+/// @brief maps the traced application's object handles to the replayed objects, open addressing with linear probing
+typedef struct {
+    unsigned long long* keys;       // 0 is an empty slot, handles are addresses and never 0
+    void** values;
+    unsigned int capacity;          // always a power of two
+    unsigned int count;
+} ReplayMap;
+
+/// @brief a record issued from the render callbacks, replayed once the same callback is invoked on the replay
+typedef struct {
+    CRenTraceRecordType type;
+    union {
+        CRenTraceQuadDraw draw;
+        CRenTraceQuadParams params;
+        CRenTraceQuadCreate quadCreate;
+        CRenTraceTexture texture;
+        CRenTraceHandle handle;
+    } payload;
+} ReplayCommand;
+
+/// @brief timings of a replayed frame
+typedef struct {
+    unsigned long long frame;       // renderer frame number, see vkRetirementQueue
+    double cpu;                     // milliseconds spent on cren_render
+    double gpu;                     // milliseconds the gpu took, negative if unavailable
+} ReplayFrame;
+
+/// @brief the replay state
+typedef struct {
+    CRenContext* context;
+    ReplayMap quads;
+    ReplayMap textures;
+
+    ReplayCommand* commands;        // records of the frame being rendered
+    unsigned int commandCount;
+    unsigned int commandCapacity;
+    int commandsApplied;            // records not bound to a render stage were replayed on this frame
+
+    ReplayFrame* frames;
+    unsigned int frameCount;
+    unsigned int frameCapacity;
+    unsigned int firstPending;      // frames from here on may still be waiting on gpu results
+
+    unsigned long long unknownQuadCalls;
+} Replay;
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Object maps
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+static unsigned int replay_map_hash(unsigned long long key) {
+    key ^= key >> 33;
+    key *= 0xff51afd7ed558ccdULL;
+    key ^= key >> 33;
+    return (unsigned int)key;
+}
+
+static int replay_map_grow(ReplayMap* map) {
+    ReplayMap grown = { 0 };
+    grown.capacity = map->capacity == 0 ? 256 : map->capacity * 2;
+    grown.keys = (unsigned long long*)crenmemory_allocate(sizeof(unsigned long long) * grown.capacity, 1);
+    grown.values = (void**)crenmemory_allocate(sizeof(void*) * grown.capacity, 1);
+    if (!grown.keys || !grown.values) return 0;
+
+    for (unsigned int i = 0; i < map->capacity; i++) {
+        if (map->keys[i] == 0) continue;
+
+        unsigned int slot = replay_map_hash(map->keys[i]) & (grown.capacity - 1);
+        while (grown.keys[slot] != 0) slot = (slot + 1) & (grown.capacity - 1);
+        grown.keys[slot] = map->keys[i];
+        grown.values[slot] = map->values[i];
+        grown.count++;
+    }
+
+    if (map->keys) crenmemory_deallocate(map->keys);
+    if (map->values) crenmemory_deallocate(map->values);
+    *map = grown;
+    return 1;
+}
+
+static void* replay_map_find(ReplayMap* map, unsigned long long key) {
+    if (map->capacity == 0 || key == 0) return NULL;
+
+    unsigned int slot = replay_map_hash(key) & (map->capacity - 1);
+    while (map->keys[slot] != 0) {
+        if (map->keys[slot] == key) return map->values[slot];
+        slot = (slot + 1) & (map->capacity - 1);
+    }
+
+    return NULL;
+}
+
+static void replay_map_insert(ReplayMap* map, unsigned long long key, void* value) {
+    if (key == 0) return;
+    if ((map->count + 1) * 2 > map->capacity && !replay_map_grow(map)) return;
+
+    unsigned int slot = replay_map_hash(key) & (map->capacity - 1);
+    while (map->keys[slot] != 0 && map->keys[slot] != key) slot = (slot + 1) & (map->capacity - 1);
+    if (map->keys[slot] == 0) map->count++;
+
+    map->keys[slot] = key;
+    map->values[slot] = value;
+}
+
+static void* replay_map_remove(ReplayMap* map, unsigned long long key) {
+    if (map->capacity == 0 || key == 0) return NULL;
+
+    unsigned int mask = map->capacity - 1;
+    unsigned int slot = replay_map_hash(key) & mask;
+    while (map->keys[slot] != 0 && map->keys[slot] != key) slot = (slot + 1) & mask;
+    if (map->keys[slot] == 0) return NULL;
+
+    void* value = map->values[slot];
+    map->keys[slot] = 0;
+    map->values[slot] = NULL;
+    map->count--;
+
+    // re-insert the entries after the removed one, so lookups don't stop at the hole
+    for (unsigned int next = (slot + 1) & mask; map->keys[next] != 0; next = (next + 1) & mask) {
+        unsigned long long movedKey = map->keys[next];
+        void* movedValue = map->values[next];
+        map->keys[next] = 0;
+        map->values[next] = NULL;
+        map->count--;
+        replay_map_insert(map, movedKey, movedValue);
+    }
+
+    return value;
+}
+
+static void replay_map_destroy(ReplayMap* map) {
+    if (map->keys) crenmemory_deallocate(map->keys);
+    if (map->values) crenmemory_deallocate(map->values);
+    crenmemory_zero(map, sizeof(ReplayMap));
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Commands
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+/// @brief returns the replayed quad, quads created before the trace started (or that failed to be created) are unknown and their calls skipped
+static CRenQuad* replay_quad(Replay* replay, unsigned long long handle) {
+    CRenQuad* quad = (CRenQuad*)replay_map_find(&replay->quads, handle);
+    if (quad == NULL) replay->unknownQuadCalls++;
+    return quad;
+}
+
+/// @brief creates a texture as the traced application did, textures created from buffers are uploaded blank
+static void replay_texture_create(Replay* replay, const CRenTraceTexture* record) {
+    CRenTexture2D* texture = (CRenTexture2D*)crenmemory_allocate(sizeof(CRenTexture2D), 1);
+    if (!texture) return;
+
+    if (record->path[0] != '\0') {
+        *texture = crenvk_texture2d_create_from_path(replay->context, record->path, record->gui);
+    }
+
+    else {
+        CrenTexture2DBuffer bufferInfo = { 0 };
+        bufferInfo.width = record->width;
+        bufferInfo.height = record->height;
+        bufferInfo.lenght = (size_t)record->width * (size_t)record->height * 4;
+        bufferInfo.data = (char*)crenmemory_allocate(bufferInfo.lenght, 1);
+        if (bufferInfo.data) *texture = crenvk_texture2d_create_from_buffer(replay->context, &bufferInfo, record->gui);
+        if (bufferInfo.data) crenmemory_deallocate(bufferInfo.data);
+    }
+
+    replay_map_insert(&replay->textures, record->handle, texture);
+}
+
+/// @brief replays a record that isn't part of the frame loop itself
+static void replay_command(Replay* replay, CRenTraceRecordType type, const void* payload) {
+    CRenContext* context = replay->context;
+
+    switch (type) {
+        case TraceRecord_TextureCreate:
+        {
+            replay_texture_create(replay, (const CRenTraceTexture*)payload);
+            break;
+        }
+
+        case TraceRecord_TextureDestroy:
+        {
+            CRenTexture2D* texture = (CRenTexture2D*)replay_map_remove(&replay->textures, ((const CRenTraceHandle*)payload)->handle);
+            if (texture) crenvk_texture2d_destroy(context, texture);
+            if (texture) crenmemory_deallocate(texture);
+            break;
+        }
+
+        case TraceRecord_QuadCreate:
+        {
+            const CRenTraceQuadCreate* record = (const CRenTraceQuadCreate*)payload;
+            CRenQuad* quad = crenvk_quad_create(context, record->albedoPath);
+            if (quad) replay_map_insert(&replay->quads, record->handle, quad);
+            break;
+        }
+
+        case TraceRecord_QuadDestroy:
+        {
+            CRenQuad* quad = (CRenQuad*)replay_map_remove(&replay->quads, ((const CRenTraceHandle*)payload)->handle);
+            if (quad) crenvk_quad_destroy(context, quad);
+            break;
+        }
+
+        case TraceRecord_QuadParams:
+        {
+            const CRenTraceQuadParams* record = (const CRenTraceQuadParams*)payload;
+            CRenQuad* quad = replay_quad(replay, record->handle);
+            if (!quad) break;
+
+            quad->id = record->id;
+            quad->params = record->params;
+            crenvk_quad_apply_buffer_changes(context, quad);
+            break;
+        }
+
+        case TraceRecord_QuadRender:
+        {
+            const CRenTraceQuadDraw* record = (const CRenTraceQuadDraw*)payload;
+            CRenQuad* quad = replay_quad(replay, record->handle);
+            if (!quad) break;
+
+            quad->id = record->id;
+            crenvk_quad_render(context, (CRenRenderStage)record->stage, quad, record->transform);
+            break;
+        }
+
+        case TraceRecord_QuadSubmit:
+        {
+            const CRenTraceQuadDraw* record = (const CRenTraceQuadDraw*)payload;
+            CRenQuad* quad = replay_quad(replay, record->handle);
+            if (!quad) break;
+
+            quad->id = record->id;
+            crenvk_quad_submit(context, quad, record->transform);
+            break;
+        }
+
+        default: { break; }
+    }
+}
+
+/// @brief keeps a record issued from the render callbacks for when the frame is replayed
+static void replay_command_push(Replay* replay, const CRenTraceRecord* record) {
+    if (record->size > sizeof(((ReplayCommand*)0)->payload)) return;
+
+    if (replay->commandCount == replay->commandCapacity) {
+        unsigned int capacity = replay->commandCapacity == 0 ? 1024 : replay->commandCapacity * 2;
+        ReplayCommand* commands = (ReplayCommand*)crenmemory_reallocate(replay->commands, sizeof(ReplayCommand) * capacity);
+        if (!commands) return;
+
+        replay->commands = commands;
+        replay->commandCapacity = capacity;
+    }
+
+    ReplayCommand* command = &replay->commands[replay->commandCount++];
+    command->type = record->type;
+    crenmemory_copy(&command->payload, record->payload, record->size);
+}
+
+/// @brief replays the draws the traced application issued for this stage, everything else is replayed on the first callback of the frame
+static void replay_render_callback(CRenContext* context, CRenRenderStage stage, double timestep) {
+    (void)timestep; // frames are replayed as recorded, not simulated
+    Replay* replay = (Replay*)cren_get_user_pointer(context);
+    int applyOthers = !replay->commandsApplied;
+    replay->commandsApplied = 1;
+
+    for (unsigned int i = 0; i < replay->commandCount; i++) {
+        ReplayCommand* command = &replay->commands[i];
+
+        if (command->type == TraceRecord_QuadRender) {
+            if ((CRenRenderStage)command->payload.draw.stage == stage) replay_command(replay, command->type, &command->payload);
+        }
+
+        else if (applyOthers) {
+            replay_command(replay, command->type, &command->payload);
+        }
+    }
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Timings
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+/// @brief picks up the gpu times of the frames that already left the gpu, frames whose results were overwritten are reported without a gpu time
+static void replay_collect_gpu_times(Replay* replay) {
+    CRenVulkanBackend* renderer = (CRenVulkanBackend*)replay->context->backend;
+    unsigned long long submitted = renderer->retirement.frameNumber;
+
+    while (replay->firstPending < replay->frameCount) {
+        ReplayFrame* frame = &replay->frames[replay->firstPending];
+        if (crenvk_frame_timer_get(replay->context, frame->frame, &frame->gpu)) {
+            replay->firstPending++;
+            continue;
+        }
+
+        // the next frame re-uses this frame's timestamps
+        if (frame->frame + CREN_CONCURRENTLY_RENDERED_FRAMES <= submitted) {
+            frame->gpu = -1.0;
+            replay->firstPending++;
+            continue;
+        }
+
+        break;
+    }
+}
+
+static void replay_frame_push(Replay* replay, unsigned long long frameNumber, double cpu) {
+    if (replay->frameCount == replay->frameCapacity) {
+        unsigned int capacity = replay->frameCapacity == 0 ? 1024 : replay->frameCapacity * 2;
+        ReplayFrame* frames = (ReplayFrame*)crenmemory_reallocate(replay->frames, sizeof(ReplayFrame) * capacity);
+        if (!frames) return;
+
+        replay->frames = frames;
+        replay->frameCapacity = capacity;
+    }
+
+    ReplayFrame* frame = &replay->frames[replay->frameCount++];
+    frame->frame = frameNumber;
+    frame->cpu = cpu;
+    frame->gpu = -1.0;
+}
+
+static void replay_report(Replay* replay, int quiet) {
+    double cpuSum = 0.0, cpuMin = 0.0, cpuMax = 0.0;
+    double gpuSum = 0.0, gpuMin = 0.0, gpuMax = 0.0;
+    unsigned int gpuCount = 0;
+
+    for (unsigned int i = 0; i < replay->frameCount; i++) {
+        ReplayFrame* frame = &replay->frames[i];
+        if (!quiet) {
+            if (frame->gpu >= 0.0) printf("frame %6u  cpu %8.3f ms  gpu %8.3f ms\n", i, frame->cpu, frame->gpu);
+            else printf("frame %6u  cpu %8.3f ms  gpu        - ms\n", i, frame->cpu);
+        }
+
+        cpuSum += frame->cpu;
+        cpuMin = i == 0 ? frame->cpu : (frame->cpu < cpuMin ? frame->cpu : cpuMin);
+        cpuMax = frame->cpu > cpuMax ? frame->cpu : cpuMax;
+
+        if (frame->gpu < 0.0) continue;
+        gpuSum += frame->gpu;
+        gpuMin = gpuCount == 0 ? frame->gpu : (frame->gpu < gpuMin ? frame->gpu : gpuMin);
+        gpuMax = frame->gpu > gpuMax ? frame->gpu : gpuMax;
+        gpuCount++;
+    }
+
+    if (replay->frameCount == 0) {
+        printf("no frames were rendered\n");
+        return;
+    }
+
+    printf("%u frames\n", replay->frameCount);
+    printf("cpu  avg %8.3f ms  min %8.3f ms  max %8.3f ms\n", cpuSum / replay->frameCount, cpuMin, cpuMax);
+    if (gpuCount > 0) printf("gpu  avg %8.3f ms  min %8.3f ms  max %8.3f ms  (%u frames measured)\n", gpuSum / gpuCount, gpuMin, gpuMax, gpuCount);
+    else printf("gpu  unavailable, the device doesn't support timestamps\n");
+    if (replay->unknownQuadCalls > 0) printf("%llu calls were skipped, their quads were created before the trace started\n", replay->unknownQuadCalls);
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Entry point
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+int main(int argc, char** argv) {
+    if (argc < 2) {
+        printf("usage: %s <trace> [assetsRoot] [--quiet] [--prepass | --no-prepass] [--dynamic-rendering] [--merged-ui] [--validations]\n", argv[0]);
+        return 1;
+    }
+
+    const char* assetsRoot = NULL;
+    int quiet = 0;
+    int prepass = -1; // as recorded
+    int dynamicRendering = 0;
+    int mergedUI = 0;
+    int validations = 0;
+    for (int i = 2; i < argc; i++) {
+        if (strcmp(argv[i], "--quiet") == 0) quiet = 1;
+        else if (strcmp(argv[i], "--prepass") == 0) prepass = 1;
+        else if (strcmp(argv[i], "--no-prepass") == 0) prepass = 0;
+        else if (strcmp(argv[i], "--dynamic-rendering") == 0) dynamicRendering = 1;
+        else if (strcmp(argv[i], "--merged-ui") == 0) mergedUI = 1;
+        else if (strcmp(argv[i], "--validations") == 0) validations = 1;
+        else assetsRoot = argv[i];
+    }
+
+    CRenTraceReader* reader = cren_trace_open(argv[1]);
+    if (!reader) {
+        printf("%s is not a valid trace\n", argv[1]);
+        return 1;
+    }
+
+    CRenTraceRecord record = { 0 };
+    if (!cren_trace_read(reader, &record) || record.type != TraceRecord_Begin) {
+        printf("%s doesn't start with the renderer configuration\n", argv[1]);
+        cren_trace_close(reader);
+        return 1;
+    }
+
+    CRenTraceBegin begin = *(const CRenTraceBegin*)record.payload;
+
+    // same configuration the trace was recorded with, but without a window
+    CRenCreateInfo ci = { 0 };
+    ci.appName = "CRen Replay";
+    ci.appVersion = CREN_MAKE_VERSION(0, 1, 0, 0);
+    ci.assetsRoot = assetsRoot ? assetsRoot : begin.assetsRoot;
+    ci.apiVersion = CREN_MAKE_VERSION(0, 1, 0, 2);
+    ci.validations = validations;
+    ci.vsync = begin.vsync;
+    ci.msaa = begin.msaa;
+    ci.width = begin.width;
+    ci.height = begin.height;
+    ci.smallerViewport = begin.smallerViewport;
+    ci.picking = begin.picking;
+    ci.depthPrepass = prepass >= 0 ? prepass : begin.depthPrepass;
+    ci.dynamicRendering = dynamicRendering;
+    ci.mergedUI = mergedUI;
+    ci.nativeWindow = NULL;
+
+    Replay replay = { 0 };
+    replay.context = cren_initialize(ci);
+    if (!replay.context) {
+        printf("Could not initialize CRen\n");
+        cren_trace_close(reader);
+        return 1;
+    }
+
+    cren_set_user_pointer(replay.context, &replay);
+    cren_set_render_callback(replay.context, replay_render_callback);
+    if (!crenvk_frame_timer_set_enabled(replay.context, 1)) printf("gpu timestamps are unsupported, only cpu times are reported\n");
+
+    CRenVulkanBackend* renderer = (CRenVulkanBackend*)replay.context->backend;
+    int inFrame = 0;
+    double frameTimestep = 0.0;
+
+    while (cren_trace_read(reader, &record)) {
+
+        // records issued from the render callbacks are kept until the frame is complete
+        if (inFrame && record.type != TraceRecord_RenderEnd) {
+            replay_command_push(&replay, &record);
+            continue;
+        }
+
+        switch (record.type) {
+            case TraceRecord_Update:
+            {
+                const CRenTraceUpdate* update = (const CRenTraceUpdate*)record.payload;
+                replay.context->camera = update->camera;
+                cren_update(replay.context, update->timestep);
+                break;
+            }
+
+            case TraceRecord_Render:
+            {
+                frameTimestep = ((const CRenTraceRender*)record.payload)->timestep;
+                replay.commandCount = 0;
+                replay.commandsApplied = 0;
+                inFrame = 1;
+                break;
+            }
+
+            case TraceRecord_RenderEnd:
+            {
+                inFrame = 0;
+                unsigned long long frameNumber = renderer->retirement.frameNumber;
+
+                double start = cren_time_seconds();
+                cren_render(replay.context, frameTimestep);
+                double cpu = (cren_time_seconds() - start) * 1000.0;
+
+                // the render callbacks weren't invoked (minimized or the swapchain was re-created), the frame's records still happened
+                if (!replay.commandsApplied) replay_render_callback(replay.context, (CRenRenderStage)-1, frameTimestep);
+
+                if (renderer->retirement.frameNumber != frameNumber) replay_frame_push(&replay, frameNumber, cpu);
+                replay_collect_gpu_times(&replay);
+                break;
+            }
+
+            case TraceRecord_Resize:
+            {
+                const CRenTraceResize* resize = (const CRenTraceResize*)record.payload;
+                cren_resize(replay.context, resize->width, resize->height);
+                break;
+            }
+
+            case TraceRecord_SetMsaa: { cren_set_msaa(replay.context, ((const CRenTraceValue*)record.payload)->value); break; }
+            case TraceRecord_SetVsync: { cren_set_vsync(replay.context, ((const CRenTraceValue*)record.payload)->value); break; }
+            case TraceRecord_Minimize: { cren_minimize(replay.context); break; }
+            case TraceRecord_Restore: { cren_restore(replay.context); break; }
+            case TraceRecord_PickingEnable: { crenvk_renderphase_picking_enable(replay.context); break; }
+            case TraceRecord_SetDepthPrepass: { if (prepass < 0) crenvk_renderphase_default_set_prepass(replay.context, ((const CRenTraceValue*)record.payload)->value); break; }
+            case TraceRecord_End: { break; }
+            default: { replay_command(&replay, record.type, record.payload); break; }
+        }
+    }
+
+    cren_trace_close(reader);
+
+    // the last frames are still on the gpu
+    vkDeviceWaitIdle(renderer->device.device);
+    replay_collect_gpu_times(&replay);
+    replay_report(&replay, quiet);
+
+    for (unsigned int i = 0; i < replay.quads.capacity; i++) {
+        if (replay.quads.keys[i] != 0) crenvk_quad_destroy(replay.context, (CRenQuad*)replay.quads.values[i]);
+    }
+
+    for (unsigned int i = 0; i < replay.textures.capacity; i++) {
+        if (replay.textures.keys[i] == 0) continue;
+        crenvk_texture2d_destroy(replay.context, (CRenTexture2D*)replay.textures.values[i]);
+        crenmemory_deallocate(replay.textures.values[i]);
+    }
+
+    cren_terminate(replay.context);
+    replay_map_destroy(&replay.quads);
+    replay_map_destroy(&replay.textures);
+    if (replay.commands) crenmemory_deallocate(replay.commands);
+    if (replay.frames) crenmemory_deallocate(replay.frames);
+
+    return 0;
+}
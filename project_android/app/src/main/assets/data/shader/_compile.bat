@@ -17,6 +17,7 @@ set SHADER_BASES=^
  grid^
  mesh^
  mesh_picking^
+ particle^
  quad^
  quad_picking^
  skybox^
@@ -40,5 +41,38 @@ for %%b in (%SHADER_BASES%) do (
     )
 )
 
+REM List of fragment-only shader base names, they run after the vertex shader of another base (quad_depth/quad_equal use quad.vert)
+set FRAGMENT_BASES=^
+ quad_depth^
+ quad_equal
+
+REM Loop through each fragment-only shader base name and compile the .frag
+for %%b in (%FRAGMENT_BASES%) do (
+    echo Compiling %%b.frag...
+    glslc -o "%OUTPUT_DIR%\%%b.frag.spv" "%%b.frag"
+    if errorlevel 1 (
+        echo Failed to compile %%b.frag
+        exit /b 1
+    )
+)
+
+REM List of compute shader base names (without extensions)
+set COMPUTE_BASES=^
+ light_cluster^
+ mipmap^
+ particle^
+ pick_rect^
+ pick_rect_ms
+
+REM Loop through each compute shader base name and compile the .comp
+for %%b in (%COMPUTE_BASES%) do (
+    echo Compiling %%b.comp...
+    glslc -o "%OUTPUT_DIR%\%%b.comp.spv" "%%b.comp"
+    if errorlevel 1 (
+        echo Failed to compile %%b.comp
+        exit /b 1
+    )
+)
+
 echo All shaders compiled successfully.
 pause
\ No newline at end of file
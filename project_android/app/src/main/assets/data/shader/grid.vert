@@ -5,6 +5,9 @@
 // includes
 #include "include/ubo_camera.glsl"
 
+// drawn from the render callback, only the main camera renders it
+#define camera CAMERA_MAIN
+
 // output vertex attributes
 layout(location = 1) out vec3 outNearPoint;
 layout(location = 2) out vec3 outFarPoint;
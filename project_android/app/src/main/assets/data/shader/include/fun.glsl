@@ -14,9 +14,28 @@ vec2 RotateUV(vec2 uv, float angle) {
     return uv;
 }
 
+// returns the cell of a sprite sheet showing at a given time, row-major from the top-left
+vec2 FlipbookCell(float time, vec2 grid, uint frames, float fps, float startTime, uint loop) {
+    if (frames == 0u || grid.x < 1.0) return vec2(0.0);
+
+    uint frame = uint(max(time - startTime, 0.0) * fps);
+    frame = loop == 1u ? frame % frames : min(frame, frames - 1u);
+
+    uint columns = uint(grid.x);
+    return vec2(float(frame % columns), float(frame / columns));
+}
+
 // applies the rotation, scale and translation of the uv coordinates
 vec2 TransformUV(vec2 uv, vec2 uvOffset, vec2 uvScale, float angle) {
     uv = RotateUV(uv, angle);
     uv = (uv + uvOffset) * uvScale;
     return uv;
+}
+
+// same as TransformUV, the rotated uv is first moved into a sprite sheet cell
+vec2 TransformFlipbookUV(vec2 uv, vec2 cell, vec2 grid, vec2 uvOffset, vec2 uvScale, float angle) {
+    uv = RotateUV(uv, angle);
+    uv = (uv + cell) / max(grid, vec2(1.0));
+    uv = (uv + uvOffset) * uvScale;
+    return uv;
 }
\ No newline at end of file
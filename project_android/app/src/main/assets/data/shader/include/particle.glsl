@@ -0,0 +1,7 @@
+// this holds the layout of a gpu particle, shared by the simulation and the rendering
+
+struct Particle
+{
+    vec4 positionAge;   // xyz world position, w seconds alive
+    vec4 velocityLife;  // xyz velocity, w seconds to live
+};
\ No newline at end of file
@@ -0,0 +1,97 @@
+// de-duplicates the object ids inside a rectangle of the picking image. Every workgroup sorts it's 16x16 tile on shared memory and
+// appends the tile's unique ids to a candidate list, the last workgroup to finish then removes the ids found by more than one tile
+// the including shader declares the picking image and LoadId, the image may or may not be multisampled
+
+layout(local_size_x = 16, local_size_y = 16, local_size_z = 1) in;
+
+layout(push_constant) uniform constants
+{
+    ivec2 offset;           // rectangle's top-left texel
+    ivec2 size;             // rectangle size in texels
+    uint workGroupCount;    // workgroups on the dispatch
+    uint maxCandidates;     // capacity of the candidate list
+    uint maxIds;            // capacity of the result list
+} params;
+
+// ids are the uint64 object ids split in two words, like the picking shaders write them
+layout(set = 0, binding = 1) coherent buffer Work { uint finished; uint candidateCount; uint padding[2]; uvec2 candidates[]; };
+layout(set = 0, binding = 2) buffer Result { uint count; uint found; uvec2 ids[]; };
+
+shared uvec2 keys[256];
+shared uint lastWorkGroup;
+
+bool Less(uvec2 a, uvec2 b)
+{
+    return a.y < b.y || (a.y == b.y && a.x < b.x);
+}
+
+bool IsEmpty(uvec2 id)
+{
+    return id.x == 0u && id.y == 0u;
+}
+
+bool IsEqual(uvec2 a, uvec2 b)
+{
+    return a.x == b.x && a.y == b.y;
+}
+
+void main()
+{
+    uint index = gl_LocalInvocationIndex;
+    ivec2 p = ivec2(gl_GlobalInvocationID.xy);
+    keys[index] = all(lessThan(p, params.size)) ? LoadId(params.offset + p) : uvec2(0u);
+    barrier();
+
+    // bitonic sort, equal ids end up next to each other and the empty ones first
+    for (uint k = 2u; k <= 256u; k <<= 1u) {
+        for (uint j = k >> 1u; j > 0u; j >>= 1u) {
+            uint other = index ^ j;
+            if (other > index) {
+                uvec2 a = keys[index];
+                uvec2 b = keys[other];
+                bool ascending = (index & k) == 0u;
+                if (Less(b, a) == ascending) {
+                    keys[index] = b;
+                    keys[other] = a;
+                }
+            }
+            barrier();
+        }
+    }
+
+    // the first of every run of equal ids is the tile's copy of it
+    uvec2 key = keys[index];
+    if (!IsEmpty(key) && (index == 0u || !IsEqual(key, keys[index - 1u]))) {
+        uint slot = atomicAdd(candidateCount, 1u);
+        if (slot < params.maxCandidates) candidates[slot] = key;
+    }
+
+    // the candidates must be visible to whichever workgroup finishes last
+    memoryBarrierBuffer();
+    barrier();
+
+    if (index == 0u) {
+        lastWorkGroup = atomicAdd(finished, 1u) == params.workGroupCount - 1u ? 1u : 0u;
+    }
+
+    barrier();
+    if (lastWorkGroup == 0u) return;
+
+    // a candidate is kept only by it's first occurrence, quadratic but the list is short and this runs on a single workgroup
+    uint total = atomicAdd(candidateCount, 0u);
+    if (index == 0u) found = total;
+    total = min(total, params.maxCandidates);
+
+    for (uint i = index; i < total; i += 256u) {
+        uvec2 candidate = candidates[i];
+        bool first = true;
+        for (uint j = 0u; j < i && first; j++) {
+            first = !IsEqual(candidates[j], candidate);
+        }
+
+        if (!first) continue;
+
+        uint slot = atomicAdd(count, 1u);
+        if (slot < params.maxIds) ids[slot] = candidate;
+    }
+}
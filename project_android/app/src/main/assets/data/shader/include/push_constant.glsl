@@ -4,4 +4,8 @@ layout(push_constant) uniform constants
 {
     uint64_t id;
 	mat4 model;
-} pushConstant;
\ No newline at end of file
+	uint view;
+} pushConstant;
+
+// the camera of the view being rendered, see ubo_camera.glsl
+#define camera cameras.views[pushConstant.view]
\ No newline at end of file
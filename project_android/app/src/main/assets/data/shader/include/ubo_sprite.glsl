@@ -1,10 +1,21 @@
 // this is included per mesh/drawable and contains information about the material
+// quads packed into an atlas page share the page buffer and select their params with the draw instance, see QuadParams
 
-layout(set = 0, binding = 1) uniform ubo_sprite
+struct SpriteParams
 {
     uint billboard;
     float uv_rotation;
     vec2 lockAxis;
     vec2 uv_offset;
     vec2 uv_scale;
-} spriteParams;
\ No newline at end of file
+    vec2 flipbookGrid;
+    uint flipbookFrames;
+    float flipbookFps;
+    float flipbookStartTime;
+    uint flipbookLoop;
+};
+
+layout(std430, set = 0, binding = 1) readonly buffer ubo_sprite
+{
+    SpriteParams sprites[];
+};
\ No newline at end of file
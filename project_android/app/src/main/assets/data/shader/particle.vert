@@ -0,0 +1,46 @@
+#version 460
+#extension GL_GOOGLE_include_directive : enable
+
+// includes
+#include "include/fun.glsl"
+#include "include/primitives.glsl"
+#include "include/ubo_camera.glsl"
+#include "include/billboard.glsl"
+#include "include/particle.glsl"
+
+// drawn from the render callback, only the main camera renders it
+#define camera CAMERA_MAIN
+
+// emitter appearance
+layout(push_constant) uniform constants
+{
+    vec4 startColor;
+    vec4 endColor;
+    vec2 size;          // half extent at birth/death
+    vec2 lockAxis;
+    uint billboard;
+    uint source;        // particle buffer the last simulation wrote
+} params;
+
+// both particle buffers, the simulation ping-pongs between them. One instance per alive particle
+layout(set = 0, binding = 1) readonly buffer ParticlesA { Particle particlesA[]; };
+layout(set = 0, binding = 3) readonly buffer ParticlesB { Particle particlesB[]; };
+
+// output vertex attributes
+layout(location = 0) out vec2 outFragTexCoord;
+layout(location = 1) out vec4 outFragColor;
+
+// entrypoint
+void main()
+{
+    Particle p = params.source == 0u ? particlesA[gl_InstanceIndex] : particlesB[gl_InstanceIndex];
+    float t = clamp(p.positionAge.w / p.velocityLife.w, 0.0, 1.0);
+
+    mat4 model = mat4(1.0);
+    model[3].xyz = p.positionAge.xyz;
+
+    vec3 vertex = SquareVertices[gl_VertexIndex].xyz * mix(params.size.x, params.size.y, t);
+    gl_Position = camera.proj * camera.view * GetBillboardMatrix(model, params.billboard, params.lockAxis) * vec4(vertex, 1.0);
+    outFragTexCoord = GetCorrectedUV(params.billboard, params.lockAxis);
+    outFragColor = mix(params.startColor, params.endColor, t);
+}
\ No newline at end of file
@@ -13,6 +13,8 @@ layout(set = 0, binding = 2) uniform sampler2D colorMapSampler;
 
 // input fragment attributes
 layout(location = 0) in vec2 inFragTexCoord;
+layout(location = 1) flat in vec2 inFlipbookCell;
+layout(location = 2) flat in uint inSprite;
 
 // output fragment color
 layout(location = 0) out vec4 outColor;
@@ -20,7 +22,9 @@ layout(location = 0) out vec4 outColor;
 // entrypoint
 void main()
 {
-    outColor = texture(colorMapSampler, TransformUV(inFragTexCoord, spriteParams.uv_offset, spriteParams.uv_scale, radians(spriteParams.uv_rotation)));
+    SpriteParams spriteParams = sprites[inSprite];
+    vec2 grid = spriteParams.flipbookFrames > 0u ? spriteParams.flipbookGrid : vec2(1.0);
+    outColor = texture(colorMapSampler, TransformFlipbookUV(inFragTexCoord, inFlipbookCell, grid, spriteParams.uv_offset, spriteParams.uv_scale, radians(spriteParams.uv_rotation)));
 
     // discard full transparent pixels
     if(outColor.a == 0.0) {
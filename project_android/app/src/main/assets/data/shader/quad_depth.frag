@@ -0,0 +1,32 @@
+#version 460
+#extension GL_GOOGLE_include_directive : enable
+#extension GL_ARB_gpu_shader_int64 : enable
+
+// depth prepass, only the colormap alpha is read and no color is written. The depth left is shaded by quad_equal.frag
+
+// includes
+#include "include/fun.glsl"
+#include "include/ubo_camera.glsl"
+#include "include/ubo_sprite.glsl"
+#include "include/push_constant.glsl"
+
+// mesh samplers
+layout(set = 0, binding = 2) uniform sampler2D colorMapSampler;
+
+// input fragment attributes
+layout(location = 0) in vec2 inFragTexCoord;
+layout(location = 1) flat in vec2 inFlipbookCell;
+layout(location = 2) flat in uint inSprite;
+
+// entrypoint
+void main()
+{
+    SpriteParams spriteParams = sprites[inSprite];
+    vec2 grid = spriteParams.flipbookFrames > 0u ? spriteParams.flipbookGrid : vec2(1.0);
+    float alpha = texture(colorMapSampler, TransformFlipbookUV(inFragTexCoord, inFlipbookCell, grid, spriteParams.uv_offset, spriteParams.uv_scale, radians(spriteParams.uv_rotation))).a;
+
+    // same test as quad.frag, full transparent pixels write no depth
+    if(alpha == 0.0) {
+        discard;
+    }
+}
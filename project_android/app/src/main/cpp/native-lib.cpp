@@ -18,6 +18,9 @@ int main(int argc, char** argv) {
     ci.requestViewport = false;
     ci.requestFullscreen = true;
     ci.requestValidations = false; // change this to true when emulation on new android versions
+    ci.msaa = 1; // flat 2D user interface, multisampling is wasted bandwidth
+    ci.vsync = true;
+    ci.adaptiveQuality = true;
 
     Cosmos::Android::Application app(ci);
     app.Run();
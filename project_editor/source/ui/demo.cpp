@@ -29,6 +29,32 @@ namespace Cosmos::Editor
 		ImGui::Text("Cam Rot: (%.3f %.3f %.3f)", renderer->camera.rotation.x, renderer->camera.rotation.y, renderer->camera.rotation.z);
 		ImGui::Text("Cam Front: (%.3f %.3f %.3f)", renderer->camera.frontPosition.x, renderer->camera.frontPosition.y, renderer->camera.frontPosition.z);
 		ImGui::Text("Size (Swapchain): %dx%d", rendererBackend->swapchain.swapchainExtent.width, rendererBackend->swapchain.swapchainExtent.height);
+		ImGui::Text("MSAA: %dx VSync: %s", renderer->createInfo.msaa, renderer->createInfo.vsync ? "On" : "Off");
+
+		QualityGovernor& governor = mApp->GetRendererRef().GetGovernorRef();
+		bool adaptive = governor.IsEnabled();
+		if (ImGui::Checkbox("Adaptive Quality", &adaptive)) governor.SetEnabled(adaptive);
+		ImGui::Text("Quality Level: %u/%u (%.2fms avg)", governor.GetLevel(), governor.GetLevelCount() - 1, governor.GetAverageFrameTime() * 1000.0);
+
+		CRenMemoryStats memory = {};
+		cren_memory_stats(renderer, &memory);
+		for (unsigned int i = 0; i < memory.heapCount; i++) {
+			if (!memory.heaps[i].deviceLocal) continue;
+			ImGui::Text("VRAM Heap %u: %.1f/%.1f MB%s", i, memory.heaps[i].usage / (1024.0 * 1024.0), memory.heaps[i].budget / (1024.0 * 1024.0), memory.budgetExtension ? "" : " (estimated)");
+		}
+		ImGui::Text("Textures: %u (%.1f MB, %u levels evicted)", memory.textureCount, memory.textureBytes / (1024.0 * 1024.0), memory.evictedLevels);
+		ImGui::Text("Streaming: %u in, %u out", memory.streamedIn, memory.streamedOut);
+
+		// dumps every rendered frame for 10 seconds at 60 fps, the file is closed a few frames after stopping
+		CRenSequenceStats sequence = {};
+		cren_capture_sequence_stats(renderer, &sequence);
+		if (sequence.recording) {
+			if (ImGui::Button("Stop Recording")) cren_capture_sequence_end(renderer);
+		}
+		else if (!sequence.writing) {
+			if (ImGui::Button("Record Frames")) cren_capture_sequence_begin(renderer, "frames.y4m", Sequence_Y4M, 1, 60, 600);
+		}
+		ImGui::Text("Recorded Frames: %llu/%llu (%llu dropped)", sequence.framesWritten, sequence.frameCapacity, sequence.framesDropped);
 		
 		ImGui::End();
 
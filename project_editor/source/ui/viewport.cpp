@@ -15,7 +15,7 @@ namespace Cosmos::Editor
 		CRenVulkanBackend* renderer = (CRenVulkanBackend*)mApp->GetRendererRef().GetContext()->backend;
 
 		vkDeviceWaitIdle(renderer->device.device);
-		crenvk_pipeline_destroy(renderer->device.device, mGrid.crenPipeline);
+		crenvk_pipeline_release(mApp->GetRendererRef().GetContext(), mGrid.crenPipeline);
 		vkDestroyDescriptorPool(renderer->device.device, mGrid.descPool, NULL);
 	}
 
@@ -27,6 +27,12 @@ namespace Cosmos::Editor
 		ImVec2 position = ImGui::GetWindowPos();
         
 		ImVec2 vpRegion = ImGui::GetContentRegionAvail();
+		ImVec2 vpPosition = ImGui::GetCursorScreenPos();
+
+		// the viewport is rendered with the panel size (times the render scale) instead of the window size
+		CRenContext* context = mApp->GetRendererRef().GetContext();
+		crenvk_renderphase_viewport_set_boundaries(context, { vpPosition.x, vpPosition.y }, { vpRegion.x, vpRegion.y });
+		crenvk_renderphase_viewport_auto_scale_update(context, mApp->GetTimestep());
 
 		ImGui::Image((ImTextureID)rendererBackend->viewportRenderphase.descriptorSet, vpRegion);
         
@@ -164,12 +170,55 @@ namespace Cosmos::Editor
 		if (ImGui::Button(ICON_LC_GRID_3X3)) {
 			mGrid.visible = !mGrid.visible;
 			selectedGrid = !selectedGrid;
+			crenvk_drawlist_invalidate(mApp->GetRendererRef().GetContext()); // grid is drawn on the render callback
 		}
 		
 		if (selectedButton) { ImGui::PopStyleColor(); }
 		
 		if (ImGui::IsItemHovered(ImGuiHoveredFlags_AllowWhenDisabled)) { ImGui::SetTooltip("Enables/Disables grid on viewport"); }
 		
+		ImGui::SameLine();
+		ImGui::SetCursorPosX(ImGui::GetCursorPosX() - 5.0f);
+		ImGui::SeparatorEx(ImGuiSeparatorFlags_Vertical);
+		ImGui::SameLine();
+
+		// render scale
+		CRenContext* context = mApp->GetRendererRef().GetContext();
+		vkViewportRenderphase& vpPhase = ((CRenVulkanBackend*)context->backend)->viewportRenderphase;
+
+		ImGui::PushItemWidth(50.0f);
+		ImGui::PushStyleVar(20, 2.0f);
+		ImGui::SetCursorPosX(ImGui::GetCursorPosX() - 5.0f);
+
+		// the adaptive quality governor owns the render scale while enabled
+		bool governed = mApp->GetRendererRef().GetGovernorRef().IsEnabled();
+		float renderScale = vpPhase.renderScale;
+		if (vpPhase.autoScale || governed) ImGui::BeginDisabled();
+		if (ImGui::SliderFloat("##RenderScale", &renderScale, CREN_VIEWPORT_RENDER_SCALE_MIN, CREN_VIEWPORT_RENDER_SCALE_MAX, "%.2fx")) { crenvk_renderphase_viewport_set_render_scale(context, renderScale); }
+		if (vpPhase.autoScale || governed) ImGui::EndDisabled();
+
+		ImGui::PopStyleVar();
+		ImGui::PopItemWidth();
+
+		if (ImGui::IsItemHovered(ImGuiHoveredFlags_AllowWhenDisabled)) { ImGui::SetTooltip("Viewport render scale (%dx%d)", vpPhase.renderExtent.width, vpPhase.renderExtent.height); }
+
+		ImGui::SameLine();
+
+		selectedButton = vpPhase.autoScale != 0;
+		if (selectedButton) {
+			ImGui::PushStyleColor(ImGuiCol_Button, activeCol);
+		}
+
+		ImGui::SetCursorPosX(ImGui::GetCursorPosX() - 5.0f);
+
+		if (governed) ImGui::BeginDisabled();
+		if (ImGui::Button(ICON_LC_GAUGE)) { crenvk_renderphase_viewport_set_auto_scale(context, !vpPhase.autoScale, 1.0 / 60.0); }
+		if (governed) ImGui::EndDisabled();
+
+		if (selectedButton) { ImGui::PopStyleColor(); }
+
+		if (ImGui::IsItemHovered(ImGuiHoveredFlags_AllowWhenDisabled)) { ImGui::SetTooltip("Enables/Disables automatic render scale, holding 60 frames per second"); }
+
 		ImGui::EndChild();
     }
 
@@ -196,7 +245,7 @@ namespace Cosmos::Editor
 		pipeCI.bindings[0].pImmutableSamplers = NULL;
 
 		mGrid.crenPipeline = crenvk_pipeline_create(renderer->device.device, &pipeCI);
-		crenvk_pipeline_build(renderer->device.device, mGrid.crenPipeline);
+		mGrid.crenPipeline = crenvk_pipeline_intern(mApp->GetRendererRef().GetContext(), mGrid.crenPipeline);
 
 		// create descriptor pool and descriptor sets
 		VkDescriptorPoolSize poolSize = {};
@@ -227,7 +276,7 @@ namespace Cosmos::Editor
 			VkDescriptorBufferInfo bufferInfo{};
 			bufferInfo.buffer = crenBuffer->buffers[i];
 			bufferInfo.offset = 0;
-			bufferInfo.range = sizeof(vkBufferCamera);
+			bufferInfo.range = sizeof(vkBufferCamera) * CREN_VIEWS_MAX;
 
 			VkWriteDescriptorSet descriptorWrite{};
 			descriptorWrite.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
@@ -30,6 +30,18 @@ namespace Cosmos
 
 			/// @brief tells the window manager it's height size, this can latter be changed
 			int height = 768;
+
+			/// @brief tells the renderer the initial anti-aliasing sample count, lowered to what the device supports
+			int msaa = 4;
+
+			/// @brief tells the renderer to wait for the vertical blank before presenting
+			bool vsync = false;
+
+			/// @brief tells the renderer to step msaa, render scale and present mode up/down to hold the target frame time
+			bool adaptiveQuality = false;
+
+			/// @brief the frame time in seconds the adaptive quality tries to hold
+			double targetFrameTime = 1.0 / 60.0;
 		};
 
 	public:
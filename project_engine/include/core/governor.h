@@ -0,0 +1,86 @@
+#pragma once
+
+#include <cren.h>
+#include <vector>
+
+namespace Cosmos
+{
+	// watches the frame time and steps the renderer quality (msaa, render scale and present mode) up/down to hold a target frame time
+	class QualityGovernor
+	{
+	public:
+
+		/// @brief a quality level the governor may step into, levels are ordered from the cheapest to the most expensive
+		struct Level
+		{
+			int msaa = 1;
+			float renderScale = 1.0f;
+		};
+
+		/// @brief how many frames are averaged before any decision is made
+		static constexpr unsigned int WindowSize = 60;
+
+		/// @brief how many consecutive windows under budget are needed before stepping quality up
+		static constexpr unsigned int StableWindowsToUpgrade = 3;
+
+	public:
+
+		/// @brief constructor, builds the quality levels based on what the device supports
+		QualityGovernor(CRenContext* context);
+
+		/// @brief destructor
+		~QualityGovernor() = default;
+
+		/// @brief returns if the governor is currently controlling the renderer quality
+		inline bool IsEnabled() const { return mEnabled; }
+
+		/// @brief returns the frame time in seconds the governor tries to hold
+		inline double GetTargetFrameTime() const { return mTargetFrameTime; }
+
+		/// @brief sets the frame time in seconds the governor tries to hold
+		inline void SetTargetFrameTime(double seconds) { mTargetFrameTime = seconds > 0.0 ? seconds : 1.0 / 60.0; }
+
+		/// @brief returns the average frame time of the last full window
+		inline double GetAverageFrameTime() const { return mAverageFrameTime; }
+
+		/// @brief returns the current quality level index
+		inline unsigned int GetLevel() const { return mLevel; }
+
+		/// @brief returns how many quality levels exists
+		inline unsigned int GetLevelCount() const { return (unsigned int)mLevels.size(); }
+
+	public:
+
+		/// @brief enables/disables the governor, the current renderer state is kept when disabling. While enabled it owns the viewport render scale, turning the viewport automatic scale off
+		void SetEnabled(bool value);
+
+		/// @brief forces a quality level, clamped to the available ones
+		void SetLevel(unsigned int level);
+
+		/// @brief feeds the governor with the last frame time in seconds, call this once per frame
+		void OnUpdate(double frameTime);
+
+	private:
+
+		/// @brief sends the current level to the renderer
+		void ApplyLevel();
+
+		/// @brief discards the rolling window, used after every quality change so the old frame times don't influence the next decision
+		void ClearWindow();
+
+	private:
+
+		CRenContext* mContext = nullptr;
+		bool mEnabled = false;
+		bool mPreferVSync = false;
+		double mTargetFrameTime = 1.0 / 60.0;
+		double mAverageFrameTime = 0.0;
+
+		unsigned int mWindowCount = 0;
+		double mWindowSum = 0.0;
+		unsigned int mStableWindows = 0;
+
+		std::vector<Level> mLevels = {};
+		unsigned int mLevel = 0;
+	};
+}
\ No newline at end of file
@@ -1,9 +1,10 @@
 #pragma once
 
+#include "core/governor.h"
 #include <cren.h>
 
 // forward declarations
-namespace Cosmos { class Application; }
+namespace Cosmos { class Application; class World; }
 
 namespace Cosmos
 {
@@ -12,7 +13,7 @@ namespace Cosmos
     public:
 
         /// @brief initializes the renderer with standart configurations
-        Renderer(Application* app, const char* appName, bool requestViewport, bool validations);
+        Renderer(Application* app, const char* appName, bool requestViewport, bool validations, int msaa, bool vsync);
 
         /// @brief shutsdown the renderer and release it's resources
         ~Renderer();
@@ -20,6 +21,15 @@ namespace Cosmos
         /// @brief returns the renderer context/backend
         inline CRenContext* GetContext() { return mContext; }
 
+        /// @brief returns a reference to the quality governor
+        inline QualityGovernor& GetGovernorRef() { return *mGovernor; }
+
+        /// @brief returns the world being rendered, may be nullptr
+        inline World* GetWorld() { return mWorld; }
+
+        /// @brief sets the world being rendered, it's lights are submitted every frame before rendering. nullptr renders without world lights
+        inline void SetWorld(World* world) { mWorld = world; }
+
     public:
 
         /// @brief updates the renderer, sending frame data to the gpu at a fixed period
@@ -51,5 +61,7 @@ namespace Cosmos
 
         Application* mApp;
         CRenContext* mContext = nullptr;
+        QualityGovernor* mGovernor = nullptr;
+        World* mWorld = nullptr;
     };
 }
\ No newline at end of file
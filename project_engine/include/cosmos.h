@@ -1,11 +1,13 @@
 #pragma once
 
 #include "core/application.h"
+#include "core/governor.h"
 #include "core/input.h"
 #include "core/logger.h"
 #include "core/renderer.h"
 #include "core/window.h"
 
+#include "scene/bvh.h"
 #include "scene/components.h"
 #include "scene/entity.h"
 #include "scene/prefab.h"
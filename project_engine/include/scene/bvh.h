@@ -0,0 +1,112 @@
+#pragma once
+
+#include <cren_math.h>
+#include <cfloat>
+#include <vector>
+
+namespace Cosmos
+{
+	// axis-aligned bounding box, empty boxes have min above max
+	struct AABB
+	{
+		float3 min = { FLT_MAX, FLT_MAX, FLT_MAX };
+		float3 max = { -FLT_MAX, -FLT_MAX, -FLT_MAX };
+
+		/// @brief grows the box to contain a point
+		void Grow(const float3& point);
+
+		/// @brief grows the box to contain another box
+		void Grow(const AABB& other);
+
+		/// @brief returns the box center
+		float3 GetCenter() const;
+
+		/// @brief returns the box surface area, 0 for empty boxes
+		float GetSurfaceArea() const;
+	};
+
+	// a half-line, the direction doesn't need to be normalized but distances are measured in it's length
+	struct Ray
+	{
+		float3 origin = { 0.0f, 0.0f, 0.0f };
+		float3 direction = { 0.0f, 0.0f, 1.0f };
+	};
+
+	// bounding volume hierarchy over a list of boxes, built top-down with the binned surface area heuristic and refitted when the boxes move
+	class BVH
+	{
+	public:
+
+		/// @brief leaves hold count boxes starting at first (on the index list), interior nodes have count 0 and their children at first and first + 1
+		struct Node
+		{
+			AABB bounds;
+			unsigned int first = 0;
+			unsigned int count = 0;
+		};
+
+		/// @brief the nearest box hit by a ray
+		struct Hit
+		{
+			unsigned int index = 0;     // box index, as given to Build
+			float distance = 0.0f;      // ray distance to where it enters the box, 0 if it starts inside
+		};
+
+		/// @brief how many bins the surface area heuristic evaluates per axis
+		static constexpr unsigned int BinCount = 12;
+
+		/// @brief nodes with up to this many boxes are never split
+		static constexpr unsigned int LeafSize = 2;
+
+		/// @brief the tree never gets deeper than this, so traversals run on a fixed stack
+		static constexpr unsigned int MaxDepth = 64;
+
+	public:
+
+		/// @brief constructor
+		BVH() = default;
+
+		/// @brief destructor
+		~BVH() = default;
+
+		/// @brief returns if the tree has no boxes
+		inline bool IsEmpty() const { return mNodes.empty(); }
+
+		/// @brief returns how many boxes the tree was built with
+		inline unsigned int GetCount() const { return (unsigned int)mBounds.size(); }
+
+		/// @brief returns the tree nodes, the root is the first one
+		inline const std::vector<Node>& GetNodes() const { return mNodes; }
+
+	public:
+
+		/// @brief builds the tree from scratch
+		void Build(const std::vector<AABB>& bounds);
+
+		/// @brief updates the tree to boxes that moved, keeping it's topology. The tree is rebuilt if the box count changed
+		/// @note refitting is far cheaper than building, but the tree quality degrades as boxes move away from where they were built
+		void Refit(const std::vector<AABB>& bounds);
+
+		/// @brief finds the nearest box hit by a ray
+		/// @param ray the ray
+		/// @param maxDistance boxes further than this are ignored
+		/// @param outHit the nearest hit, untouched if nothing was hit
+		/// @return true if a box was hit
+		bool Raycast(const Ray& ray, float maxDistance, Hit& outHit) const;
+
+	private:
+
+		/// @brief splits a node in two with the surface area heuristic, returns false when keeping it as a leaf is cheaper
+		bool Split(unsigned int nodeIndex);
+
+		/// @brief recomputes a leaf bounds from it's boxes
+		void UpdateLeafBounds(Node& node) const;
+
+	private:
+
+		std::vector<Node> mNodes;
+		std::vector<unsigned int> mIndices;     // box indices, ordered so every leaf references a contiguous range
+		std::vector<AABB> mBounds;
+		std::vector<float3> mCenters;           // box centers, only used while building
+	};
+}
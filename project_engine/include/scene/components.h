@@ -60,4 +60,20 @@ namespace Cosmos
 		// returns the transformation matrix
 		mat4 GetTransform();
 	};
+
+	struct LightComponent
+	{
+		float3 color;
+		float intensity;
+		float radius;
+
+		// constructor
+		LightComponent(float3 color = { 1.0f, 1.0f, 1.0f }, float intensity = 1.0f, float radius = 10.0f);
+
+		// saves the component into a data file
+		static void Serialize(Entity* entity, Datafile& dataFile);
+
+		// loads the component into the entity from data file
+		static void Deserialize(Entity* entity, Datafile& dataFile);
+	};
 }
\ No newline at end of file
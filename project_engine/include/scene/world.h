@@ -1,8 +1,11 @@
 #pragma once
 
+#include "scene/bvh.h"
 #include "util/library.h"
 
+#include <cren.h>
 #include <entt.hpp>
+#include <vector>
 
 // forward declarations
 namespace Cosmos { class Entity; }
@@ -11,6 +14,19 @@ namespace Cosmos
 {
     class World
     {
+    public:
+
+        /// @brief the nearest entity hit by a ray
+        struct RaycastHit
+        {
+            entt::entity entity = entt::null;
+            float distance = 0.0f;                      // in ray direction lengths
+            float3 position = { 0.0f, 0.0f, 0.0f };     // where the ray enters the entity bounds
+        };
+
+        /// @brief how many refits the bvh goes through before it's re-built, refits degrade it's quality as entities move
+        static constexpr unsigned int BVHRebuildInterval = 300;
+
     public:
 
         /// @brief constructor
@@ -25,6 +41,9 @@ namespace Cosmos
         /// @brief returns a reference to the world entity registry
         inline entt::registry& GetRegistryRef() { return mRegistry; }
 
+        /// @brief returns the bounding volume hierarchy over the entities with a transform
+        inline const BVH& GetBVH() const { return mBVH; }
+
     public:
 
         /// called once per frame, updates the world
@@ -33,10 +52,42 @@ namespace Cosmos
         /// called once per frame, renders the world
         void OnRender(int stage, double interpolation);
 
+        /// @brief submits the point lights of the entities with a transform and a light to the renderer, must be called every frame before rendering
+        /// @param context the renderer the world is rendered with
+        void SubmitLights(CRenContext* context);
+
+    public:
+
+        /// @brief returns the world-space ray going through a point of the camera's image, the camera's inverse view-projection un-projects it
+        /// @param camera the camera the image is rendered with
+        /// @param x point on the image, like returned by Window::GetViewportCursorPosition
+        /// @param y point on the image
+        /// @param width image width
+        /// @param height image height
+        static Ray ScreenToRay(const CRenCamera& camera, double x, double y, double width, double height);
+
+        /// @brief finds the nearest entity with a transform hit by a ray, on the cpu and without waiting for the gpu picking
+        /// @note entities are bound by their transform applied to a [-1, 1] box (the size of a quad), as of the last OnUpdate or RefreshBVH
+        /// @param origin ray origin
+        /// @param direction ray direction
+        /// @param outHit the nearest hit, may be nullptr
+        /// @param maxDistance hits further than this are ignored
+        /// @return true if an entity was hit
+        bool Raycast(float3 origin, float3 direction, RaycastHit* outHit = nullptr, float maxDistance = FLT_MAX);
+
+        /// @brief updates the entities bvh to their current transforms, refitting it or re-building it when entities were added/removed. Called by OnUpdate
+        void RefreshBVH();
+
     private:
 
         const char* mName;
         Library<Entity*> mEntities;
         entt::registry mRegistry;
+
+        BVH mBVH;
+        std::vector<entt::entity> mBVHEntities;     // entity of every box on the bvh
+        std::vector<entt::entity> mRefreshEntities; // entities with a transform on the current refresh, kept to avoid allocations
+        std::vector<AABB> mBVHBounds;
+        unsigned int mRefitCount = 0;
     };
 }
\ No newline at end of file
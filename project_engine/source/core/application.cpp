@@ -6,10 +6,11 @@ namespace Cosmos
 {
     Application::Application(const CreateInfo& ci) : 
         mWindow(this, ci.appName, ci.width, ci.height, ci.requestFullscreen), 
-        mRenderer(this, ci.appName, ci.requestViewport, ci.requestValidations),
+        mRenderer(this, ci.appName, ci.requestViewport, ci.requestValidations, ci.msaa, ci.vsync),
         mGUI(this)
     {
-    
+        mRenderer.GetGovernorRef().SetTargetFrameTime(ci.targetFrameTime);
+        mRenderer.GetGovernorRef().SetEnabled(ci.adaptiveQuality);
     }
 
     Application::~Application()
@@ -31,6 +32,8 @@ namespace Cosmos
             mTimeStep = (currentTicks - previousTicks) / (double)mWindow.GetTimerFrequency();
             previousTicks = currentTicks;
 
+            mRenderer.GetGovernorRef().OnUpdate(mTimeStep);
+
             mWindow.OnUpdate();
             mGUI.OnUpdate();
 
@@ -0,0 +1,138 @@
+#include "core/governor.h"
+
+#include "core/logger.h"
+
+namespace Cosmos
+{
+	QualityGovernor::QualityGovernor(CRenContext* context)
+		: mContext(context)
+	{
+		CRenVulkanBackend* backend = (CRenVulkanBackend*)mContext->backend;
+		int maxMSAA = (int)crenvk_device_get_max_msaa(backend->device.physicalDevice);
+
+		// the viewport is rendered without multisampling, it's cost is driven by the render scale. Otherwise msaa is what we can trade
+		if (backend->hint_viewport) {
+			mLevels.push_back({ 1, 0.5f });
+			mLevels.push_back({ 1, 0.75f });
+			mLevels.push_back({ 1, 1.0f });
+		}
+
+		else {
+			for (int msaa = 1; msaa <= maxMSAA && msaa <= 8; msaa *= 2) {
+				mLevels.push_back({ msaa, 1.0f });
+			}
+		}
+
+		// start at the highest level that is not above the current configuration
+		float renderScale = backend->hint_viewport ? backend->viewportRenderphase.renderScale : 1.0f;
+		for (unsigned int i = 0; i < (unsigned int)mLevels.size(); i++) {
+			if (mLevels[i].msaa <= mContext->createInfo.msaa && mLevels[i].renderScale <= renderScale) {
+				mLevel = i;
+			}
+		}
+
+		mPreferVSync = mContext->createInfo.vsync != 0;
+	}
+
+	void QualityGovernor::SetEnabled(bool value)
+	{
+		if (mEnabled == value) return;
+
+		mEnabled = value;
+		mPreferVSync = mContext->createInfo.vsync != 0;
+		mStableWindows = 0;
+		ClearWindow();
+
+		// the viewport automatic scale would fight over the render scale
+		if (mEnabled) crenvk_renderphase_viewport_set_auto_scale(mContext, 0, mTargetFrameTime);
+	}
+
+	void QualityGovernor::SetLevel(unsigned int level)
+	{
+		if (mLevels.empty()) return;
+
+		mLevel = level < (unsigned int)mLevels.size() ? level : (unsigned int)mLevels.size() - 1;
+		ApplyLevel();
+		ClearWindow();
+	}
+
+	void QualityGovernor::OnUpdate(double frameTime)
+	{
+		if (!mEnabled || mLevels.empty()) return;
+
+		mWindowSum += frameTime;
+		mWindowCount++;
+
+		if (mWindowCount < WindowSize) return;
+
+		// a full window, time to decide
+		mAverageFrameTime = mWindowSum / (double)WindowSize;
+		ClearWindow();
+
+		const unsigned int topLevel = (unsigned int)mLevels.size() - 1;
+		const bool overBudget = mAverageFrameTime > mTargetFrameTime * 1.10;
+		const bool underBudget = mAverageFrameTime < mTargetFrameTime * 0.75;
+
+		// step down right away, frame drops are more noticeable than quality
+		if (overBudget) {
+			mStableWindows = 0;
+
+			if (mLevel > 0) {
+				mLevel--;
+				ApplyLevel();
+				COSMOS_LOG(LogSeverity::Info, "Quality governor stepped down to level %u (%.2fms average)", mLevel, mAverageFrameTime * 1000.0);
+			}
+
+			// already at the cheapest level, tearing is preferable than halving the framerate with vsync
+			else if (mContext->createInfo.vsync) {
+				cren_set_vsync(mContext, 0);
+				COSMOS_LOG(LogSeverity::Info, "Quality governor disabled vsync (%.2fms average)", mAverageFrameTime * 1000.0);
+			}
+
+			return;
+		}
+
+		// step up only after being stable under budget for a while, avoiding ping-ponging between two levels
+		if (underBudget) {
+			mStableWindows++;
+			if (mStableWindows < StableWindowsToUpgrade) return;
+			mStableWindows = 0;
+
+			// restore the user's vsync before spending the headroom on quality
+			if (mPreferVSync && !mContext->createInfo.vsync) {
+				cren_set_vsync(mContext, 1);
+				COSMOS_LOG(LogSeverity::Info, "Quality governor restored vsync (%.2fms average)", mAverageFrameTime * 1000.0);
+			}
+
+			else if (mLevel < topLevel) {
+				mLevel++;
+				ApplyLevel();
+				COSMOS_LOG(LogSeverity::Info, "Quality governor stepped up to level %u (%.2fms average)", mLevel, mAverageFrameTime * 1000.0);
+			}
+
+			return;
+		}
+
+		// within the hysteresis band, keep things as they are
+		mStableWindows = 0;
+	}
+
+	void QualityGovernor::ApplyLevel()
+	{
+		const Level& level = mLevels[mLevel];
+		CRenVulkanBackend* backend = (CRenVulkanBackend*)mContext->backend;
+
+		cren_set_msaa(mContext, level.msaa);
+
+		if (backend->hint_viewport) {
+			crenvk_renderphase_viewport_set_auto_scale(mContext, 0, mTargetFrameTime);
+			crenvk_renderphase_viewport_set_render_scale(mContext, level.renderScale);
+		}
+	}
+
+	void QualityGovernor::ClearWindow()
+	{
+		mWindowCount = 0;
+		mWindowSum = 0.0;
+	}
+}
\ No newline at end of file
@@ -1,10 +1,11 @@
 #include "core/renderer.h"
 #include "core/application.h"
 #include "core/logger.h"
+#include "scene/world.h"
 
 namespace Cosmos
 {
-	Renderer::Renderer(Application* app, const char* appName, bool requestViewport, bool validations)
+	Renderer::Renderer(Application* app, const char* appName, bool requestViewport, bool validations, int msaa, bool vsync)
         : mApp(app)
 	{
         // initialization
@@ -14,8 +15,8 @@ namespace Cosmos
         ci.assetsRoot = "data";
         ci.apiVersion = CREN_MAKE_VERSION(0, 1, 0, 2);
         ci.validations = validations;
-        ci.vsync = 0;
-        ci.msaa = 4;
+        ci.vsync = (int)vsync;
+        ci.msaa = msaa;
         ci.width = mApp->GetWindowRef().GetWidth();
         ci.height = mApp->GetWindowRef().GetHeight();
         ci.smallerViewport = (int)requestViewport;
@@ -24,6 +25,8 @@ namespace Cosmos
         mContext = cren_initialize(ci);
         COSMOS_ASSERT(mContext != nullptr, "Failed to initialize CRen");
 
+        mGovernor = new QualityGovernor(mContext);
+
         // callbacks
         cren_set_user_pointer(mContext, this);
 
@@ -50,6 +53,7 @@ namespace Cosmos
 
 	Renderer::~Renderer()
 	{
+        delete mGovernor;
         cren_terminate(mContext);
 	}
 
@@ -60,6 +64,9 @@ namespace Cosmos
 
     void Renderer::OnRender(double timestep)
     {
+        // the renderer forgets the lights after every frame
+        if (mWorld != nullptr) mWorld->SubmitLights(mContext);
+
         cren_render(mContext, timestep);
     }
 
@@ -0,0 +1,282 @@
+#include "scene/bvh.h"
+
+#include <algorithm>
+#include <utility>
+
+namespace Cosmos
+{
+	void AABB::Grow(const float3& point)
+	{
+		min = { std::min(min.x, point.x), std::min(min.y, point.y), std::min(min.z, point.z) };
+		max = { std::max(max.x, point.x), std::max(max.y, point.y), std::max(max.z, point.z) };
+	}
+
+	void AABB::Grow(const AABB& other)
+	{
+		min = { std::min(min.x, other.min.x), std::min(min.y, other.min.y), std::min(min.z, other.min.z) };
+		max = { std::max(max.x, other.max.x), std::max(max.y, other.max.y), std::max(max.z, other.max.z) };
+	}
+
+	float3 AABB::GetCenter() const
+	{
+		return { (min.x + max.x) * 0.5f, (min.y + max.y) * 0.5f, (min.z + max.z) * 0.5f };
+	}
+
+	float AABB::GetSurfaceArea() const
+	{
+		float3 extent = { max.x - min.x, max.y - min.y, max.z - min.z };
+		if (extent.x < 0.0f || extent.y < 0.0f || extent.z < 0.0f) return 0.0f;
+
+		return 2.0f * (extent.x * extent.y + extent.y * extent.z + extent.z * extent.x);
+	}
+
+	// returns the distance the ray enters the box at, FLT_MAX if it misses. The inverse direction is pre-computed by the caller
+	static float IntersectAABB(const AABB& box, const float3& origin, const float3& inverseDirection)
+	{
+		float tx1 = (box.min.x - origin.x) * inverseDirection.x;
+		float tx2 = (box.max.x - origin.x) * inverseDirection.x;
+		float tmin = std::min(tx1, tx2);
+		float tmax = std::max(tx1, tx2);
+
+		float ty1 = (box.min.y - origin.y) * inverseDirection.y;
+		float ty2 = (box.max.y - origin.y) * inverseDirection.y;
+		tmin = std::max(tmin, std::min(ty1, ty2));
+		tmax = std::min(tmax, std::max(ty1, ty2));
+
+		float tz1 = (box.min.z - origin.z) * inverseDirection.z;
+		float tz2 = (box.max.z - origin.z) * inverseDirection.z;
+		tmin = std::max(tmin, std::min(tz1, tz2));
+		tmax = std::min(tmax, std::max(tz1, tz2));
+
+		// boxes behind the origin are misses, boxes around it are hit right away
+		tmin = std::max(tmin, 0.0f);
+		return tmax >= tmin ? tmin : FLT_MAX;
+	}
+
+	void BVH::Build(const std::vector<AABB>& bounds)
+	{
+		mNodes.clear();
+		mBounds = bounds;
+		if (mBounds.empty()) return;
+
+		unsigned int count = (unsigned int)mBounds.size();
+		mIndices.resize(count);
+		mCenters.resize(count);
+		for (unsigned int i = 0; i < count; i++) {
+			mIndices[i] = i;
+			mCenters[i] = mBounds[i].GetCenter();
+		}
+
+		// a binary tree with single-box leaves has at most 2n - 1 nodes, reserving it keeps node references valid while splitting
+		mNodes.reserve((size_t)count * 2);
+		Node root;
+		root.first = 0;
+		root.count = count;
+		UpdateLeafBounds(root);
+		mNodes.push_back(root);
+
+		std::vector<std::pair<unsigned int, unsigned int>> stack; // node, depth
+		stack.push_back({ 0, 1 });
+
+		while (!stack.empty()) {
+			auto [nodeIndex, depth] = stack.back();
+			stack.pop_back();
+
+			if (depth >= MaxDepth || !Split(nodeIndex)) continue;
+
+			unsigned int left = mNodes[nodeIndex].first;
+			stack.push_back({ left, depth + 1 });
+			stack.push_back({ left + 1, depth + 1 });
+		}
+
+		mCenters.clear();
+	}
+
+	void BVH::Refit(const std::vector<AABB>& bounds)
+	{
+		if (bounds.size() != mBounds.size() || mNodes.empty()) {
+			Build(bounds);
+			return;
+		}
+
+		mBounds = bounds;
+
+		// children are always created after their parent, walking backwards visits them first
+		for (size_t i = mNodes.size(); i-- > 0;) {
+			Node& node = mNodes[i];
+
+			if (node.count > 0) {
+				UpdateLeafBounds(node);
+				continue;
+			}
+
+			node.bounds = mNodes[node.first].bounds;
+			node.bounds.Grow(mNodes[node.first + 1].bounds);
+		}
+	}
+
+	bool BVH::Raycast(const Ray& ray, float maxDistance, Hit& outHit) const
+	{
+		if (mNodes.empty()) return false;
+
+		// a zero direction component becomes infinity, which the slab test handles
+		const float3 inverseDirection = { 1.0f / ray.direction.x, 1.0f / ray.direction.y, 1.0f / ray.direction.z };
+		float closest = maxDistance;
+		bool hit = false;
+
+		if (IntersectAABB(mNodes[0].bounds, ray.origin, inverseDirection) >= closest) return false;
+
+		unsigned int stack[MaxDepth];
+		unsigned int stackSize = 0;
+		unsigned int nodeIndex = 0;
+
+		while (true) {
+			const Node& node = mNodes[nodeIndex];
+
+			if (node.count > 0) {
+				for (unsigned int i = node.first; i < node.first + node.count; i++) {
+					float distance = IntersectAABB(mBounds[mIndices[i]], ray.origin, inverseDirection);
+					if (distance >= closest) continue;
+
+					closest = distance;
+					outHit.index = mIndices[i];
+					outHit.distance = distance;
+					hit = true;
+				}
+
+				if (stackSize == 0) break;
+				nodeIndex = stack[--stackSize];
+				continue;
+			}
+
+			// the nearest child is visited first, so the other one is often culled by the hits found on it
+			unsigned int nearChild = node.first;
+			unsigned int farChild = node.first + 1;
+			float nearDistance = IntersectAABB(mNodes[nearChild].bounds, ray.origin, inverseDirection);
+			float farDistance = IntersectAABB(mNodes[farChild].bounds, ray.origin, inverseDirection);
+
+			if (nearDistance > farDistance) {
+				std::swap(nearDistance, farDistance);
+				std::swap(nearChild, farChild);
+			}
+
+			if (nearDistance >= closest) {
+				if (stackSize == 0) break;
+				nodeIndex = stack[--stackSize];
+				continue;
+			}
+
+			nodeIndex = nearChild;
+			if (farDistance < closest) stack[stackSize++] = farChild;
+		}
+
+		return hit;
+	}
+
+	bool BVH::Split(unsigned int nodeIndex)
+	{
+		Node& node = mNodes[nodeIndex];
+		if (node.count <= LeafSize) return false;
+
+		// bins are laid over the centers, not the boxes, so large boxes don't squeeze every center into a single bin
+		AABB centerBounds;
+		for (unsigned int i = node.first; i < node.first + node.count; i++) {
+			centerBounds.Grow(mCenters[mIndices[i]]);
+		}
+
+		struct Bin
+		{
+			AABB bounds;
+			unsigned int count = 0;
+		};
+
+		int bestAxis = -1;
+		unsigned int bestSplit = 0;
+		float bestCost = FLT_MAX;
+
+		for (int axis = 0; axis < 3; axis++) {
+			float low = centerBounds.min.data[axis];
+			float extent = centerBounds.max.data[axis] - low;
+			if (extent <= 0.0f) continue;
+
+			Bin bins[BinCount];
+			float scale = (float)BinCount / extent;
+			for (unsigned int i = node.first; i < node.first + node.count; i++) {
+				unsigned int index = mIndices[i];
+				unsigned int bin = std::min(BinCount - 1, (unsigned int)((mCenters[index].data[axis] - low) * scale));
+				bins[bin].bounds.Grow(mBounds[index]);
+				bins[bin].count++;
+			}
+
+			// sweep the bins from both sides, the cost of a split is how many boxes each side holds weighted by it's area
+			float leftArea[BinCount - 1], rightArea[BinCount - 1];
+			unsigned int leftCount[BinCount - 1], rightCount[BinCount - 1];
+			AABB leftBox, rightBox;
+			unsigned int leftSum = 0, rightSum = 0;
+
+			for (unsigned int i = 0; i < BinCount - 1; i++) {
+				leftSum += bins[i].count;
+				leftBox.Grow(bins[i].bounds);
+				leftCount[i] = leftSum;
+				leftArea[i] = leftBox.GetSurfaceArea();
+
+				rightSum += bins[BinCount - 1 - i].count;
+				rightBox.Grow(bins[BinCount - 1 - i].bounds);
+				rightCount[BinCount - 2 - i] = rightSum;
+				rightArea[BinCount - 2 - i] = rightBox.GetSurfaceArea();
+			}
+
+			for (unsigned int i = 0; i < BinCount - 1; i++) {
+				if (leftCount[i] == 0 || rightCount[i] == 0) continue;
+
+				float cost = (float)leftCount[i] * leftArea[i] + (float)rightCount[i] * rightArea[i];
+				if (cost >= bestCost) continue;
+
+				bestAxis = axis;
+				bestSplit = i;
+				bestCost = cost;
+			}
+		}
+
+		// every center is on the same spot or no split beats testing every box of the node
+		if (bestAxis < 0 || bestCost >= (float)node.count * node.bounds.GetSurfaceArea()) return false;
+
+		float low = centerBounds.min.data[bestAxis];
+		float scale = (float)BinCount / (centerBounds.max.data[bestAxis] - low);
+		unsigned int i = node.first;
+		unsigned int j = node.first + node.count;
+
+		while (i < j) {
+			unsigned int bin = std::min(BinCount - 1, (unsigned int)((mCenters[mIndices[i]].data[bestAxis] - low) * scale));
+			if (bin <= bestSplit) i++;
+			else std::swap(mIndices[i], mIndices[--j]);
+		}
+
+		unsigned int leftCount = i - node.first;
+		if (leftCount == 0 || leftCount == node.count) return false;
+
+		Node left;
+		left.first = node.first;
+		left.count = leftCount;
+		UpdateLeafBounds(left);
+
+		Node right;
+		right.first = i;
+		right.count = node.count - leftCount;
+		UpdateLeafBounds(right);
+
+		node.first = (unsigned int)mNodes.size();
+		node.count = 0;
+		mNodes.push_back(left);
+		mNodes.push_back(right);
+		return true;
+	}
+
+	void BVH::UpdateLeafBounds(Node& node) const
+	{
+		node.bounds = AABB();
+		for (unsigned int i = node.first; i < node.first + node.count; i++) {
+			node.bounds.Grow(mBounds[mIndices[i]]);
+		}
+	}
+}
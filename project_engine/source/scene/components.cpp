@@ -101,4 +101,39 @@ namespace Cosmos
 
 		return mat4_mul(smat, mat4_mul(rmat, tmat)); // scale  (rotate  translate) // (Row-Major)
 	}
+
+	LightComponent::LightComponent(float3 color, float intensity, float radius)
+		: color(color), intensity(intensity), radius(radius)
+	{
+	}
+
+	void LightComponent::Serialize(Entity* entity, Datafile& dataFile)
+	{
+		if (entity->HasComponent<LightComponent>()) {
+			std::string uuid = std::to_string(entity->GetComponent<IDComponent>().id);
+			auto& component = entity->GetComponent<LightComponent>();
+			auto& place = dataFile[uuid]["Light"];
+
+			place["Color"]["R"].SetDouble(component.color.x);
+			place["Color"]["G"].SetDouble(component.color.y);
+			place["Color"]["B"].SetDouble(component.color.z);
+
+			place["Intensity"].SetDouble(component.intensity);
+			place["Radius"].SetDouble(component.radius);
+		}
+	}
+
+	void LightComponent::Deserialize(Entity* entity, Datafile& dataFile)
+	{
+		if (dataFile.Exists("Light")) {
+			entity->AddComponent<LightComponent>();
+			auto& component = entity->GetComponent<LightComponent>();
+
+			auto& dataC = dataFile["Light"]["Color"];
+			component.color = { (float)dataC["R"].GetDouble(), (float)dataC["G"].GetDouble(), (float)dataC["B"].GetDouble() };
+
+			component.intensity = (float)dataFile["Light"]["Intensity"].GetDouble();
+			component.radius = (float)dataFile["Light"]["Radius"].GetDouble();
+		}
+	}
 }
\ No newline at end of file
@@ -13,5 +13,7 @@ namespace Cosmos
     {
         IDComponent::Serialize(this, data);
         NameComponent::Serialize(this, data);
+        TransformComponent::Serialize(this, data);
+        LightComponent::Serialize(this, data);
     }
 }
\ No newline at end of file
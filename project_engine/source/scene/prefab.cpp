@@ -136,6 +136,11 @@ namespace Cosmos
             );
         }
 
+        if (entity->HasComponent<LightComponent>()) {
+            const LightComponent& light = entity->GetComponent<LightComponent>();
+            newEntity->AddComponent<LightComponent>(light.color, light.intensity, light.radius);
+        }
+
         // insert into the library of entities
         std::stringstream ss;
         ss << newEntity->GetComponent<IDComponent>().id;
@@ -185,6 +190,7 @@ namespace Cosmos
                 IDComponent::Deserialize(entity, data);
                 NameComponent::Deserialize(entity, data);
                 TransformComponent::Deserialize(entity, data);
+                LightComponent::Deserialize(entity, data);
 
                 prefab->GetEntitiesRef().insert({ entity->GetComponent<NameComponent>().name, entity });
 
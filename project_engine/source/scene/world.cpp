@@ -1,7 +1,22 @@
 #include "scene/world.h"
 
+#include "scene/components.h"
+
+#include <cmath>
+
 namespace Cosmos
 {
+	// multiplies a column-major matrix by a vector, like the shaders do
+	static float4 TransformVector(const mat4& m, float4 v)
+	{
+		float4 result;
+		for (int row = 0; row < 4; row++) {
+			result.data[row] = m.data[0][row] * v.x + m.data[1][row] * v.y + m.data[2][row] * v.z + m.data[3][row] * v.w;
+		}
+
+		return result;
+	}
+
 	World::World(const char* name)
 		: mName(name)
 	{
@@ -13,9 +28,100 @@ namespace Cosmos
 
 	void World::OnUpdate(double timestep)
 	{
+		RefreshBVH();
 	}
 
 	void World::OnRender(int stage, double interpolation)
 	{
 	}
+
+	void World::SubmitLights(CRenContext* context)
+	{
+		auto view = mRegistry.view<TransformComponent, LightComponent>();
+		for (auto handle : view) {
+			const TransformComponent& transform = view.get<TransformComponent>(handle);
+			const LightComponent& light = view.get<LightComponent>(handle);
+
+			vkPointLight pointLight = { 0 };
+			pointLight.position = transform.translation;
+			pointLight.radius = light.radius;
+			pointLight.color = light.color;
+			pointLight.intensity = light.intensity;
+
+			// lights past the renderer's limit are dropped, there's no point on trying the others
+			if (!crenvk_light_submit(context, &pointLight)) return;
+		}
+	}
+
+	Ray World::ScreenToRay(const CRenCamera& camera, double x, double y, double width, double height)
+	{
+		// same projection the renderer sends to the gpu, with vulkan's flipped y
+		mat4 projection = camera.perspective;
+		projection.data[1][1] *= -1.0f;
+		mat4 inverseViewProjection = mat4_inverse(mat4_mul(camera.view, projection)); // my mat4 is reversed, this is projection * view
+
+		float ndcX = width > 0.0 ? (float)(2.0 * x / width - 1.0) : 0.0f;
+		float ndcY = height > 0.0 ? (float)(2.0 * y / height - 1.0) : 0.0f;
+		float4 nearPoint = TransformVector(inverseViewProjection, { ndcX, ndcY, 0.0f, 1.0f });
+		float4 farPoint = TransformVector(inverseViewProjection, { ndcX, ndcY, 1.0f, 1.0f });
+
+		float3 origin = { nearPoint.x / nearPoint.w, nearPoint.y / nearPoint.w, nearPoint.z / nearPoint.w };
+		float3 target = { farPoint.x / farPoint.w, farPoint.y / farPoint.w, farPoint.z / farPoint.w };
+
+		Ray ray;
+		ray.origin = origin;
+		ray.direction = float3_normalize(float3_sub(target, origin));
+		return ray;
+	}
+
+	bool World::Raycast(float3 origin, float3 direction, RaycastHit* outHit, float maxDistance)
+	{
+		Ray ray;
+		ray.origin = origin;
+		ray.direction = direction;
+
+		BVH::Hit hit;
+		if (!mBVH.Raycast(ray, maxDistance, hit)) return false;
+
+		if (outHit) {
+			outHit->entity = mBVHEntities[hit.index];
+			outHit->distance = hit.distance;
+			outHit->position = float3_add(origin, float3_scalar(direction, hit.distance));
+		}
+
+		return true;
+	}
+
+	void World::RefreshBVH()
+	{
+		mRefreshEntities.clear();
+		mBVHBounds.clear();
+
+		auto view = mRegistry.view<TransformComponent>();
+		for (auto handle : view) {
+			mat4 transform = view.get<TransformComponent>(handle).GetTransform();
+
+			// the [-1, 1] box transformed, each axis extent is the sum of the absolute rotated/scaled axes
+			AABB box;
+			for (int row = 0; row < 3; row++) {
+				float extent = std::fabs(transform.data[0][row]) + std::fabs(transform.data[1][row]) + std::fabs(transform.data[2][row]);
+				box.min.data[row] = transform.data[3][row] - extent;
+				box.max.data[row] = transform.data[3][row] + extent;
+			}
+
+			mRefreshEntities.push_back(handle);
+			mBVHBounds.push_back(box);
+		}
+
+		// the same entities are refitted in place, anything else builds a new tree
+		if (mRefreshEntities == mBVHEntities && mRefitCount < BVHRebuildInterval && !mBVH.IsEmpty()) {
+			mBVH.Refit(mBVHBounds);
+			mRefitCount++;
+			return;
+		}
+
+		mBVHEntities.swap(mRefreshEntities);
+		mBVH.Build(mBVHBounds);
+		mRefitCount = 0;
+	}
 }
\ No newline at end of file
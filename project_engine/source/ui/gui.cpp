@@ -102,6 +102,21 @@ namespace Cosmos
 		initInfo.MSAASamples = rendererBackend->uiRenderphase.renderpass->msaa;
 		initInfo.Allocator = nullptr;
 		initInfo.RenderPass = rendererBackend->uiRenderphase.renderpass->renderPass;
+		initInfo.ApiVersion = rendererBackend->device.apiVersion; // below 1.3 imgui loads the KHR dynamic rendering entry points
+		if (rendererBackend->uiRenderphase.renderpass->dynamic) {
+			// there's no render pass object, imgui builds it's pipeline against the swapchain format
+			initInfo.UseDynamicRendering = true;
+			initInfo.PipelineRenderingCreateInfo = {};
+			initInfo.PipelineRenderingCreateInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_RENDERING_CREATE_INFO_KHR;
+			initInfo.PipelineRenderingCreateInfo.colorAttachmentCount = 1;
+			initInfo.PipelineRenderingCreateInfo.pColorAttachmentFormats = &rendererBackend->uiRenderphase.renderpass->surfaceFormat;
+		}
+
+		if (rendererBackend->uiRenderphase.merged) {
+			// the ui is drawn on the default render pass second subpass, over the resolved image
+			initInfo.RenderPass = rendererBackend->defaultRenderphase.renderpass->renderPass;
+			initInfo.Subpass = 1;
+		}
 		ImGui_ImplVulkan_Init(&initInfo);
 		// fonts
 		constexpr const ImWchar iconRanges1[] = { ICON_MIN_FA, ICON_MAX_FA, 0 };
@@ -1,4 +1,5 @@
 #include <stdio.h>
+#include <stdlib.h>
 #include <cren.h>
 
 #ifdef PLATFORM_WINDOWS
@@ -16,6 +17,71 @@
 
 static CRenContext* sContext = NULL;
 
+// optional overdraw benchmark, run the example with a cut-out sprite path (and optionally how many layers) to stack full-screen sprites in front of the camera
+// the depth prepass is toggled every few seconds and the average gpu frame time of each mode is printed, the difference is the overdraw the prepass saves
+#define BENCHMARK_LAYERS_DEFAULT 64
+#define BENCHMARK_LAYERS_MAX 1024
+#define BENCHMARK_PERIOD 3.0
+
+typedef struct {
+    CRenQuad* quads[BENCHMARK_LAYERS_MAX];
+    int layers;
+    double elapsed;                 // seconds on the current mode
+    double gpuSum;
+    unsigned int gpuCount;
+} Benchmark;
+
+static Benchmark sBenchmark = { 0 };
+
+// creates the benchmark sprites, the first layer is the nearest one so the blended draw order (back-to-front) shades every layer of every pixel
+static void benchmark_create(const char* spritePath, int layers) {
+    sBenchmark.layers = layers < 1 ? 1 : (layers > BENCHMARK_LAYERS_MAX ? BENCHMARK_LAYERS_MAX : layers);
+    for (int i = 0; i < sBenchmark.layers; i++) {
+        sBenchmark.quads[i] = crenvk_quad_create(sContext, spritePath);
+    }
+
+    if (!crenvk_frame_timer_set_enabled(sContext, 1)) printf("Benchmark: gpu timestamps are unsupported\n");
+    printf("Benchmark: %d layers, depth prepass %s\n", sBenchmark.layers, crenvk_renderphase_default_prepass_enabled(sContext) ? "on" : "off");
+}
+
+// submits the sprites and gathers the gpu time of the previous frames, must be called before cren_render
+static void benchmark_update(double timestep) {
+    if (sBenchmark.layers == 0) return;
+
+    // the camera starts at (0, 1, 0) looking towards -z, every sprite covers the whole view
+    for (int i = 0; i < sBenchmark.layers; i++) {
+        if (sBenchmark.quads[i] == NULL) continue;
+        mat4 transform = mat4_translate(mat4_identity(), (float3){ 0.0f, 1.0f, -2.0f - 0.01f * (float)i });
+        transform = mat4_scale(transform, (float3){ 4.0f, 4.0f, 1.0f });
+        crenvk_quad_submit(sContext, sBenchmark.quads[i], transform);
+    }
+
+    // the oldest frame in flight was waited on by the previous cren_render
+    CRenVulkanBackend* renderer = (CRenVulkanBackend*)sContext->backend;
+    double milliseconds = 0.0;
+    if (renderer->retirement.frameNumber >= CREN_CONCURRENTLY_RENDERED_FRAMES && crenvk_frame_timer_get(sContext, renderer->retirement.frameNumber - CREN_CONCURRENTLY_RENDERED_FRAMES, &milliseconds)) {
+        sBenchmark.gpuSum += milliseconds;
+        sBenchmark.gpuCount++;
+    }
+
+    sBenchmark.elapsed += timestep;
+    if (sBenchmark.elapsed < BENCHMARK_PERIOD) return;
+
+    int prepass = crenvk_renderphase_default_prepass_enabled(sContext);
+    if (sBenchmark.gpuCount > 0) printf("Benchmark: depth prepass %-3s gpu avg %8.3f ms over %u frames\n", prepass ? "on" : "off", sBenchmark.gpuSum / sBenchmark.gpuCount, sBenchmark.gpuCount);
+
+    crenvk_renderphase_default_set_prepass(sContext, !prepass);
+    sBenchmark.elapsed = 0.0;
+    sBenchmark.gpuSum = 0.0;
+    sBenchmark.gpuCount = 0;
+}
+
+static void benchmark_destroy() {
+    for (int i = 0; i < sBenchmark.layers; i++) {
+        crenvk_quad_destroy(sContext, sBenchmark.quads[i]);
+    }
+}
+
 // required cren callback, it signals the user when it's time to draw objects so the user can manager how and what to draw
 static void render_callback(CRenContext* context, CRenRenderStage stage, double timestep) {}
 
@@ -84,6 +150,10 @@ int main(int arg, char** argv) {
     ci.width = width;                               // initial window width
     ci.height = height;                             // initial window height
     ci.smallerViewport = 1;                         // request the renderer to be displayed on a smaller viewport and not the window entirelly
+    ci.picking = 0;                                 // the object picking phase is only created once something is picked, instead of at initialization
+    ci.depthPrepass = 0;                            // sprites are shaded back-to-front without a depth prepass, see the overdraw benchmark
+    ci.dynamicRendering = 0;                        // phases render with render pass and framebuffer objects, dynamic rendering needs vulkan 1.3 or VK_KHR_dynamic_rendering
+    ci.mergedUI = 0;                                // the ui has it's own render pass, merging it into the default one saves bandwidth on tile-based gpus
     ci.nativeWindow = glfwGetWin32Window(window);   // ptr to the window object so a window-surface may be created for that window in particular, in this case a HWND
 
     // initialize the CRen
@@ -99,6 +169,9 @@ int main(int arg, char** argv) {
     cren_set_ui_image_count_callback(sContext, uiimagecount_callback);
     cren_set_draw_ui_raw_data_callback(sContext, drawuirawdata_callback);
 
+    // the overdraw benchmark was requested
+    if (arg > 1) benchmark_create(argv[1], arg > 2 ? atoi(argv[2]) : BENCHMARK_LAYERS_DEFAULT);
+
     // main-loop
     uint64_t previousTicks = glfwGetTimerValue();
     double accumulator = 0.0;
@@ -126,10 +199,12 @@ int main(int arg, char** argv) {
         }
 
         const double alpha = accumulator / FIXED_TIMESTEP;
+        benchmark_update(timeStep);
         cren_render(sContext, alpha);
     }
 
     // we must destroy the window and terminate glfw at the end of our program
+    benchmark_destroy();
     cren_terminate(sContext);
     glfwDestroyWindow(window);
     glfwTerminate();